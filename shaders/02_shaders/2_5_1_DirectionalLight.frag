@@ -1,41 +1,24 @@
 #version 330 core
 
+#include "common/Material.glsl"
+#include "common/Light.glsl"
+
 out vec4 FragColor;
 
 in vec3 vNormal;
 in vec3 vFragPos;
 in vec2 vTexCoord;
 
-struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
-    float shininess;
-};
-
-struct Light {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;  
-};
-
 uniform vec3 viewPos;
 uniform Material material;
-uniform Light light;
+uniform DirLight light;
 
 void main() {
-    vec3 ambient = light.ambient * texture(material.diffuse, vTexCoord).rgb;
-
     vec3 norm = normalize(vNormal);
-    vec3 lightDir = normalize(-light.direction);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * texture(material.diffuse, vTexCoord).rgb;
-
     vec3 viewDir = normalize(viewPos - vFragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * spec * (texture(material.specular, vTexCoord).rgb);
+    vec3 diffuseColor = texture(material.diffuse, vTexCoord).rgb;
+    vec3 specularColor = texture(material.specular, vTexCoord).rgb;
 
-    vec3 result = ambient + diffuse + specular;
+    vec3 result = calcDirLight(light, norm, viewDir, diffuseColor, specularColor, material.shininess);
     FragColor = vec4(result, 1.0);
-}
\ No newline at end of file
+}
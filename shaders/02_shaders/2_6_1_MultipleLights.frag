@@ -0,0 +1,54 @@
+#version 330 core
+
+#include "common/Material.glsl"
+#include "common/Light.glsl"
+
+// the application compiles one variant per define set (ShaderLibrary), these are the defaults
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 4
+#endif
+#ifndef SPECULAR_MAP
+#define SPECULAR_MAP 1
+#endif
+#ifndef SPOT_LIGHT
+#define SPOT_LIGHT 1
+#endif
+
+in vec3 vFragPos;
+in vec3 vNormal;
+in vec2 vTexCoord;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform DirLight dirLight;
+#if NUM_POINT_LIGHTS > 0
+uniform PointLight pointLights[NUM_POINT_LIGHTS];
+#endif
+#if SPOT_LIGHT
+uniform SpotLight spotLight;
+#endif
+
+out vec4 FragColor;
+
+void main() {
+    vec3 norm = normalize(vNormal);
+    vec3 viewDir = normalize(viewPos - vFragPos);
+    vec3 diffuseColor = texture(material.diffuse, vTexCoord).rgb;
+#if SPECULAR_MAP
+    vec3 specularColor = texture(material.specular, vTexCoord).rgb;
+#else
+    vec3 specularColor = vec3(0.5);
+#endif
+
+    vec3 result = calcDirLight(dirLight, norm, viewDir, diffuseColor, specularColor, material.shininess);
+#if NUM_POINT_LIGHTS > 0
+    // constant trip count, the compiler unrolls it
+    for (int i = 0; i < NUM_POINT_LIGHTS; i++) {
+        result += calcPointLight(pointLights[i], norm, vFragPos, viewDir, diffuseColor, specularColor, material.shininess);
+    }
+#endif
+#if SPOT_LIGHT
+    result += calcSpotLight(spotLight, norm, vFragPos, viewDir, diffuseColor, specularColor, material.shininess);
+#endif
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 vFragPos;
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+void main() {
+    vFragPos = vec3(model * vec4(aPos, 1.0));
+    vNormal = mat3(transpose(inverse(model))) * aNormal;  
+    vTexCoord = aTexCoord;
+
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
\ No newline at end of file
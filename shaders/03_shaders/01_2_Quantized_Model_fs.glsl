@@ -0,0 +1,12 @@
+#version 330 core
+uniform sampler2D texture_diffuse1;
+in vec2 vTexcoord;
+in vec3 vNormal;
+
+out vec4 fragColor;
+
+void main() {
+    // a little directional shading so broken normals are visible
+    float light = 0.6 + 0.4 * max(dot(normalize(vNormal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+    fragColor = vec4(texture(texture_diffuse1, vTexcoord).rgb * light, 1.0);
+}
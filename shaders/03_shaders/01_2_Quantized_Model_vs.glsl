@@ -0,0 +1,31 @@
+#version 330 core
+// QuantizedVertex layout, see utils/VertexQuantization.h
+layout(location = 0) in vec3 aPosition;   // unorm16, 0..1 inside the mesh AABB
+layout(location = 1) in vec2 aNormal;     // snorm16, octahedral
+layout(location = 2) in vec2 aTexcoord;   // half float
+
+out vec2 vTexcoord;
+out vec3 vNormal;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * s;
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 position = positionOffset + aPosition * positionScale;
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+    vNormal = mat3(model) * octDecode(aNormal);
+    vTexcoord = aTexcoord;
+}
@@ -0,0 +1,16 @@
+#version 330 core
+uniform sampler2DArray atlas;
+in vec2 vTexcoord;
+flat in vec4 vUvTransform;
+flat in float vLayer;
+
+out vec4 fragColor;
+
+void main() {
+    // fract repeats inside the region, the gradients of the unwrapped coordinates keep the
+    // mip level from jumping at the seams
+    vec2 uv = fract(vTexcoord) * vUvTransform.xy + vUvTransform.zw;
+    vec2 dx = dFdx(vTexcoord) * vUvTransform.xy;
+    vec2 dy = dFdy(vTexcoord) * vUvTransform.xy;
+    fragColor = textureGrad(atlas, vec3(uv, vLayer), dx, dy);
+}
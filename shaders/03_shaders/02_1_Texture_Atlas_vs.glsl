@@ -0,0 +1,21 @@
+#version 330 core
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aTexcoord;
+// per instance
+layout(location = 2) in vec2 aOffset;
+layout(location = 3) in vec4 aUvTransform;
+layout(location = 4) in float aLayer;
+
+out vec2 vTexcoord;
+flat out vec4 vUvTransform;
+flat out float vLayer;
+
+uniform mat4 projection;
+uniform float scale;
+
+void main() {
+    gl_Position = projection * vec4(aPosition * scale + aOffset, 0.0f, 1.0f);
+    vTexcoord = aTexcoord;
+    vUvTransform = aUvTransform;
+    vLayer = aLayer;
+}
@@ -0,0 +1,14 @@
+#version 330 core
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aTexcoord;
+
+out vec2 vTexcoord;
+
+uniform mat4 projection;
+uniform float scale;
+uniform vec2 offset;
+
+void main() {
+    gl_Position = projection * vec4(aPosition * scale + offset, 0.0f, 1.0f);
+    vTexcoord = aTexcoord;
+}
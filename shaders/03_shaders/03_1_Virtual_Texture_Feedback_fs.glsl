@@ -0,0 +1,23 @@
+#version 330 core
+uniform sampler2D pageTable;
+uniform vec2 virtualSize;
+uniform float tileSize;
+uniform float maxLevel;
+uniform float feedbackBias;         // log2 of how much smaller the feedback target is
+
+in vec2 vTexcoord;
+
+out vec4 fragColor;
+
+// the tile this pixel samples: x and y low bytes in r and g, level + 1 in b, the high nibbles in a
+void main() {
+    vec2 texel = clamp(vTexcoord, 0.0, 1.0) * virtualSize;
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float level = clamp(floor(0.5 * log2(max(dot(dx, dx), dot(dy, dy))) - feedbackBias), 0.0, maxLevel);
+
+    // tiles of this level, the page table itself is padded to a power of two
+    ivec2 tiles = ivec2(ceil(max(floor(virtualSize / exp2(level)), vec2(1.0)) / tileSize));
+    ivec2 tile = min(ivec2(texel / (tileSize * exp2(level))), tiles - 1);
+    fragColor = vec4(float(tile.x & 255), float(tile.y & 255), level + 1.0, float((tile.x >> 8) | ((tile.y >> 8) << 4))) / 255.0;
+}
@@ -0,0 +1,30 @@
+#version 330 core
+uniform sampler2D pageTexture;      // resident tiles with their borders
+uniform sampler2D pageTable;        // per level: page x, page y, level of the data (x 255)
+uniform vec2 virtualSize;
+uniform float tileSize;
+uniform float tileBorder;
+uniform float pageTextureSize;
+uniform float maxLevel;
+
+in vec2 vTexcoord;
+
+out vec4 fragColor;
+
+void main() {
+    vec2 texel = clamp(vTexcoord, 0.0, 1.0) * virtualSize;
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float level = clamp(floor(0.5 * log2(max(dot(dx, dx), dot(dy, dy)))), 0.0, maxLevel);
+
+    // tiles of this level, the page table itself is padded to a power of two
+    ivec2 tiles = ivec2(ceil(max(floor(virtualSize / exp2(level)), vec2(1.0)) / tileSize));
+    ivec2 tile = min(ivec2(texel / (tileSize * exp2(level))), tiles - 1);
+    vec4 entry = texelFetch(pageTable, tile, int(level)) * 255.0;
+
+    // a missing tile points at a resident ancestor, find the texel inside that coarser tile
+    vec2 inTile = texel / (tileSize * exp2(entry.b));
+    vec2 local = (inTile - floor(inTile)) * tileSize;
+    vec2 page = entry.rg * (tileSize + 2.0 * tileBorder) + tileBorder + local;
+    fragColor = texture(pageTexture, page / pageTextureSize);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec2 aTexcoord;
+
+out vec2 vTexcoord;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+void main() {
+    gl_Position = projection * view * model * vec4(aPosition, 1.0f);
+    vTexcoord = aTexcoord;
+}
@@ -0,0 +1,9 @@
+#version 330 core
+uniform sampler2D textureRGBA;
+in vec2 vTexcoord;
+
+out vec4 fragColor;
+
+void main() {
+    fragColor = texture(textureRGBA, vTexcoord);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+uniform sampler2D textureY;
+uniform sampler2D textureUV;
+uniform mat3 yuvToRgb;
+uniform vec3 yuvOffset;
+in vec2 vTexcoord;
+
+out vec4 fragColor;
+
+void main() {
+    vec3 yuv = vec3(texture(textureY, vTexcoord).r, texture(textureUV, vTexcoord).rg);
+    fragColor = vec4(clamp(yuvToRgb * (yuv - yuvOffset), 0.0f, 1.0f), 1.0f);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aTexcoord;
+
+out vec2 vTexcoord;
+
+uniform vec2 scale;
+
+void main() {
+    gl_Position = vec4(aPosition * scale, 0.0f, 1.0f);
+    // video rows are top-down
+    vTexcoord = vec2(aTexcoord.x, 1.0f - aTexcoord.y);
+}
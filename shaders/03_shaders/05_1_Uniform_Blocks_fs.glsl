@@ -0,0 +1,62 @@
+#version 330 core
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct PointLight {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;   // constant, linear, quadratic
+};
+
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
+layout(std140) uniform Lights {
+    PointLight pointLights[8];
+    int pointLightCount;
+};
+
+in vec3 vFragPos;
+in vec3 vNormal;
+in vec2 vTexCoord;
+
+uniform Material material;
+
+out vec4 FragColor;
+
+vec3 pointLight(PointLight light, vec3 norm, vec3 viewDir, vec3 diffuseColor, vec3 specularColor) {
+    vec3 lightDir = normalize(light.position.xyz - vFragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+
+    float distance = length(light.position.xyz - vFragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
+
+    vec3 ambient = light.ambient.rgb * diffuseColor;
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
+    vec3 specular = light.specular.rgb * spec * specularColor;
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+void main() {
+    vec3 diffuseColor = texture(material.diffuse, vTexCoord).rgb;
+    vec3 specularColor = texture(material.specular, vTexCoord).rgb;
+    vec3 norm = normalize(vNormal);
+    vec3 viewDir = normalize(viewPos.xyz - vFragPos);
+
+    vec3 result = vec3(0.0);
+    for (int i = 0; i < pointLightCount; i++) {
+        result += pointLight(pointLights[i], norm, viewDir, diffuseColor, specularColor);
+    }
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+// FrameUniforms.h, written once per frame for every program
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
+// written once per draw
+layout(std140) uniform Object {
+    mat4 model;
+    mat4 normalMatrix;
+};
+
+out vec3 vFragPos;
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+void main() {
+    vFragPos = vec3(model * vec4(aPos, 1.0));
+    vNormal = mat3(normalMatrix) * aNormal;
+    vTexCoord = aTexCoord;
+
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
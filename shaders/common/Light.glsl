@@ -0,0 +1,81 @@
+// light types and their Phong terms, shared by the lighting shaders
+struct DirLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight {
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    float cutOff;
+    float outerCutOff;
+};
+
+// lightDir points from the fragment to the light, diffuseColor and specularColor come from the material
+vec3 calcPhong(vec3 ambientLight, vec3 diffuseLight, vec3 specularLight, vec3 lightDir, vec3 normal, vec3 viewDir,
+               vec3 diffuseColor, vec3 specularColor, float shininess) {
+    vec3 ambient = ambientLight * diffuseColor;
+
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = diffuseLight * diff * diffuseColor;
+
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = specularLight * spec * specularColor;
+
+    return ambient + diffuse + specular;
+}
+
+float calcAttenuation(float constant, float linear, float quadratic, float distance) {
+    return 1.0 / (constant + linear * distance + quadratic * (distance * distance));
+}
+
+vec3 calcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess) {
+    vec3 lightDir = normalize(-light.direction);
+    return calcPhong(light.ambient, light.diffuse, light.specular, lightDir, normal, viewDir, diffuseColor, specularColor, shininess);
+}
+
+vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess) {
+    vec3 lightDir = normalize(light.position - fragPos);
+    float attenuation = calcAttenuation(light.constant, light.linear, light.quadratic, length(light.position - fragPos));
+    return attenuation * calcPhong(light.ambient, light.diffuse, light.specular, lightDir, normal, viewDir, diffuseColor, specularColor, shininess);
+}
+
+vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess) {
+    vec3 lightDir = normalize(light.position - fragPos);
+
+    // soft edge between cutOff and outerCutOff, the ambient term is not cut
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+
+    vec3 ambient = light.ambient * diffuseColor;
+    vec3 lit = calcPhong(vec3(0.0), light.diffuse, light.specular, lightDir, normal, viewDir, diffuseColor, specularColor, shininess);
+
+    float attenuation = calcAttenuation(light.constant, light.linear, light.quadratic, length(light.position - fragPos));
+    return attenuation * (ambient + intensity * lit);
+}
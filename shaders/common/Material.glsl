@@ -0,0 +1,6 @@
+// textured Phong material, shared by the lighting shaders
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
@@ -2,6 +2,7 @@
 #include "utils/Input.h"
 #include "utils/OribitCamera.h"
 #include "utils/Shader.h"
+#include "utils/ShaderReload.h"
 #include "utils/Texture.h"
 #include "utils/VertexArray.h"
 #include "utils/VertexBuffer.h"
@@ -45,9 +46,13 @@ public:
         lastX = window->getWidth() / 2.0;
         lastY = window->getHeight() / 2.0;
 
+        // edit the shaders while the demo runs
+        ShaderReload::getInstance().start("shaders");
+
         Input& input = Input::getInstance();
         while(!window->shouldClose()) {
             window->pollEvents();
+            ShaderReload::getInstance().update();
 
             if (input.GetMouseButton(GLFW_MOUSE_BUTTON_LEFT)) {
                 if (!dragging) {
@@ -75,21 +80,21 @@ public:
             glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(window->getWidth()) / static_cast<float>(window->getHeight()), 0.1f, 100.0f);
             cubeShader->use();
 
-            cubeShader->setFloat3("viewPos", orbitCamera->getEye());
-            cubeShader->setMatrix4("view", orbitCamera->getViewMatrix());
-            cubeShader->setMatrix4("projection", projection);
+            cubeShader->setFloat3("viewPos"_uniform, orbitCamera->getEye());
+            cubeShader->setMatrix4("view"_uniform, orbitCamera->getViewMatrix());
+            cubeShader->setMatrix4("projection"_uniform, projection);
 
-            cubeShader->setInt("material.diffuse", 0);
-            cubeShader->setInt("material.specular", 1);
-            cubeShader->setFloat("material.shininess", 32.0f);
+            cubeShader->setInt("material.diffuse"_uniform, 0);
+            cubeShader->setInt("material.specular"_uniform, 1);
+            cubeShader->setFloat("material.shininess"_uniform, 32.0f);
 
-            cubeShader->setFloat3("light.ambient", glm::vec3(0.3f, 0.3f, 0.3f));
-            cubeShader->setFloat3("light.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-            cubeShader->setFloat3("light.specular", glm::vec3(1.f, 1.f, 1.f));
-            cubeShader->setFloat3("light.position", lightPos);
-            cubeShader->setFloat("light.constant", 1.0f);   
-            cubeShader->setFloat("light.linear", 0.09f);
-            cubeShader->setFloat("light.quadratic", 0.032f);
+            cubeShader->setFloat3("light.ambient"_uniform, glm::vec3(0.3f, 0.3f, 0.3f));
+            cubeShader->setFloat3("light.diffuse"_uniform, glm::vec3(0.5f, 0.5f, 0.5f));
+            cubeShader->setFloat3("light.specular"_uniform, glm::vec3(1.f, 1.f, 1.f));
+            cubeShader->setFloat3("light.position"_uniform, lightPos);
+            cubeShader->setFloat("light.constant"_uniform, 1.0f);   
+            cubeShader->setFloat("light.linear"_uniform, 0.09f);
+            cubeShader->setFloat("light.quadratic"_uniform, 0.032f);
 
             cubeVao->bind();
             diffuseTex->bind(0);
@@ -99,7 +104,7 @@ public:
                 model = glm::translate(model, cubePositions[i]);
                 float angle = 20.0f * i;
                 model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-                cubeShader->setMatrix4("model", model);
+                cubeShader->setMatrix4("model"_uniform, model);
 
                 glDrawArrays(GL_TRIANGLES, 0, 36);
             }
@@ -110,16 +115,18 @@ public:
             auto model = glm::mat4(1.0);
             model = glm::translate(model, lightPos);
             model = glm::scale(model, glm::vec3(0.2f));
-            lightShader->setFloat3("lightColor", lightColor);
-            lightShader->setMatrix4("model", model);
-            lightShader->setMatrix4("view", orbitCamera->getViewMatrix());
-            lightShader->setMatrix4("projection", projection);
+            lightShader->setFloat3("lightColor"_uniform, lightColor);
+            lightShader->setMatrix4("model"_uniform, model);
+            lightShader->setMatrix4("view"_uniform, orbitCamera->getViewMatrix());
+            lightShader->setMatrix4("projection"_uniform, projection);
             lightVao->bind();
             glDrawArrays(GL_TRIANGLES, 0, 36);
             lightVao->unbind();
         
             window->swapBuffer();
         }
+        // before the window goes, the reload worker's context shares with it
+        ShaderReload::getInstance().stop();
     }
     
 private:
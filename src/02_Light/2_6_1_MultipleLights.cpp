@@ -0,0 +1,315 @@
+#include "utils/Window.h"
+#include "utils/Input.h"
+#include "utils/OribitCamera.h"
+#include "utils/Shader.h"
+#include "utils/ShaderLibrary.h"
+#include "utils/ShaderReload.h"
+#include "utils/Texture.h"
+#include "utils/VertexArray.h"
+#include "utils/VertexBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Directional light, up to 4 point lights and a flashlight, one shader specialized per define set:
+ *   0-4 : NUM_POINT_LIGHTS, the loop over them has a constant trip count
+ *   S   : SPECULAR_MAP, off replaces the specular texture with a constant
+ *   F   : SPOT_LIGHT
+ * Every combination is a program of its own from the ShaderLibrary, compiled on first use (or
+ * loaded from the ProgramCache) and reused after that. The structs and light math come from
+ * shaders/common, edits to them reload every variant.
+ */
+class MultipleLights {
+public:
+    static constexpr int MAX_POINT_LIGHTS = 4;
+
+    MultipleLights(unsigned int width, unsigned int height, const std::string& title)
+    : window(std::make_unique<Window>(width, height, title))
+    , lightShader(std::make_unique<Shader>("shaders/02_shaders/2_1_1_Light.vert", "shaders/02_shaders/2_1_1_Light.frag"))
+    , cubeVao(std::make_unique<VertexArray>())
+    , lightVao(std::make_unique<VertexArray>())
+    , diffuseTex(std::make_unique<Texture>("assets/textures/container2.png"))
+    , specularTex(std::make_unique<Texture>("assets/textures/container2_specular.png"))
+    , orbitCamera(std::make_unique<OribitCamera>(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f), 10.f, 1.f, glm::radians(0.f), glm::radians(0.f)))
+    {
+        init();
+    }
+
+    ~MultipleLights() {
+        // the variants and the reload worker's shared context belong to this window
+        ShaderReload::getInstance().stop();
+        ShaderLibrary::getInstance().clear();
+    }
+
+    void run() {
+        glEnable(GL_DEPTH_TEST);
+
+        glm::vec3 cubePositions[] = {
+            glm::vec3( 0.0f,  0.0f,  0.0f),
+            glm::vec3( 2.0f,  5.0f, -15.0f),
+            glm::vec3(-1.5f, -2.2f, -2.5f),
+            glm::vec3(-3.8f, -2.0f, -12.3f),
+            glm::vec3( 2.4f, -0.4f, -3.5f),
+            glm::vec3(-1.7f,  3.0f, -7.5f),
+            glm::vec3( 1.3f, -2.0f, -2.5f),
+            glm::vec3( 1.5f,  2.0f, -2.5f),
+            glm::vec3( 1.5f,  0.2f, -1.5f),
+            glm::vec3(-1.3f,  1.0f, -1.5f)
+        };
+
+        glm::vec3 pointLightPositions[MAX_POINT_LIGHTS] = {
+            glm::vec3( 0.7f,  0.2f,  2.0f),
+            glm::vec3( 2.3f, -3.3f, -4.0f),
+            glm::vec3(-4.0f,  2.0f, -12.0f),
+            glm::vec3( 0.0f,  0.0f, -3.0f)
+        };
+        glm::vec3 pointLightColors[MAX_POINT_LIGHTS] = {
+            glm::vec3(1.0f, 0.6f, 0.0f),
+            glm::vec3(1.0f, 0.0f, 0.0f),
+            glm::vec3(1.0f, 1.0f, 0.0f),
+            glm::vec3(0.2f, 0.2f, 1.0f)
+        };
+
+        // std::string setters: the keys are hashed once per set, the names are built once here
+        std::vector<std::string> pointLightNames[MAX_POINT_LIGHTS];
+        const char* fields[] = {"position", "ambient", "diffuse", "specular", "constant", "linear", "quadratic"};
+        for (int i = 0; i < MAX_POINT_LIGHTS; i++) {
+            for (const char* field: fields) {
+                pointLightNames[i].push_back("pointLights[" + std::to_string(i) + "]." + field);
+            }
+        }
+
+        lastX = window->getWidth() / 2.0;
+        lastY = window->getHeight() / 2.0;
+
+        ShaderReload::getInstance().start("shaders");
+        selectVariant();
+
+        Input& input = Input::getInstance();
+        while(!window->shouldClose()) {
+            window->pollEvents();
+            ShaderReload::getInstance().update();
+
+            for (int count = 0; count <= MAX_POINT_LIGHTS; count++) {
+                if (input.GetKeyDown(GLFW_KEY_0 + count) && count != numPointLights) {
+                    numPointLights = count;
+                    selectVariant();
+                }
+            }
+            if (input.GetKeyDown(GLFW_KEY_S)) {
+                specularMap = !specularMap;
+                selectVariant();
+            }
+            if (input.GetKeyDown(GLFW_KEY_F)) {
+                spotLight = !spotLight;
+                selectVariant();
+            }
+
+            if (input.GetMouseButton(GLFW_MOUSE_BUTTON_LEFT)) {
+                if (!dragging) {
+                    auto mousePos = input.GetMousePosition();
+                    lastX = mousePos.x;
+                    lastY = mousePos.y;
+                    dragging = true;
+                }
+                auto mousePos = input.GetMousePosition();
+                curX = mousePos.x;
+                curY = mousePos.y;
+                const auto deltaX = curX - lastX;
+                const auto deltaY = curY - lastY;
+                orbitCamera->rotateAzimuth(glm::radians(static_cast<float>(deltaX) * 0.5f));
+                orbitCamera->rotatePolar(glm::radians(static_cast<float>(deltaY) * 0.5f));
+                lastX = curX;
+                lastY = curY;
+            } else {
+                dragging = false;
+            }
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // cube
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(window->getWidth()) / static_cast<float>(window->getHeight()), 0.1f, 100.0f);
+            Shader& cubeShader = *variant;
+            cubeShader.use();
+
+            cubeShader.setFloat3("viewPos"_uniform, orbitCamera->getEye());
+            cubeShader.setMatrix4("view"_uniform, orbitCamera->getViewMatrix());
+            cubeShader.setMatrix4("projection"_uniform, projection);
+
+            // inactive in variants that compiled the uniform away, those sets are no-ops
+            cubeShader.setInt("material.diffuse"_uniform, 0);
+            cubeShader.setInt("material.specular"_uniform, 1);
+            cubeShader.setFloat("material.shininess"_uniform, 32.0f);
+
+            cubeShader.setFloat3("dirLight.direction"_uniform, glm::vec3(-0.2f, -1.0f, -0.3f));
+            cubeShader.setFloat3("dirLight.ambient"_uniform, glm::vec3(0.05f, 0.05f, 0.05f));
+            cubeShader.setFloat3("dirLight.diffuse"_uniform, glm::vec3(0.4f, 0.4f, 0.4f));
+            cubeShader.setFloat3("dirLight.specular"_uniform, glm::vec3(0.5f, 0.5f, 0.5f));
+
+            for (int i = 0; i < numPointLights; i++) {
+                const std::vector<std::string>& names = pointLightNames[i];
+                cubeShader.setFloat3(names[0], pointLightPositions[i]);
+                cubeShader.setFloat3(names[1], pointLightColors[i] * 0.1f);
+                cubeShader.setFloat3(names[2], pointLightColors[i]);
+                cubeShader.setFloat3(names[3], pointLightColors[i]);
+                cubeShader.setFloat(names[4], 1.0f);
+                cubeShader.setFloat(names[5], 0.09f);
+                cubeShader.setFloat(names[6], 0.032f);
+            }
+
+            cubeShader.setFloat3("spotLight.position"_uniform, orbitCamera->getEye());
+            cubeShader.setFloat3("spotLight.direction"_uniform, -orbitCamera->getEye());
+            cubeShader.setFloat3("spotLight.ambient"_uniform, glm::vec3(0.0f, 0.0f, 0.0f));
+            cubeShader.setFloat3("spotLight.diffuse"_uniform, glm::vec3(1.0f, 1.0f, 1.0f));
+            cubeShader.setFloat3("spotLight.specular"_uniform, glm::vec3(1.0f, 1.0f, 1.0f));
+            cubeShader.setFloat("spotLight.constant"_uniform, 1.0f);
+            cubeShader.setFloat("spotLight.linear"_uniform, 0.09f);
+            cubeShader.setFloat("spotLight.quadratic"_uniform, 0.032f);
+            cubeShader.setFloat("spotLight.cutOff"_uniform, glm::cos(glm::radians(12.5f)));
+            cubeShader.setFloat("spotLight.outerCutOff"_uniform, glm::cos(glm::radians(15.0f)));
+
+            cubeVao->bind();
+            diffuseTex->bind(0);
+            specularTex->bind(1);
+            for (unsigned int i = 0; i < 10; i++) {
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::translate(model, cubePositions[i]);
+                float angle = 20.0f * i;
+                model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+                cubeShader.setMatrix4("model"_uniform, model);
+
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            cubeVao->unbind();
+
+            // lights
+            lightShader->use();
+            lightShader->setMatrix4("view"_uniform, orbitCamera->getViewMatrix());
+            lightShader->setMatrix4("projection"_uniform, projection);
+            lightVao->bind();
+            for (int i = 0; i < numPointLights; i++) {
+                auto model = glm::mat4(1.0);
+                model = glm::translate(model, pointLightPositions[i]);
+                model = glm::scale(model, glm::vec3(0.2f));
+                lightShader->setFloat3("lightColor"_uniform, pointLightColors[i]);
+                lightShader->setMatrix4("model"_uniform, model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            lightVao->unbind();
+        
+            window->swapBuffer();
+            // GetKeyDown compares against the previous frame
+            input.Update();
+        }
+    }
+    
+private:
+    std::unique_ptr<Window> window;
+    std::unique_ptr<Shader> lightShader;
+    std::unique_ptr<VertexArray> cubeVao;
+    std::unique_ptr<VertexArray> lightVao;
+    std::unique_ptr<Texture> diffuseTex;
+    std::unique_ptr<Texture> specularTex;
+    std::unique_ptr<OribitCamera> orbitCamera;
+
+    Shader* variant = nullptr;
+    int numPointLights = MAX_POINT_LIGHTS;
+    bool specularMap = true;
+    bool spotLight = true;
+
+    bool dragging = false;
+    double lastX, lastY;
+    double curX, curY;
+
+    void selectVariant() {
+        const ShaderDefines defines {
+            {"NUM_POINT_LIGHTS", std::to_string(numPointLights)},
+            {"SPECULAR_MAP", specularMap ? "1" : "0"},
+            {"SPOT_LIGHT", spotLight ? "1" : "0"}
+        };
+        ShaderLibrary& library = ShaderLibrary::getInstance();
+        const char* vertexPath = "shaders/02_shaders/2_6_1_MultipleLights.vert";
+        const char* fragmentPath = "shaders/02_shaders/2_6_1_MultipleLights.frag";
+        const bool known = library.contains(vertexPath, fragmentPath, defines);
+        variant = &library.get(vertexPath, fragmentPath, defines);
+        std::cout << "variant " << defines.toString() << (known ? " (reused)" : " (loaded)")
+                  << ", " << library.getStats().variants << " variants" << std::endl;
+    }
+
+    void init() {
+        float vertices[] = {
+            // positions          // normals           // texture coords
+            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+            0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+            0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+            0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+            0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+            0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+            0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+            -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+            -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+            0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+            0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+            0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+            0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+            0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+            0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+            0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+            0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+            0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+            0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+            0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+            0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+        };
+
+        VertexBuffer vbo;
+        vbo.upload(vertices, sizeof(vertices));
+
+        std::vector<VertexAttribute> attrs  {
+            VertexAttribute{0, 3, AttributeType::Float, false, 8 * sizeof(float), (void*)0},
+            VertexAttribute{1, 3, AttributeType::Float, false, 8 * sizeof(float), (void*)(sizeof(float) * 3)},
+            VertexAttribute{2, 2, AttributeType::Float, false, 8 * sizeof(float), (void*)(sizeof(float) * 6)},
+        };
+
+        cubeVao->bind();
+        cubeVao->addVertexBuffer(vbo, attrs);
+        cubeVao->unbind();
+
+        lightVao->bind();
+        lightVao->addVertexBuffer(vbo, {attrs[0]});
+        lightVao->unbind();
+    }
+
+};
+
+int main() {
+    MultipleLights app(800, 600, "2.6.1.MultipleLights");
+    try {
+        app.run();
+    } catch (const std::exception& e) {
+        std::cout << "Exception: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "utils/Image.h"
+#include "utils/MipChain.h"
+#include "utils/TextureCache.h"
+#include "utils/TextureUploadQueue.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Texture upload benchmark, frame times while textures arrive mid session
+ *   sync   : uploadMipChain of every texture inside one frame (glTexImage2D from client memory)
+ *   async  : TextureCache::insertAsync + TextureUploadQueue::update with a per frame budget
+ * Every frame ends with glFinish so the driver's copy cost shows up in the frame it was issued.
+ * The mip chains are prebuilt, only the GL side is measured.
+ *
+ * usage: 3_10_Texture_Upload_Benchmark [textures] [budget MB] [image]
+ */
+
+struct FrameTimes {
+    double maxMs = 0.0;
+    double totalMs = 0.0;
+    int frames = 0;
+
+    void add(double ms) {
+        maxMs = std::max(maxMs, ms);
+        totalMs += ms;
+        frames++;
+    }
+
+    double averageMs() const { return frames > 0 ? totalMs / frames : 0.0; }
+};
+
+template<typename Func>
+double frame(Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    glClear(GL_COLOR_BUFFER_BIT);
+    func();
+    glFinish();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char **argv) {
+    const int count = argc > 1 ? std::stoi(argv[1]) : 8;
+    const double budgetMegabytes = argc > 2 ? std::stod(argv[2]) : 8.0;
+    const std::string path = argc > 3 ? argv[3] : "textures/fire_frame.jpg";
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Texture Upload Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    Image image;
+    if (!loadImage(path, image, true)) {
+        std::cout << path << ": failed to load" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    const std::vector<Image> mips = buildMipLevels(image, MipColorSpace::SRGB);
+    size_t chainBytes = image.byteSize();
+    for (const auto& mip: mips) {
+        chainBytes += mip.byteSize();
+    }
+    const double chainMegabytes = static_cast<double>(chainBytes) / (1024.0 * 1024.0);
+
+    std::cout << "\n==== Texture upload benchmark (" << count << " x " << path << ", " << image.width << "x" << image.height
+              << "x" << image.channels << ", " << mips.size() + 1 << " levels, " << chainMegabytes << " MB each) ====" << std::endl;
+
+    // a few idle frames first so both runs start from a warm driver
+    FrameTimes idle;
+    for (int i = 0; i < 30; i++) {
+        idle.add(frame([]() {}));
+    }
+    std::cout << "idle   avg " << idle.averageMs() << " ms | max " << idle.maxMs << " ms" << std::endl;
+
+    std::vector<GLuint> textures(count);
+    glGenTextures(count, textures.data());
+    FrameTimes sync;
+    sync.add(frame([&]() {
+        for (GLuint texture: textures) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            uploadMipChain(GL_TEXTURE_2D, image.pixels.data(), image.width, image.height, image.channels, mips);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }));
+    glDeleteTextures(count, textures.data());
+    std::cout << "sync   one frame of " << sync.maxMs << " ms (" << chainMegabytes * count / sync.maxMs * 1000.0
+              << " MB/s)" << std::endl;
+
+    UploadBudget budget;
+    budget.maxBytes = static_cast<size_t>(budgetMegabytes * 1024.0 * 1024.0);
+    std::vector<TextureCache::Handle> handles;
+    FrameTimes async;
+    async.add(frame([&]() {
+        for (int i = 0; i < count; i++) {
+            // distinct keys so the cache does not hand back the first texture
+            handles.push_back(TextureCache::getInstance().insertAsync(path + "#" + std::to_string(i), image, mips));
+        }
+        TextureUploadQueue::getInstance().update(budget);
+    }));
+    int firstReady = -1;
+    while (!TextureUploadQueue::getInstance().isIdle() && async.frames < 100000) {
+        async.add(frame([&]() { TextureUploadQueue::getInstance().update(budget); }));
+        if (firstReady < 0 && std::any_of(handles.begin(), handles.end(), [](const TextureCache::Handle& handle) { return handle->ready; })) {
+            firstReady = async.frames;
+        }
+    }
+    const TextureUploadStats stats = TextureUploadQueue::getInstance().getStats();
+    std::cout << "async  " << async.frames << " frames, avg " << async.averageMs() << " ms | max " << async.maxMs
+              << " ms | first texture complete after " << firstReady << " frames (budget " << budgetMegabytes << " MB/frame)" << std::endl;
+    std::cout << "       ring " << stats.ringBytes / (1024 * 1024) << " MB " << (stats.persistent ? "persistently mapped" : "mapped per copy")
+              << " | " << stats.completed << " completed, " << stats.bytesUploaded / (1024 * 1024) << " MB uploaded, "
+              << stats.ringStalls << " frames stalled on the ring" << std::endl;
+
+    handles.clear();
+    TextureUploadQueue::getInstance().shutdown();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
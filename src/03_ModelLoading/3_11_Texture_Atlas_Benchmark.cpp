@@ -0,0 +1,230 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "utils/Shader.h"
+#include "utils/Texture.h"
+#include "utils/TextureAtlas.h"
+#include "utils/VertexArray.h"
+#include "utils/VertexBuffer.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Texture atlas benchmark
+ *   packing : TextureAtlasBuilder stats for the demo textures and a synthetic sprite set,
+ *             as one texture per array layer and skyline packed with a 4 texel gutter
+ *   drawing : a grid of quads, each with one of the demo textures
+ *             - bind per draw   : Texture::bind + glDrawArrays per quad, what the demos do
+ *             - sorted binds    : quads grouped by texture, one bind per texture
+ *             - atlas instanced : one bind and one glDrawArraysInstanced, region per instance
+ * Every frame ends with glFinish.
+ *
+ * usage: 3_11_Texture_Atlas_Benchmark [quads] [frames]
+ */
+
+struct QuadInstance {
+    glm::vec2 offset;
+    glm::vec4 uvTransform;
+    float layer;
+};
+
+struct DrawCounters {
+    size_t draws = 0;
+    size_t binds = 0;
+};
+
+template<typename Func>
+double measure(int frames, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        func();
+        glFinish();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+static void printStats(const char* name, const AtlasStats& stats) {
+    std::cout << "  " << name << ": " << stats.textures << " textures -> " << stats.layers << " x " << stats.layerWidth << "x"
+              << stats.layerHeight << ", " << stats.levels << " levels | efficiency " << stats.efficiency * 100.0 << " % | "
+              << static_cast<double>(stats.bytes) / (1024.0 * 1024.0) << " MB | built in " << stats.buildMs << " ms" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    const int quads = argc > 1 ? std::stoi(argv[1]) : 4096;
+    const int frames = argc > 2 ? std::stoi(argv[2]) : 200;
+    const std::vector<std::string> paths = {
+        "textures/container2.png", "textures/container2_specular.png", "textures/grass.png",
+        "textures/blending_transparent_window.png", "textures/awesomeface.png", "textures/container.jpg",
+        "textures/wall.jpg", "textures/marble.jpg", "textures/metal.png", "textures/matrix.jpg",
+    };
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(512, 512, "Texture Atlas Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    std::cout << "\n==== Texture atlas benchmark (" << quads << " quads, " << frames << " frames) ====" << std::endl;
+    std::cout << "packing" << std::endl;
+    TextureAtlasBuilder builder;
+    if (!builder.addFiles(paths)) {
+        glfwTerminate();
+        return -1;
+    }
+    TextureAtlas arrayAtlas = builder.build(AtlasLayout::Array);
+    TextureAtlas packedAtlas = builder.build(AtlasLayout::Packed);
+    printStats("demo textures, array ", arrayAtlas.getStats());
+    printStats("demo textures, packed", packedAtlas.getStats());
+
+    // UI style sprite set: many small images of mixed size, where packing pays off the most
+    TextureAtlasBuilder sprites(1024, 2);
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> side(8, 160);
+    for (int i = 0; i < 300; i++) {
+        Image image;
+        image.width = side(random);
+        image.height = side(random);
+        image.channels = 4;
+        image.pixels.assign(static_cast<size_t>(image.width) * image.height * 4, static_cast<unsigned char>(i));
+        sprites.add("sprite" + std::to_string(i), std::move(image));
+    }
+    printStats("300 sprites,   array ", sprites.build(AtlasLayout::Array).getStats());
+    printStats("300 sprites,   packed", sprites.build(AtlasLayout::Packed).getStats());
+
+    std::vector<Texture> textures = Texture::loadFromFiles(paths);
+
+    // unit quad, texcoords up to 2 so the atlas path has to repeat inside its regions
+    const float quad[] = {
+        -0.5f, -0.5f, 0.0f, 0.0f,
+         0.5f, -0.5f, 2.0f, 0.0f,
+         0.5f,  0.5f, 2.0f, 2.0f,
+         0.5f,  0.5f, 2.0f, 2.0f,
+        -0.5f,  0.5f, 0.0f, 2.0f,
+        -0.5f, -0.5f, 0.0f, 0.0f,
+    };
+    VertexBuffer quadVbo;
+    quadVbo.upload(quad, sizeof(quad) / sizeof(float));
+    const std::vector<VertexAttribute> quadAttributes = {
+        {0, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)0},
+        {1, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)(2 * sizeof(float))},
+    };
+    VertexArray quadVao;
+    quadVao.addVertexBuffer(quadVbo, quadAttributes);
+    quadVao.unbind();
+
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(quads))));
+    const float cell = 2.0f / static_cast<float>(columns);
+    std::vector<glm::vec2> offsets(quads);
+    std::vector<int> textureOf(quads);
+    for (int i = 0; i < quads; i++) {
+        offsets[i] = glm::vec2(-1.0f + cell * (static_cast<float>(i % columns) + 0.5f), -1.0f + cell * (static_cast<float>(i / columns) + 0.5f));
+        textureOf[i] = i % static_cast<int>(paths.size());
+    }
+    std::vector<int> objectOrder(quads);
+    std::iota(objectOrder.begin(), objectOrder.end(), 0);
+    std::vector<int> sortedOrder = objectOrder;
+    std::stable_sort(sortedOrder.begin(), sortedOrder.end(), [&](int a, int b) { return textureOf[a] < textureOf[b]; });
+
+    const glm::mat4 projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
+    Shader bindShader("shaders/03_shaders/02_2_Texture_Bind_vs.glsl", "shaders/03_shaders/02_2_Texture_Bind_fs.glsl");
+    bindShader.use();
+    bindShader.setMatrix4("projection", projection);
+    bindShader.setFloat("scale", cell * 0.9f);
+    bindShader.setInt("texture_diffuse1", 0);
+    const GLint offsetLocation = glGetUniformLocation(bindShader.ID, "offset");
+
+    DrawCounters perDraw, sorted;
+    const auto drawSeparate = [&](const std::vector<int>& order, bool bindEveryDraw, DrawCounters& counters) {
+        bindShader.use();
+        quadVao.bind();
+        int bound = -1;
+        for (int i: order) {
+            if (bindEveryDraw || textureOf[i] != bound) {
+                textures[textureOf[i]].bind(0);
+                bound = textureOf[i];
+                counters.binds++;
+            }
+            glUniform2f(offsetLocation, offsets[i].x, offsets[i].y);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            counters.draws++;
+        }
+        quadVao.unbind();
+    };
+    const double perDrawMs = measure(frames, [&]() { drawSeparate(objectOrder, true, perDraw); });
+    const double sortedMs = measure(frames, [&]() { drawSeparate(sortedOrder, false, sorted); });
+
+    Shader atlasShader("shaders/03_shaders/02_1_Texture_Atlas_vs.glsl", "shaders/03_shaders/02_1_Texture_Atlas_fs.glsl");
+    atlasShader.use();
+    atlasShader.setMatrix4("projection", projection);
+    atlasShader.setFloat("scale", cell * 0.9f);
+    atlasShader.setInt("atlas", 0);
+
+    std::cout << "drawing" << std::endl;
+    std::cout << "  bind per draw   : " << perDrawMs << " ms / frame | " << perDraw.draws / frames << " draws, "
+              << perDraw.binds / frames << " binds" << std::endl;
+    std::cout << "  sorted binds    : " << sortedMs << " ms / frame | " << sorted.draws / frames << " draws, "
+              << sorted.binds / frames << " binds" << std::endl;
+
+    for (const TextureAtlas* atlas: {&arrayAtlas, &packedAtlas}) {
+        std::vector<QuadInstance> instances(quads);
+        for (int i = 0; i < quads; i++) {
+            const AtlasRegion& region = atlas->getRegions()[textureOf[i]];
+            instances[i] = {offsets[i], region.uvTransform, static_cast<float>(region.layer)};
+        }
+        VertexBuffer instanceVbo;
+        instanceVbo.upload(instances);
+        VertexArray instanceVao;
+        instanceVao.addVertexBuffer(quadVbo, quadAttributes);
+        instanceVao.addVertexBuffer(instanceVbo, {
+            {2, 2, AttributeType::Float, false, sizeof(QuadInstance), (void*)offsetof(QuadInstance, offset)},
+            {3, 4, AttributeType::Float, false, sizeof(QuadInstance), (void*)offsetof(QuadInstance, uvTransform)},
+            {4, 1, AttributeType::Float, false, sizeof(QuadInstance), (void*)offsetof(QuadInstance, layer)},
+        });
+        glVertexAttribDivisor(2, 1);
+        glVertexAttribDivisor(3, 1);
+        glVertexAttribDivisor(4, 1);
+        instanceVao.unbind();
+
+        DrawCounters counters;
+        const double atlasMs = measure(frames, [&]() {
+            atlasShader.use();
+            instanceVao.bind();
+            atlas->bind(0);
+            counters.binds++;
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, quads);
+            counters.draws++;
+            instanceVao.unbind();
+        });
+        std::cout << "  atlas instanced : " << atlasMs << " ms / frame | " << counters.draws / frames << " draw, "
+                  << counters.binds / frames << " bind (" << (atlas->getLayout() == AtlasLayout::Array ? "array" : "packed")
+                  << " layout)" << std::endl;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "utils/Image.h"
+#include "utils/Shader.h"
+#include "utils/VertexArray.h"
+#include "utils/VertexBuffer.h"
+#include "utils/VirtualTexture.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/*
+ * Virtual texture streaming: a plane textured with a tiled .vtex image, the camera flies
+ * from an overview down to a few texels per pixel and back. Only the tiles the feedback pass
+ * asks for are in the physical page texture; the stats line compares that fixed VRAM cost
+ * with the full resolution image.
+ * Without a .vtex argument textures/container2.png is baked 8 x 8 times (4000x4000) on the
+ * first run, VirtualTextureBake makes gigapixel sized ones.
+ *
+ * usage: 3_12_Virtual_Texture [file.vtex] [seconds, 0 = until closed] [pages per side]
+ */
+
+const int width = 1280;
+const int height = 720;
+const char *title = "Virtual Texture";
+
+int main(int argc, char **argv) {
+    std::string path = argc > 1 ? argv[1] : "textures/container2_x8.vtex";
+    const double seconds = argc > 2 ? std::stod(argv[2]) : 0.0;
+    const int pagesPerSide = argc > 3 ? std::stoi(argv[3]) : VirtualTexture::DEFAULT_PAGES_PER_SIDE;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow *window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    if (argc <= 1 && !std::ifstream(path)) {
+        Image source;
+        VirtualTextureBakeOptions options;
+        options.repeat = 8;
+        std::cout << "baking " << path << " from textures/container2.png" << std::endl;
+        if (!loadImage("textures/container2.png", source) || !bakeVirtualTexture(source, path, options)) {
+            glfwTerminate();
+            return -1;
+        }
+    }
+    VirtualTexture virtualTexture;
+    if (!virtualTexture.open(path, pagesPerSide)) {
+        glfwTerminate();
+        return -1;
+    }
+
+    Shader shader("shaders/03_shaders/03_1_Virtual_Texture_vs.glsl", "shaders/03_shaders/03_1_Virtual_Texture_fs.glsl");
+    Shader feedbackShader("shaders/03_shaders/03_1_Virtual_Texture_vs.glsl", "shaders/03_shaders/03_1_Virtual_Texture_Feedback_fs.glsl");
+
+    // the plane spans -1..1 in x and z, uv 0..1
+    const float plane[] = {
+        -1.0f, 0.0f,  1.0f, 0.0f, 0.0f,
+         1.0f, 0.0f,  1.0f, 1.0f, 0.0f,
+         1.0f, 0.0f, -1.0f, 1.0f, 1.0f,
+         1.0f, 0.0f, -1.0f, 1.0f, 1.0f,
+        -1.0f, 0.0f, -1.0f, 0.0f, 1.0f,
+        -1.0f, 0.0f,  1.0f, 0.0f, 0.0f,
+    };
+    VertexBuffer vbo;
+    vbo.upload(plane, sizeof(plane) / sizeof(float));
+    VertexArray vao;
+    vao.addVertexBuffer(vbo, {
+        {0, 3, AttributeType::Float, false, 5 * sizeof(float), (void*)0},
+        {1, 2, AttributeType::Float, false, 5 * sizeof(float), (void*)(3 * sizeof(float))},
+    });
+    vao.unbind();
+
+    const glm::mat4 projection = glm::perspective(glm::radians(60.f), (float)width / (float)height, 0.0005f, 10.f);
+    const auto drawPlane = [&](Shader& program, const glm::mat4& view) {
+        program.use();
+        program.setMatrix4("projection", projection);
+        program.setMatrix4("view", view);
+        program.setMatrix4("model", glm::mat4(1.f));
+        virtualTexture.setUniforms(program);
+        virtualTexture.bind();
+        vao.bind();
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        vao.unbind();
+    };
+
+    glEnable(GL_DEPTH_TEST);
+    const double start = glfwGetTime();
+    double lastReport = start;
+    int frames = 0;
+    while (!glfwWindowShouldClose(window)) {
+        const double time = glfwGetTime() - start;
+        if (seconds > 0.0 && time > seconds) {
+            break;
+        }
+        // a slow circle over the plane, the height swings between overview and close up on a log scale
+        const float angle = static_cast<float>(time * 0.1);
+        const float altitude = std::pow(10.0f, -2.5f + 2.5f * (0.5f + 0.5f * std::cos(static_cast<float>(time * 0.25))));
+        const glm::vec3 target(0.6f * std::cos(angle), 0.0f, 0.6f * std::sin(angle));
+        const glm::vec3 eye = target + glm::vec3(altitude * 0.8f, altitude, altitude * 0.8f);
+        const glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.f, 1.f, 0.f));
+
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        glViewport(0, 0, framebufferWidth, framebufferHeight);
+
+        // which tiles are visible, read back next frame
+        virtualTexture.beginFeedback(framebufferWidth, framebufferHeight);
+        drawPlane(feedbackShader, view);
+        virtualTexture.endFeedback();
+        virtualTexture.update();
+
+        glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawPlane(shader, view);
+
+        glfwPollEvents();
+        glfwSwapBuffers(window);
+        frames++;
+
+        const double now = glfwGetTime();
+        if (now - lastReport >= 1.0) {
+            const VirtualTextureStats stats = virtualTexture.getStats();
+            std::cout << frames / (now - lastReport) << " fps | altitude " << altitude << " | tiles " << stats.residentTiles << "/"
+                      << stats.capacity << " resident, " << stats.requestedTiles << " requested, " << stats.missingTiles
+                      << " drawn coarser, " << stats.loadsInFlight << " loading | " << stats.loadedTiles << " loaded, "
+                      << stats.evictedTiles << " evicted | VRAM " << stats.gpuBytes / (1024 * 1024) << " MB for a "
+                      << stats.virtualBytes / (1024 * 1024) << " MB image" << std::endl;
+            lastReport = now;
+            frames = 0;
+        }
+    }
+
+    virtualTexture.close();
+    glfwTerminate();
+    return 0;
+}
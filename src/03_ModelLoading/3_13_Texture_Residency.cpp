@@ -0,0 +1,200 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "utils/ImGuiManager.h"
+#include "utils/Model.h"
+#include "utils/OribitCamera.h"
+#include "utils/Shader.h"
+#include "utils/Texture.h"
+#include "utils/TextureCube.h"
+#include "utils/TextureResidency.h"
+#include "utils/TextureUploadQueue.h"
+#include "utils/VertexArray.h"
+#include "utils/VertexBuffer.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <imgui.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Texture residency under a VRAM budget: the backpack model, a skybox and a wall of textured
+ * quads can be switched on and off. Whatever is hidden becomes a candidate for the
+ * TextureResidency, which drops its top mips and then evicts it once the budget is exceeded;
+ * showing it again reloads it from its files. The panel shows the live numbers per texture.
+ *
+ * usage: 3_13_Texture_Residency [budget MB, 0 = no limit]
+ */
+
+const int width = 1280;
+const int height = 720;
+const char *title = "Texture Residency";
+
+bool dragging = false;
+double lastX = width / 2.0, lastY = height / 2.0;
+double curX = width / 2.0, curY = height / 2.0;
+
+OribitCamera oribitCamera(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 1.0f, 0.f), 6.f, 1.f, 0, 0);
+
+void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+    if (!ImGui::GetIO().WantCaptureMouse) {
+        oribitCamera.zoom(static_cast<float>(yoffset));
+    }
+}
+
+int main(int argc, char **argv) {
+    const int budgetMegabytes = argc > 1 ? std::stoi(argv[1]) : 48;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow *window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetScrollCallback(window, scrollCallback);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    TextureResidency& residency = TextureResidency::getInstance();
+    residency.setBudget(static_cast<size_t>(budgetMegabytes) * 1024 * 1024);
+
+    {
+        ImGuiManager imguiManager(window);
+        Shader modelShader("shaders/03_shaders/01_1_Backpack_Rendering_vs.glsl", "shaders/03_shaders/01_1_Backpack_Rendering_fs.glsl");
+        Shader skyboxShader("shaders/04_shaders/4_6_1_skybox.vert", "shaders/04_shaders/4_6_1_skybox.frag");
+        Shader quadShader("shaders/03_shaders/02_2_Texture_Bind_vs.glsl", "shaders/03_shaders/02_2_Texture_Bind_fs.glsl");
+        Model backpack("models/backpack/backpack.obj");
+
+        TextureCube skybox;
+        skybox.loadFromFiles({"textures/lake_skybox/right.jpg", "textures/lake_skybox/left.jpg", "textures/lake_skybox/top.jpg",
+                              "textures/lake_skybox/bottom.jpg", "textures/lake_skybox/front.jpg", "textures/lake_skybox/back.jpg"});
+        std::vector<Texture> wall = Texture::loadFromFiles({
+            "textures/container2.png", "textures/container2_specular.png", "textures/grass.png",
+            "textures/blending_transparent_window.png", "textures/awesomeface.png", "textures/container.jpg",
+            "textures/wall.jpg", "textures/marble.jpg", "textures/metal.png", "textures/matrix.jpg",
+        });
+
+        const float cube[] = {
+            -1.0f,  1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f,
+            -1.0f, -1.0f,  1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f,  1.0f, -1.0f, -1.0f,  1.0f,
+             1.0f, -1.0f, -1.0f,  1.0f, -1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f, -1.0f,  1.0f, -1.0f, -1.0f,
+            -1.0f, -1.0f,  1.0f, -1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  1.0f,
+            -1.0f,  1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f, -1.0f,
+            -1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f,  1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f, -1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f,
+        };
+        VertexBuffer cubeVbo;
+        cubeVbo.upload(cube, sizeof(cube) / sizeof(float));
+        VertexArray cubeVao;
+        cubeVao.addVertexBuffer(cubeVbo, {{0, 3, AttributeType::Float, false, 3 * sizeof(float), (void*)0}});
+        cubeVao.unbind();
+
+        const float quad[] = {
+            -0.5f, -0.5f, 0.0f, 0.0f,
+             0.5f, -0.5f, 1.0f, 0.0f,
+             0.5f,  0.5f, 1.0f, 1.0f,
+             0.5f,  0.5f, 1.0f, 1.0f,
+            -0.5f,  0.5f, 0.0f, 1.0f,
+            -0.5f, -0.5f, 0.0f, 0.0f,
+        };
+        VertexBuffer quadVbo;
+        quadVbo.upload(quad, sizeof(quad) / sizeof(float));
+        VertexArray quadVao;
+        quadVao.addVertexBuffer(quadVbo, {
+            {0, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)0},
+            {1, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)(2 * sizeof(float))},
+        });
+        quadVao.unbind();
+
+        bool showBackpack = true;
+        bool showSkybox = true;
+        bool showWall = true;
+        glEnable(GL_DEPTH_TEST);
+        while (!glfwWindowShouldClose(window)) {
+            const bool captured = ImGui::GetIO().WantCaptureMouse;
+            if (!captured && glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+                if (!dragging) {
+                    glfwGetCursorPos(window, &lastX, &lastY);
+                    dragging = true;
+                }
+                glfwGetCursorPos(window, &curX, &curY);
+                oribitCamera.rotateAzimuth(glm::radians(static_cast<float>(curX - lastX) * 0.5f));
+                oribitCamera.rotatePolar(glm::radians(static_cast<float>(curY - lastY) * 0.5f));
+                lastX = curX;
+                lastY = curY;
+            } else {
+                dragging = false;
+            }
+
+            glViewport(0, 0, width, height);
+            glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            const glm::mat4 projection = glm::perspective(glm::radians(45.f), (float)width / (float)height, 0.1f, 100.f);
+            const glm::mat4 view = oribitCamera.getViewMatrix();
+
+            if (showSkybox) {
+                glDepthMask(GL_FALSE);
+                skyboxShader.use();
+                skyboxShader.setMatrix4("view", glm::mat4(glm::mat3(view)));
+                skyboxShader.setMatrix4("projection", projection);
+                skybox.bind();
+                cubeVao.bind();
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                cubeVao.unbind();
+                glDepthMask(GL_TRUE);
+            }
+            if (showBackpack) {
+                modelShader.use();
+                modelShader.setMatrix4("projection", projection);
+                modelShader.setMatrix4("view", view);
+                modelShader.setMatrix4("model", glm::mat4(1.f));
+                backpack.draw(modelShader);
+            }
+            if (showWall) {
+                // a row of thumbnails along the bottom edge
+                glDisable(GL_DEPTH_TEST);
+                quadShader.use();
+                quadShader.setMatrix4("projection", glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f));
+                quadShader.setFloat("scale", 0.18f);
+                quadShader.setInt("texture_diffuse1", 0);
+                quadVao.bind();
+                for (size_t i = 0; i < wall.size(); i++) {
+                    wall[i].bind(0);
+                    quadShader.setFloat2("offset", glm::vec2(-0.9f + 0.2f * static_cast<float>(i), -0.85f));
+                    glDrawArrays(GL_TRIANGLES, 0, 6);
+                }
+                quadVao.unbind();
+                glEnable(GL_DEPTH_TEST);
+            }
+
+            imguiManager.newFrame();
+            ImGui::Begin("Scene");
+            ImGui::Checkbox("Backpack", &showBackpack);
+            ImGui::Checkbox("Skybox", &showSkybox);
+            ImGui::Checkbox("Texture wall", &showWall);
+            ImGui::End();
+            residency.drawPanel();
+            imguiManager.render();
+
+            // streamed reloads arrive through the upload queue, then the residency enforces the budget
+            TextureUploadQueue::getInstance().update();
+            residency.update();
+
+            glfwPollEvents();
+            glfwSwapBuffers(window);
+        }
+        TextureUploadQueue::getInstance().shutdown();
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "utils/ImageCache.h"
+#include "utils/TextureCache.h"
+#include "utils/TextureCube.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Decoded texture cache benchmark, per texture:
+ *   cold : no .texbin, stb_image decode + CPU mip chain + writing the .texbin + upload
+ *   warm : the .texbin is mapped and every level uploaded from the mapping
+ * Both go through TextureCache::acquire (what Texture::loadFromFile does) and end with glFinish;
+ * the texture is released in between so every load misses the in-process cache.
+ * The skybox row is TextureCube::loadFromFiles, six faces without mips.
+ *
+ * usage: 3_14_Image_Cache_Benchmark [iterations]
+ */
+
+template<typename Func>
+double measure(int iterations, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+static void printRow(const std::string& name, double coldMs, double warmMs, size_t cacheBytes) {
+    std::cout << "  " << name << std::string(name.size() < 36 ? 36 - name.size() : 1, ' ') << "cold " << coldMs << " ms | warm "
+              << warmMs << " ms | " << (warmMs > 0.0 ? coldMs / warmMs : 0.0) << "x | .texbin "
+              << static_cast<double>(cacheBytes) / (1024.0 * 1024.0) << " MB" << std::endl;
+}
+
+static size_t fileSize(const std::string& path) {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    return error ? 0 : static_cast<size_t>(size);
+}
+
+int main(int argc, char **argv) {
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+    const std::vector<std::string> paths = {
+        "textures/container2.png", "textures/container2_specular.png", "textures/grass.png",
+        "textures/blending_transparent_window.png", "textures/awesomeface.png", "textures/container.jpg",
+        "textures/wall.jpg", "textures/marble.jpg", "textures/metal.png", "textures/matrix.jpg",
+    };
+    const std::vector<std::string> skybox = {
+        "textures/lake_skybox/right.jpg", "textures/lake_skybox/left.jpg", "textures/lake_skybox/top.jpg",
+        "textures/lake_skybox/bottom.jpg", "textures/lake_skybox/front.jpg", "textures/lake_skybox/back.jpg",
+    };
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Image Cache Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    std::cout << "\n==== Image cache benchmark (" << iterations << " iterations) ====" << std::endl;
+    double coldTotal = 0.0;
+    double warmTotal = 0.0;
+    const uint32_t flags = ImageCache::flagsFor(true, true, MipColorSpace::SRGB);
+    for (const auto& path: paths) {
+        const std::string cachePath = ImageCache::cachePathFor(path, flags);
+        bool loaded = true;
+        const double coldMs = measure(iterations, [&]() {
+            std::remove(cachePath.c_str());
+            loaded = TextureCache::getInstance().acquire(path) != nullptr && loaded;
+            glFinish();
+        });
+        if (!loaded) {
+            std::cout << "  " << path << ": failed to load, skipped" << std::endl;
+            continue;
+        }
+        const double warmMs = measure(iterations, [&]() {
+            TextureCache::getInstance().acquire(path);
+            glFinish();
+        });
+        printRow(path, coldMs, warmMs, fileSize(cachePath));
+        coldTotal += coldMs;
+        warmTotal += warmMs;
+    }
+
+    std::vector<std::string> facePaths;
+    for (const auto& face: skybox) {
+        facePaths.push_back(ImageCache::cachePathFor(face, IMAGE_CACHE_NONE));
+    }
+    bool skyboxLoaded = true;
+    const double coldSkyboxMs = measure(iterations, [&]() {
+        for (const auto& facePath: facePaths) {
+            std::remove(facePath.c_str());
+        }
+        TextureCube cube;
+        skyboxLoaded = cube.loadFromFiles(skybox) && skyboxLoaded;
+        glFinish();
+    });
+    if (skyboxLoaded) {
+        const double warmSkyboxMs = measure(iterations, [&]() {
+            TextureCube cube;
+            cube.loadFromFiles(skybox);
+            glFinish();
+        });
+        size_t skyboxBytes = 0;
+        for (const auto& facePath: facePaths) {
+            skyboxBytes += fileSize(facePath);
+        }
+        printRow("lake_skybox (cube, 6 faces)", coldSkyboxMs, warmSkyboxMs, skyboxBytes);
+        coldTotal += coldSkyboxMs;
+        warmTotal += warmSkyboxMs;
+    }
+
+    const ImageCacheStats stats = ImageCache::getStats();
+    std::cout << "  total: cold " << coldTotal << " ms | warm " << warmTotal << " ms | "
+              << (warmTotal > 0.0 ? coldTotal / warmTotal : 0.0) << "x" << std::endl;
+    std::cout << "  cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.stale << " stale, "
+              << stats.writes << " writes, " << static_cast<double>(stats.mappedBytes) / (1024.0 * 1024.0)
+              << " MB mapped" << std::endl;
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
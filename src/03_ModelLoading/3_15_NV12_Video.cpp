@@ -0,0 +1,191 @@
+#include "utils/NV12Stream.h"
+#include "utils/Shader.h"
+#include "utils/TextureYUV.h"
+#include "utils/VertexArray.h"
+#include "utils/VertexBuffer.h"
+#include "utils/YuvConvert.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * NV12 video playback from a raw .yuv file.
+ *   gpu: NV12Stream stages frames in two pixel buffers, TextureYUV holds the Y and UV planes
+ *        and the fragment shader converts to RGB
+ *   cpu: convertNV12ToRGBA on this thread, the RGBA frame is uploaded to one texture
+ * A stats line per second shows the frame rate, skipped frames and upload / convert cost.
+ * The shipped dump has a single frame, it is uploaded again at the video rate all the same.
+ *
+ * usage: 3_15_NV12_Video [file.yuv] [width] [height] [fps] [gpu|cpu] [601|709]
+ */
+
+const int width = 1280;
+const int height = 720;
+const char *title = "NV12 Video";
+
+int main(int argc, char **argv) {
+    const std::string path = argc > 1 ? argv[1] : "textures/dump_out_raw_image_nv12_1920x1080.yuv";
+    const int videoWidth = argc > 2 ? std::stoi(argv[2]) : 1920;
+    const int videoHeight = argc > 3 ? std::stoi(argv[3]) : 1080;
+    const double framesPerSecond = argc > 4 ? std::stod(argv[4]) : 30.0;
+    const bool cpuConvert = argc > 5 && std::string(argv[5]) == "cpu";
+    const YuvColorSpace colorSpace = argc > 6 && std::string(argv[6]) == "709" ? YuvColorSpace::BT709 : YuvColorSpace::BT601;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow *window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    {
+        NV12Stream stream;
+        if (!stream.open(path, videoWidth, videoHeight, framesPerSecond)) {
+            glfwTerminate();
+            return -1;
+        }
+        std::cout << path << ": " << stream.getFrameCount() << " frames of " << videoWidth << "x" << videoHeight << " at "
+                  << framesPerSecond << " fps, " << (cpuConvert ? std::string("cpu convert (") + yuvSimdName() + ")" : "gpu convert")
+                  << std::endl;
+
+        Shader yuvShader("shaders/03_shaders/04_1_NV12_Video_vs.glsl", "shaders/03_shaders/04_1_NV12_Video_fs.glsl");
+        Shader rgbaShader("shaders/03_shaders/04_1_NV12_Video_vs.glsl", "shaders/03_shaders/04_1_NV12_Video_RGBA_fs.glsl");
+        TextureYUV video;
+        video.create(videoWidth, videoHeight, colorSpace);
+
+        // the cpu path: one RGBA8 texture replaced every frame
+        std::vector<unsigned char> rgba;
+        GLuint rgbaTexture = 0;
+        if (cpuConvert) {
+            rgba.resize(static_cast<size_t>(videoWidth) * videoHeight * 4);
+            glGenTextures(1, &rgbaTexture);
+            glBindTexture(GL_TEXTURE_2D, rgbaTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, videoWidth, videoHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        const float quad[] = {
+            -1.0f, -1.0f, 0.0f, 0.0f,
+             1.0f, -1.0f, 1.0f, 0.0f,
+             1.0f,  1.0f, 1.0f, 1.0f,
+             1.0f,  1.0f, 1.0f, 1.0f,
+            -1.0f,  1.0f, 0.0f, 1.0f,
+            -1.0f, -1.0f, 0.0f, 0.0f,
+        };
+        VertexBuffer quadVbo;
+        quadVbo.upload(quad, sizeof(quad) / sizeof(float));
+        VertexArray quadVao;
+        quadVao.addVertexBuffer(quadVbo, {
+            {0, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)0},
+            {1, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)(2 * sizeof(float))},
+        });
+        quadVao.unbind();
+
+        const double start = glfwGetTime();
+        double lastReport = start;
+        int frames = 0;
+        int64_t shownTick = -1;
+        size_t cpuFrames = 0;
+        double convertMs = 0.0;
+        while (!glfwWindowShouldClose(window)) {
+            const double time = glfwGetTime() - start;
+            if (cpuConvert) {
+                const int64_t tick = static_cast<int64_t>(std::floor(time * framesPerSecond));
+                if (tick != shownTick) {
+                    const unsigned char* frame = stream.getFrame(static_cast<int>(tick % stream.getFrameCount()));
+                    const auto convertStart = std::chrono::steady_clock::now();
+                    convertNV12ToRGBA(frame, frame + static_cast<size_t>(videoWidth) * videoHeight, videoWidth, videoHeight, rgba.data(),
+                                      colorSpace);
+                    convertMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - convertStart).count();
+                    glBindTexture(GL_TEXTURE_2D, rgbaTexture);
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, videoWidth, videoHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+                    glBindTexture(GL_TEXTURE_2D, 0);
+                    shownTick = tick;
+                    cpuFrames++;
+                }
+            } else {
+                stream.update(video, time);
+            }
+
+            int framebufferWidth, framebufferHeight;
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            glViewport(0, 0, framebufferWidth, framebufferHeight);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            // letterboxed to the video aspect
+            const float windowAspect = static_cast<float>(framebufferWidth) / static_cast<float>(std::max(framebufferHeight, 1));
+            const float videoAspect = static_cast<float>(videoWidth) / static_cast<float>(videoHeight);
+            const glm::vec2 scale = videoAspect > windowAspect ? glm::vec2(1.0f, windowAspect / videoAspect)
+                                                               : glm::vec2(videoAspect / windowAspect, 1.0f);
+            if (cpuConvert) {
+                rgbaShader.use();
+                rgbaShader.setFloat2("scale", scale);
+                rgbaShader.setInt("textureRGBA", 0);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, rgbaTexture);
+            } else {
+                yuvShader.use();
+                yuvShader.setFloat2("scale", scale);
+                video.setUniforms(yuvShader);
+                video.bind();
+            }
+            quadVao.bind();
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            quadVao.unbind();
+
+            glfwPollEvents();
+            glfwSwapBuffers(window);
+            frames++;
+
+            const double now = glfwGetTime();
+            if (now - lastReport >= 1.0) {
+                std::cout << frames / (now - lastReport) << " fps";
+                if (cpuConvert) {
+                    std::cout << " | " << cpuFrames << " frames converted, " << (cpuFrames ? convertMs / cpuFrames : 0.0)
+                              << " ms per frame" << std::endl;
+                    cpuFrames = 0;
+                    convertMs = 0.0;
+                } else {
+                    const NV12StreamStats stats = stream.getStats();
+                    std::cout << " | frame " << stream.getFrameIndex() << "/" << stream.getFrameCount() << " | " << stats.framesShown
+                              << " shown, " << stats.framesSkipped << " skipped | prefetch " << stats.prefetchHits << " hits, "
+                              << stats.prefetchMisses << " misses | staging " << stats.lastStageMs << " ms | "
+                              << static_cast<double>(stats.bytesUploaded) / (1024.0 * 1024.0) << " MB uploaded" << std::endl;
+                }
+                lastReport = now;
+                frames = 0;
+            }
+        }
+        if (rgbaTexture != 0) {
+            glDeleteTextures(1, &rgbaTexture);
+        }
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "utils/MappedFile.h"
+#include "utils/TextureYUV.h"
+#include "utils/ThreadPool.h"
+#include "utils/YuvConvert.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * NV12 conversion benchmark on one frame of a raw .yuv file, throughput in MPixels/s
+ *   scalar / simd   : convertNV12ToRGBA on one thread with the SIMD kernel off / on
+ *   simd + pool     : rows split across the ThreadPool
+ *   upload nv12     : TextureYUV::upload of the two planes (1.5 bytes per pixel), the shader converts
+ *   upload rgba     : glTexSubImage2D of the converted RGBA8 frame (4 bytes per pixel)
+ * Uploads end with glFinish. SIMD and scalar results are compared byte for byte.
+ *
+ * usage: 3_16_NV12_Convert_Benchmark [iterations] [file.yuv width height]
+ */
+
+template<typename Func>
+double measure(int iterations, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 50;
+    const std::string path = argc > 2 ? argv[2] : "textures/dump_out_raw_image_nv12_1920x1080.yuv";
+    const int videoWidth = argc > 3 ? std::stoi(argv[3]) : 1920;
+    const int videoHeight = argc > 4 ? std::stoi(argv[4]) : 1080;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "NV12 Convert Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    MappedFile file;
+    if (!file.open(path) || file.size() < nv12FrameBytes(videoWidth, videoHeight)) {
+        std::cout << "can not read a " << videoWidth << "x" << videoHeight << " NV12 frame from " << path << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    const unsigned char* y = file.data();
+    const unsigned char* uv = y + static_cast<size_t>(videoWidth) * videoHeight;
+    const double megapixels = static_cast<double>(videoWidth) * videoHeight / 1e6;
+    const auto report = [megapixels](const char* name, double ms) {
+        std::cout << "  " << name << ms << " ms (" << megapixels / ms * 1000.0 << " MPixels/s, " << 1000.0 / ms << " frames/s)" << std::endl;
+    };
+
+    std::cout << "\n==== NV12 convert benchmark: " << path << " " << videoWidth << "x" << videoHeight << " (" << iterations
+              << " iterations, " << yuvSimdName() << ", " << ThreadPool::getInstance().getThreadCount() << " worker threads) ===="
+              << std::endl;
+    std::vector<unsigned char> scalar(static_cast<size_t>(videoWidth) * videoHeight * 4);
+    std::vector<unsigned char> simd(scalar.size());
+    for (YuvColorSpace colorSpace: {YuvColorSpace::BT601, YuvColorSpace::BT709}) {
+        std::cout << (colorSpace == YuvColorSpace::BT601 ? "BT.601" : "BT.709") << std::endl;
+        setYuvSimdEnabled(false);
+        report("scalar        : ", measure(iterations, [&]() {
+            convertNV12ToRGBA(y, uv, videoWidth, videoHeight, scalar.data(), colorSpace, false);
+        }));
+        setYuvSimdEnabled(true);
+        report("simd          : ", measure(iterations, [&]() {
+            convertNV12ToRGBA(y, uv, videoWidth, videoHeight, simd.data(), colorSpace, false);
+        }));
+        report("simd + pool   : ", measure(iterations, [&]() {
+            convertNV12ToRGBA(y, uv, videoWidth, videoHeight, simd.data(), colorSpace, true);
+        }));
+        std::cout << "  simd output  : " << (simd == scalar ? "identical to scalar" : "DIFFERS from scalar") << std::endl;
+    }
+
+    TextureYUV video;
+    video.create(videoWidth, videoHeight);
+    GLuint rgbaTexture = 0;
+    glGenTextures(1, &rgbaTexture);
+    glBindTexture(GL_TEXTURE_2D, rgbaTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, videoWidth, videoHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::cout << "upload" << std::endl;
+    report("nv12 planes   : ", measure(iterations, [&]() {
+        video.upload(y, uv);
+        glFinish();
+    }));
+    report("rgba          : ", measure(iterations, [&]() {
+        glBindTexture(GL_TEXTURE_2D, rgbaTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, videoWidth, videoHeight, GL_RGBA, GL_UNSIGNED_BYTE, simd.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glFinish();
+    }));
+    report("convert + rgba: ", measure(iterations, [&]() {
+        convertNV12ToRGBA(y, uv, videoWidth, videoHeight, simd.data());
+        glBindTexture(GL_TEXTURE_2D, rgbaTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, videoWidth, videoHeight, GL_RGBA, GL_UNSIGNED_BYTE, simd.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glFinish();
+    }));
+
+    glDeleteTextures(1, &rgbaTexture);
+    video.release();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "utils/DirectStateAccess.h"
+#include "utils/Shader.h"
+#include "utils/Texture.h"
+#include "utils/VertexArray.h"
+#include "utils/VertexBuffer.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Direct state access benchmark: a grid of objects, each with its own texture, vertex buffer and
+ * vertex array, built and drawn once with the 3.3 bind-to-edit path and once with DSA.
+ *   setup : VertexBuffer::upload + VertexArray::addVertexBuffer + Texture::setParameter
+ *   frame : per object the vertices are streamed again (VertexBuffer::upload), the LOD bias is
+ *           animated (Texture::setParameter), then bind + draw + unbind
+ * The counters are the glBind* calls issued by Texture, VertexBuffer and VertexArray.
+ * Asks for a 4.5 context, on a 3.3 one only the fallback path runs. Every frame ends with glFinish.
+ *
+ * usage: 3_17_DSA_Benchmark [objects] [frames]
+ */
+
+struct SceneObject {
+    Texture texture;
+    VertexBuffer vbo;
+    VertexArray vao;
+};
+
+struct PathResult {
+    double setupMs = 0.0;
+    double frameMs = 0.0;
+    gl::BindStats setupBinds;
+    gl::BindStats frameBinds;       // per frame
+};
+
+static PathResult runPath(bool useDsa, int objects, int frames, Shader& shader) {
+    gl::setDsaEnabled(useDsa);
+    PathResult result;
+
+    // small checker texture shared as pixel data, every object gets its own GL texture
+    unsigned char checker[8 * 8 * 4];
+    for (int i = 0; i < 8 * 8; i++) {
+        const unsigned char value = ((i % 8) / 2 + (i / 8) / 2) % 2 ? 230 : 40;
+        checker[i * 4 + 0] = value;
+        checker[i * 4 + 1] = value;
+        checker[i * 4 + 2] = 255;
+        checker[i * 4 + 3] = 255;
+    }
+    const std::vector<VertexAttribute> attributes = {
+        {0, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)0},
+        {1, 2, AttributeType::Float, false, 4 * sizeof(float), (void*)(2 * sizeof(float))},
+    };
+    float quad[] = {
+        -0.5f, -0.5f, 0.0f, 0.0f,
+         0.5f, -0.5f, 1.0f, 0.0f,
+         0.5f,  0.5f, 1.0f, 1.0f,
+         0.5f,  0.5f, 1.0f, 1.0f,
+        -0.5f,  0.5f, 0.0f, 1.0f,
+        -0.5f, -0.5f, 0.0f, 0.0f,
+    };
+
+    std::vector<std::unique_ptr<SceneObject>> scene;
+    for (int i = 0; i < objects; i++) {
+        auto object = std::make_unique<SceneObject>();
+        object->texture.createFromData(checker, 8, 8, 4);
+        scene.push_back(std::move(object));
+    }
+
+    gl::resetBindStats();
+    const auto setupStart = std::chrono::steady_clock::now();
+    for (auto& object: scene) {
+        object->vbo.upload(quad, sizeof(quad) / sizeof(float), BufferUsage::StreamDraw);
+        object->vao.addVertexBuffer(object->vbo, attributes);
+        object->vao.unbind();
+        object->texture.setParameter(GL_TEXTURE_WRAP_S, static_cast<GLuint>(GL_CLAMP_TO_EDGE));
+        object->texture.setParameter(GL_TEXTURE_WRAP_T, static_cast<GLuint>(GL_CLAMP_TO_EDGE));
+        object->texture.setParameter(GL_TEXTURE_MAG_FILTER, static_cast<GLuint>(GL_NEAREST));
+    }
+    glFinish();
+    result.setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count();
+    result.setupBinds = gl::getBindStats();
+
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(objects))));
+    const float cell = 2.0f / static_cast<float>(columns);
+    shader.use();
+    shader.setMatrix4("projection", glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f));
+    shader.setFloat("scale", cell * 0.9f);
+    shader.setInt("texture_diffuse1", 0);
+
+    gl::resetBindStats();
+    const auto frameStart = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        const float wobble = 0.05f * std::sin(static_cast<float>(frame) * 0.1f);
+        for (size_t i = 0; i < scene.size(); i++) {
+            SceneObject& object = *scene[i];
+            quad[0] = -0.5f + wobble;
+            quad[20] = -0.5f + wobble;
+            object.vbo.upload(quad, sizeof(quad) / sizeof(float), BufferUsage::StreamDraw);
+            object.texture.setParameter(GL_TEXTURE_LOD_BIAS, wobble);
+
+            const int column = static_cast<int>(i) % columns;
+            const int row = static_cast<int>(i) / columns;
+            shader.setFloat2("offset", glm::vec2(-1.0f + cell * (column + 0.5f), -1.0f + cell * (row + 0.5f)));
+            object.vao.bind();
+            object.texture.bind(0);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            object.vao.unbind();
+        }
+        glFinish();
+    }
+    result.frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count() / frames;
+    const gl::BindStats total = gl::getBindStats();
+    result.frameBinds.textureBinds = total.textureBinds / frames;
+    result.frameBinds.bufferBinds = total.bufferBinds / frames;
+    result.frameBinds.vertexArrayBinds = total.vertexArrayBinds / frames;
+    return result;
+}
+
+static void printBinds(const char* name, const gl::BindStats& binds) {
+    std::cout << "    " << name << binds.total() << " binds (" << binds.textureBinds << " texture, " << binds.bufferBinds
+              << " buffer, " << binds.vertexArrayBinds << " vertex array)" << std::endl;
+}
+
+static void printResult(const char* name, const PathResult& result) {
+    std::cout << "  " << name << ": setup " << result.setupMs << " ms, frame " << result.frameMs << " ms" << std::endl;
+    printBinds("setup    : ", result.setupBinds);
+    printBinds("per frame: ", result.frameBinds);
+}
+
+int main(int argc, char **argv) {
+    const int objects = argc > 1 ? std::stoi(argv[1]) : 1024;
+    const int frames = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(512, 512, "DSA Benchmark", nullptr, nullptr);
+    if (!window) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(512, 512, "DSA Benchmark", nullptr, nullptr);
+    }
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    {
+        Shader shader("shaders/03_shaders/02_2_Texture_Bind_vs.glsl", "shaders/03_shaders/02_2_Texture_Bind_fs.glsl");
+        std::cout << "\n==== DSA benchmark (" << objects << " objects, " << frames << " frames, "
+                  << reinterpret_cast<const char*>(glGetString(GL_VERSION)) << ") ====" << std::endl;
+
+        const PathResult bindToEdit = runPath(false, objects, frames, shader);
+        printResult("bind-to-edit (3.3)", bindToEdit);
+        if (gl::hasDsa()) {
+            const PathResult direct = runPath(true, objects, frames, shader);
+            printResult("direct state access", direct);
+            std::cout << "  binds per frame: " << bindToEdit.frameBinds.total() << " -> " << direct.frameBinds.total()
+                      << ", frame time " << (direct.frameMs > 0.0 ? bindToEdit.frameMs / direct.frameMs : 0.0) << "x" << std::endl;
+        } else {
+            std::cout << "  direct state access: not available on this context" << std::endl;
+        }
+        gl::setDsaEnabled(true);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
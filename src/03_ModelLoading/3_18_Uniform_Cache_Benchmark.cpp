@@ -0,0 +1,118 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "utils/Shader.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/*
+ * Uniform update benchmark on the point light shader of 2_5_2: per object the camera, material and
+ * light uniforms are set like the demo does, only the model matrix really changes.
+ *   uncached : glGetUniformLocation + glUniform on every set (the old Shader)
+ *   strings  : std::string names, hashed at run time into the reflected table, repeats skipped
+ *   keys     : "name"_uniform keys hashed at compile time, repeats skipped
+ * Only the CPU time of the updates is measured, nothing is drawn. Every frame ends with glFinish.
+ *
+ * usage: 3_18_Uniform_Cache_Benchmark [objects] [frames]
+ */
+
+static void setUniformsByName(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4& model) {
+    shader.setFloat3("viewPos", glm::vec3(0.0f, 0.0f, 10.0f));
+    shader.setMatrix4("view", view);
+    shader.setMatrix4("projection", projection);
+    shader.setInt("material.diffuse", 0);
+    shader.setInt("material.specular", 1);
+    shader.setFloat("material.shininess", 32.0f);
+    shader.setFloat3("light.ambient", glm::vec3(0.3f, 0.3f, 0.3f));
+    shader.setFloat3("light.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
+    shader.setFloat3("light.specular", glm::vec3(1.f, 1.f, 1.f));
+    shader.setFloat3("light.position", glm::vec3(1.2f, 1.0f, 2.0f));
+    shader.setFloat("light.constant", 1.0f);
+    shader.setFloat("light.linear", 0.09f);
+    shader.setFloat("light.quadratic", 0.032f);
+    shader.setMatrix4("model", model);
+}
+
+static void setUniformsByKey(const Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4& model) {
+    shader.setFloat3("viewPos"_uniform, glm::vec3(0.0f, 0.0f, 10.0f));
+    shader.setMatrix4("view"_uniform, view);
+    shader.setMatrix4("projection"_uniform, projection);
+    shader.setInt("material.diffuse"_uniform, 0);
+    shader.setInt("material.specular"_uniform, 1);
+    shader.setFloat("material.shininess"_uniform, 32.0f);
+    shader.setFloat3("light.ambient"_uniform, glm::vec3(0.3f, 0.3f, 0.3f));
+    shader.setFloat3("light.diffuse"_uniform, glm::vec3(0.5f, 0.5f, 0.5f));
+    shader.setFloat3("light.specular"_uniform, glm::vec3(1.f, 1.f, 1.f));
+    shader.setFloat3("light.position"_uniform, glm::vec3(1.2f, 1.0f, 2.0f));
+    shader.setFloat("light.constant"_uniform, 1.0f);
+    shader.setFloat("light.linear"_uniform, 0.09f);
+    shader.setFloat("light.quadratic"_uniform, 0.032f);
+    shader.setMatrix4("model"_uniform, model);
+}
+
+template<typename SetUniforms>
+static void run(const char* name, Shader& shader, int objects, int frames, SetUniforms&& setUniforms) {
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    shader.invalidateUniformCache();
+    shader.resetUniformStats();
+
+    double updateMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < objects; i++) {
+            const glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i % 32), static_cast<float>(i / 32),
+                                                                              static_cast<float>(frame)));
+            setUniforms(shader, view, projection, model);
+        }
+        updateMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        glFinish();
+    }
+
+    const UniformStats stats = shader.getUniformStats();
+    std::cout << "  " << name << updateMs / frames << " ms per frame | per frame " << stats.writes / frames << " glUniform, "
+              << stats.skipped / frames << " skipped, " << stats.lookups / frames << " glGetUniformLocation" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    const int objects = argc > 1 ? std::stoi(argv[1]) : 1000;
+    const int frames = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Uniform Cache Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    {
+        Shader shader("shaders/02_shaders/2_5_2_PointLight.vert", "shaders/02_shaders/2_5_2_PointLight.frag");
+        shader.use();
+        std::cout << "\n==== Uniform cache benchmark (" << objects << " objects x 14 uniforms, " << frames << " frames) ====" << std::endl;
+
+        Shader::setUniformCacheEnabled(false);
+        run("uncached: ", shader, objects, frames, setUniformsByName);
+        Shader::setUniformCacheEnabled(true);
+        run("strings : ", shader, objects, frames, setUniformsByName);
+        run("keys    : ", shader, objects, frames, setUniformsByKey);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "utils/ProgramCache.h"
+#include "utils/Shader.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Program load benchmark over every vertex / fragment pair under shaders/
+ * (x.vert + x.frag, x_vs.glsl + x_fs.glsl):
+ *   source : ProgramCache off, compile and link from GLSL
+ *   fill   : empty cache, compiled and the binaries written
+ *   warm   : glProgramBinary from the cache
+ * Every pass prints one line per program. Uses its own cache directory and empties it first.
+ *
+ * usage: 3_19_Program_Cache_Benchmark [shader root]
+ */
+
+static std::vector<std::pair<std::string, std::string>> findPrograms(const std::string& root) {
+    std::vector<std::pair<std::string, std::string>> programs;
+    std::error_code error;
+    for (const auto& entry: std::filesystem::recursive_directory_iterator(root, error)) {
+        const std::string path = entry.path().generic_string();
+        const auto endsWith = [&path](const std::string& suffix) {
+            return path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        std::string fragment;
+        if (endsWith(".vert")) {
+            fragment = path.substr(0, path.size() - 5) + ".frag";
+        } else if (endsWith("_vs.glsl")) {
+            fragment = path.substr(0, path.size() - 8) + "_fs.glsl";
+        }
+        if (!fragment.empty() && std::filesystem::exists(fragment)) {
+            programs.emplace_back(path, fragment);
+        }
+    }
+    std::sort(programs.begin(), programs.end());
+    return programs;
+}
+
+static void loadAll(const char* name, const std::vector<std::pair<std::string, std::string>>& programs) {
+    ProgramCache& cache = ProgramCache::getInstance();
+    cache.clearRecords();
+    std::cout << name << std::endl;
+    {
+        std::vector<std::unique_ptr<Shader>> shaders;
+        for (const auto& program: programs) {
+            shaders.push_back(std::make_unique<Shader>(program.first.c_str(), program.second.c_str()));
+        }
+        glFinish();
+    }
+    cache.printReport();
+}
+
+int main(int argc, char **argv) {
+    const std::string root = argc > 1 ? argv[1] : "shaders";
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Program Cache Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    ProgramCache& cache = ProgramCache::getInstance();
+    const std::vector<std::pair<std::string, std::string>> programs = findPrograms(root);
+    std::cout << "\n==== Program cache benchmark: " << programs.size() << " programs under " << root << " ("
+              << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << ") ====" << std::endl;
+    if (!cache.isSupported()) {
+        std::cout << "program binaries are not supported by this context, only the source path runs" << std::endl;
+    }
+
+    cache.setDirectory(cache.getDirectory() + "/benchmark");
+    std::error_code error;
+    std::filesystem::remove_all(cache.getDirectory(), error);
+
+    cache.setEnabled(false);
+    loadAll("source", programs);
+    cache.setEnabled(true);
+    if (cache.isSupported()) {
+        loadAll("fill", programs);
+        loadAll("warm", programs);
+        const ProgramCacheStats stats = cache.getStats();
+        std::cout << "cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.rejected << " rejected, "
+                  << stats.writes << " written to " << cache.getDirectory() << std::endl;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
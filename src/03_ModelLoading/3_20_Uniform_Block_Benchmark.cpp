@@ -0,0 +1,283 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "utils/FrameUniforms.h"
+#include "utils/Shader.h"
+#include "utils/Texture.h"
+#include "utils/VertexArray.h"
+#include "utils/VertexBuffer.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Shared uniform data with a growing number of programs, each drawing a few cubes lit by a moving
+ * point light while the camera orbits:
+ *   uniforms : view / projection / viewPos and the light struct set into every program with
+ *              Shader::set* (the uniform cache skips what did not change), model per draw
+ *   blocks   : Camera and Lights written once per frame through FrameUniforms, Object per draw
+ * "cpu" is the time to issue the frame, "frame" adds the glFinish. The uniform path grows with
+ * the program count, the block path only with the draws.
+ *
+ * usage: 3_20_Uniform_Block_Benchmark [max programs] [objects per program] [frames]
+ */
+
+static const float CUBE[] = {
+    // positions          // normals           // texture coords
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+};
+
+struct FrameState {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos;
+    glm::vec3 lightPos;
+};
+
+struct PassResult {
+    double cpuMs = 0.0;
+    double frameMs = 0.0;
+    size_t uniformWrites = 0;   // glUniform calls per frame
+    size_t blockWrites = 0;     // FrameUniforms blocks per frame
+};
+
+static FrameState frameState(int frame) {
+    const float angle = static_cast<float>(frame) * 0.02f;
+    FrameState state;
+    state.viewPos = glm::vec3(std::sin(angle) * 12.0f, 4.0f, std::cos(angle) * 12.0f);
+    state.view = glm::lookAt(state.viewPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    state.projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    state.lightPos = glm::vec3(std::cos(angle * 3.0f) * 3.0f, 2.0f, std::sin(angle * 3.0f) * 3.0f);
+    return state;
+}
+
+static glm::mat4 objectModel(int program, int object) {
+    return glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(object % 4) * 1.5f - 2.25f, static_cast<float>(program % 8) - 3.5f,
+                                                     static_cast<float>(object / 4) * 1.5f - static_cast<float>(program / 8)));
+}
+
+static PassResult runUniforms(std::vector<std::unique_ptr<Shader>>& shaders, int objects, int frames) {
+    PassResult result;
+    for (auto& shader: shaders) {
+        shader->invalidateUniformCache();
+        shader->resetUniformStats();
+    }
+    for (int frame = 0; frame < frames; frame++) {
+        const FrameState state = frameState(frame);
+        const auto start = std::chrono::steady_clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        for (size_t p = 0; p < shaders.size(); p++) {
+            Shader& shader = *shaders[p];
+            shader.use();
+            shader.setMatrix4("view"_uniform, state.view);
+            shader.setMatrix4("projection"_uniform, state.projection);
+            shader.setFloat3("viewPos"_uniform, state.viewPos);
+            shader.setInt("material.diffuse"_uniform, 0);
+            shader.setInt("material.specular"_uniform, 1);
+            shader.setFloat("material.shininess"_uniform, 32.0f);
+            shader.setFloat3("light.position"_uniform, state.lightPos);
+            shader.setFloat3("light.ambient"_uniform, glm::vec3(0.3f));
+            shader.setFloat3("light.diffuse"_uniform, glm::vec3(0.5f));
+            shader.setFloat3("light.specular"_uniform, glm::vec3(1.0f));
+            shader.setFloat("light.constant"_uniform, 1.0f);
+            shader.setFloat("light.linear"_uniform, 0.09f);
+            shader.setFloat("light.quadratic"_uniform, 0.032f);
+            for (int i = 0; i < objects; i++) {
+                shader.setMatrix4("model"_uniform, objectModel(static_cast<int>(p), i));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+        result.cpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        glFinish();
+        result.frameMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    for (auto& shader: shaders) {
+        result.uniformWrites += shader->getUniformStats().writes;
+    }
+    result.cpuMs /= frames;
+    result.frameMs /= frames;
+    result.uniformWrites /= frames;
+    return result;
+}
+
+static PassResult runBlocks(std::vector<std::unique_ptr<Shader>>& shaders, int objects, int frames) {
+    PassResult result;
+    FrameUniforms& uniforms = FrameUniforms::getInstance();
+    uniforms.resetStats();
+    for (auto& shader: shaders) {
+        shader->invalidateUniformCache();
+        shader->resetUniformStats();
+    }
+    for (int frame = 0; frame < frames; frame++) {
+        const FrameState state = frameState(frame);
+        const auto start = std::chrono::steady_clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        uniforms.beginFrame();
+
+        CameraUniforms camera;
+        camera.view = state.view;
+        camera.projection = state.projection;
+        camera.viewPos = glm::vec4(state.viewPos, 1.0f);
+        uniforms.setCamera(camera);
+
+        LightUniforms lights;
+        lights.pointLightCount = 1;
+        PointLightUniforms& light = lights.pointLights[0];
+        light.position = glm::vec4(state.lightPos, 1.0f);
+        light.ambient = glm::vec4(0.3f);
+        light.diffuse = glm::vec4(0.5f);
+        light.specular = glm::vec4(1.0f);
+        light.attenuation = glm::vec4(1.0f, 0.09f, 0.032f, 0.0f);
+        uniforms.setLights(lights);
+
+        for (size_t p = 0; p < shaders.size(); p++) {
+            Shader& shader = *shaders[p];
+            shader.use();
+            shader.setInt("material.diffuse"_uniform, 0);
+            shader.setInt("material.specular"_uniform, 1);
+            shader.setFloat("material.shininess"_uniform, 32.0f);
+            for (int i = 0; i < objects; i++) {
+                ObjectUniforms object;
+                object.model = objectModel(static_cast<int>(p), i);
+                // translation only, the normal matrix is the model matrix
+                object.normalMatrix = object.model;
+                uniforms.setObject(object);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+        uniforms.endFrame();
+        result.cpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        glFinish();
+        result.frameMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    for (auto& shader: shaders) {
+        result.uniformWrites += shader->getUniformStats().writes;
+    }
+    result.cpuMs /= frames;
+    result.frameMs /= frames;
+    result.uniformWrites /= frames;
+    result.blockWrites = uniforms.getStats().writes / frames;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    const int maxPrograms = argc > 1 ? std::stoi(argv[1]) : 64;
+    const int objects = argc > 2 ? std::stoi(argv[2]) : 8;
+    const int frames = argc > 3 ? std::stoi(argv[3]) : 200;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(512, 512, "Uniform Block Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    {
+        glEnable(GL_DEPTH_TEST);
+        VertexBuffer vbo;
+        vbo.upload(CUBE, sizeof(CUBE) / sizeof(float));
+        VertexArray vao;
+        vao.addVertexBuffer(vbo, {
+            {0, 3, AttributeType::Float, false, 8 * sizeof(float), (void*)0},
+            {1, 3, AttributeType::Float, false, 8 * sizeof(float), (void*)(sizeof(float) * 3)},
+            {2, 2, AttributeType::Float, false, 8 * sizeof(float), (void*)(sizeof(float) * 6)},
+        });
+        vao.bind();
+
+        const unsigned char white[4] = {255, 255, 255, 255};
+        Texture diffuse, specular;
+        diffuse.createFromData(white, 1, 1, 4);
+        specular.createFromData(white, 1, 1, 4);
+        diffuse.bind(0);
+        specular.bind(1);
+
+        FrameUniforms::getInstance().init();
+        std::cout << "\n==== Uniform block benchmark (" << objects << " objects per program, " << frames << " frames, "
+                  << (FrameUniforms::getInstance().getStats().persistent ? "persistent ring" : "ring mapped per write") << ") ===="
+                  << std::endl;
+        std::cout << "programs | uniforms: cpu / frame ms, glUniform | blocks: cpu / frame ms, glUniform + blocks" << std::endl;
+
+        std::vector<std::unique_ptr<Shader>> uniformShaders;
+        std::vector<std::unique_ptr<Shader>> blockShaders;
+        for (int programs = 1; programs <= maxPrograms; programs *= 2) {
+            while (static_cast<int>(uniformShaders.size()) < programs) {
+                uniformShaders.push_back(std::make_unique<Shader>("shaders/02_shaders/2_5_2_PointLight.vert",
+                                                                  "shaders/02_shaders/2_5_2_PointLight.frag"));
+                blockShaders.push_back(std::make_unique<Shader>("shaders/03_shaders/05_1_Uniform_Blocks_vs.glsl",
+                                                                "shaders/03_shaders/05_1_Uniform_Blocks_fs.glsl"));
+            }
+            const PassResult classic = runUniforms(uniformShaders, objects, frames);
+            const PassResult blocks = runBlocks(blockShaders, objects, frames);
+            std::cout << "  " << programs << " | " << classic.cpuMs << " / " << classic.frameMs << " ms, " << classic.uniformWrites
+                      << " | " << blocks.cpuMs << " / " << blocks.frameMs << " ms, " << blocks.uniformWrites << " + "
+                      << blocks.blockWrites << std::endl;
+        }
+        const FrameUniformStats stats = FrameUniforms::getInstance().getStats();
+        if (stats.overflows > 0) {
+            std::cout << "  " << stats.overflows << " blocks did not fit the ring, raise FrameUniforms::init's frame size" << std::endl;
+        }
+        FrameUniforms::getInstance().shutdown();
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
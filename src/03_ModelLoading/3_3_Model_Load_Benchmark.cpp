@@ -0,0 +1,86 @@
+#include "utils/Model.h"
+#include "utils/MeshCache.h"
+#include "utils/TextureCache.h"
+#include "utils/ThreadPool.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+/*
+ * Model load benchmark
+ *   cold: Assimp import every time (cache disabled)
+ *   warm: .meshbin mapped load
+ *
+ * usage: 3_3_Model_Load_Benchmark [model path] [iterations]
+ */
+
+template<typename Func>
+double measure(int iterations, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    const std::string path = argc > 1 ? argv[1] : "models/backpack/backpack.obj";
+    const int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Model Load Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    ModelLoadOptions cold;
+    cold.useCache = false;
+    ModelLoadOptions warm;
+
+    // start from a clean state and build the cache once
+    std::remove(MeshCache::cachePathFor(path).c_str());
+    { Model prime(path.c_str(), warm); }
+    glFinish();
+
+    ModelLoadStats coldStats, warmStats;
+    const double coldMs = measure(iterations, [&]() { Model model(path.c_str(), cold); glFinish(); coldStats = model.getLoadStats(); });
+    const double warmMs = measure(iterations, [&]() { Model model(path.c_str(), warm); glFinish(); warmStats = model.getLoadStats(); });
+
+    auto printStats = [](const char *label, const ModelLoadStats& stats) {
+        std::cout << label << "import " << stats.importMs << " / convert " << stats.convertMs
+                  << " / textures " << stats.textureMs << " / upload " << stats.uploadMs
+                  << " ms (" << stats.meshCount << " meshes)" << std::endl;
+    };
+
+    std::cout << "\n==== Model load benchmark: " << path << " (" << iterations << " iterations) ====" << std::endl;
+    std::cout << "cold (assimp)    : " << coldMs << " ms" << std::endl;
+    std::cout << "warm (.meshbin)  : " << warmMs << " ms" << std::endl;
+    std::cout << "speedup          : " << (warmMs > 0.0 ? coldMs / warmMs : 0.0) << "x" << std::endl;
+    printStats("cold breakdown   : ", coldStats);
+    printStats("warm breakdown   : ", warmStats);
+    std::cout << "worker threads   : " << ThreadPool::getInstance().getThreadCount() << std::endl;
+    const TextureCacheStats textureStats = TextureCache::getInstance().getStats();
+    std::cout << "texture cache    : " << textureStats.hits << " hits / " << textureStats.misses << " misses" << std::endl;
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "glm/fwd.hpp"
+#include "glm/trigonometric.hpp"
+#include "utils/Model.h"
+#include "utils/OribitCamera.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+const int width = 800;
+const int height = 600;
+const char *title = "Quantized Model";
+
+
+bool dragging = false;
+double lastX = width / 2.0, lastY = height / 2.0;
+double curX = width / 2.0, curY = height / 2.0;
+
+OribitCamera oribitCamera(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 1.0f, 0.f), 6.f, 1.f, 0, 0);
+
+// Q toggles between the full float and the quantized copy
+bool showQuantized = true;
+
+
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_Q && action == GLFW_PRESS) {
+        showQuantized = !showQuantized;
+        std::cout << (showQuantized ? "quantized vertices" : "float vertices") << std::endl;
+    }
+}
+
+
+void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+    oribitCamera.zoom(static_cast<float>(yoffset));
+}
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow *window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetKeyCallback(window, keyCallback);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    Shader floatShader("shaders/03_shaders/01_1_Backpack_Rendering_vs.glsl", "shaders/03_shaders/01_1_Backpack_Rendering_fs.glsl");
+    Shader quantizedShader("shaders/03_shaders/01_2_Quantized_Model_vs.glsl", "shaders/03_shaders/01_2_Quantized_Model_fs.glsl");
+
+    Model floatModel("models/backpack/backpack.obj");
+    ModelLoadOptions options;
+    options.quantizeVertices = true;
+    // useCache=false so the import (and with it the error report) runs every time
+    options.useCache = false;
+    Model quantizedModel("models/backpack/backpack.obj", options);
+
+    std::cout << "vertex buffers: float " << floatModel.getLoadStats().vertexBytes / 1024 << " KB, quantized "
+              << quantizedModel.getLoadStats().vertexBytes / 1024 << " KB (press Q to toggle)" << std::endl;
+    std::cout << "index buffers: " << quantizedModel.getLoadStats().indexBytes / 1024 << " KB, "
+              << quantizedModel.getLoadStats().indexBytes32 / 1024 << " KB as 32 bit" << std::endl;
+
+    glEnable(GL_DEPTH_TEST);
+    while(!glfwWindowShouldClose(window)) {
+        // Handle input
+        const auto leftMouseBtnState = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
+        if (leftMouseBtnState == GLFW_PRESS) {
+            if (!dragging) {
+                glfwGetCursorPos(window, &lastX, &lastY);
+                dragging = true;
+            }
+            glfwGetCursorPos(window, &curX, &curY);
+            const auto deltaX = curX - lastX;
+            const auto deltaY = curY - lastY;
+            oribitCamera.rotateAzimuth(glm::radians(static_cast<float>(deltaX) * 0.5f));
+            oribitCamera.rotatePolar(glm::radians(static_cast<float>(deltaY) * 0.5f));
+            lastX = curX;
+            lastY = curY;
+        } else {
+            dragging = false;
+        }
+
+        glViewport(0, 0, width, height);
+        glClearColor(0.01f, 0.01f, 0.01f, 0.1f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        Shader& shader = showQuantized ? quantizedShader : floatShader;
+        shader.use();
+        // glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)height, 0.1f, 100.f);
+        glm::mat4 projection = glm::perspective(glm::radians(45.f), (float)width / (float)height, 0.1f, 100.f);
+        glm::mat4 view = oribitCamera.getViewMatrix();
+        shader.setMatrix4("projection", projection);
+        shader.setMatrix4("view", view);
+        glm::mat4 model = glm::mat4(1.f);
+        model = glm::translate(model, glm::vec3(0.f, 0.f, 0.f));
+        model = glm::scale(model, glm::vec3(1.f));
+        model = glm::rotate(model, glm::radians(30.f), glm::vec3(0.f, 1.0f, 0.f));
+        shader.setMatrix4("model", model);
+
+        if (showQuantized) {
+            quantizedModel.draw(shader);
+        } else {
+            floatModel.draw(shader);
+        }
+
+        glfwPollEvents();
+        glfwSwapBuffers(window);
+    }
+
+    glfwTerminate();
+    return 0;
+}
\ No newline at end of file
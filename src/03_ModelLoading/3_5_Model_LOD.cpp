@@ -0,0 +1,139 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "glm/fwd.hpp"
+#include "glm/trigonometric.hpp"
+#include "utils/Model.h"
+#include "utils/OribitCamera.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+const int width = 800;
+const int height = 600;
+const char *title = "Model LOD";
+const int gridSize = 7;
+const float spacing = 4.f;
+
+
+bool dragging = false;
+double lastX = width / 2.0, lastY = height / 2.0;
+double curX = width / 2.0, curY = height / 2.0;
+
+OribitCamera oribitCamera(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 1.0f, 0.f), 20.f, 1.f, 0, 0);
+
+// L toggles LOD selection to compare against full resolution
+bool useLods = true;
+
+
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+        useLods = !useLods;
+        std::cout << (useLods ? "LODs on" : "LODs off") << std::endl;
+    }
+}
+
+
+void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+    oribitCamera.zoom(static_cast<float>(yoffset));
+}
+
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    GLFWwindow *window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetKeyCallback(window, keyCallback);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    Shader shader("shaders/03_shaders/01_1_Backpack_Rendering_vs.glsl", "shaders/03_shaders/01_1_Backpack_Rendering_fs.glsl");
+    ModelLoadOptions options;
+    options.optimizeMeshes = true;
+    options.generateLods = true;
+    Model modelObj("models/backpack/backpack.obj", options);
+
+    double lastReport = glfwGetTime();
+    size_t frames = 0, trianglesFull = 0, trianglesDrawn = 0;
+
+    glEnable(GL_DEPTH_TEST);
+    while(!glfwWindowShouldClose(window)) {
+        // Handle input
+        const auto leftMouseBtnState = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
+        if (leftMouseBtnState == GLFW_PRESS) {
+            if (!dragging) {
+                glfwGetCursorPos(window, &lastX, &lastY);
+                dragging = true;
+            }
+            glfwGetCursorPos(window, &curX, &curY);
+            const auto deltaX = curX - lastX;
+            const auto deltaY = curY - lastY;
+            oribitCamera.rotateAzimuth(glm::radians(static_cast<float>(deltaX) * 0.5f));
+            oribitCamera.rotatePolar(glm::radians(static_cast<float>(deltaY) * 0.5f));
+            lastX = curX;
+            lastY = curY;
+        } else {
+            dragging = false;
+        }
+
+        glViewport(0, 0, width, height);
+        glClearColor(0.01f, 0.01f, 0.01f, 0.1f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+        // glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)height, 0.1f, 100.f);
+        glm::mat4 projection = glm::perspective(glm::radians(45.f), (float)width / (float)height, 0.1f, 200.f);
+        glm::mat4 view = oribitCamera.getViewMatrix();
+        shader.setMatrix4("projection", projection);
+        shader.setMatrix4("view", view);
+        // a grid of copies reaching into the distance
+        for (int z = 0; z < gridSize; z++) {
+            for (int x = 0; x < gridSize; x++) {
+                glm::mat4 model = glm::mat4(1.f);
+                model = glm::translate(model, glm::vec3((x - gridSize / 2) * spacing, 0.f, -z * spacing * 2.f));
+                model = glm::rotate(model, glm::radians(30.f), glm::vec3(0.f, 1.0f, 0.f));
+                shader.setMatrix4("model", model);
+
+                if (useLods) {
+                    modelObj.draw(shader, model, view, projection, static_cast<float>(height));
+                    trianglesFull += modelObj.getDrawStats().trianglesFull;
+                    trianglesDrawn += modelObj.getDrawStats().trianglesDrawn;
+                } else {
+                    modelObj.draw(shader);
+                }
+            }
+        }
+
+        frames++;
+        if (glfwGetTime() - lastReport >= 1.0 && useLods) {
+            const size_t saved = (trianglesFull - trianglesDrawn) / frames;
+            std::cout << "triangles per frame: " << trianglesDrawn / frames << " of " << trianglesFull / frames
+                      << ", saved " << saved << " (" << (trianglesFull ? 100.0 * (trianglesFull - trianglesDrawn) / trianglesFull : 0.0) << "%)" << std::endl;
+            lastReport = glfwGetTime();
+            frames = trianglesFull = trianglesDrawn = 0;
+        } else if (!useLods) {
+            lastReport = glfwGetTime();
+            frames = trianglesFull = trianglesDrawn = 0;
+        }
+
+        glfwPollEvents();
+        glfwSwapBuffers(window);
+    }
+
+    glfwTerminate();
+    return 0;
+}
\ No newline at end of file
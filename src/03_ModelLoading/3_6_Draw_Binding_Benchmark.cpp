@@ -0,0 +1,121 @@
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "utils/Model.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+/*
+ * Draw binding benchmark
+ *   counts heap allocations and texture binds per Model::draw with the precompiled
+ *   material bindings, next to the old per draw "texture_diffuse" + std::to_string(n) lookup
+ *
+ * usage: 3_6_Draw_Binding_Benchmark [model path] [frames]
+ */
+
+static std::atomic<size_t> allocations {0};
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char **argv) {
+    const std::string path = argc > 1 ? argv[1] : "models/backpack/backpack.obj";
+    const int frames = argc > 2 ? std::stoi(argv[2]) : 1000;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Draw Binding Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    Shader shader("shaders/03_shaders/01_1_Backpack_Rendering_vs.glsl", "shaders/03_shaders/01_1_Backpack_Rendering_fs.glsl");
+    Model modelObj(path.c_str());
+    const size_t meshCount = modelObj.getLoadStats().meshCount;
+
+    shader.use();
+    const glm::mat4 projection = glm::perspective(glm::radians(45.f), 1.f, 0.1f, 100.f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 6.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    shader.setMatrix4("projection", projection);
+    shader.setMatrix4("view", view);
+    shader.setMatrix4("model", glm::mat4(1.f));
+
+    // warm up, the first draw resolves the sampler uniforms and the draw order
+    modelObj.draw(shader);
+    glFinish();
+
+    const size_t bindsBefore = modelObj.getBindState().binds;
+    const size_t skippedBefore = modelObj.getBindState().skipped;
+    size_t allocationsBefore = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        modelObj.draw(shader);
+    }
+    glFinish();
+    const double bindingMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const size_t bindingAllocations = allocations - allocationsBefore;
+
+    // what Mesh::draw used to do for each mesh, assuming one diffuse texture per mesh
+    allocationsBefore = allocations;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        for (size_t m = 0; m < meshCount; m++) {
+            unsigned int diffuseNr = 1;
+            std::string name;
+            const std::string type = "texture_diffuse";
+            if (type == "texture_diffuse") {
+                name = "texture_diffuse" + std::to_string(diffuseNr++);
+            }
+            shader.setInt(name, 0);
+        }
+    }
+    glFinish();
+    const double legacyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const size_t legacyAllocations = allocations - allocationsBefore;
+
+    const size_t binds = modelObj.getBindState().binds - bindsBefore;
+    const size_t skipped = modelObj.getBindState().skipped - skippedBefore;
+
+    std::cout << "\n==== Draw binding benchmark: " << path << " (" << meshCount << " meshes, " << frames << " frames) ====" << std::endl;
+    std::cout << "material bindings : " << static_cast<double>(bindingAllocations) / frames << " allocations / frame, "
+              << bindingMs / frames << " ms / frame (draws included)" << std::endl;
+    std::cout << "texture binds     : " << static_cast<double>(binds) / frames << " issued, "
+              << static_cast<double>(skipped) / frames << " skipped / frame" << std::endl;
+    std::cout << "legacy names only : " << static_cast<double>(legacyAllocations) / frames << " allocations / frame, "
+              << legacyMs / frames << " ms / frame (no draws)" << std::endl;
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "utils/Image.h"
+#include "utils/ImageCache.h"
+#include "utils/TextureCube.h"
+#include "utils/ThreadPool.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Skybox decode benchmark
+ *   cold    : first TextureCube::loadFromFiles of the process (the OS file cache may still be warm)
+ *   serial  : six loadImage calls one after another, the old TextureCube behaviour
+ *   parallel: the six faces decoded on the ThreadPool
+ *   cube    : TextureCube::loadFromFiles, parallel decode + upload on this thread
+ * The .texbin cache is off so every load decodes, 3_14_Image_Cache_Benchmark measures it.
+ *
+ * usage: 3_7_Skybox_Decode_Benchmark [iterations]
+ */
+
+struct Skybox {
+    std::string name;
+    std::vector<std::string> faces;   // right left top bottom back front
+};
+
+template<typename Func>
+double measure(int iterations, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 5;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Skybox Decode Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    ImageCache::setEnabled(false);
+    const std::vector<Skybox> skyboxes = {
+        {"lake_skybox", {"textures/lake_skybox/right.jpg", "textures/lake_skybox/left.jpg", "textures/lake_skybox/top.jpg",
+                         "textures/lake_skybox/bottom.jpg", "textures/lake_skybox/front.jpg", "textures/lake_skybox/back.jpg"}},
+        {"roblox_skybox", {"textures/roblox_skybox/px.png", "textures/roblox_skybox/nx.png", "textures/roblox_skybox/py.png",
+                           "textures/roblox_skybox/ny.png", "textures/roblox_skybox/pz.png", "textures/roblox_skybox/nz.png"}},
+    };
+
+    std::cout << "\n==== Skybox decode benchmark (" << iterations << " iterations, "
+              << ThreadPool::getInstance().getThreadCount() << " worker threads) ====" << std::endl;
+    for (const auto& skybox: skyboxes) {
+        const auto coldStart = std::chrono::steady_clock::now();
+        TextureCube cube;
+        if (!cube.loadFromFiles(skybox.faces)) {
+            std::cout << skybox.name << ": failed to load, skipped" << std::endl;
+            continue;
+        }
+        glFinish();
+        const double coldMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - coldStart).count();
+
+        Image faces[6];
+        const double serialMs = measure(iterations, [&]() {
+            for (size_t i = 0; i < 6; i++) {
+                loadImage(skybox.faces[i], faces[i], false);
+            }
+        });
+        const double parallelMs = measure(iterations, [&]() {
+            ThreadPool::getInstance().parallelFor(6, [&](size_t i) {
+                loadImage(skybox.faces[i], faces[i], false);
+            });
+        });
+        const double cubeMs = measure(iterations, [&]() {
+            TextureCube reload;
+            reload.loadFromFiles(skybox.faces);
+            glFinish();
+        });
+
+        const double megapixels = 6.0 * cube.getWidth() * cube.getHeight() / 1e6;
+        std::cout << skybox.name << " (6 x " << cube.getWidth() << "x" << cube.getHeight() << ")" << std::endl;
+        std::cout << "  cold cube load  : " << coldMs << " ms" << std::endl;
+        std::cout << "  serial decode   : " << serialMs << " ms (" << megapixels / serialMs * 1000.0 << " MPixels/s)" << std::endl;
+        std::cout << "  parallel decode : " << parallelMs << " ms (" << megapixels / parallelMs * 1000.0 << " MPixels/s)" << std::endl;
+        std::cout << "  speedup         : " << (parallelMs > 0.0 ? serialMs / parallelMs : 0.0) << "x" << std::endl;
+        std::cout << "  cube load       : " << cubeMs << " ms (decode + upload)" << std::endl;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "utils/Image.h"
+#include "utils/Ktx2.h"
+#include "utils/Texture.h"
+#include "utils/TextureCompression.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/*
+ * Compressed texture benchmark, PNG/JPEG vs KTX2 produced by the TextureCompress tool
+ *   stb  : loadImage + Texture::createFromData (glTexImage2D + CPU mip chain)
+ *   ktx2 : readKtx2 + uploadKtx2 (glCompressedTexImage2D per stored level)
+ * Both bypass the TextureCache so every iteration decodes and uploads again.
+ *
+ * usage: 3_8_Compressed_Texture_Benchmark [image] [ktx2] [iterations]
+ *   create the ktx2 first, e.g. TextureCompress -f bc7 textures/container2.png
+ */
+
+template<typename Func>
+double measure(int iterations, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    const std::string imagePath = argc > 1 ? argv[1] : "textures/container2.png";
+    const std::string ktx2Path = argc > 2 ? argv[2] : "textures/container2.ktx2";
+    const int iterations = argc > 3 ? std::stoi(argv[3]) : 10;
+
+    if (!std::ifstream(ktx2Path)) {
+        std::cout << ktx2Path << " not found, run: TextureCompress -f bc7 " << imagePath << std::endl;
+        return -1;
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Compressed Texture Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    Image image;
+    Ktx2Texture ktx;
+    if (!loadImage(imagePath, image, true) || !readKtx2(ktx2Path, ktx)) {
+        std::cout << "Failed to load " << imagePath << " or " << ktx2Path << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    const bool supported = isCompressedFormatSupported(ktx.format);
+
+    const double stbDecodeMs = measure(iterations, [&]() {
+        Image decoded;
+        loadImage(imagePath, decoded, true);
+    });
+    const double stbLoadMs = measure(iterations, [&]() {
+        Image decoded;
+        loadImage(imagePath, decoded, true);
+        Texture texture;
+        texture.createFromData(decoded.pixels.data(), decoded.width, decoded.height, decoded.channels);
+        glFinish();
+    });
+    const double ktxReadMs = measure(iterations, [&]() {
+        Ktx2Texture file;
+        readKtx2(ktx2Path, file);
+    });
+    const double ktxLoadMs = measure(iterations, [&]() {
+        Ktx2Texture file;
+        readKtx2(ktx2Path, file);
+        GLuint id;
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        uploadKtx2(file, GL_TEXTURE_2D);
+        glFinish();
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDeleteTextures(1, &id);
+    });
+
+    // a full mip chain adds a third on top of level 0, the ktx2 chain is stored in the file
+    const size_t stbBytes = static_cast<size_t>(image.width) * image.height * 4 * 4 / 3;
+    const size_t ktxBytes = supported ? ktx.byteSize() : stbBytes;
+    Image decoded;
+    decompressImage(ktx.levels[0].data(), ktx.width, ktx.height, ktx.format, decoded);
+    const double psnr = computePsnr(image, decoded, compressedChannels(ktx.format));
+
+    std::cout << "\n==== Compressed texture benchmark (" << iterations << " iterations) ====" << std::endl;
+    std::cout << imagePath << " " << image.width << "x" << image.height << "x" << image.channels << " vs "
+              << ktx2Path << " " << compressedFormatName(ktx.format) << ", " << ktx.levels.size() << " levels" << std::endl;
+    std::cout << "  driver support : " << (supported ? "native" : "no, decoded to RGBA8 on the cpu") << std::endl;
+    std::cout << "  quality        : PSNR " << psnr << " dB (level 0)" << std::endl;
+    std::cout << "  stb decode     : " << stbDecodeMs << " ms" << std::endl;
+    std::cout << "  stb load       : " << stbLoadMs << " ms (decode + upload + mipmaps)" << std::endl;
+    std::cout << "  ktx2 read      : " << ktxReadMs << " ms" << std::endl;
+    std::cout << "  ktx2 load      : " << ktxLoadMs << " ms (read + upload)" << std::endl;
+    std::cout << "  speedup        : " << (ktxLoadMs > 0.0 ? stbLoadMs / ktxLoadMs : 0.0) << "x" << std::endl;
+    std::cout << "  vram           : " << stbBytes / 1024 << " KB -> " << ktxBytes / 1024 << " KB" << std::endl;
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
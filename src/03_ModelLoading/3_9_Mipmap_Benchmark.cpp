@@ -0,0 +1,148 @@
+#include "utils/Image.h"
+#include "utils/MipChain.h"
+#include "utils/ThreadPool.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Mip chain benchmark, throughput in MPixels/s of level 0
+ *   scalar / simd   : buildMipLevels with the SIMD kernels off / on, linear and sRGB filtering
+ *   batch           : chains of all images one after another vs one ThreadPool job per image
+ *   gpu             : glTexImage2D + glGenerateMipmap vs uploadMipChain of the prebuilt levels
+ * SIMD and scalar results are compared byte for byte.
+ *
+ * usage: 3_9_Mipmap_Benchmark [iterations] [image...]
+ */
+
+template<typename Func>
+double measure(int iterations, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+static bool sameLevels(const std::vector<Image>& a, const std::vector<Image>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].pixels != b[i].pixels) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int iterations = argc > 1 ? std::stoi(argv[1]) : 10;
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; i++) {
+        paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        paths = {"textures/container2.png", "textures/wall.jpg", "textures/matrix.jpg", "textures/lake_skybox/right.jpg"};
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Mipmap Benchmark", nullptr, nullptr);
+    if (!window) {
+        std::cout << "Failed to create glfw window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to load gl" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    std::vector<Image> images;
+    for (const auto& path: paths) {
+        Image image;
+        if (loadImage(path, image, true)) {
+            images.push_back(std::move(image));
+        } else {
+            std::cout << path << ": failed to load, skipped" << std::endl;
+        }
+    }
+
+    std::cout << "\n==== Mipmap benchmark (" << iterations << " iterations, " << mipSimdName() << " kernels, "
+              << ThreadPool::getInstance().getThreadCount() << " worker threads) ====" << std::endl;
+    double totalMegapixels = 0.0;
+    for (size_t i = 0; i < images.size(); i++) {
+        const Image& image = images[i];
+        const double megapixels = static_cast<double>(image.width) * image.height / 1e6;
+        totalMegapixels += megapixels;
+        std::cout << paths[i] << " (" << image.width << "x" << image.height << "x" << image.channels << ", "
+                  << mipLevelCount(image.width, image.height) << " levels)" << std::endl;
+
+        for (MipColorSpace colorSpace: {MipColorSpace::Linear, MipColorSpace::SRGB}) {
+            std::vector<Image> scalarLevels, simdLevels;
+            setMipSimdEnabled(false);
+            const double scalarMs = measure(iterations, [&]() { scalarLevels = buildMipLevels(image, colorSpace); });
+            setMipSimdEnabled(true);
+            const double simdMs = measure(iterations, [&]() { simdLevels = buildMipLevels(image, colorSpace); });
+
+            std::cout << (colorSpace == MipColorSpace::SRGB ? "  srgb  " : "  linear")
+                      << " scalar " << scalarMs << " ms (" << megapixels / scalarMs * 1000.0 << " MPixels/s)"
+                      << " | simd " << simdMs << " ms (" << megapixels / simdMs * 1000.0 << " MPixels/s)"
+                      << " | " << (sameLevels(scalarLevels, simdLevels) ? "identical" : "MISMATCH") << std::endl;
+        }
+
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const GLenum format = formatForChannels(image.channels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        const double gpuMs = measure(iterations, [&]() {
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glFinish();
+        });
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        const std::vector<Image> levels = buildMipLevels(image, MipColorSpace::SRGB);
+        const double uploadMs = measure(iterations, [&]() {
+            uploadMipChain(GL_TEXTURE_2D, image.pixels.data(), image.width, image.height, image.channels, levels);
+            glFinish();
+        });
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDeleteTextures(1, &texture);
+        std::cout << "  gpu    glGenerateMipmap " << gpuMs << " ms | level by level upload " << uploadMs
+                  << " ms (chain built off the GL thread)" << std::endl;
+    }
+
+    if (images.size() > 1) {
+        std::vector<std::vector<Image>> chains(images.size());
+        const double serialMs = measure(iterations, [&]() {
+            for (size_t i = 0; i < images.size(); i++) {
+                chains[i] = buildMipLevels(images[i], MipColorSpace::SRGB);
+            }
+        });
+        const double parallelMs = measure(iterations, [&]() {
+            ThreadPool::getInstance().parallelFor(images.size(), [&](size_t i) {
+                chains[i] = buildMipLevels(images[i], MipColorSpace::SRGB);
+            });
+        });
+        std::cout << "batch of " << images.size() << " (srgb): serial " << serialMs << " ms ("
+                  << totalMegapixels / serialMs * 1000.0 << " MPixels/s) | parallel " << parallelMs << " ms ("
+                  << totalMegapixels / parallelMs * 1000.0 << " MPixels/s)" << std::endl;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
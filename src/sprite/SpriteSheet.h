@@ -15,6 +15,7 @@ namespace Sprite {
  * 
  * 管理精灵图纹理和帧定义
  * 支持不规则布局（手动指定每帧的位置和大小）
+ * 纹理经由 TextureCache 共享，多个 SpriteSheet 使用同一张图片时只解码、上传一次
  * 
  * 使用示例：
  *   SpriteSheet sheet("character.png");
@@ -43,7 +44,7 @@ public:
     /**
      * 析构函数
      * 
-     * 自动释放纹理资源（通过 Texture2 的 RAII）
+     * 自动释放纹理引用（通过 Texture 的 RAII），最后一个引用释放时 TextureCache 删除 GL 纹理
      */
     ~SpriteSheet() = default;
     
@@ -0,0 +1,186 @@
+#include "utils/Image.h"
+#include "utils/Ktx2.h"
+#include "utils/MipChain.h"
+#include "utils/TextureCompression.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * TextureCompress: offline PNG/JPEG -> block compressed KTX2 with a precomputed mip chain
+ *
+ * usage: TextureCompress [-f bc1|bc3|bc5|bc7|etc2] [-o out.ktx2] [--no-mips] [--no-flip] [--linear] image...
+ *        TextureCompress --cube -o sky.ktx2 right left top bottom back front
+ *
+ * Images are flipped like Texture::loadFromFile does (cube maps never are), so a .ktx2 can
+ * replace its source path 1:1. Mips of color formats are filtered in linear light, --linear (and
+ * bc5, which holds normals) filters the stored values directly.
+ * Reports PSNR of level 0 and the load time against stb_image.
+ */
+
+struct Options {
+    CompressedFormat format = CompressedFormat::BC7;
+    std::string output;
+    bool mips = true;
+    bool flip = true;
+    bool cube = false;
+    bool linear = false;
+    std::vector<std::string> inputs;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static size_t fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? static_cast<size_t>(file.tellg()) : 0;
+}
+
+static std::string ktx2PathFor(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    const size_t slash = path.find_last_of('/');
+    const bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    return (hasExtension ? path.substr(0, dot) : path) + ".ktx2";
+}
+
+static void printUsage() {
+    std::cout << "usage: TextureCompress [-f bc1|bc3|bc5|bc7|etc2] [-o out.ktx2] [--no-mips] [--no-flip] [--linear] image...\n"
+              << "       TextureCompress --cube [-f format] -o out.ktx2 right left top bottom back front" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if ((arg == "-f" || arg == "--format") && i + 1 < argc) {
+            if (!parseCompressedFormat(argv[++i], options.format)) {
+                std::cout << "ERROR::TEXTURE_COMPRESS:: unknown format " << argv[i] << std::endl;
+                return false;
+            }
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--no-mips") {
+            options.mips = false;
+        } else if (arg == "--no-flip") {
+            options.flip = false;
+        } else if (arg == "--linear") {
+            options.linear = true;
+        } else if (arg == "--cube") {
+            options.cube = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cout << "ERROR::TEXTURE_COMPRESS:: unknown option " << arg << std::endl;
+            return false;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.inputs.empty() || (options.cube && (options.inputs.size() != 6 || options.output.empty()))
+        || (!options.cube && options.inputs.size() > 1 && !options.output.empty())) {
+        return false;
+    }
+    return true;
+}
+
+// encodes the faces (one for 2D) into texture, returns false if a source can not be decoded
+static bool compressFaces(const std::vector<std::string>& inputs, const Options& options, const std::string& output) {
+    const bool flip = options.flip && !options.cube;
+    std::vector<Image> faces(inputs.size());
+
+    auto start = std::chrono::steady_clock::now();
+    size_t sourceBytes = 0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!loadImage(inputs[i], faces[i], flip)) {
+            return false;
+        }
+        if (faces[i].width != faces[0].width || faces[i].height != faces[0].height) {
+            std::cout << "ERROR::TEXTURE_COMPRESS:: " << inputs[i] << " has a different size than " << inputs[0] << std::endl;
+            return false;
+        }
+        sourceBytes += fileSize(inputs[i]);
+    }
+    const double decodeMs = elapsedMs(start);
+    if (faces[0].channels == 4 && compressedChannels(options.format) < 4) {
+        std::cout << "WARNING::TEXTURE_COMPRESS:: " << compressedFormatName(options.format) << " drops the alpha channel, use bc3 or bc7" << std::endl;
+    }
+
+    Ktx2Texture ktx;
+    ktx.format = options.format;
+    ktx.width = faces[0].width;
+    ktx.height = faces[0].height;
+    ktx.faceCount = static_cast<int>(faces.size());
+
+    start = std::chrono::steady_clock::now();
+    size_t pixels = 0;
+    size_t uncompressedBytes = 0;
+    double psnr = 99.0;
+    const MipColorSpace colorSpace = options.linear || options.format == CompressedFormat::BC5 ? MipColorSpace::Linear : MipColorSpace::SRGB;
+    std::vector<Image> levels(faces);
+    for (int level = 0; ; level++) {
+        std::vector<unsigned char>& data = ktx.levels.emplace_back();
+        for (size_t face = 0; face < levels.size(); face++) {
+            std::vector<unsigned char> blocks;
+            compressImage(levels[face], options.format, blocks);
+            data.insert(data.end(), blocks.begin(), blocks.end());
+            pixels += static_cast<size_t>(levels[face].width) * levels[face].height;
+            uncompressedBytes += static_cast<size_t>(levels[face].width) * levels[face].height * 4;
+            if (level == 0) {
+                Image decoded;
+                decompressImage(blocks.data(), levels[face].width, levels[face].height, options.format, decoded);
+                psnr = std::min(psnr, computePsnr(levels[face], decoded, compressedChannels(options.format)));
+            }
+        }
+        const bool last = levels[0].width == 1 && levels[0].height == 1;
+        if (!options.mips || last) {
+            break;
+        }
+        for (auto& image: levels) {
+            image = downsampleImage(image, colorSpace);
+        }
+    }
+    const double encodeMs = elapsedMs(start);
+
+    if (!writeKtx2(output, ktx)) {
+        return false;
+    }
+
+    // what a load costs: stb decode of the source vs reading the container (uploads are timed by the benchmark demo)
+    start = std::chrono::steady_clock::now();
+    Ktx2Texture reloaded;
+    const bool readBack = readKtx2(output, reloaded);
+    const double readMs = elapsedMs(start);
+
+    std::cout << inputs[0] << (inputs.size() > 1 ? " (+5 faces)" : "") << " -> " << output
+              << " [" << compressedFormatName(ktx.format) << ", " << ktx.width << "x" << ktx.height << ", "
+              << ktx.levels.size() << " levels]" << std::endl;
+    std::cout << "  source  : " << sourceBytes / 1024 << " KB on disk, " << uncompressedBytes / 1024 << " KB as RGBA8 with mips" << std::endl;
+    std::cout << "  encoded : " << fileSize(output) / 1024 << " KB, " << encodeMs << " ms ("
+              << pixels / 1e3 / std::max(encodeMs, 1e-3) << " MPixels/s)" << std::endl;
+    std::cout << "  quality : PSNR " << psnr << " dB (level 0" << (faces.size() > 1 ? ", worst face" : "") << ")" << std::endl;
+    std::cout << "  load    : ktx2 read " << readMs << " ms vs stb decode " << decodeMs << " ms"
+              << (readBack ? "" : " (read back FAILED)") << std::endl;
+    return readBack;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    std::cout << "TextureCompress: " << ThreadPool::getInstance().getThreadCount() << " worker threads" << std::endl;
+
+    bool ok = true;
+    if (options.cube) {
+        ok = compressFaces(options.inputs, options, options.output);
+    } else {
+        for (const auto& input: options.inputs) {
+            const std::string output = options.output.empty() ? ktx2PathFor(input) : options.output;
+            ok = compressFaces({input}, options, output) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
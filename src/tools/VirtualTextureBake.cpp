@@ -0,0 +1,84 @@
+#include "utils/Image.h"
+#include "utils/MipChain.h"
+#include "utils/ThreadPool.h"
+#include "utils/VirtualTexture.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/*
+ * VirtualTextureBake: offline PNG/JPEG -> tiled .vtex file for VirtualTexture
+ *
+ * usage: VirtualTextureBake [-t tile size] [-b border] [--repeat n] [--linear] [--no-flip] -o out.vtex image
+ *
+ * --repeat tiles the image n x n times without building the result in memory, e.g.
+ * textures/container2.png (500x500) with --repeat 64 is a 32000x32000 (1 gigapixel) test image.
+ * Tiles are stored uncompressed, the file is about 1.5x the RGBA8 size of level 0 (borders + mips).
+ */
+
+struct Options {
+    VirtualTextureBakeOptions bake;
+    std::string output;
+    std::string input;
+    bool flip = true;
+};
+
+static void printUsage() {
+    std::cout << "usage: VirtualTextureBake [-t tile size] [-b border] [--repeat n] [--linear] [--no-flip] -o out.vtex image" << std::endl;
+}
+
+static bool parseOptions(int argc, char **argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if ((arg == "-t" || arg == "--tile") && i + 1 < argc) {
+            options.bake.tileSize = std::stoi(argv[++i]);
+        } else if ((arg == "-b" || arg == "--border") && i + 1 < argc) {
+            options.bake.border = std::stoi(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            options.bake.repeat = std::stoi(argv[++i]);
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--linear") {
+            options.bake.colorSpace = MipColorSpace::Linear;
+        } else if (arg == "--no-flip") {
+            options.flip = false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cout << "ERROR::VIRTUAL_TEXTURE_BAKE:: unknown option " << arg << std::endl;
+            return false;
+        } else if (options.input.empty()) {
+            options.input = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.input.empty() && isVirtualTexturePath(options.output);
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    Image source;
+    if (!loadImage(options.input, source, options.flip)) {
+        return 1;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    if (!bakeVirtualTexture(source, options.output, options.bake)) {
+        return 1;
+    }
+    const double bakeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::ifstream file(options.output, std::ios::binary | std::ios::ate);
+    const double fileMegabytes = file ? static_cast<double>(file.tellg()) / (1024.0 * 1024.0) : 0.0;
+    const double megapixels = static_cast<double>(source.width) * options.bake.repeat * source.height * options.bake.repeat / 1e6;
+    std::cout << options.input << " x" << options.bake.repeat * options.bake.repeat << " -> " << options.output << " ["
+              << source.width * options.bake.repeat << "x" << source.height * options.bake.repeat << ", " << megapixels
+              << " MPixels, " << options.bake.tileSize << " texel tiles + " << options.bake.border << " border]" << std::endl;
+    std::cout << "  " << fileMegabytes << " MB written in " << bakeMs << " ms on " << ThreadPool::getInstance().getThreadCount()
+              << " worker threads" << std::endl;
+    return 0;
+}
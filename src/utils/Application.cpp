@@ -1,5 +1,10 @@
 #include "Application.h"
+#include "FrameUniforms.h"
 #include "Input.h"
+#include "ShaderLibrary.h"
+#include "ShaderReload.h"
+#include "TextureResidency.h"
+#include "TextureUploadQueue.h"
 #include "GLFW/glfw3.h"
 #include <assert.h>
 #include <stdexcept>
@@ -49,6 +54,8 @@ void Application::init(unsigned int glVersionMajor, unsigned int glVersionMinor)
         cleanup();
         throw std::runtime_error("Failed to initialize GLAD");
     }
+    // every demo edits its shaders live, no-op when there is no shaders directory
+    ShaderReload::getInstance().start("shaders");
 }
 
 void Application::run() {
@@ -71,6 +78,12 @@ void Application::render() {}
 
 void Application::update() {
     assert(mWindow != nullptr && "Window is not initialized");
+    // textures loaded with the async paths arrive a slice per frame
+    TextureUploadQueue::getInstance().update();
+    // reloads what was drawn degraded, trims / evicts the rest when over the VRAM budget
+    TextureResidency::getInstance().update();
+    // swaps in shaders that finished recompiling since the last frame
+    ShaderReload::getInstance().update();
     glfwSwapBuffers(mWindow);
     glfwPollEvents();
     
@@ -80,6 +93,12 @@ void Application::update() {
 
 void Application::cleanup() {
     if (mWindow) {
+        // the staging ring, the uniform block ring and its fences belong to this context
+        TextureUploadQueue::getInstance().shutdown();
+        FrameUniforms::getInstance().shutdown();
+        // joins the compile worker and destroys its hidden window
+        ShaderReload::getInstance().stop();
+        ShaderLibrary::getInstance().clear();
         glfwDestroyWindow(mWindow);
         mWindow = nullptr;
     }
@@ -0,0 +1,90 @@
+#include "DirectStateAccess.h"
+#include "utils/Utils.h"
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+namespace gl {
+
+namespace {
+
+DsaFunctions functions;
+bool loaded = false;
+bool available = false;
+bool enabled = true;
+BindStats bindStats;
+
+template<typename Proc>
+bool load(Proc& proc, const char* name) {
+    proc = reinterpret_cast<Proc>(glfwGetProcAddress(name));
+    return proc != nullptr;
+}
+
+void loadFunctions() {
+    loaded = true;
+    if (!hasVersion(4, 5) && !hasExtension("GL_ARB_direct_state_access")) {
+        return;
+    }
+    bool ok = load(functions.createTextures, "glCreateTextures");
+    ok = load(functions.textureParameteri, "glTextureParameteri") && ok;
+    ok = load(functions.textureParameterf, "glTextureParameterf") && ok;
+    ok = load(functions.createBuffers, "glCreateBuffers") && ok;
+    ok = load(functions.namedBufferData, "glNamedBufferData") && ok;
+    ok = load(functions.createVertexArrays, "glCreateVertexArrays") && ok;
+    ok = load(functions.enableVertexArrayAttrib, "glEnableVertexArrayAttrib") && ok;
+    ok = load(functions.vertexArrayVertexBuffer, "glVertexArrayVertexBuffer") && ok;
+    ok = load(functions.vertexArrayAttribFormat, "glVertexArrayAttribFormat") && ok;
+    ok = load(functions.vertexArrayAttribIFormat, "glVertexArrayAttribIFormat") && ok;
+    ok = load(functions.vertexArrayAttribBinding, "glVertexArrayAttribBinding") && ok;
+    ok = load(functions.vertexArrayElementBuffer, "glVertexArrayElementBuffer") && ok;
+    if (!ok) {
+        std::cout << "WARNING::DSA:: the context reports direct state access but entry points are missing, using bind-to-edit" << std::endl;
+        functions = DsaFunctions();
+    }
+    available = ok;
+}
+
+}
+
+bool hasDsa() {
+    if (!loaded) {
+        loadFunctions();
+    }
+    return available;
+}
+
+bool useDsa() {
+    return enabled && hasDsa();
+}
+
+void setDsaEnabled(bool value) {
+    enabled = value;
+}
+
+const DsaFunctions& dsa() {
+    return functions;
+}
+
+void bindTexture(GLenum target, GLuint id) {
+    bindStats.textureBinds++;
+    glBindTexture(target, id);
+}
+
+void bindBuffer(GLenum target, GLuint id) {
+    bindStats.bufferBinds++;
+    glBindBuffer(target, id);
+}
+
+void bindVertexArray(GLuint id) {
+    bindStats.vertexArrayBinds++;
+    glBindVertexArray(id);
+}
+
+BindStats getBindStats() {
+    return bindStats;
+}
+
+void resetBindStats() {
+    bindStats = BindStats();
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef OPENGL_UTILS_DIRECT_STATE_ACCESS_H
+#define OPENGL_UTILS_DIRECT_STATE_ACCESS_H
+
+#include <glad/glad.h>
+#include <cstddef>
+
+/*
+ * GL 4.5 / GL_ARB_direct_state_access: objects are edited by name instead of bind-to-edit.
+ * glad is generated for 3.3, so the entry points are loaded here on first use (a context must be
+ * current). Texture, VertexBuffer and VertexArray take the DSA path when it is available and
+ * keep the 3.3 bind-to-edit code as fallback.
+ *
+ * The bind counters count the glBind* calls those classes issue, to compare both paths.
+ * GL thread only.
+ */
+namespace gl {
+
+typedef void (APIENTRYP CreateTexturesProc)(GLenum target, GLsizei n, GLuint* textures);
+typedef void (APIENTRYP TextureParameteriProc)(GLuint texture, GLenum pname, GLint param);
+typedef void (APIENTRYP TextureParameterfProc)(GLuint texture, GLenum pname, GLfloat param);
+typedef void (APIENTRYP CreateBuffersProc)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRYP NamedBufferDataProc)(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+typedef void (APIENTRYP CreateVertexArraysProc)(GLsizei n, GLuint* arrays);
+typedef void (APIENTRYP EnableVertexArrayAttribProc)(GLuint vaobj, GLuint index);
+typedef void (APIENTRYP VertexArrayVertexBufferProc)(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+typedef void (APIENTRYP VertexArrayAttribFormatProc)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized,
+                                                     GLuint relativeoffset);
+typedef void (APIENTRYP VertexArrayAttribIFormatProc)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+typedef void (APIENTRYP VertexArrayAttribBindingProc)(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+typedef void (APIENTRYP VertexArrayElementBufferProc)(GLuint vaobj, GLuint buffer);
+
+struct DsaFunctions {
+    CreateTexturesProc createTextures = nullptr;
+    TextureParameteriProc textureParameteri = nullptr;
+    TextureParameterfProc textureParameterf = nullptr;
+    CreateBuffersProc createBuffers = nullptr;
+    NamedBufferDataProc namedBufferData = nullptr;
+    CreateVertexArraysProc createVertexArrays = nullptr;
+    EnableVertexArrayAttribProc enableVertexArrayAttrib = nullptr;
+    VertexArrayVertexBufferProc vertexArrayVertexBuffer = nullptr;
+    VertexArrayAttribFormatProc vertexArrayAttribFormat = nullptr;
+    VertexArrayAttribIFormatProc vertexArrayAttribIFormat = nullptr;
+    VertexArrayAttribBindingProc vertexArrayAttribBinding = nullptr;
+    VertexArrayElementBufferProc vertexArrayElementBuffer = nullptr;
+};
+
+// the context has DSA and every entry point loaded (checked once)
+bool hasDsa();
+
+// hasDsa and not switched off, decides the path of every call
+bool useDsa();
+
+/*
+ * false forces the 3.3 bind-to-edit path, for benchmarks and validation. Objects keep working
+ * across a switch, but switch before creating them: names from glGen* only become objects on
+ * their first bind.
+ */
+void setDsaEnabled(bool enabled);
+
+const DsaFunctions& dsa();
+
+struct BindStats {
+    size_t textureBinds = 0;
+    size_t bufferBinds = 0;
+    size_t vertexArrayBinds = 0;
+
+    size_t total() const { return textureBinds + bufferBinds + vertexArrayBinds; }
+};
+
+// counted glBindTexture / glBindBuffer / glBindVertexArray
+void bindTexture(GLenum target, GLuint id);
+
+void bindBuffer(GLenum target, GLuint id);
+
+void bindVertexArray(GLuint id);
+
+BindStats getBindStats();
+
+void resetBindStats();
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <iostream>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+std::string FileWatcher::normalizePath(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::weakly_canonical(path, error);
+    if (error) {
+        absolute = std::filesystem::absolute(path, error).lexically_normal();
+    }
+    return absolute.generic_string();
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher(): fd(-1) {}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::isWatching() const {
+    return fd >= 0 && !directories.empty();
+}
+
+void FileWatcher::addDirectory(const std::string& directory) {
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF;
+    const int wd = inotify_add_watch(fd, directory.c_str(), mask);
+    if (wd < 0) {
+        std::cout << "WARNING::FILE_WATCHER:: can not watch " << directory << std::endl;
+        return;
+    }
+    directories[wd] = directory;
+}
+
+bool FileWatcher::watch(const std::string& directory) {
+    if (!std::filesystem::is_directory(directory)) {
+        std::cout << "WARNING::FILE_WATCHER:: " << directory << " is not a directory" << std::endl;
+        return false;
+    }
+    if (fd < 0) {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            std::cout << "WARNING::FILE_WATCHER:: inotify is not available" << std::endl;
+            return false;
+        }
+    }
+    // inotify is not recursive, every directory gets its own watch
+    const size_t before = directories.size();
+    addDirectory(normalizePath(directory));
+    std::error_code error;
+    for (const auto& entry: std::filesystem::recursive_directory_iterator(directory, error)) {
+        if (entry.is_directory()) {
+            addDirectory(normalizePath(entry.path().string()));
+        }
+    }
+    return directories.size() > before;
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> changed;
+    if (fd < 0) {
+        return changed;
+    }
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    while (true) {
+        const ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            // EAGAIN: nothing left to read
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+            const auto directory = directories.find(event->wd);
+            if (directory == directories.end()) {
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                directories.erase(directory);
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+            const std::string path = directory->second + "/" + event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & IN_CREATE) {
+                    addDirectory(path);
+                }
+                continue;
+            }
+            // IN_CREATE alone is an empty file, its content arrives with IN_CLOSE_WRITE
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                changed.push_back(path);
+            }
+        }
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return changed;
+}
+
+void FileWatcher::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    directories.clear();
+}
+
+#else
+
+FileWatcher::FileWatcher() = default;
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::isWatching() const {
+    return !roots.empty();
+}
+
+bool FileWatcher::watch(const std::string& directory) {
+    if (!std::filesystem::is_directory(directory)) {
+        std::cout << "WARNING::FILE_WATCHER:: " << directory << " is not a directory" << std::endl;
+        return false;
+    }
+    roots.push_back(directory);
+    scan(nullptr);
+    lastScan = std::chrono::steady_clock::now();
+    return true;
+}
+
+void FileWatcher::scan(std::vector<std::string>* changed) {
+    for (const auto& root: roots) {
+        std::error_code error;
+        for (const auto& entry: std::filesystem::recursive_directory_iterator(root, error)) {
+            if (!entry.is_regular_file(error)) {
+                continue;
+            }
+            const std::filesystem::file_time_type time = entry.last_write_time(error);
+            if (error) {
+                continue;
+            }
+            const std::string path = normalizePath(entry.path().string());
+            const auto known = times.find(path);
+            if (known == times.end() || known->second != time) {
+                if (changed && known != times.end()) {
+                    changed->push_back(path);
+                }
+                times[path] = time;
+            }
+        }
+    }
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> changed;
+    const auto now = std::chrono::steady_clock::now();
+    if (roots.empty() || now - lastScan < POLL_INTERVAL) {
+        return changed;
+    }
+    lastScan = now;
+    scan(&changed);
+    return changed;
+}
+
+void FileWatcher::stop() {
+    roots.clear();
+    times.clear();
+}
+
+#endif
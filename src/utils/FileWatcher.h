@@ -0,0 +1,53 @@
+#ifndef OPENGL_UTILS_FILE_WATCHER_H
+#define OPENGL_UTILS_FILE_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Files changed under directory trees. inotify on Linux: the directories are watched, so editors
+ * that save by writing a temporary file and renaming it over the original are seen too. Other
+ * platforms compare modification times, at most every POLL_INTERVAL.
+ */
+class FileWatcher {
+public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{500};
+
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // the directory and everything below it, false if it can not be watched
+    bool watch(const std::string& directory);
+
+    // canonical paths (normalizePath) of the files changed since the last call, never blocks
+    std::vector<std::string> poll();
+
+    void stop();
+
+    bool isWatching() const;
+
+    // absolute, lexically normal, '/' separated: what poll returns for the same file
+    static std::string normalizePath(const std::string& path);
+
+private:
+#ifdef __linux__
+    int fd;
+    std::unordered_map<int, std::string> directories;
+
+    void addDirectory(const std::string& directory);
+#else
+    std::vector<std::string> roots;
+    std::unordered_map<std::string, std::filesystem::file_time_type> times;
+    std::chrono::steady_clock::time_point lastScan;
+
+    void scan(std::vector<std::string>* changed);
+#endif
+};
+
+#endif
@@ -0,0 +1,204 @@
+#include "FrameUniforms.h"
+#include "utils/Utils.h"
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <iostream>
+
+// GL 4.4 / GL_ARB_buffer_storage, a 3.3 core glad does not define them
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace {
+
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+constexpr GLuint64 FENCE_TIMEOUT_NS = 1000000000ull;
+
+struct BlockBinding {
+    const char* name;
+    GLuint binding;
+    size_t size;
+};
+
+const BlockBinding BLOCKS[] = {
+    {"Camera", UNIFORM_BINDING_CAMERA, sizeof(CameraUniforms)},
+    {"Lights", UNIFORM_BINDING_LIGHTS, sizeof(LightUniforms)},
+    {"Object", UNIFORM_BINDING_OBJECT, sizeof(ObjectUniforms)},
+};
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+FrameUniforms& FrameUniforms::getInstance() {
+    static FrameUniforms instance;
+    return instance;
+}
+
+bool FrameUniforms::init(size_t bytes) {
+    if (buffer != 0) {
+        shutdown();
+    }
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    offsetAlignment = offsetAlignment > 0 ? offsetAlignment : 256;
+    frameBytes = alignUp(bytes, static_cast<size_t>(offsetAlignment));
+    const size_t ringSize = frameBytes * FRAMES;
+
+    BufferStorageProc bufferStorage = nullptr;
+    if (gl::hasVersion(4, 4) || gl::hasExtension("GL_ARB_buffer_storage")) {
+        bufferStorage = reinterpret_cast<BufferStorageProc>(glfwGetProcAddress("glBufferStorage"));
+    }
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (bufferStorage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(ringSize), nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(ringSize), flags));
+        if (!mapped) {
+            // immutable storage can not be respecified, start over with a plain buffer
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        }
+    }
+    if (!mapped) {
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(ringSize), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    frame = 0;
+    offset = 0;
+    inFrame = false;
+    stats.persistent = mapped != nullptr;
+    return buffer != 0;
+}
+
+void FrameUniforms::shutdown() {
+    if (buffer == 0) {
+        return;
+    }
+    for (GLsync& fence: fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (mapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        mapped = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    inFrame = false;
+}
+
+void FrameUniforms::beginFrame() {
+    if (buffer == 0 && !init()) {
+        return;
+    }
+    if (inFrame) {
+        endFrame();
+    }
+    frame = (frame + 1) % FRAMES;
+    offset = 0;
+    inFrame = true;
+
+    GLsync& fence = fences[frame];
+    if (!fence) {
+        return;
+    }
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        stats.stalls++;
+        // GL_WAIT_FAILED means a lost context, nothing reads the ring any more either
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS) == GL_TIMEOUT_EXPIRED) {
+        }
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void FrameUniforms::endFrame() {
+    if (!inFrame) {
+        return;
+    }
+    inFrame = false;
+    if (offset > 0) {
+        fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void FrameUniforms::setCamera(const CameraUniforms& camera) {
+    write(UNIFORM_BINDING_CAMERA, &camera, sizeof(camera));
+}
+
+void FrameUniforms::setLights(const LightUniforms& lights) {
+    write(UNIFORM_BINDING_LIGHTS, &lights, sizeof(lights));
+}
+
+void FrameUniforms::setObject(const ObjectUniforms& object) {
+    write(UNIFORM_BINDING_OBJECT, &object, sizeof(object));
+}
+
+bool FrameUniforms::write(GLuint binding, const void* data, size_t size) {
+    if (!inFrame) {
+        beginFrame();
+    }
+    if (buffer == 0) {
+        return false;
+    }
+    if (offset + size > frameBytes) {
+        if (stats.overflows++ == 0) {
+            std::cout << "WARNING::FRAME_UNIFORMS:: " << frameBytes << " bytes per frame are not enough, uniform blocks are dropped" << std::endl;
+        }
+        return false;
+    }
+    const size_t ringOffset = static_cast<size_t>(frame) * frameBytes + offset;
+    if (mapped) {
+        std::memcpy(mapped + ringOffset, data, size);
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, static_cast<GLintptr>(ringOffset), static_cast<GLsizeiptr>(size));
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        // the fences guarantee the gpu is done with this range, no need to let the driver sync
+        void* target = glMapBufferRange(GL_UNIFORM_BUFFER, static_cast<GLintptr>(ringOffset), static_cast<GLsizeiptr>(size),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (target) {
+            std::memcpy(target, data, size);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+        }
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, static_cast<GLintptr>(ringOffset), static_cast<GLsizeiptr>(size));
+    }
+    offset = alignUp(offset + size, static_cast<size_t>(offsetAlignment));
+    stats.writes++;
+    stats.bytes += size;
+    return true;
+}
+
+void FrameUniforms::bindBlocks(GLuint program) {
+    for (const BlockBinding& block: BLOCKS) {
+        const GLuint index = glGetUniformBlockIndex(program, block.name);
+        if (index == GL_INVALID_INDEX) {
+            continue;
+        }
+        GLint size = 0;
+        glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+        // smaller is fine (the tail of a block may be rounded differently), larger reads past the range
+        if (static_cast<size_t>(size) > block.size) {
+            std::cout << "WARNING::FRAME_UNIFORMS:: block " << block.name << " is " << size << " bytes in the shader but " << block.size
+                      << " in FrameUniforms, declare it layout(std140) as in FrameUniforms.h" << std::endl;
+        }
+        glUniformBlockBinding(program, index, block.binding);
+    }
+}
+
+void FrameUniforms::resetStats() {
+    const bool persistent = stats.persistent;
+    stats = FrameUniformStats();
+    stats.persistent = persistent;
+}
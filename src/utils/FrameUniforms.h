@@ -0,0 +1,126 @@
+#ifndef OPENGL_UTILS_FRAME_UNIFORMS_H
+#define OPENGL_UTILS_FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * std140 uniform blocks shared by every program. Shader binds the blocks it declares to these
+ * binding points after link, so one write per frame reaches all programs:
+ *
+ *   layout(std140) uniform Camera { mat4 view; mat4 projection; vec4 viewPos; };
+ *   layout(std140) uniform Lights { PointLight pointLights[8]; int pointLightCount; };
+ *   layout(std140) uniform Object { mat4 model; mat4 normalMatrix; };
+ *
+ * The C++ structs below mirror those blocks byte for byte (vec3 padded to vec4, mat3 as mat4).
+ */
+enum UniformBinding : GLuint {
+    UNIFORM_BINDING_CAMERA = 0,
+    UNIFORM_BINDING_LIGHTS = 1,
+    UNIFORM_BINDING_OBJECT = 2,
+};
+
+struct CameraUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 viewPos;          // w unused
+};
+
+struct PointLightUniforms {
+    glm::vec4 position;         // w unused
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 attenuation;      // constant, linear, quadratic, unused
+};
+
+const int MAX_POINT_LIGHTS = 8;
+
+struct LightUniforms {
+    PointLightUniforms pointLights[MAX_POINT_LIGHTS];
+    int pointLightCount = 0;
+    int padding[3] = {};
+};
+
+struct ObjectUniforms {
+    glm::mat4 model;
+    glm::mat4 normalMatrix;     // mat3(transpose(inverse(model))) in the upper left
+};
+
+static_assert(sizeof(CameraUniforms) == 144, "Camera block must match std140");
+static_assert(sizeof(PointLightUniforms) == 80, "PointLight must match std140");
+static_assert(sizeof(LightUniforms) == 80 * MAX_POINT_LIGHTS + 16, "Lights block must match std140");
+static_assert(sizeof(ObjectUniforms) == 128, "Object block must match std140");
+
+struct FrameUniformStats {
+    size_t writes = 0;          // blocks written since the last reset
+    size_t bytes = 0;
+    size_t overflows = 0;       // writes dropped because the frame's part of the ring was full
+    size_t stalls = 0;          // beginFrame waited for the gpu to finish with a ring part
+    bool persistent = false;    // GL_ARB_buffer_storage mapping, otherwise mapped per write
+};
+
+/*
+ * Per-frame ring of uniform block data in one uniform buffer, split in FRAMES parts.
+ *   - beginFrame moves to the next part, waiting on its fence from FRAMES frames ago
+ *   - every set* call appends the block to that part and binds the range to its binding point;
+ *     camera and lights once per frame, Object once per draw
+ *   - endFrame fences the part
+ * Written data is never overwritten while a draw may still read it, so no write has to sync.
+ * GL thread only.
+ */
+class FrameUniforms {
+public:
+    static constexpr int FRAMES = 3;
+    static constexpr size_t DEFAULT_FRAME_BYTES = 256 * 1024;
+
+    static FrameUniforms& getInstance();
+
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // bytes per frame, enough for the camera, the lights and every Object block of a frame
+    bool init(size_t frameBytes = DEFAULT_FRAME_BYTES);
+
+    void beginFrame();
+
+    void endFrame();
+
+    void setCamera(const CameraUniforms& camera);
+
+    void setLights(const LightUniforms& lights);
+
+    void setObject(const ObjectUniforms& object);
+
+    // appends size bytes and binds them to binding, false when this frame's part is full
+    bool write(GLuint binding, const void* data, size_t size);
+
+    /*
+     * Points the Camera / Lights / Object blocks a program declares at their binding points and
+     * warns when a block is bigger than the struct. Called by Shader after link.
+     */
+    static void bindBlocks(GLuint program);
+
+    FrameUniformStats getStats() const { return stats; }
+
+    void resetStats();
+
+    void shutdown();
+
+private:
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr;
+    size_t frameBytes = 0;
+    GLint offsetAlignment = 256;
+    int frame = 0;
+    size_t offset = 0;          // next free byte in the current part
+    bool inFrame = false;
+    GLsync fences[FRAMES] = {};
+    FrameUniformStats stats;
+
+    FrameUniforms() = default;
+};
+
+#endif
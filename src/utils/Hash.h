@@ -0,0 +1,52 @@
+#ifndef OPENGL_UTILS_HASH_H
+#define OPENGL_UTILS_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// FNV-1a 64 bit, used for cache keys
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = FNV_OFFSET_BASIS) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+inline uint64_t hashString(const std::string& str, uint64_t seed = FNV_OFFSET_BASIS) {
+    return hashBytes(str.data(), str.size(), seed);
+}
+
+// same hash at compile time, for keys of string literals
+constexpr uint64_t hashLiteral(const char* str, size_t size, uint64_t seed = FNV_OFFSET_BASIS) {
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// hash of the whole file content, false if the file can not be read
+inline bool hashFile(const std::string& path, uint64_t& hash, uint64_t seed = FNV_OFFSET_BASIS) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    char buffer[64 * 1024];
+    hash = seed;
+    while (file) {
+        file.read(buffer, sizeof(buffer));
+        hash = hashBytes(buffer, static_cast<size_t>(file.gcount()), hash);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include "Image.h"
+#include <cstring>
+#include <iostream>
+#include "stb_define.h"
+
+bool loadImage(const std::string& filepath, Image& image, bool flipVertically) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
+    if (!data) {
+        std::cerr << "Failed to load image: " << filepath << std::endl;
+        std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    const size_t rowSize = static_cast<size_t>(width) * channels;
+    image.pixels.resize(rowSize * height);
+    if (flipVertically) {
+        for (int y = 0; y < height; y++) {
+            std::memcpy(&image.pixels[rowSize * (height - 1 - y)], data + rowSize * y, rowSize);
+        }
+    } else {
+        std::memcpy(image.pixels.data(), data, image.pixels.size());
+    }
+
+    stbi_image_free(data);
+    return true;
+}
+
+GLenum formatForChannels(int channels) {
+    switch (channels) {
+        case 1:
+            return GL_RED;
+        case 2:
+            return GL_RG;
+        case 3:
+            return GL_RGB;
+        case 4:
+            return GL_RGBA;
+        default:
+            return 0;
+    }
+}
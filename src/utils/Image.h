@@ -0,0 +1,29 @@
+#ifndef OPENGL_UTILS_IMAGE_H
+#define OPENGL_UTILS_IMAGE_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+// decoded 8 bit pixels, rows bottom-up when loaded with flipVertically
+struct Image {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;
+
+    size_t byteSize() const { return pixels.size(); }
+    bool isValid() const { return !pixels.empty(); }
+};
+
+/*
+ * Decodes an image file with stb_image.
+ * Safe to call from worker threads: the vertical flip is done here while copying
+ * instead of through the global stbi_set_flip_vertically_on_load flag.
+ */
+bool loadImage(const std::string& filepath, Image& image, bool flipVertically = true);
+
+// GL_RED / GL_RG / GL_RGB / GL_RGBA, 0 if unsupported
+GLenum formatForChannels(int channels);
+
+#endif
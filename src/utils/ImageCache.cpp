@@ -0,0 +1,266 @@
+#include "ImageCache.h"
+#include "utils/Hash.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+static const char IMAGE_CACHE_MAGIC[8] = {'T', 'E', 'X', 'B', 'I', 'N', '\0', '\0'};
+
+static std::atomic<bool> cacheEnabled{true};
+static std::mutex statsMutex;
+static ImageCacheStats cacheStats;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// size and modification time of the source, the cheap part of the staleness check
+static bool sourceStamp(const std::string& path, uint64_t& size, int64_t& time) {
+    std::error_code error;
+    size = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+    if (error) {
+        return false;
+    }
+    time = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    return !error;
+}
+
+ImageCache::ImageCache(): header(nullptr), levels(nullptr) {}
+
+uint32_t ImageCache::flagsFor(bool flipVertically, bool mips, MipColorSpace colorSpace) {
+    uint32_t flags = IMAGE_CACHE_NONE;
+    if (flipVertically) {
+        flags |= IMAGE_CACHE_FLIPPED;
+    }
+    if (mips) {
+        flags |= IMAGE_CACHE_MIPS;
+        // the color space only changes the filtered levels
+        if (colorSpace == MipColorSpace::Linear) {
+            flags |= IMAGE_CACHE_LINEAR;
+        }
+    }
+    return flags;
+}
+
+bool ImageCache::open(const std::string& sourcePath, uint32_t flags) {
+    close();
+    if (!isEnabled()) {
+        return false;
+    }
+    const std::string cachePath = cachePathFor(sourcePath, flags);
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!sourceStamp(sourcePath, sourceSize, sourceTime) || !file.open(cachePath)) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        cacheStats.misses++;
+        return false;
+    }
+
+    header = file.size() >= sizeof(ImageCacheHeader) ? reinterpret_cast<const ImageCacheHeader*>(file.data()) : nullptr;
+    if (!header
+        || std::memcmp(header->magic, IMAGE_CACHE_MAGIC, sizeof(IMAGE_CACHE_MAGIC)) != 0
+        || header->version != VERSION
+        || header->flags != flags
+        || header->fileSize != file.size()) {
+        close();
+        std::lock_guard<std::mutex> lock(statsMutex);
+        cacheStats.misses++;
+        return false;
+    }
+    levels = reinterpret_cast<const ImageCacheLevel*>(file.data() + sizeof(ImageCacheHeader));
+    if (!validate(flags)) {
+        std::cout << "WARNING::IMAGE_CACHE:: corrupted cache file " << cachePath << std::endl;
+        close();
+        std::lock_guard<std::mutex> lock(statsMutex);
+        cacheStats.misses++;
+        return false;
+    }
+
+    if (header->sourceSize != sourceSize || header->sourceTime != sourceTime) {
+        // touched but maybe not changed: the content decides
+        uint64_t sourceHash = 0;
+        if (header->sourceSize != sourceSize || !hashFile(sourcePath, sourceHash) || sourceHash != header->sourceHash) {
+            close();
+            std::lock_guard<std::mutex> lock(statsMutex);
+            cacheStats.stale++;
+            return false;
+        }
+        // same content, store the new time so the next open skips the hash (best effort, the mapping is private)
+        std::fstream out(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+        if (out) {
+            out.seekp(static_cast<std::streamoff>(offsetof(ImageCacheHeader, sourceTime)));
+            out.write(reinterpret_cast<const char*>(&sourceTime), sizeof(sourceTime));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    cacheStats.hits++;
+    cacheStats.mappedBytes += byteSize();
+    return true;
+}
+
+void ImageCache::close() {
+    file.close();
+    header = nullptr;
+    levels = nullptr;
+}
+
+bool ImageCache::validate(uint32_t flags) const {
+    const uint64_t size = file.size();
+    if (header->width == 0 || header->height == 0 || formatForChannels(static_cast<int>(header->channels)) == 0) {
+        return false;
+    }
+    const uint32_t expectedLevels = (flags & IMAGE_CACHE_MIPS)
+        ? static_cast<uint32_t>(mipLevelCount(static_cast<int>(header->width), static_cast<int>(header->height))) : 1;
+    if (header->levelCount != expectedLevels
+        || sizeof(ImageCacheHeader) + uint64_t(header->levelCount) * sizeof(ImageCacheLevel) > size) {
+        return false;
+    }
+    uint32_t width = header->width;
+    uint32_t height = header->height;
+    for (uint32_t i = 0; i < header->levelCount; i++) {
+        const ImageCacheLevel& level = levels[i];
+        if (level.width != width || level.height != height
+            || level.size != uint64_t(width) * height * header->channels
+            || level.offset + level.size > size) {
+            return false;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return true;
+}
+
+size_t ImageCache::byteSize() const {
+    size_t bytes = 0;
+    for (int i = 0; i < getLevelCount(); i++) {
+        bytes += static_cast<size_t>(levels[i].size);
+    }
+    return bytes;
+}
+
+const unsigned char* ImageCache::getLevel(int level, int& width, int& height) const {
+    width = static_cast<int>(levels[level].width);
+    height = static_cast<int>(levels[level].height);
+    return file.data() + levels[level].offset;
+}
+
+void ImageCache::upload(GLenum target, int firstLevel) const {
+    const GLenum format = formatForChannels(getChannels());
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = firstLevel; i < getLevelCount(); i++) {
+        int width, height;
+        const unsigned char* pixels = getLevel(i, width, height);
+        glTexImage2D(target, i - firstLevel, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
+
+void ImageCache::copyTo(Image& image, std::vector<Image>& mips) const {
+    mips.assign(getLevelCount() > 1 ? getLevelCount() - 1 : 0, Image());
+    for (int i = 0; i < getLevelCount(); i++) {
+        Image& level = i == 0 ? image : mips[i - 1];
+        const unsigned char* pixels = getLevel(i, level.width, level.height);
+        level.channels = getChannels();
+        level.pixels.assign(pixels, pixels + levels[i].size);
+    }
+}
+
+std::string ImageCache::cachePathFor(const std::string& sourcePath, uint32_t flags) {
+    std::string path = sourcePath;
+    if (flags & IMAGE_CACHE_FLIPPED) {
+        path += ".flip";
+    }
+    if (flags & IMAGE_CACHE_MIPS) {
+        path += (flags & IMAGE_CACHE_LINEAR) ? ".mips-linear" : ".mips";
+    }
+    return path + ".texbin";
+}
+
+bool ImageCache::write(const std::string& sourcePath, uint32_t flags, const Image& image, const std::vector<Image>& mips) {
+    if (!isEnabled() || !image.isValid()) {
+        return false;
+    }
+    ImageCacheHeader header {};
+    std::memcpy(header.magic, IMAGE_CACHE_MAGIC, sizeof(IMAGE_CACHE_MAGIC));
+    header.version = VERSION;
+    header.flags = flags;
+    header.width = static_cast<uint32_t>(image.width);
+    header.height = static_cast<uint32_t>(image.height);
+    header.channels = static_cast<uint32_t>(image.channels);
+    header.levelCount = static_cast<uint32_t>((flags & IMAGE_CACHE_MIPS) ? mips.size() + 1 : 1);
+    if (!sourceStamp(sourcePath, header.sourceSize, header.sourceTime) || !hashFile(sourcePath, header.sourceHash)) {
+        return false;
+    }
+
+    std::vector<ImageCacheLevel> entries(header.levelCount);
+    uint64_t offset = alignUp(sizeof(ImageCacheHeader) + entries.size() * sizeof(ImageCacheLevel), 16);
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Image& level = i == 0 ? image : mips[i - 1];
+        entries[i].offset = offset;
+        entries[i].size = level.byteSize();
+        entries[i].width = static_cast<uint32_t>(level.width);
+        entries[i].height = static_cast<uint32_t>(level.height);
+        offset = alignUp(offset + level.byteSize(), 16);
+    }
+    header.fileSize = offset;
+
+    // write to a temporary file first so a crash (or a second writer) never leaves a half written cache behind
+    const std::string cachePath = cachePathFor(sourcePath, flags);
+    const std::string tmpPath = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cout << "WARNING::IMAGE_CACHE:: can not write " << tmpPath << std::endl;
+            return false;
+        }
+        const char padding[16] = {};
+        auto pad = [&out, &padding]() {
+            const uint64_t pos = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(alignUp(pos, 16) - pos));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ImageCacheLevel));
+        pad();
+        for (size_t i = 0; i < entries.size(); i++) {
+            const Image& level = i == 0 ? image : mips[i - 1];
+            out.write(reinterpret_cast<const char*>(level.pixels.data()), static_cast<std::streamsize>(level.byteSize()));
+            pad();
+        }
+        if (!out) {
+            std::cout << "WARNING::IMAGE_CACHE:: failed writing " << tmpPath << std::endl;
+            return false;
+        }
+    }
+
+    std::remove(cachePath.c_str());
+    if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    cacheStats.writes++;
+    return true;
+}
+
+void ImageCache::setEnabled(bool enabled) {
+    cacheEnabled = enabled;
+}
+
+bool ImageCache::isEnabled() {
+    return cacheEnabled;
+}
+
+ImageCacheStats ImageCache::getStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return cacheStats;
+}
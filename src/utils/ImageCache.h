@@ -0,0 +1,123 @@
+#ifndef OPENGL_UTILS_IMAGE_CACHE_H
+#define OPENGL_UTILS_IMAGE_CACHE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "utils/Image.h"
+#include "utils/MappedFile.h"
+#include "utils/MipChain.h"
+
+/*
+ * .texbin file layout (all offsets are absolute, little endian):
+ *
+ *   ImageCacheHeader
+ *   ImageCacheLevel   [levelCount]   base level first
+ *   pixel data        (16 byte aligned per level, tightly packed 8 bit rows)
+ *
+ * Decoded pixels of one source image in the layout glTexImage2D takes, so a warm load is an
+ * mmap plus the upload instead of a JPEG / PNG decode and a CPU mip chain.
+ * Sits next to the source (container2.png -> container2.png.flip.mips.texbin). The source size
+ * and modification time are the fast check; when they differ the source is hashed and the cache
+ * still counts when the content is the same (e.g. after a fresh checkout).
+ */
+
+// how the cached pixels were produced from the source, part of the file name and checked on open
+enum ImageCacheFlags : uint32_t {
+    IMAGE_CACHE_NONE = 0,
+    IMAGE_CACHE_FLIPPED = 1 << 0,     // rows bottom-up
+    IMAGE_CACHE_MIPS = 1 << 1,        // full chain down to 1x1 after the base level
+    IMAGE_CACHE_LINEAR = 1 << 2,      // chain filtered with MipColorSpace::Linear instead of SRGB
+};
+
+struct ImageCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t sourceHash;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t levelCount;
+    uint64_t fileSize;
+};
+
+struct ImageCacheLevel {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct ImageCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;      // no cache file, or written for other flags / an older version
+    size_t stale = 0;       // the source changed since the cache was written
+    size_t writes = 0;
+    size_t mappedBytes = 0; // pixel bytes served from hits
+};
+
+class ImageCache {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    ImageCache();
+
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    static uint32_t flagsFor(bool flipVertically, bool mips, MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    // maps the cache of sourcePath for these flags, false on a miss or a stale / corrupted file
+    bool open(const std::string& sourcePath, uint32_t flags);
+
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+
+    int getWidth() const { return header ? static_cast<int>(header->width) : 0; }
+    int getHeight() const { return header ? static_cast<int>(header->height) : 0; }
+    int getChannels() const { return header ? static_cast<int>(header->channels) : 0; }
+    int getLevelCount() const { return header ? static_cast<int>(header->levelCount) : 0; }
+
+    // pixel bytes of every level
+    size_t byteSize() const;
+
+    // level pixels, valid while the cache is open
+    const unsigned char* getLevel(int level, int& width, int& height) const;
+
+    /*
+     * glTexImage2D of every level from firstLevel on straight from the mapping into the texture
+     * bound to target (GL_TEXTURE_2D or a cube face), firstLevel becoming level 0, unpack alignment 1.
+     * Sampler state and the level range are left to the caller.
+     */
+    void upload(GLenum target, int firstLevel = 0) const;
+
+    // copies the levels out, for consumers that need owned pixels (TextureUploadQueue)
+    void copyTo(Image& image, std::vector<Image>& mips) const;
+
+    // image is level 0, mips the levels below it (empty without IMAGE_CACHE_MIPS)
+    static bool write(const std::string& sourcePath, uint32_t flags, const Image& image, const std::vector<Image>& mips);
+
+    static std::string cachePathFor(const std::string& sourcePath, uint32_t flags);
+
+    // process wide switch, off makes open always miss and write a no-op (benchmarks, read-only installs)
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled();
+
+    static ImageCacheStats getStats();
+
+private:
+    MappedFile file;
+    const ImageCacheHeader* header;
+    const ImageCacheLevel* levels;
+
+    bool validate(uint32_t flags) const;
+};
+
+#endif
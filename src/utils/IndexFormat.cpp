@@ -0,0 +1,51 @@
+#include "IndexFormat.h"
+#include <cstdint>
+#include <cstring>
+
+IndexType chooseIndexType(unsigned int maxIndex, bool allowByte) {
+    if (allowByte && maxIndex <= 0xFFu) {
+        return IndexType::UInt8;
+    }
+    if (maxIndex <= 0xFFFFu) {
+        return IndexType::UInt16;
+    }
+    return IndexType::UInt32;
+}
+
+size_t indexTypeSize(IndexType type) {
+    switch (type) {
+        case IndexType::UInt8:  return sizeof(uint8_t);
+        case IndexType::UInt16: return sizeof(uint16_t);
+        default:                return sizeof(uint32_t);
+    }
+}
+
+GLenum indexTypeGL(IndexType type) {
+    switch (type) {
+        case IndexType::UInt8:  return GL_UNSIGNED_BYTE;
+        case IndexType::UInt16: return GL_UNSIGNED_SHORT;
+        default:                return GL_UNSIGNED_INT;
+    }
+}
+
+void packIndices(const unsigned int* indices, size_t count, IndexType type, void* out) {
+    switch (type) {
+        case IndexType::UInt8: {
+            uint8_t* dst = static_cast<uint8_t*>(out);
+            for (size_t i = 0; i < count; i++) {
+                dst[i] = static_cast<uint8_t>(indices[i]);
+            }
+            break;
+        }
+        case IndexType::UInt16: {
+            uint16_t* dst = static_cast<uint16_t*>(out);
+            for (size_t i = 0; i < count; i++) {
+                dst[i] = static_cast<uint16_t>(indices[i]);
+            }
+            break;
+        }
+        default:
+            std::memcpy(out, indices, count * sizeof(unsigned int));
+            break;
+    }
+}
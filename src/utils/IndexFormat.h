@@ -0,0 +1,32 @@
+#ifndef OPENGL_UTILS_INDEX_FORMAT_H
+#define OPENGL_UTILS_INDEX_FORMAT_H
+
+#include <glad/glad.h>
+#include <cstddef>
+
+/*
+ * Storage type of an index buffer. Meshes keep 32 bit indices on the cpu side (importer, .meshbin)
+ * and narrow them on upload to the smallest type that can address all their vertices.
+ * 8 bit indices are opt-in: several desktop drivers convert them to 16 bit behind the scenes,
+ * which costs more than the few bytes saved.
+ */
+enum class IndexType {
+    UInt8,
+    UInt16,
+    UInt32,
+};
+
+// largest vertex count a 16 bit index buffer can address
+const size_t INDEX_16_MAX_VERTICES = 65536;
+
+// smallest type able to hold maxIndex
+IndexType chooseIndexType(unsigned int maxIndex, bool allowByte = false);
+
+size_t indexTypeSize(IndexType type);
+
+GLenum indexTypeGL(IndexType type);
+
+// writes count indices of the given type to out, which must hold count * indexTypeSize(type) bytes
+void packIndices(const unsigned int* indices, size_t count, IndexType type, void* out);
+
+#endif
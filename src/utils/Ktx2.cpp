@@ -0,0 +1,278 @@
+#include "Ktx2.h"
+#include "utils/Image.h"
+#include "utils/MipChain.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const unsigned char KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+struct Ktx2Header {
+    unsigned char identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header layout");
+
+struct Ktx2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+struct Ktx2Sample {
+    uint32_t bitOffset;
+    uint32_t bitLength;
+    uint32_t channel;
+};
+
+// VkFormat, Khronos data format color model and the samples of the basic DFD block
+struct Ktx2FormatInfo {
+    CompressedFormat format;
+    uint32_t vkFormat;
+    uint32_t colorModel;
+    int sampleCount;
+    Ktx2Sample samples[2];
+};
+
+const Ktx2FormatInfo FORMAT_INFOS[] = {
+    {CompressedFormat::BC1, 131, 128, 1, {{0, 64, 0}}},                   // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    {CompressedFormat::BC3, 137, 130, 2, {{0, 64, 15}, {64, 64, 0}}},     // VK_FORMAT_BC3_UNORM_BLOCK, alpha then color
+    {CompressedFormat::BC5, 141, 132, 2, {{0, 64, 0}, {64, 64, 1}}},      // VK_FORMAT_BC5_UNORM_BLOCK, red then green
+    {CompressedFormat::BC7, 145, 134, 1, {{0, 128, 0}}},                  // VK_FORMAT_BC7_UNORM_BLOCK
+    {CompressedFormat::ETC2, 147, 161, 1, {{0, 64, 2}}},                  // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+};
+
+const Ktx2FormatInfo* findFormat(CompressedFormat format) {
+    for (const auto& info: FORMAT_INFOS) {
+        if (info.format == format) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+const Ktx2FormatInfo* findVkFormat(uint32_t vkFormat) {
+    for (const auto& info: FORMAT_INFOS) {
+        if (info.vkFormat == vkFormat) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+// data format descriptor: total size + one basic block (linear BT.709, 4x4 texel blocks)
+std::vector<uint32_t> buildDfd(const Ktx2FormatInfo& info) {
+    const uint32_t blockSize = 24 + 16 * info.sampleCount;
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);
+    dfd.push_back(0);                                   // vendor Khronos, descriptor type basic
+    dfd.push_back(2 | (blockSize << 16));               // version 2
+    dfd.push_back(info.colorModel | (1u << 8) | (1u << 16));   // primaries BT.709, transfer linear, flags 0
+    dfd.push_back(3 | (3u << 8));                       // texel block 4x4x1x1, stored minus one
+    dfd.push_back(static_cast<uint32_t>(compressedBlockBytes(info.format)));   // bytesPlane0
+    dfd.push_back(0);
+    for (int i = 0; i < info.sampleCount; i++) {
+        const Ktx2Sample& sample = info.samples[i];
+        dfd.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24));
+        dfd.push_back(0);                               // sample position
+        dfd.push_back(0);                               // lower
+        dfd.push_back(0xFFFFFFFFu);                     // upper
+    }
+    return dfd;
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+size_t Ktx2Texture::byteSize() const {
+    size_t bytes = 0;
+    for (const auto& level: levels) {
+        bytes += level.size();
+    }
+    return bytes;
+}
+
+void Ktx2Texture::dropLevels(int count) {
+    count = std::min(count, static_cast<int>(levels.size()) - 1);
+    if (count <= 0) {
+        return;
+    }
+    const int newWidth = levelWidth(count);
+    const int newHeight = levelHeight(count);
+    levels.erase(levels.begin(), levels.begin() + count);
+    width = newWidth;
+    height = newHeight;
+}
+
+bool isKtx2Path(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot + 1);
+    for (auto& c: extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == "ktx2";
+}
+
+bool writeKtx2(const std::string& path, const Ktx2Texture& texture) {
+    const Ktx2FormatInfo* info = findFormat(texture.format);
+    if (!info || texture.levels.empty() || (texture.faceCount != 1 && texture.faceCount != 6)) {
+        std::cout << "ERROR::KTX2:: nothing valid to write to " << path << std::endl;
+        return false;
+    }
+
+    const std::vector<uint32_t> dfd = buildDfd(*info);
+    const size_t levelCount = texture.levels.size();
+
+    Ktx2Header header = {};
+    std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat = info->vkFormat;
+    header.typeSize = 1;
+    header.pixelWidth = static_cast<uint32_t>(texture.width);
+    header.pixelHeight = static_cast<uint32_t>(texture.height);
+    header.faceCount = static_cast<uint32_t>(texture.faceCount);
+    header.levelCount = static_cast<uint32_t>(levelCount);
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + levelCount * sizeof(Ktx2LevelIndex));
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+    // mip data is stored smallest level first, each level aligned to the block size
+    const size_t alignment = compressedBlockBytes(texture.format);
+    std::vector<Ktx2LevelIndex> index(levelCount);
+    size_t offset = header.dfdByteOffset + header.dfdByteLength;
+    for (size_t level = levelCount; level-- > 0;) {
+        offset = alignUp(offset, alignment);
+        index[level].byteOffset = offset;
+        index[level].byteLength = texture.levels[level].size();
+        index[level].uncompressedByteLength = texture.levels[level].size();
+        offset += texture.levels[level].size();
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::KTX2:: can not write " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Ktx2LevelIndex));
+    file.write(reinterpret_cast<const char*>(dfd.data()), dfd.size() * sizeof(uint32_t));
+    size_t written = header.dfdByteOffset + header.dfdByteLength;
+    const char padding[16] = {};
+    for (size_t level = levelCount; level-- > 0;) {
+        file.write(padding, index[level].byteOffset - written);
+        file.write(reinterpret_cast<const char*>(texture.levels[level].data()), texture.levels[level].size());
+        written = index[level].byteOffset + index[level].byteLength;
+    }
+    return static_cast<bool>(file);
+}
+
+bool readKtx2(const std::string& path, Ktx2Texture& texture) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cout << "ERROR::KTX2:: can not open " << path << std::endl;
+        return false;
+    }
+    const size_t size = static_cast<size_t>(file.tellg());
+    std::vector<unsigned char> data(size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), size);
+    if (!file || size < sizeof(Ktx2Header)) {
+        std::cout << "ERROR::KTX2:: truncated file " << path << std::endl;
+        return false;
+    }
+
+    Ktx2Header header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    const Ktx2FormatInfo* info = findVkFormat(header.vkFormat);
+    if (std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        std::cout << "ERROR::KTX2:: not a KTX2 file " << path << std::endl;
+        return false;
+    }
+    if (!info || header.supercompressionScheme != 0 || header.pixelDepth > 1 || header.layerCount > 1
+        || (header.faceCount != 1 && header.faceCount != 6) || header.levelCount == 0 || header.pixelWidth == 0 || header.pixelHeight == 0) {
+        std::cout << "ERROR::KTX2:: unsupported layout or format " << header.vkFormat << " in " << path << std::endl;
+        return false;
+    }
+    // levelWidth shifts by the level, more levels than the full chain (or dimensions an int can not
+    // hold) would overflow it
+    if (header.pixelWidth > static_cast<uint32_t>(INT_MAX) || header.pixelHeight > static_cast<uint32_t>(INT_MAX)
+        || header.levelCount > static_cast<uint32_t>(mipLevelCount(static_cast<int>(header.pixelWidth), static_cast<int>(header.pixelHeight)))) {
+        std::cout << "ERROR::KTX2:: " << header.pixelWidth << "x" << header.pixelHeight << " with " << header.levelCount << " levels in " << path << std::endl;
+        return false;
+    }
+    if (sizeof(Ktx2Header) + static_cast<uint64_t>(header.levelCount) * sizeof(Ktx2LevelIndex) > size) {
+        std::cout << "ERROR::KTX2:: truncated level index in " << path << std::endl;
+        return false;
+    }
+
+    texture.format = info->format;
+    texture.width = static_cast<int>(header.pixelWidth);
+    texture.height = static_cast<int>(header.pixelHeight);
+    texture.faceCount = static_cast<int>(header.faceCount);
+    texture.levels.assign(header.levelCount, std::vector<unsigned char>());
+    for (uint32_t level = 0; level < header.levelCount; level++) {
+        Ktx2LevelIndex index;
+        std::memcpy(&index, data.data() + sizeof(Ktx2Header) + level * sizeof(Ktx2LevelIndex), sizeof(index));
+        const uint64_t expected = static_cast<uint64_t>(texture.faceCount)
+            * compressedImageBytes(texture.format, texture.levelWidth(static_cast<int>(level)), texture.levelHeight(static_cast<int>(level)));
+        if (index.byteLength != expected || index.byteLength > size || index.byteOffset > size - index.byteLength) {
+            std::cout << "ERROR::KTX2:: level " << level << " out of range in " << path << std::endl;
+            return false;
+        }
+        texture.levels[level].assign(data.begin() + index.byteOffset, data.begin() + index.byteOffset + index.byteLength);
+    }
+    return true;
+}
+
+GLenum uploadKtx2(const Ktx2Texture& texture, GLenum target) {
+    const bool supported = isCompressedFormatSupported(texture.format);
+    if (!supported) {
+        std::cout << "WARNING::KTX2:: " << compressedFormatName(texture.format) << " is not supported by the driver, decoding on the cpu" << std::endl;
+    }
+    const GLenum internalFormat = supported ? compressedGLFormat(texture.format) : GL_RGBA8;
+
+    for (size_t level = 0; level < texture.levels.size(); level++) {
+        const int width = texture.levelWidth(static_cast<int>(level));
+        const int height = texture.levelHeight(static_cast<int>(level));
+        const size_t faceBytes = texture.faceBytes(static_cast<int>(level));
+        for (int face = 0; face < texture.faceCount; face++) {
+            const GLenum faceTarget = target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target;
+            const unsigned char* data = texture.levels[level].data() + face * faceBytes;
+            if (supported) {
+                glCompressedTexImage2D(faceTarget, static_cast<GLint>(level), internalFormat, width, height, 0, static_cast<GLsizei>(faceBytes), data);
+            } else {
+                Image decoded;
+                decompressImage(data, width, height, texture.format, decoded);
+                glTexImage2D(faceTarget, static_cast<GLint>(level), GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, decoded.pixels.data());
+            }
+        }
+    }
+    // the chain may stop before 1x1, sampling past it would make the texture incomplete
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.levels.size()) - 1);
+    return internalFormat;
+}
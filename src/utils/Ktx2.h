@@ -0,0 +1,46 @@
+#ifndef OPENGL_UTILS_KTX2_H
+#define OPENGL_UTILS_KTX2_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "utils/TextureCompression.h"
+
+/*
+ * KTX2 container for the block compressed formats in TextureCompression.h.
+ * Only what TextureCompress writes is read back: no supercompression, no array layers,
+ * 2D textures or cube maps (faceCount 6) with a precomputed mip chain.
+ */
+struct Ktx2Texture {
+    CompressedFormat format = CompressedFormat::BC7;
+    int width = 0;
+    int height = 0;
+    int faceCount = 1;
+    // level 0 first, each level holds all faces back to back (+X -X +Y -Y +Z -Z)
+    std::vector<std::vector<unsigned char>> levels;
+
+    int levelWidth(int level) const { return width >> level > 0 ? width >> level : 1; }
+    int levelHeight(int level) const { return height >> level > 0 ? height >> level : 1; }
+    size_t faceBytes(int level) const { return levels[level].size() / faceCount; }
+    size_t byteSize() const;
+
+    // removes the count largest levels, level count becomes level 0
+    void dropLevels(int count);
+};
+
+bool isKtx2Path(const std::string& path);
+
+bool writeKtx2(const std::string& path, const Ktx2Texture& texture);
+
+bool readKtx2(const std::string& path, Ktx2Texture& texture);
+
+/*
+ * uploads all levels (and faces) into the texture bound to target (GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP)
+ * with glCompressedTexImage2D and limits GL_TEXTURE_MAX_LEVEL to the stored chain. When the driver
+ * lacks the format the levels are decoded on the cpu and uploaded as GL_RGBA8 instead.
+ * Returns the GL internal format that ended up on the gpu.
+ */
+GLenum uploadKtx2(const Ktx2Texture& texture, GLenum target);
+
+#endif
@@ -0,0 +1,132 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(): mData(nullptr), mSize(0), mFile(nullptr), mMapping(nullptr) {}
+#else
+MappedFile::MappedFile(): mData(nullptr), mSize(0), mFd(-1) {}
+#endif
+
+MappedFile::MappedFile(const std::string& path): MappedFile() {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept: MappedFile() {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(mData, other.mData);
+        std::swap(mSize, other.mSize);
+#ifdef _WIN32
+        std::swap(mFile, other.mFile);
+        std::swap(mMapping, other.mMapping);
+#else
+        std::swap(mFd, other.mFd);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    mFile = file;
+    mMapping = mapping;
+    mData = static_cast<const uint8_t*>(view);
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mData) {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping) {
+        CloseHandle(static_cast<HANDLE>(mMapping));
+    }
+    if (mFile) {
+        CloseHandle(static_cast<HANDLE>(mFile));
+    }
+    mData = nullptr;
+    mSize = 0;
+    mFile = nullptr;
+    mMapping = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    mFd = fd;
+    mData = static_cast<const uint8_t*>(addr);
+    mSize = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mData) {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+    if (mFd >= 0) {
+        ::close(mFd);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mFd = -1;
+}
+
+#endif
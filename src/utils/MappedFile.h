@@ -0,0 +1,39 @@
+#ifndef OPENGL_UTILS_MAPPED_FILE_H
+#define OPENGL_UTILS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile)
+class MappedFile {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool isOpen() const { return mData != nullptr; }
+
+private:
+    const uint8_t* mData;
+    size_t mSize;
+#ifdef _WIN32
+    void* mFile;
+    void* mMapping;
+#else
+    int mFd;
+#endif
+};
+
+#endif
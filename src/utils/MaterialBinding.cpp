@@ -0,0 +1,99 @@
+#include "MaterialBinding.h"
+#include "utils/Hash.h"
+#include "utils/Mesh.h"
+#include "utils/TextureResidency.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+struct SamplerGroup {
+    const char* type;
+    GLint firstUnit;
+};
+
+const int UNITS_PER_TYPE = 4;
+
+const SamplerGroup SAMPLER_GROUPS[] = {
+    {"texture_diffuse", 0},
+    {"texture_specular", 4},
+    {"texture_normal", 8},
+    {"texture_height", 12},
+};
+
+const SamplerGroup* findGroup(const std::string& type) {
+    for (const auto& group: SAMPLER_GROUPS) {
+        if (type == group.type) {
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+void TextureBindState::reset() {
+    std::fill(textures, textures + UNITS, 0u);
+}
+
+MaterialBinding::MaterialBinding(): slotCount(0), key(0) {}
+
+MaterialBinding::MaterialBinding(const std::vector<Texture2D>& textures): slotCount(0), key(0) {
+    int used[sizeof(SAMPLER_GROUPS) / sizeof(SAMPLER_GROUPS[0])] = {};
+    for (const auto& texture: textures) {
+        const SamplerGroup* group = findGroup(texture.type);
+        if (!group) {
+            std::cout << "WARNING::MATERIAL:: unknown texture type " << texture.type << ", not bound" << std::endl;
+            continue;
+        }
+        int& count = used[group - SAMPLER_GROUPS];
+        if (count >= UNITS_PER_TYPE || slotCount >= MATERIAL_MAX_SLOTS) {
+            std::cout << "WARNING::MATERIAL:: too many " << texture.type << " textures, " << texture.path << " is not bound" << std::endl;
+            continue;
+        }
+        MaterialSlot& slot = slots[slotCount++];
+        slot.texture = texture.id;
+        slot.unit = group->firstUnit + count;
+        // shader code: uniform sampler2D texture_diffuse1, texture_diffuse2, ...
+        std::snprintf(slot.uniform, sizeof(slot.uniform), "%s%d", group->type, ++count);
+    }
+
+    if (slotCount > 0) {
+        key = FNV_OFFSET_BASIS;
+        for (int i = 0; i < slotCount; i++) {
+            key = hashBytes(&slots[i].unit, sizeof(slots[i].unit), key);
+            key = hashBytes(&slots[i].texture, sizeof(slots[i].texture), key);
+        }
+    }
+}
+
+void MaterialBinding::configure(const Shader& shader) const {
+    for (int i = 0; i < slotCount; i++) {
+        shader.setInt(UniformKey(slots[i].uniform, std::strlen(slots[i].uniform)), slots[i].unit);
+    }
+    configuredPrograms.push_back(shader.getProgramGeneration());
+}
+
+void MaterialBinding::bind(const Shader& shader, TextureBindState& state) const {
+    if (slotCount == 0) {
+        return;
+    }
+    if (std::find(configuredPrograms.begin(), configuredPrograms.end(), shader.getProgramGeneration()) == configuredPrograms.end()) {
+        configure(shader);
+    }
+    for (int i = 0; i < slotCount; i++) {
+        const MaterialSlot& slot = slots[i];
+        // a skipped bind is still a use, the residency must not evict it
+        TextureResidency::getInstance().touch(slot.texture);
+        if (state.textures[slot.unit] == slot.texture) {
+            state.skipped++;
+            continue;
+        }
+        glActiveTexture(GL_TEXTURE0 + slot.unit);
+        glBindTexture(GL_TEXTURE_2D, slot.texture);
+        state.textures[slot.unit] = slot.texture;
+        state.binds++;
+    }
+}
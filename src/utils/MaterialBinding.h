@@ -0,0 +1,69 @@
+#ifndef OPENGL_UTILS_MATERIAL_BINDING_H
+#define OPENGL_UTILS_MATERIAL_BINDING_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "utils/Shader.h"
+
+struct Texture2D;
+
+const int MATERIAL_MAX_SLOTS = 8;
+
+/*
+ * Texture units are fixed per sampler name:
+ *   texture_diffuse1..4  -> unit 0..3
+ *   texture_specular1..4 -> unit 4..7
+ *   texture_normal1..4   -> unit 8..11
+ *   texture_height1..4   -> unit 12..15
+ * so a program's sampler uniforms never change once assigned and drawing does no uniform work at all.
+ */
+struct MaterialSlot {
+    GLuint texture = 0;
+    GLint unit = 0;
+    char uniform[32] = {};
+};
+
+// what is bound on each unit, consecutive draws with the same material skip the binds
+struct TextureBindState {
+    static const int UNITS = 16;
+
+    GLuint textures[UNITS] = {};
+    size_t binds = 0;
+    size_t skipped = 0;
+
+    // forget the bindings, e.g. at the start of a frame when other code may have touched the units
+    void reset();
+};
+
+class MaterialBinding {
+public:
+    MaterialBinding();
+
+    // resolved once, the Texture2D type strings are not looked at again
+    explicit MaterialBinding(const std::vector<Texture2D>& textures);
+
+    // the shader must be in use
+    void bind(const Shader& shader, TextureBindState& state) const;
+
+    // equal for materials binding the same textures to the same units, used to sort draws
+    uint64_t getKey() const { return key; }
+
+    int getSlotCount() const { return slotCount; }
+
+private:
+    MaterialSlot slots[MATERIAL_MAX_SLOTS];
+    int slotCount;
+    uint64_t key;
+    /*
+     * Shader::getProgramGeneration of the programs whose samplers were already pointed at our units,
+     * only grows the first time a program is seen. Not the GL name: a reloaded or new program may get
+     * the name of a deleted one and would keep its samplers at unit 0.
+     */
+    mutable std::vector<uint64_t> configuredPrograms;
+
+    void configure(const Shader& shader) const;
+};
+
+#endif
@@ -1,15 +1,45 @@
 #include "Mesh.h"
+#include "utils/MeshArena.h"
 #include "utils/Texture.h"
 #include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
 #include <string>
+#include <utility>
 
 
-Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture2D>& textures) {
+Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture2D>& textures)
+    : vao(0), vbo(0), ebo(0), indexCount(0), baseVertex(0), indexOffset(0), indexType(IndexType::UInt32), format(VertexFormat::Float), boundsCenter(0.f), boundsRadius(0.f) {
     this->vertices = vertices;
     this->indices = indices;
     this->textures = textures;
+    this->material = MaterialBinding(textures);
 
-    setupMesh();
+    setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size(), false);
+}
+
+Mesh::Mesh(MeshData&& data, const std::vector<Texture2D>& textures, const std::shared_ptr<MeshArena>& arena, VertexFormat format,
+           bool allowByteIndices)
+    : vao(0), vbo(0), ebo(0), indexCount(0), arena(arena), baseVertex(0), indexOffset(0), indexType(IndexType::UInt32), format(format), boundsCenter(0.f), boundsRadius(0.f) {
+    this->vertices = std::move(data.vertices);
+    this->indices = std::move(data.indices);
+    this->textures = textures;
+    this->material = MaterialBinding(textures);
+
+    setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size(), allowByteIndices);
+    if (!data.lods.empty()) {
+        setLods(data.lods);
+    }
+}
+
+Mesh::Mesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount, const std::vector<Texture2D>& textures,
+           const std::shared_ptr<MeshArena>& arena, VertexFormat format,
+           bool allowByteIndices)
+    : vao(0), vbo(0), ebo(0), indexCount(0), arena(arena), baseVertex(0), indexOffset(0), indexType(IndexType::UInt32), format(format), boundsCenter(0.f), boundsRadius(0.f) {
+    this->textures = textures;
+    this->material = MaterialBinding(textures);
+
+    setupMesh(vertices, vertexCount, indices, indexCount, allowByteIndices);
 }
 
 
@@ -17,39 +47,115 @@ Mesh::~Mesh() {
     // todo
 }
 
-void Mesh::draw(Shader& shader) {
-    /*
-     * shader code
-     * uniform texture_diffuse1
-     * uniform texture_diffuse2
-     * uniform texture_...
-     *
-    */
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
-
-    std::string name;
-    for (unsigned int i = 0; i < textures.size(); i++) {
-        glActiveTexture(GL_TEXTURE0 + i);
-        auto type = textures[i].type;
-        if (type == "texture_diffuse") {
-            name = "texture_diffuse" + std::to_string(diffuseNr++);
-        } else if (type == "texture_spcular") {
-            name ="texture_spcular" + std::to_string(specularNr++);
-        }
-        shader.setInt(name, i);
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
-    }
+void Mesh::draw(Shader& shader, int lod) {
+    TextureBindState state;
+    draw(shader, lod, state);
+}
 
-    glBindVertexArray(vao);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+void Mesh::draw(Shader& shader, int lod, TextureBindState& state) {
+    material.bind(shader, state);
+    setQuantizationUniforms(shader);
+
+    if (arena) {
+        arena->bind();
+    } else {
+        glBindVertexArray(vao);
+    }
+    drawElements(lod);
     glBindVertexArray(0);
 
     // reset active texture unit 0
     glActiveTexture(GL_TEXTURE0);
 }
 
-void Mesh::setupMesh() {
+void Mesh::drawBatched(Shader& shader, int lod, TextureBindState& state) {
+    material.bind(shader, state);
+    setQuantizationUniforms(shader);
+    drawElements(lod);
+}
+
+void Mesh::setQuantizationUniforms(Shader& shader) const {
+    if (format != VertexFormat::Quantized) {
+        return;
+    }
+    // consecutive meshes of one model often share the bounds, the shader skips those writes
+    shader.setFloat3("positionOffset"_uniform, quantization.offset);
+    shader.setFloat3("positionScale"_uniform, quantization.scale);
+}
+
+void Mesh::drawElements(int lod) const {
+    const MeshLod& range = lods[std::min(std::max(lod, 0), static_cast<int>(lods.size()) - 1)];
+    const size_t offset = range.indexOffset * indexTypeSize(indexType);
+    if (arena) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, indexTypeGL(indexType), (void*)(indexOffset + offset), baseVertex);
+    } else {
+        glDrawElements(GL_TRIANGLES, range.indexCount, indexTypeGL(indexType), (void*)offset);
+    }
+}
+
+void Mesh::setLods(const std::vector<MeshLod>& lods) {
+    std::vector<MeshLod> valid;
+    for (const auto& lod: lods) {
+        if (static_cast<uint64_t>(lod.indexOffset) + lod.indexCount <= indexCount && valid.size() < static_cast<size_t>(MESH_MAX_LODS)) {
+            valid.push_back(lod);
+        }
+    }
+    if (!valid.empty()) {
+        this->lods = std::move(valid);
+    }
+}
+
+void Mesh::setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount, bool allowByteIndices) {
+    this->indexCount = static_cast<unsigned int>(indexCount);
+    // everything is level 0 until setLods says otherwise
+    lods.assign(1, MeshLod {0, static_cast<uint32_t>(indexCount), 0.f});
+
+    if (vertexCount > 0) {
+        glm::vec3 min = vertexData[0].position, max = vertexData[0].position;
+        for (size_t i = 1; i < vertexCount; i++) {
+            min = glm::min(min, vertexData[i].position);
+            max = glm::max(max, vertexData[i].position);
+        }
+        boundsCenter = (min + max) * 0.5f;
+        boundsRadius = glm::length(max - min) * 0.5f;
+    }
+
+    // the gpu copy is converted, the cpu side (vertices member, caches) stays full precision
+    const void* uploadData = vertexData;
+    std::vector<QuantizedVertex> quantized;
+    if (format == VertexFormat::Quantized) {
+        quantization = computeQuantizationBounds(vertexData, vertexCount);
+        quantized.resize(vertexCount);
+        quantizeVertices(vertexData, vertexCount, quantization, quantized.data());
+        uploadData = quantized.data();
+    }
+
+    // narrowest index type for the largest referenced vertex, LOD ranges stay valid since they count indices
+    unsigned int maxIndex = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        maxIndex = std::max(maxIndex, indexData[i]);
+    }
+    indexType = chooseIndexType(maxIndex, allowByteIndices);
+    const void* indexUpload = indexData;
+    std::vector<unsigned char> packedIndices;
+    if (indexType != IndexType::UInt32) {
+        packedIndices.resize(indexCount * indexTypeSize(indexType));
+        packIndices(indexData, indexCount, indexType, packedIndices.data());
+        indexUpload = packedIndices.data();
+    }
+
+    if (arena && arena->getFormat() != format) {
+        std::cout << "WARNING::MESH:: arena vertex format does not match, mesh gets its own buffers" << std::endl;
+        arena.reset();
+    }
+
+    if (arena) {
+        const MeshArenaRange range = arena->allocate(uploadData, vertexCount, indexUpload, indexCount, indexType);
+        baseVertex = range.baseVertex;
+        indexOffset = range.indexOffset;
+        return;
+    }
+
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
@@ -58,21 +164,14 @@ void Mesh::setupMesh() {
 
     // bind vbo and upload data
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * vertexStride(format), uploadData, GL_STATIC_DRAW);
 
     // bind ebo and upload data
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexTypeSize(indexType), indexUpload, GL_STATIC_DRAW);
 
     // order: vertex  normal texcoord
-    glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(Vertex), (void*)offsetof(Vertex, texcoords));
-    glEnableVertexAttribArray(2);
+    setupVertexAttributes(format);
 
     // todo unbind vbo, ebo buffer;
     glBindVertexArray(0);
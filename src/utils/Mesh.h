@@ -2,7 +2,12 @@
 #define OPENGL_UTILS_MESH
 
 #include "glm/fwd.hpp"
+#include "utils/IndexFormat.h"
+#include "utils/MaterialBinding.h"
 #include "utils/Shader.h"
+#include "utils/VertexQuantization.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -12,12 +17,39 @@ struct Vertex {
     glm::vec2 texcoords;
 };
 
+// material texture before it is loaded, type is the sampler prefix e.g. "texture_diffuse"
+struct TextureRef {
+    std::string type;
+    std::string path;
+};
+
+// index range of one level of detail, level 0 is the full resolution mesh
+struct MeshLod {
+    uint32_t indexOffset;   // in indices, not bytes
+    uint32_t indexCount;
+    float error;            // simplification error in model units
+};
+
+const int MESH_MAX_LODS = 4;
+
+// cpu side mesh produced by the importer, turned into a Mesh on the GL thread
+struct MeshData {
+    std::vector<Vertex> vertices;
+    // with a LOD chain all levels are stored back to back, see lods
+    std::vector<unsigned int> indices;
+    // empty when no chain was built, otherwise one entry per level
+    std::vector<MeshLod> lods;
+    std::vector<TextureRef> textures;
+    unsigned int materialIndex = 0;
+};
+
 struct Texture2D {
     unsigned int id;
     std::string type;
     std::string path;
 };
 
+class MeshArena;
 
 class Mesh {
 public:
@@ -27,14 +59,72 @@ public:
 
     Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<Texture2D>& textures);
 
+    /*
+     * with an arena the geometry is appended to the shared buffers instead of getting its own VAO.
+     * VertexFormat::Quantized converts to QuantizedVertex on upload, the shader then needs the
+     * positionOffset / positionScale uniforms set by draw().
+     * Indices are uploaded as 16 bit when the mesh has at most 65536 vertices, allowByteIndices
+     * additionally permits 8 bit for meshes with at most 256 vertices.
+     */
+    Mesh(MeshData&& data, const std::vector<Texture2D>& textures, const std::shared_ptr<MeshArena>& arena = nullptr,
+         VertexFormat format = VertexFormat::Float, bool allowByteIndices = false);
+
+    // upload straight from external memory (e.g. a mapped .meshbin), no cpu copy is kept
+    Mesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount, const std::vector<Texture2D>& textures,
+         const std::shared_ptr<MeshArena>& arena = nullptr, VertexFormat format = VertexFormat::Float, bool allowByteIndices = false);
+
     ~Mesh();
 
-    void draw(Shader& shader);
+    // lod is clamped to the available levels
+    void draw(Shader& shader, int lod = 0);
+
+    // textures already bound according to state are skipped, see Model::draw
+    void draw(Shader& shader, int lod, TextureBindState& state);
+
+    // draw without touching the VAO, the caller has bound the arena (see Model::draw)
+    void drawBatched(Shader& shader, int lod, TextureBindState& state);
+
+    // meshes with the same key bind the same textures
+    uint64_t getMaterialKey() const { return material.getKey(); }
+
+    // replaces the level table, ranges index into the uploaded indices (e.g. from a .meshbin)
+    void setLods(const std::vector<MeshLod>& lods);
+
+    int getLodCount() const { return static_cast<int>(lods.size()); }
+    const MeshLod& getLod(int lod) const { return lods[lod]; }
+
+    // bounding sphere around the vertex AABB, in model space
+    const glm::vec3& getBoundsCenter() const { return boundsCenter; }
+    float getBoundsRadius() const { return boundsRadius; }
+
+    bool isInArena() const { return arena != nullptr; }
+
+    VertexFormat getFormat() const { return format; }
+
+    IndexType getIndexType() const { return indexType; }
+
+    // gpu index storage, all levels
+    size_t getIndexBytes() const { return indexCount * indexTypeSize(indexType); }
 
 private:
     unsigned int vao, vbo, ebo;
+    unsigned int indexCount;
+    std::shared_ptr<MeshArena> arena;
+    int baseVertex;
+    size_t indexOffset;
+    IndexType indexType;
+    VertexFormat format;
+    QuantizationBounds quantization;
+    std::vector<MeshLod> lods;
+    glm::vec3 boundsCenter;
+    float boundsRadius;
+    MaterialBinding material;
+
+    void setQuantizationUniforms(Shader& shader) const;
+
+    void drawElements(int lod) const;
 
-    void setupMesh();
+    void setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount, bool allowByteIndices);
 };
 
 
@@ -0,0 +1,120 @@
+#include "MeshArena.h"
+#include <algorithm>
+
+namespace {
+
+const size_t INDEX_ALIGNMENT = 4;
+
+size_t alignIndexBytes(size_t bytes) {
+    return (bytes + INDEX_ALIGNMENT - 1) / INDEX_ALIGNMENT * INDEX_ALIGNMENT;
+}
+
+}
+
+MeshArena::MeshArena(size_t vertexCapacity, size_t indexByteCapacity, VertexFormat format)
+    : vao(0), vbo(0), ebo(0), format(format), stride(vertexStride(format))
+    , vertexCount(0), vertexCapacity(std::max<size_t>(vertexCapacity, 1))
+    , indexBytes(0), indexByteCapacity(alignIndexBytes(std::max<size_t>(indexByteCapacity, 1))) {
+    glGenVertexArrays(1, &vao);
+    vbo = createBuffer(GL_ARRAY_BUFFER, this->vertexCapacity * stride);
+    ebo = createBuffer(GL_ARRAY_BUFFER, this->indexByteCapacity);
+    setupAttributes();
+}
+
+MeshArena::~MeshArena() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+}
+
+GLuint MeshArena::createBuffer(GLenum target, size_t bytes) {
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    glBufferData(target, bytes, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(target, 0);
+    return buffer;
+}
+
+GLuint MeshArena::growBuffer(GLuint buffer, size_t usedBytes, size_t newBytes) {
+    GLuint grown = createBuffer(GL_COPY_WRITE_BUFFER, newBytes);
+    if (usedBytes > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+    return grown;
+}
+
+void MeshArena::setupAttributes() {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+    // same layout as Mesh::setupMesh
+    setupVertexAttributes(format);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+size_t MeshArena::indexBytesFor(size_t indexCount, IndexType indexType) {
+    return alignIndexBytes(indexCount * indexTypeSize(indexType));
+}
+
+void MeshArena::reserve(size_t vertexTotal, size_t indexByteTotal) {
+    bool changed = false;
+    if (vertexTotal > vertexCapacity) {
+        vbo = growBuffer(vbo, vertexCount * stride, vertexTotal * stride);
+        vertexCapacity = vertexTotal;
+        changed = true;
+    }
+    if (indexByteTotal > indexByteCapacity) {
+        indexByteTotal = alignIndexBytes(indexByteTotal);
+        ebo = growBuffer(ebo, indexBytes, indexByteTotal);
+        indexByteCapacity = indexByteTotal;
+        changed = true;
+    }
+    if (changed) {
+        // the VAO still points at the old buffers
+        setupAttributes();
+    }
+}
+
+MeshArenaRange MeshArena::allocate(const void* vertices, size_t count, const void* indices, size_t icount, IndexType indexType) {
+    // indexBytes is always aligned, so the range starts on a multiple of any index size
+    const size_t ibytes = indexBytesFor(icount, indexType);
+    // grow geometrically so appending many small meshes stays linear
+    reserve(vertexCount + count > vertexCapacity ? std::max(vertexCount + count, vertexCapacity * 2) : 0,
+            indexBytes + ibytes > indexByteCapacity ? std::max(indexBytes + ibytes, indexByteCapacity * 2) : 0);
+
+    MeshArenaRange range;
+    range.baseVertex = static_cast<GLint>(vertexCount);
+    range.indexOffset = indexBytes;
+    range.indexCount = static_cast<GLsizei>(icount);
+    range.indexType = indexType;
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, vertexCount * stride, count * stride, vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // written through GL_COPY_WRITE_BUFFER so the currently bound VAO's index buffer is left alone
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, range.indexOffset, icount * indexTypeSize(indexType), indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    vertexCount += count;
+    indexBytes += ibytes;
+    return range;
+}
+
+void MeshArena::bind() const {
+    glBindVertexArray(vao);
+}
+
+void MeshArena::unbind() const {
+    glBindVertexArray(0);
+}
@@ -0,0 +1,67 @@
+#ifndef OPENGL_UTILS_MESH_ARENA_H
+#define OPENGL_UTILS_MESH_ARENA_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include "utils/IndexFormat.h"
+#include "utils/Mesh.h"
+#include "utils/VertexQuantization.h"
+
+// where a mesh lives inside the arena buffers
+struct MeshArenaRange {
+    GLint baseVertex = 0;
+    size_t indexOffset = 0;   // in bytes, passed as the indices pointer
+    GLsizei indexCount = 0;
+    IndexType indexType = IndexType::UInt32;
+};
+
+/*
+ * One VAO + one vertex buffer + one index buffer shared by many meshes with the same vertex format.
+ * Meshes are appended and drawn with glDrawElementsBaseVertex, so a whole model (or several
+ * models) needs a single VAO bind instead of one per sub mesh.
+ * Buffers grow by copying on the GPU (glCopyBufferSubData) when they run out of space.
+ * The index buffer is untyped: every mesh stores its indices in its own IndexType, ranges are
+ * aligned to 4 bytes so any type can follow any other.
+ */
+class MeshArena {
+public:
+    // capacities in vertices and index bytes
+    MeshArena(size_t vertexCapacity = 64 * 1024, size_t indexByteCapacity = 512 * 1024, VertexFormat format = VertexFormat::Float);
+    ~MeshArena();
+
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    // make room up front when the totals are known, avoids growing copies
+    void reserve(size_t vertexCount, size_t indexBytes);
+
+    /*
+     * vertices are vertexCount elements of getFormat()'s layout (Vertex or QuantizedVertex),
+     * indices are indexCount elements of indexType, already packed (see packIndices)
+     */
+    MeshArenaRange allocate(const void* vertices, size_t vertexCount, const void* indices, size_t indexCount, IndexType indexType);
+
+    // bytes allocate() will take for indexCount indices of the type, alignment padding included
+    static size_t indexBytesFor(size_t indexCount, IndexType indexType);
+
+    void bind() const;
+    void unbind() const;
+
+    size_t getVertexCount() const { return vertexCount; }
+    size_t getIndexBytes() const { return indexBytes; }
+    size_t getByteSize() const { return vertexCapacity * stride + indexByteCapacity; }
+    VertexFormat getFormat() const { return format; }
+
+private:
+    GLuint vao, vbo, ebo;
+    VertexFormat format;
+    size_t stride;
+    size_t vertexCount, vertexCapacity;
+    size_t indexBytes, indexByteCapacity;
+
+    static GLuint createBuffer(GLenum target, size_t bytes);
+    static GLuint growBuffer(GLuint buffer, size_t usedBytes, size_t newBytes);
+    void setupAttributes();
+};
+
+#endif
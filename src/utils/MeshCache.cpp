@@ -0,0 +1,250 @@
+#include "MeshCache.h"
+#include "utils/Hash.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+static const char MESH_CACHE_MAGIC[8] = {'M', 'E', 'S', 'H', 'B', 'I', 'N', '\0'};
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+MeshCache::MeshCache(): header(nullptr), entries(nullptr), textures(nullptr) {}
+
+bool MeshCache::open(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t processFlags) {
+    close();
+    if (!file.open(cachePath)) {
+        return false;
+    }
+    if (file.size() < sizeof(MeshCacheHeader)) {
+        close();
+        return false;
+    }
+
+    header = reinterpret_cast<const MeshCacheHeader*>(file.data());
+    if (std::memcmp(header->magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0
+        || header->version != VERSION
+        || header->sourceHash != sourceHash
+        || header->importFlags != importFlags
+        || header->processFlags != processFlags
+        || header->vertexStride != sizeof(Vertex)
+        || header->indexStride != sizeof(unsigned int)
+        || header->fileSize != file.size()) {
+        close();
+        return false;
+    }
+
+    entries = reinterpret_cast<const MeshCacheEntry*>(file.data() + sizeof(MeshCacheHeader));
+    textures = reinterpret_cast<const MeshCacheTexture*>(entries + header->meshCount);
+    if (!validate()) {
+        std::cout << "WARNING::MESH_CACHE:: corrupted cache file " << cachePath << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MeshCache::close() {
+    file.close();
+    header = nullptr;
+    entries = nullptr;
+    textures = nullptr;
+}
+
+bool MeshCache::validate() const {
+    const uint64_t size = file.size();
+    const uint64_t tablesEnd = sizeof(MeshCacheHeader)
+        + uint64_t(header->meshCount) * sizeof(MeshCacheEntry)
+        + uint64_t(header->textureCount) * sizeof(MeshCacheTexture);
+    if (tablesEnd > size) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header->meshCount; i++) {
+        const MeshCacheEntry& entry = entries[i];
+        if (entry.vertexOffset + uint64_t(entry.vertexCount) * sizeof(Vertex) > size
+            || entry.indexOffset + uint64_t(entry.indexCount) * sizeof(unsigned int) > size
+            || uint64_t(entry.firstTexture) + entry.textureCount > header->textureCount) {
+            return false;
+        }
+        if (entry.lodCount > MESH_MAX_LODS) {
+            return false;
+        }
+        for (uint32_t lod = 0; lod < entry.lodCount; lod++) {
+            if (uint64_t(entry.lods[lod].indexOffset) + entry.lods[lod].indexCount > entry.indexCount) {
+                return false;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < header->textureCount; i++) {
+        const MeshCacheTexture& texture = textures[i];
+        if (texture.typeOffset + texture.typeLength > size || texture.pathOffset + texture.pathLength > size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t MeshCache::getMeshCount() const {
+    return header ? header->meshCount : 0;
+}
+
+MeshCacheView MeshCache::getMesh(size_t index) const {
+    const MeshCacheEntry& entry = entries[index];
+    const char* base = reinterpret_cast<const char*>(file.data());
+
+    MeshCacheView view;
+    view.vertices = reinterpret_cast<const Vertex*>(file.data() + entry.vertexOffset);
+    view.vertexCount = entry.vertexCount;
+    view.indices = reinterpret_cast<const unsigned int*>(file.data() + entry.indexOffset);
+    view.indexCount = entry.indexCount;
+    view.textures.reserve(entry.textureCount);
+    for (uint32_t i = 0; i < entry.textureCount; i++) {
+        const MeshCacheTexture& texture = textures[entry.firstTexture + i];
+        TextureRef ref;
+        ref.type.assign(base + texture.typeOffset, texture.typeLength);
+        ref.path.assign(base + texture.pathOffset, texture.pathLength);
+        view.textures.push_back(std::move(ref));
+    }
+    view.lods.assign(entry.lods, entry.lods + entry.lodCount);
+    return view;
+}
+
+std::string MeshCache::cachePathFor(const std::string& sourcePath) {
+    return sourcePath + ".meshbin";
+}
+
+bool MeshCache::hashSource(const std::string& sourcePath, uint64_t& hash) {
+    if (!hashFile(sourcePath, hash)) {
+        return false;
+    }
+    std::string extension = std::filesystem::path(sourcePath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension != ".obj") {
+        return true;
+    }
+    // the materials become texture references in the cache, an edited .mtl must be a miss too
+    std::ifstream file(sourcePath);
+    const std::filesystem::path directory = std::filesystem::path(sourcePath).parent_path();
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string::npos || line.compare(i, 6, "mtllib") != 0 || i + 6 == line.size() || !std::isspace(static_cast<unsigned char>(line[i + 6]))) {
+            continue;
+        }
+        // like Assimp, the rest of the line is the file name
+        i = line.find_first_not_of(" \t", i + 6);
+        const size_t end = line.find_last_not_of(" \t\r");
+        if (i == std::string::npos || end < i) {
+            continue;
+        }
+        const std::string name = line.substr(i, end - i + 1);
+        hash = hashString(name, hash);
+        uint64_t materialHash = 0;
+        if (hashFile((directory / name).string(), materialHash)) {
+            hash = hashBytes(&materialHash, sizeof(materialHash), hash);
+        } else {
+            // missing now, appearing later is a change as well
+            hash = hashString("\n", hash);
+        }
+    }
+    return true;
+}
+
+bool MeshCache::write(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t processFlags,
+                      const std::vector<MeshData>& meshes) {
+    MeshCacheHeader header {};
+    std::memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    header.version = VERSION;
+    header.importFlags = importFlags;
+    header.processFlags = processFlags;
+    header.sourceHash = sourceHash;
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.vertexStride = sizeof(Vertex);
+    header.indexStride = sizeof(unsigned int);
+
+    std::vector<MeshCacheEntry> entries(meshes.size());
+    std::vector<MeshCacheTexture> textures;
+    std::string strings;
+
+    for (const auto& mesh: meshes) {
+        header.textureCount += static_cast<uint32_t>(mesh.textures.size());
+    }
+    const uint64_t stringsOffset = sizeof(MeshCacheHeader)
+        + entries.size() * sizeof(MeshCacheEntry)
+        + uint64_t(header.textureCount) * sizeof(MeshCacheTexture);
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        entries[i].firstTexture = static_cast<uint32_t>(textures.size());
+        entries[i].textureCount = static_cast<uint32_t>(meshes[i].textures.size());
+        entries[i].lodCount = static_cast<uint32_t>(std::min<size_t>(meshes[i].lods.size(), MESH_MAX_LODS));
+        std::copy(meshes[i].lods.begin(), meshes[i].lods.begin() + entries[i].lodCount, entries[i].lods);
+        for (const auto& texture: meshes[i].textures) {
+            MeshCacheTexture record {};
+            record.typeOffset = stringsOffset + strings.size();
+            record.typeLength = static_cast<uint32_t>(texture.type.size());
+            strings += texture.type;
+            record.pathOffset = stringsOffset + strings.size();
+            record.pathLength = static_cast<uint32_t>(texture.path.size());
+            strings += texture.path;
+            textures.push_back(record);
+        }
+    }
+
+    uint64_t offset = alignUp(stringsOffset + strings.size(), 16);
+    for (size_t i = 0; i < meshes.size(); i++) {
+        entries[i].vertexOffset = offset;
+        entries[i].vertexCount = static_cast<uint32_t>(meshes[i].vertices.size());
+        offset = alignUp(offset + meshes[i].vertices.size() * sizeof(Vertex), 16);
+    }
+    for (size_t i = 0; i < meshes.size(); i++) {
+        entries[i].indexOffset = offset;
+        entries[i].indexCount = static_cast<uint32_t>(meshes[i].indices.size());
+        offset = alignUp(offset + meshes[i].indices.size() * sizeof(unsigned int), 16);
+    }
+    header.fileSize = offset;
+
+    // write to a temporary file first so a crash never leaves a half written cache behind
+    const std::string tmpPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cout << "WARNING::MESH_CACHE:: can not write " << tmpPath << std::endl;
+            return false;
+        }
+        const char padding[16] = {};
+        auto pad = [&out, &padding]() {
+            const uint64_t pos = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(alignUp(pos, 16) - pos));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(MeshCacheEntry));
+        out.write(reinterpret_cast<const char*>(textures.data()), textures.size() * sizeof(MeshCacheTexture));
+        out.write(strings.data(), strings.size());
+        pad();
+        for (const auto& mesh: meshes) {
+            out.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+            pad();
+        }
+        for (const auto& mesh: meshes) {
+            out.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+            pad();
+        }
+        if (!out) {
+            std::cout << "WARNING::MESH_CACHE:: failed writing " << tmpPath << std::endl;
+            return false;
+        }
+    }
+
+    std::remove(cachePath.c_str());
+    if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
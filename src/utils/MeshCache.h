@@ -0,0 +1,108 @@
+#ifndef OPENGL_UTILS_MESH_CACHE_H
+#define OPENGL_UTILS_MESH_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "utils/MappedFile.h"
+#include "utils/Mesh.h"
+
+/*
+ * .meshbin file layout (all offsets are absolute, little endian):
+ *
+ *   MeshCacheHeader
+ *   MeshCacheEntry    [meshCount]
+ *   MeshCacheTexture  [textureCount]
+ *   string table      (texture types and paths, not null terminated)
+ *   vertex data       (16 byte aligned, Vertex[])
+ *   index data        (16 byte aligned, unsigned int[])
+ *
+ * The file is only valid for the exact source content, import flags and
+ * processing flags it was built from; anything else is treated as a miss.
+ */
+
+// post import processing baked into the cached vertex/index data
+enum MeshProcessFlags : uint32_t {
+    MESH_PROCESS_NONE = 0,
+    MESH_PROCESS_VERTEX_CACHE = 1 << 0,   // Forsyth triangle order + vertex fetch order
+    MESH_PROCESS_OVERDRAW = 1 << 1,       // cluster sort on top of the vertex cache order
+    MESH_PROCESS_LOD = 1 << 2,            // simplified index ranges appended after level 0
+    MESH_PROCESS_SPLIT = 1 << 3,          // meshes above 65536 vertices cut into 16 bit addressable chunks
+};
+
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t importFlags;
+    uint64_t sourceHash;
+    uint32_t meshCount;
+    uint32_t textureCount;
+    uint32_t vertexStride;
+    uint32_t indexStride;
+    uint32_t processFlags;
+    uint32_t reserved;
+    uint64_t fileSize;
+};
+
+struct MeshCacheEntry {
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t firstTexture;
+    uint32_t textureCount;
+    uint32_t lodCount;                // 0 when there is no LOD chain
+    MeshLod lods[MESH_MAX_LODS];      // ranges inside this mesh's indices
+};
+
+struct MeshCacheTexture {
+    uint64_t typeOffset;
+    uint64_t pathOffset;
+    uint32_t typeLength;
+    uint32_t pathLength;
+};
+
+// view into a mapped mesh, valid while the MeshCache is open
+struct MeshCacheView {
+    const Vertex* vertices;
+    uint32_t vertexCount;
+    const unsigned int* indices;
+    uint32_t indexCount;
+    std::vector<TextureRef> textures;
+    std::vector<MeshLod> lods;
+};
+
+class MeshCache {
+public:
+    static constexpr uint32_t VERSION = 3;
+
+    MeshCache();
+
+    // maps the cache file and checks it against the source hash, import and processing flags
+    bool open(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t processFlags = MESH_PROCESS_NONE);
+
+    void close();
+
+    size_t getMeshCount() const;
+
+    MeshCacheView getMesh(size_t index) const;
+
+    static std::string cachePathFor(const std::string& sourcePath);
+
+    // hash of the model file and the files the importer reads with it (an OBJ's mtllib materials),
+    // the sourceHash to open and write with; false if the model file can not be read
+    static bool hashSource(const std::string& sourcePath, uint64_t& hash);
+
+    static bool write(const std::string& cachePath, uint64_t sourceHash, uint32_t importFlags, uint32_t processFlags,
+                      const std::vector<MeshData>& meshes);
+
+private:
+    MappedFile file;
+    const MeshCacheHeader* header;
+    const MeshCacheEntry* entries;
+    const MeshCacheTexture* textures;
+
+    bool validate() const;
+};
+
+#endif
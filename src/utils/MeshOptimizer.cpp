@@ -0,0 +1,620 @@
+#include "MeshOptimizer.h"
+#include "utils/Hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace MeshOptimizer {
+
+namespace {
+
+// Forsyth's tuned constants, see "Linear-Speed Vertex Cache Optimisation" (2006)
+const int CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+
+float vertexScore(int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.f;
+    }
+    float score = 0.f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // the vertices of the last triangle get a fixed score so the next one does not just reuse the same edge
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            const float scaler = 1.f / (CACHE_SIZE - 3);
+            score = std::pow(1.f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+    // vertices with few triangles left are finished first, reduces the number of lone triangles later on
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+bool indicesInRange(const std::vector<unsigned int>& indices, size_t vertexCount) {
+    for (unsigned int index: indices) {
+        if (index >= vertexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// symmetric 4x4 plane quadric (Garland & Heckbert), accumulated with triangle area as weight
+struct Quadric {
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+    double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+    double a22 = 0.0, a23 = 0.0;
+    double a33 = 0.0;
+    double weight = 0.0;
+
+    void addPlane(const glm::vec3& n, float d, double w) {
+        a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z; a03 += w * n.x * d;
+        a11 += w * n.y * n.y; a12 += w * n.y * n.z; a13 += w * n.y * d;
+        a22 += w * n.z * n.z; a23 += w * n.z * d;
+        a33 += w * d * d;
+        weight += w;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+        a11 += q.a11; a12 += q.a12; a13 += q.a13;
+        a22 += q.a22; a23 += q.a23;
+        a33 += q.a33;
+        weight += q.weight;
+    }
+
+    // weighted mean squared distance of p to the accumulated planes
+    double error(const glm::vec3& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        const double e = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+                       + a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+                       + a22 * z * z + 2.0 * a23 * z
+                       + a33;
+        return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+    }
+};
+
+struct PositionKey {
+    glm::vec3 position;
+
+    bool operator==(const PositionKey& other) const {
+        return std::memcmp(&position, &other.position, sizeof(position)) == 0;
+    }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const {
+        return static_cast<size_t>(hashBytes(&key.position, sizeof(key.position)));
+    }
+};
+
+// move every wedge of source (it only has one) onto targetWedge
+struct Collapse {
+    unsigned int source;
+    unsigned int target;
+    unsigned int sourceWedge;
+    unsigned int targetWedge;
+    double cost;
+};
+
+uint64_t edgeKey(unsigned int a, unsigned int b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize) {
+    VertexCacheStats stats;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || !indicesInRange(indices, vertexCount)) {
+        return stats;
+    }
+
+    // FIFO emulation with timestamps: a vertex is cached while fewer than cacheSize misses happened since its own
+    std::vector<size_t> cachedAt(vertexCount, 0);
+    std::vector<char> used(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+    size_t unique = 0;
+    for (unsigned int index: indices) {
+        if (!used[index]) {
+            used[index] = 1;
+            unique++;
+        }
+        if (time - cachedAt[index] > cacheSize) {
+            cachedAt[index] = time++;
+            misses++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / triangleCount;
+    stats.atvr = unique ? static_cast<float>(misses) / unique : 0.f;
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || !indicesInRange(indices, vertexCount)) {
+        return;
+    }
+
+    // vertex -> triangle adjacency (compressed rows), entries are swap-removed as triangles are emitted
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index: indices) {
+        remaining[index]++;
+    }
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    int bestTriangle = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+        if (triangleScore[t] > triangleScore[bestTriangle]) {
+            bestTriangle = static_cast<int>(t);
+        }
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> nextCache;
+    cache.reserve(CACHE_SIZE + 3);
+    nextCache.reserve(CACHE_SIZE + 3);
+    size_t scanCursor = 0;
+
+    while (bestTriangle >= 0) {
+        const size_t t = static_cast<size_t>(bestTriangle);
+        emitted[t] = 1;
+        for (int k = 0; k < 3; k++) {
+            const unsigned int v = indices[t * 3 + k];
+            result.push_back(v);
+
+            // drop t from the vertex' remaining triangles
+            unsigned int* begin = &adjacency[offsets[v]];
+            unsigned int* end = begin + remaining[v];
+            unsigned int* found = std::find(begin, end, static_cast<unsigned int>(t));
+            if (found != end) {
+                std::swap(*found, *(end - 1));
+                remaining[v]--;
+            }
+        }
+
+        // emitted triangle moves to the front of the LRU cache
+        nextCache.clear();
+        for (int k = 0; k < 3; k++) {
+            nextCache.push_back(indices[t * 3 + k]);
+        }
+        for (unsigned int v: cache) {
+            if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2]) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // rescore everything that was or is in the cache, evicted vertices fall back to position -1
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            const unsigned int v = nextCache[i];
+            cachePosition[v] = i < static_cast<size_t>(CACHE_SIZE) ? static_cast<int>(i) : -1;
+            score[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        bestTriangle = -1;
+        float bestScore = -1.f;
+        for (unsigned int v: nextCache) {
+            for (unsigned int a = 0; a < remaining[v]; a++) {
+                const unsigned int candidate = adjacency[offsets[v] + a];
+                const float candidateScore = score[indices[candidate * 3]] + score[indices[candidate * 3 + 1]] + score[indices[candidate * 3 + 2]];
+                triangleScore[candidate] = candidateScore;
+                if (candidateScore > bestScore) {
+                    bestScore = candidateScore;
+                    bestTriangle = static_cast<int>(candidate);
+                }
+            }
+        }
+
+        if (nextCache.size() > static_cast<size_t>(CACHE_SIZE)) {
+            nextCache.resize(CACHE_SIZE);
+        }
+        cache.swap(nextCache);
+
+        // nothing adjacent to the cache left, continue with the next untouched triangle
+        if (bestTriangle < 0) {
+            while (scanCursor < triangleCount && emitted[scanCursor]) {
+                scanCursor++;
+            }
+            if (scanCursor < triangleCount) {
+                bestTriangle = static_cast<int>(scanCursor);
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || !indicesInRange(indices, vertices.size())) {
+        return;
+    }
+
+    // hard boundaries: triangles where all three vertices miss a 16 entry FIFO, the cache is cold there anyway
+    // so reordering whole clusters costs (almost) no extra vertex shader work
+    const size_t cacheSize = 16;
+    std::vector<size_t> cachedAt(vertices.size(), 0);
+    size_t time = cacheSize + 1;
+    std::vector<size_t> clusterStart;
+    for (size_t t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int k = 0; k < 3; k++) {
+            const unsigned int v = indices[t * 3 + k];
+            if (time - cachedAt[v] > cacheSize) {
+                cachedAt[v] = time++;
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3) {
+            clusterStart.push_back(t);
+        }
+    }
+    const size_t clusterCount = clusterStart.size();
+    if (clusterCount < 2) {
+        return;
+    }
+    clusterStart.push_back(triangleCount);
+
+    // area weighted centroid and normal of the mesh and each cluster
+    std::vector<glm::vec3> clusterCentroid(clusterCount, glm::vec3(0.f));
+    std::vector<glm::vec3> clusterNormal(clusterCount, glm::vec3(0.f));
+    glm::vec3 meshCentroid(0.f);
+    float meshArea = 0.f;
+    for (size_t c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.f;
+        for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+            const glm::vec3& p0 = vertices[indices[t * 3]].position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(normal);
+            const glm::vec3 center = (p0 + p1 + p2) / 3.f;
+            clusterCentroid[c] += center * area;
+            clusterNormal[c] += normal;
+            clusterArea += area;
+        }
+        meshCentroid += clusterCentroid[c];
+        meshArea += clusterArea;
+        clusterCentroid[c] = clusterArea > 0.f ? clusterCentroid[c] / clusterArea : vertices[indices[clusterStart[c] * 3]].position;
+    }
+    if (meshArea > 0.f) {
+        meshCentroid = meshCentroid / meshArea;
+    }
+
+    // clusters facing away from the center are likely occluders, draw them first
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        const float length = glm::length(clusterNormal[c]);
+        sortKey[c] = length > 0.f ? glm::dot(clusterCentroid[c] - meshCentroid, clusterNormal[c] / length) : 0.f;
+    }
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKey](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (size_t c: order) {
+        result.insert(result.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+    }
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    if (!indicesInRange(indices, vertices.size())) {
+        return;
+    }
+    const unsigned int unassigned = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), unassigned);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+    for (unsigned int& index: indices) {
+        if (remap[index] == unassigned) {
+            remap[index] = static_cast<unsigned int>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+std::vector<unsigned int> simplify(const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                   size_t targetIndexCount, float* error) {
+    std::vector<unsigned int> result(indices.begin(), indices.end() - indices.size() % 3);
+    if (error) {
+        *error = 0.f;
+    }
+    const size_t vertexCount = vertices.size();
+    if (result.size() <= targetIndexCount || !indicesInRange(result, vertexCount)) {
+        return result;
+    }
+
+    // weld by exact position, a position is identified by the first vertex found there
+    std::vector<unsigned int> position(vertexCount);
+    {
+        std::unordered_map<PositionKey, unsigned int, PositionKeyHash> first;
+        first.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            position[v] = first.emplace(PositionKey {vertices[v].position}, static_cast<unsigned int>(v)).first->second;
+        }
+    }
+
+    // seams: more than one referenced vertex (wedge) at a position, those stay where they are
+    std::vector<unsigned int> wedgeCount(vertexCount, 0);
+    std::vector<char> referenced(vertexCount, 0);
+    for (unsigned int index: result) {
+        if (!referenced[index]) {
+            referenced[index] = 1;
+            wedgeCount[position[index]]++;
+        }
+    }
+    std::vector<char> locked(vertexCount, 0);
+    for (size_t p = 0; p < vertexCount; p++) {
+        locked[p] = wedgeCount[p] > 1;
+    }
+
+    // open borders and non manifold edges of the welded mesh are locked as well
+    {
+        std::unordered_map<uint64_t, unsigned int> edges;
+        edges.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                edges[edgeKey(position[result[i + k]], position[result[i + (k + 1) % 3]])]++;
+            }
+        }
+        for (const auto& edge: edges) {
+            const unsigned int a = static_cast<unsigned int>(edge.first >> 32);
+            const unsigned int b = static_cast<unsigned int>(edge.first & 0xffffffffu);
+            if (edge.second > 1 || edges.find(edgeKey(b, a)) == edges.end()) {
+                locked[a] = 1;
+                locked[b] = 1;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const glm::vec3& p0 = vertices[result[i]].position;
+        const glm::vec3& p1 = vertices[result[i + 1]].position;
+        const glm::vec3& p2 = vertices[result[i + 2]].position;
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(normal);
+        if (length == 0.f) {
+            continue;
+        }
+        normal = normal / length;
+        const float d = -glm::dot(normal, p0);
+        for (int k = 0; k < 3; k++) {
+            quadrics[position[result[i + k]]].addPlane(normal, d, length * 0.5);
+        }
+    }
+
+    std::vector<unsigned int> remap(vertexCount);
+    std::iota(remap.begin(), remap.end(), 0u);
+    std::vector<Collapse> candidates;
+    std::vector<char> touched(vertexCount);
+    std::vector<unsigned int> triangleOffsets(vertexCount + 1);
+    std::vector<unsigned int> triangleFill(vertexCount);
+    std::vector<unsigned int> triangles;
+    float maxError = 0.f;
+
+    // a collapse must keep its wedges consistent and must not flip any remaining triangle around the source
+    auto isValid = [&](const Collapse& collapse) {
+        const glm::vec3& targetPosition = vertices[collapse.targetWedge].position;
+        for (unsigned int a = triangleOffsets[collapse.source]; a < triangleOffsets[collapse.source + 1]; a++) {
+            const unsigned int* corner = &result[triangles[a] * 3];
+            bool hasTarget = false;
+            for (int k = 0; k < 3; k++) {
+                if (position[corner[k]] == collapse.target) {
+                    hasTarget = true;
+                    if (corner[k] != collapse.targetWedge) {
+                        return false;
+                    }
+                }
+            }
+            if (hasTarget) {
+                continue;   // degenerates and is removed
+            }
+            glm::vec3 before[3], after[3];
+            for (int k = 0; k < 3; k++) {
+                before[k] = vertices[corner[k]].position;
+                after[k] = position[corner[k]] == collapse.source ? targetPosition : before[k];
+            }
+            const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if (glm::dot(normalBefore, normalAfter) <= 0.f) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // passes of greedy cheapest-first collapses, each position changes at most once per pass
+    while (result.size() > targetIndexCount) {
+        const size_t triangleCount = result.size() / 3;
+
+        candidates.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                const unsigned int va = result[i + k];
+                const unsigned int vb = result[i + (k + 1) % 3];
+                const unsigned int pa = position[va];
+                const unsigned int pb = position[vb];
+                if (pa == pb || (locked[pa] && locked[pb])) {
+                    continue;
+                }
+                Quadric quadric = quadrics[pa];
+                quadric.add(quadrics[pb]);
+                if (!locked[pa]) {
+                    candidates.push_back(Collapse {pa, pb, va, vb, quadric.error(vertices[vb].position)});
+                }
+                if (!locked[pb]) {
+                    candidates.push_back(Collapse {pb, pa, vb, va, quadric.error(vertices[va].position)});
+                }
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        // position -> triangles of the current result
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+        for (unsigned int index: result) {
+            triangleOffsets[position[index] + 1]++;
+        }
+        for (size_t p = 0; p < vertexCount; p++) {
+            triangleOffsets[p + 1] += triangleOffsets[p];
+        }
+        triangles.resize(result.size());
+        std::copy(triangleOffsets.begin(), triangleOffsets.end() - 1, triangleFill.begin());
+        for (size_t i = 0; i < result.size(); i++) {
+            triangles[triangleFill[position[result[i]]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        std::fill(touched.begin(), touched.end(), 0);
+        const size_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+        size_t removed = 0;
+        for (const Collapse& collapse: candidates) {
+            if (touched[collapse.source] || touched[collapse.target] || !isValid(collapse)) {
+                continue;
+            }
+            remap[collapse.sourceWedge] = collapse.targetWedge;
+            quadrics[collapse.target].add(quadrics[collapse.source]);
+            maxError = std::max(maxError, static_cast<float>(std::sqrt(collapse.cost)));
+
+            for (unsigned int a = triangleOffsets[collapse.source]; a < triangleOffsets[collapse.source + 1]; a++) {
+                const unsigned int* corner = &result[triangles[a] * 3];
+                bool hasTarget = false;
+                for (int k = 0; k < 3; k++) {
+                    touched[position[corner[k]]] = 1;
+                    hasTarget = hasTarget || position[corner[k]] == collapse.target;
+                }
+                removed += hasTarget;
+            }
+            if (removed >= trianglesToRemove) {
+                break;
+            }
+        }
+        if (removed == 0) {
+            break;
+        }
+
+        // targets are never collapsed in the same pass, one remap hop is enough
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const unsigned int a = remap[result[i]];
+            const unsigned int b = remap[result[i + 1]];
+            const unsigned int c = remap[result[i + 2]];
+            if (position[a] == position[b] || position[b] == position[c] || position[c] == position[a]) {
+                continue;
+            }
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (error) {
+        *error = maxError;
+    }
+    return result;
+}
+
+std::vector<MeshData> splitMesh(MeshData&& mesh, size_t maxVertices) {
+    std::vector<MeshData> chunks;
+    if (mesh.vertices.size() <= maxVertices || maxVertices < 3 || !mesh.lods.empty()
+        || !indicesInRange(mesh.indices, mesh.vertices.size())) {
+        chunks.push_back(std::move(mesh));
+        return chunks;
+    }
+
+    // owner[v] is the chunk v was last copied into, remap[v] its index there
+    const size_t NO_CHUNK = static_cast<size_t>(-1);
+    std::vector<size_t> owner(mesh.vertices.size(), NO_CHUNK);
+    std::vector<unsigned int> remap(mesh.vertices.size(), 0);
+    const size_t indexCount = mesh.indices.size() - mesh.indices.size() % 3;
+    for (size_t t = 0; t < indexCount; t += 3) {
+        size_t missing = 0;
+        for (int k = 0; k < 3; k++) {
+            missing += owner[mesh.indices[t + k]] != chunks.size() - 1 ? 1 : 0;
+        }
+        if (chunks.empty() || chunks.back().vertices.size() + missing > maxVertices) {
+            chunks.emplace_back();
+            chunks.back().textures = mesh.textures;
+            chunks.back().materialIndex = mesh.materialIndex;
+        }
+
+        MeshData& chunk = chunks.back();
+        const size_t current = chunks.size() - 1;
+        for (int k = 0; k < 3; k++) {
+            const unsigned int v = mesh.indices[t + k];
+            if (owner[v] != current) {
+                owner[v] = current;
+                remap[v] = static_cast<unsigned int>(chunk.vertices.size());
+                chunk.vertices.push_back(mesh.vertices[v]);
+            }
+            chunk.indices.push_back(remap[v]);
+        }
+    }
+    return chunks;
+}
+
+void buildLodChain(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, std::vector<MeshLod>& lods) {
+    static const float ratios[] = {0.5f, 0.25f, 0.125f};
+
+    lods.clear();
+    indices.resize(indices.size() - indices.size() % 3);
+    const size_t baseCount = indices.size();
+    lods.push_back(MeshLod {0, static_cast<uint32_t>(baseCount), 0.f});
+
+    std::vector<unsigned int> previous(indices);
+    float chainError = 0.f;
+    for (float ratio: ratios) {
+        if (lods.size() >= static_cast<size_t>(MESH_MAX_LODS)) {
+            break;
+        }
+        float lodError = 0.f;
+        std::vector<unsigned int> lod = simplify(previous, vertices, static_cast<size_t>(baseCount / 3 * ratio) * 3, &lodError);
+        // a level that is not clearly smaller only costs memory
+        if (lod.empty() || lod.size() > previous.size() * 8 / 10) {
+            break;
+        }
+        optimizeVertexCache(lod, vertices.size());
+        // each level is simplified from the previous one, the distances add up
+        chainError += lodError;
+        lods.push_back(MeshLod {static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lod.size()), chainError});
+        indices.insert(indices.end(), lod.begin(), lod.end());
+        previous.swap(lod);
+    }
+}
+
+}
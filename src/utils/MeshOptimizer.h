@@ -0,0 +1,59 @@
+#ifndef OPENGL_UTILS_MESH_OPTIMIZER_H
+#define OPENGL_UTILS_MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+#include "utils/IndexFormat.h"
+#include "utils/Mesh.h"
+
+/*
+ * Import time index/vertex reordering for triangle lists.
+ * All functions are pure cpu work and safe to run on worker threads.
+ *
+ * Typical order:
+ *   splitMesh            -> (optional) chunks small enough for 16 bit indices
+ *   optimizeVertexCache  -> triangles ordered for post transform cache reuse
+ *   optimizeOverdraw     -> (optional) cache friendly clusters sorted front to back-ish
+ *   optimizeVertexFetch  -> vertices reordered by first use
+ *   buildLodChain        -> (optional) simplified index ranges sharing the vertex buffer
+ */
+namespace MeshOptimizer {
+
+struct VertexCacheStats {
+    float acmr = 0.f;   // average cache miss ratio, transformed vertices per triangle (0.5 .. 3)
+    float atvr = 0.f;   // average transform to vertex ratio, transformed / unique vertices (1 is ideal)
+};
+
+// FIFO post transform cache simulation
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+// Tom Forsyth's linear speed vertex cache optimisation
+void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+// splits the cache optimized order into clusters at cache boundaries and sorts them outside-in
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices);
+
+// reorders vertices by first reference and drops unreferenced ones
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+/*
+ * quadric error metric edge collapse onto existing vertices, the result indexes the same vertex buffer.
+ * Border, seam (several vertices sharing a position) and non manifold vertices never move so no cracks
+ * open up; meshes with many uv seams stop early. error receives the largest collapse distance in model units.
+ */
+std::vector<unsigned int> simplify(const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                   size_t targetIndexCount, float* error = nullptr);
+
+/*
+ * cuts a mesh into chunks of at most maxVertices vertices each, triangles keep their order and every chunk
+ * gets its own vertex buffer in first use order. Shared vertices along the cuts are duplicated.
+ * Meshes that already fit, carry LOD ranges or have out of range indices are returned unchanged.
+ */
+std::vector<MeshData> splitMesh(MeshData&& mesh, size_t maxVertices = INDEX_16_MAX_VERTICES);
+
+// appends 50% / 25% / 12.5% levels to indices and fills lods (level 0 included), stops when a level barely shrinks
+void buildLodChain(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, std::vector<MeshLod>& lods);
+
+}
+
+#endif
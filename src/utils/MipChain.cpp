@@ -0,0 +1,301 @@
+#include "MipChain.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIP_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIP_SIMD_NEON 1
+#endif
+
+namespace {
+
+// linear light is kept in 14 bits: four samples still fit a 16 bit lane and every sRGB byte round trips
+constexpr uint32_t LINEAR_MAX = (1u << 14) - 1;
+
+// levels smaller than this are not worth splitting across the pool
+constexpr size_t PARALLEL_MIN_PIXELS = 256 * 256;
+constexpr int BAND_ROWS = 32;
+
+std::atomic<bool> simdEnabled {true};
+
+struct SrgbTables {
+    uint16_t decode[256];               // sRGB byte -> linear
+    uint16_t linear[256];               // alpha byte -> same 14 bit scale, no curve
+    unsigned char encode[LINEAR_MAX + 1];
+
+    SrgbTables() {
+        for (int i = 0; i < 256; i++) {
+            const double c = i / 255.0;
+            const double l = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+            decode[i] = static_cast<uint16_t>(std::lround(l * LINEAR_MAX));
+            linear[i] = static_cast<uint16_t>((i * LINEAR_MAX + 127) / 255);
+        }
+        for (uint32_t i = 0; i <= LINEAR_MAX; i++) {
+            const double l = static_cast<double>(i) / LINEAR_MAX;
+            const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            encode[i] = static_cast<unsigned char>(std::lround(std::min(c, 1.0) * 255.0));
+        }
+    }
+};
+
+const SrgbTables& srgbTables() {
+    static const SrgbTables tables;
+    return tables;
+}
+
+// dst[i] = a[i] + b[i]
+void addRows(const unsigned char* a, const unsigned char* b, uint16_t* dst, size_t count, bool simd) {
+    size_t i = 0;
+    if (simd) {
+#if MIP_SIMD_AVX2
+        for (; i + 16 <= count; i += 16) {
+            const __m256i wa = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+            const __m256i wb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi16(wa, wb));
+        }
+#endif
+#if MIP_SIMD_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_add_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero)));
+        }
+#elif MIP_SIMD_NEON
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16_t va = vld1q_u8(a + i);
+            const uint8x16_t vb = vld1q_u8(b + i);
+            vst1q_u16(dst + i, vaddl_u8(vget_low_u8(va), vget_low_u8(vb)));
+            vst1q_u16(dst + i + 8, vaddl_u8(vget_high_u8(va), vget_high_u8(vb)));
+        }
+#endif
+    }
+    for (; i < count; i++) {
+        dst[i] = static_cast<uint16_t>(a[i] + b[i]);
+    }
+}
+
+// like addRows but in linear light, table lookups do not vectorize without a gather
+void addRowsSrgb(const unsigned char* a, const unsigned char* b, uint16_t* dst, int pixels, int channels) {
+    const SrgbTables& tables = srgbTables();
+    for (int x = 0; x < pixels; x++) {
+        const size_t base = static_cast<size_t>(x) * channels;
+        for (int c = 0; c < 3; c++) {
+            dst[base + c] = static_cast<uint16_t>(tables.decode[a[base + c]] + tables.decode[b[base + c]]);
+        }
+        if (channels == 4) {
+            dst[base + 3] = static_cast<uint16_t>(tables.linear[a[base + 3]] + tables.linear[b[base + 3]]);
+        }
+    }
+}
+
+// dst[x * channels + c] = (sum[2x * channels + c] + sum[(2x + 1) * channels + c] + 2) / 4
+void averagePairs(const uint16_t* sum, uint16_t* dst, int outWidth, int channels, bool simd) {
+    int x = 0;
+    if (simd && channels == 4) {
+#if MIP_SIMD_AVX2
+        const __m256i two8 = _mm256_set1_epi16(2);
+        for (; x + 4 <= outWidth; x += 4) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sum + x * 8));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sum + x * 8 + 16));
+            __m256i s = _mm256_add_epi16(_mm256_unpacklo_epi64(a, b), _mm256_unpackhi_epi64(a, b));
+            s = _mm256_srli_epi16(_mm256_add_epi16(s, two8), 2);
+            // the 128 bit lanes hold output pixels (0, 2 | 1, 3)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_permute4x64_epi64(s, _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+#endif
+#if MIP_SIMD_SSE2
+        const __m128i two = _mm_set1_epi16(2);
+        for (; x + 2 <= outWidth; x += 2) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sum + x * 8));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sum + x * 8 + 8));
+            const __m128i s = _mm_add_epi16(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_srli_epi16(_mm_add_epi16(s, two), 2));
+        }
+#elif MIP_SIMD_NEON
+        for (; x + 2 <= outWidth; x += 2) {
+            const uint16x8_t a = vld1q_u16(sum + x * 8);
+            const uint16x8_t b = vld1q_u16(sum + x * 8 + 8);
+            const uint16x8_t s = vaddq_u16(vcombine_u16(vget_low_u16(a), vget_low_u16(b)), vcombine_u16(vget_high_u16(a), vget_high_u16(b)));
+            vst1q_u16(dst + x * 4, vrshrq_n_u16(s, 2));
+        }
+#endif
+    }
+    for (; x < outWidth; x++) {
+        const uint16_t* left = sum + static_cast<size_t>(x) * 2 * channels;
+        for (int c = 0; c < channels; c++) {
+            dst[static_cast<size_t>(x) * channels + c] = static_cast<uint16_t>((left[c] + left[channels + c] + 2) >> 2);
+        }
+    }
+}
+
+void narrowRow(const uint16_t* src, unsigned char* dst, size_t count, bool simd) {
+    size_t i = 0;
+    if (simd) {
+#if MIP_SIMD_AVX2
+        for (; i + 32 <= count; i += 32) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+#endif
+#if MIP_SIMD_SSE2
+        for (; i + 16 <= count; i += 16) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+        }
+#elif MIP_SIMD_NEON
+        for (; i + 16 <= count; i += 16) {
+            vst1q_u8(dst + i, vcombine_u8(vmovn_u16(vld1q_u16(src + i)), vmovn_u16(vld1q_u16(src + i + 8))));
+        }
+#endif
+    }
+    for (; i < count; i++) {
+        dst[i] = static_cast<unsigned char>(src[i]);
+    }
+}
+
+void encodeSrgbRow(const uint16_t* src, unsigned char* dst, int pixels, int channels) {
+    const SrgbTables& tables = srgbTables();
+    for (int x = 0; x < pixels; x++) {
+        const size_t base = static_cast<size_t>(x) * channels;
+        for (int c = 0; c < 3; c++) {
+            dst[base + c] = tables.encode[src[base + c]];
+        }
+        if (channels == 4) {
+            dst[base + 3] = static_cast<unsigned char>((src[base + 3] * 255u + LINEAR_MAX / 2) / LINEAR_MAX);
+        }
+    }
+}
+
+void downsampleRows(const unsigned char* pixels, int width, int height, int channels, bool srgb, Image& half, int rowBegin, int rowEnd) {
+    const bool simd = simdEnabled.load(std::memory_order_relaxed);
+    const size_t sourceRow = static_cast<size_t>(width) * channels;
+    // a 1 pixel wide source has no right neighbour, its only column is used twice
+    const int sourceColumns = std::min(width, half.width * 2);
+    std::vector<uint16_t> sum(static_cast<size_t>(half.width) * 2 * channels);
+    std::vector<uint16_t> average(static_cast<size_t>(half.width) * channels);
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        const unsigned char* row0 = pixels + sourceRow * std::min(y * 2, height - 1);
+        const unsigned char* row1 = pixels + sourceRow * std::min(y * 2 + 1, height - 1);
+        if (srgb) {
+            addRowsSrgb(row0, row1, sum.data(), sourceColumns, channels);
+        } else {
+            addRows(row0, row1, sum.data(), static_cast<size_t>(sourceColumns) * channels, simd);
+        }
+        if (width == 1) {
+            std::copy(sum.begin(), sum.begin() + channels, sum.begin() + channels);
+        }
+        averagePairs(sum.data(), average.data(), half.width, channels, simd);
+
+        unsigned char* out = half.pixels.data() + static_cast<size_t>(y) * half.width * channels;
+        if (srgb) {
+            encodeSrgbRow(average.data(), out, half.width, channels);
+        } else {
+            narrowRow(average.data(), out, average.size(), simd);
+        }
+    }
+}
+
+Image downsample(const unsigned char* pixels, int width, int height, int channels, MipColorSpace colorSpace) {
+    Image half;
+    half.width = std::max(width / 2, 1);
+    half.height = std::max(height / 2, 1);
+    half.channels = channels;
+    half.pixels.resize(static_cast<size_t>(half.width) * half.height * channels);
+    // the curve only applies to color, RG / R images are data
+    const bool srgb = colorSpace == MipColorSpace::SRGB && channels >= 3;
+
+    const size_t outputPixels = static_cast<size_t>(half.width) * half.height;
+    if (outputPixels < PARALLEL_MIN_PIXELS) {
+        downsampleRows(pixels, width, height, channels, srgb, half, 0, half.height);
+        return half;
+    }
+    // nested calls from a worker are fine, parallelFor lets the caller work through the bands itself
+    const size_t bands = (static_cast<size_t>(half.height) + BAND_ROWS - 1) / BAND_ROWS;
+    ThreadPool::getInstance().parallelFor(bands, [&](size_t band) {
+        const int begin = static_cast<int>(band) * BAND_ROWS;
+        downsampleRows(pixels, width, height, channels, srgb, half, begin, std::min(begin + BAND_ROWS, half.height));
+    });
+    return half;
+}
+
+}
+
+Image downsampleImage(const Image& image, MipColorSpace colorSpace) {
+    if (!image.isValid() || image.channels <= 0) {
+        return Image();
+    }
+    return downsample(image.pixels.data(), image.width, image.height, image.channels, colorSpace);
+}
+
+std::vector<Image> buildMipLevels(const unsigned char* pixels, int width, int height, int channels, MipColorSpace colorSpace) {
+    std::vector<Image> levels;
+    if (!pixels || width <= 0 || height <= 0 || channels <= 0) {
+        return levels;
+    }
+    levels.reserve(mipLevelCount(width, height) - 1);
+    const unsigned char* source = pixels;
+    while (width > 1 || height > 1) {
+        levels.push_back(downsample(source, width, height, channels, colorSpace));
+        source = levels.back().pixels.data();
+        width = levels.back().width;
+        height = levels.back().height;
+    }
+    return levels;
+}
+
+std::vector<Image> buildMipLevels(const Image& base, MipColorSpace colorSpace) {
+    return buildMipLevels(base.pixels.data(), base.width, base.height, base.channels, colorSpace);
+}
+
+int mipLevelCount(int width, int height) {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2) {
+        levels++;
+    }
+    return levels;
+}
+
+void uploadMipChain(GLenum target, const unsigned char* pixels, int width, int height, int channels, const std::vector<Image>& levels) {
+    const GLenum format = formatForChannels(channels);
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(target, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    for (size_t i = 0; i < levels.size(); i++) {
+        const Image& level = levels[i];
+        glTexImage2D(target, static_cast<GLint>(i + 1), format, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, level.pixels.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size()));
+}
+
+const char* mipSimdName() {
+#if MIP_SIMD_AVX2
+    return "AVX2";
+#elif MIP_SIMD_SSE2
+    return "SSE2";
+#elif MIP_SIMD_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void setMipSimdEnabled(bool enabled) {
+    simdEnabled.store(enabled, std::memory_order_relaxed);
+}
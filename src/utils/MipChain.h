@@ -0,0 +1,43 @@
+#ifndef OPENGL_UTILS_MIP_CHAIN_H
+#define OPENGL_UTILS_MIP_CHAIN_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include "utils/Image.h"
+
+/*
+ * CPU mip chain, replaces glGenerateMipmap so the filter is the same on every driver and
+ * the work can run on ThreadPool workers instead of the GL thread.
+ * The 2x2 box filter is vectorized (AVX2 / SSE2 / NEON, picked at compile time). 4 channel
+ * images are SIMD end to end, other channel counts only in the vertical pass.
+ */
+enum class MipColorSpace: uint8_t {
+    Linear,     // data textures: normals, masks, roughness
+    SRGB,       // color: averaged in linear light and encoded again, alpha and 1/2 channel images stay linear
+};
+
+// next mip level: 2x2 box filter, odd sizes round down (at least 1 pixel)
+Image downsampleImage(const Image& image, MipColorSpace colorSpace = MipColorSpace::Linear);
+
+// levels 1..n down to 1x1, the base level itself is not copied
+std::vector<Image> buildMipLevels(const unsigned char* pixels, int width, int height, int channels, MipColorSpace colorSpace);
+
+std::vector<Image> buildMipLevels(const Image& base, MipColorSpace colorSpace);
+
+// floor(log2(max(width, height))) + 1
+int mipLevelCount(int width, int height);
+
+/*
+ * glTexImage2D of the base and every level into the texture bound to target (level by level,
+ * unpack alignment 1 for odd RGB rows) and clamps GL_TEXTURE_MAX_LEVEL to the chain.
+ */
+void uploadMipChain(GLenum target, const unsigned char* pixels, int width, int height, int channels, const std::vector<Image>& levels);
+
+// "AVX2", "SSE2", "NEON" or "scalar"
+const char* mipSimdName();
+
+// false forces the scalar kernels, for benchmarks and validation
+void setMipSimdEnabled(bool enabled);
+
+#endif
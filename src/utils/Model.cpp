@@ -6,165 +6,674 @@
 #include "assimp/scene.h"
 #include "assimp/types.h"
 #include "glm/fwd.hpp"
+#include "utils/Hash.h"
+#include "utils/Image.h"
 #include "utils/Mesh.h"
+#include "utils/MeshArena.h"
+#include "utils/MeshCache.h"
+#include "utils/MeshOptimizer.h"
+#include "utils/MipChain.h"
 #include "utils/Texture.h"
-#include <cstring>
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <iterator>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
-#include "utils/stb_define.h"
 
 
-unsigned int TextureFromFile(const char *path, const std::string &directory, bool gamma = false);
 
-Model::Model(const char *path) {
-    loadModel(path);
+// state shared with the background job, outlives the Model if it is destroyed mid load
+struct Model::AsyncLoad {
+    std::atomic<bool> done {false};
+    bool failed = false;
+    std::vector<MeshData> meshes;
+    std::vector<TextureRef> textures;   // unique material textures
+    std::vector<Image> images;          // decoded pixels, same order as textures
+    std::vector<std::vector<Image>> mips;   // levels below each image, built on the worker too
+    glm::vec3 boundsMin {0.f};
+    glm::vec3 boundsMax {0.f};
+    ModelLoadStats stats;
+    size_t nextTexture = 0;
+    size_t nextMesh = 0;
+    bool boundsApplied = false;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 24 vertex box, used as the stand-in while an async model streams in
+static MeshData makeBoxMesh(const glm::vec3& min, const glm::vec3& max) {
+    static const float faces[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    static const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    static const unsigned int quad[6] = {0, 1, 2, 2, 3, 0};
+
+    MeshData data;
+    for (const auto& face: faces) {
+        const glm::vec3 n(face[0], face[1], face[2]);
+        // two tangent axes spanning the face, u x v == n keeps the winding counter clockwise
+        const glm::vec3 u = n.x != 0.f ? glm::vec3(0.f, n.x, 0.f) : glm::vec3(n.y + n.z, 0.f, 0.f);
+        const glm::vec3 v = glm::cross(n, u);
+        const unsigned int base = static_cast<unsigned int>(data.vertices.size());
+        for (const auto& c: corners) {
+            const glm::vec3 p = n + u * c[0] + v * c[1];   // in [-1, 1]^3
+            Vertex vertex;
+            vertex.position = min + (p * 0.5f + glm::vec3(0.5f)) * (max - min);
+            vertex.normal = n;
+            vertex.texcoords = glm::vec2(c[0] * 0.5f + 0.5f, c[1] * 0.5f + 0.5f);
+            data.vertices.push_back(vertex);
+        }
+        for (unsigned int index: quad) {
+            data.indices.push_back(base + index);
+        }
+    }
+    return data;
+}
+
+uint32_t ModelLoadOptions::processFlags() const {
+    uint32_t flags = MESH_PROCESS_NONE;
+    if (optimizeMeshes || optimizeOverdraw) {
+        flags |= MESH_PROCESS_VERTEX_CACHE;
+    }
+    if (optimizeOverdraw) {
+        flags |= MESH_PROCESS_OVERDRAW;
+    }
+    if (generateLods) {
+        flags |= MESH_PROCESS_LOD;
+    }
+    if (splitLargeMeshes) {
+        flags |= MESH_PROCESS_SPLIT;
+    }
+    return flags;
+}
+
+Model::Model(const char *path, const ModelLoadOptions& options): options(options), resident(false), arena(options.arena) {
+    if (arena && arena->getFormat() != options.vertexFormat()) {
+        std::cout << "WARNING::MODEL:: shared arena has a different vertex format, meshes are not packed" << std::endl;
+        arena.reset();
+        this->options.arena.reset();
+        this->options.packMeshes = false;
+    }
+    if (options.async) {
+        loadModelAsync(path);
+    } else {
+        loadModel(path);
+    }
 }
 
 void Model::draw(Shader& shader) {
-    for (unsigned int i = 0; i < meshes.size(); i++) {
-        meshes[i].draw(shader);
+    if (!resident) {
+        if (placeholder) {
+            placeholder->draw(shader);
+        }
+        return;
+    }
+    drawMeshes(shader, false);
+}
+
+void Model::draw(Shader& shader, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) {
+    if (!resident) {
+        if (placeholder) {
+            placeholder->draw(shader);
+        }
+        return;
+    }
+    selectLods(model, view, projection, viewportHeight);
+    drawMeshes(shader, true);
+}
+
+void Model::drawMeshes(Shader& shader, bool useLods) {
+    if (drawOrder.size() != meshes.size()) {
+        drawOrder.resize(meshes.size());
+        std::iota(drawOrder.begin(), drawOrder.end(), 0u);
+        std::stable_sort(drawOrder.begin(), drawOrder.end(), [this](unsigned int a, unsigned int b) {
+            return meshes[a].getMaterialKey() < meshes[b].getMaterialKey();
+        });
+    }
+    // other code may have bound textures since the last draw
+    bindState.reset();
+
+    if (arena) {
+        // one VAO bind for the whole model
+        arena->bind();
+        for (unsigned int i: drawOrder) {
+            meshes[i].drawBatched(shader, useLods ? meshLods[i] : 0, bindState);
+        }
+        arena->unbind();
+        glActiveTexture(GL_TEXTURE0);
+        return;
+    }
+    for (unsigned int i: drawOrder) {
+        meshes[i].draw(shader, useLods ? meshLods[i] : 0, bindState);
     }
 }
 
+void Model::selectLods(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) {
+    drawStats = ModelDrawStats();
+    meshLods.resize(meshes.size());
+
+    const glm::mat4 modelView = view * model;
+    // errors and radii are in model space, scale them by the largest axis scale
+    const float scale = std::sqrt(std::max(glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+                                  std::max(glm::dot(glm::vec3(model[1]), glm::vec3(model[1])), glm::dot(glm::vec3(model[2]), glm::vec3(model[2])))));
+    // projection[2][3] is -1 for perspective and 0 for orthographic projections
+    const bool perspective = projection[2][3] != 0.f;
+    const float pixelsPerUnitAtOne = projection[1][1] * viewportHeight * 0.5f;
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh& mesh = meshes[i];
+        int lod = 0;
+        if (mesh.getLodCount() > 1) {
+            float pixelsPerUnit = pixelsPerUnitAtOne;
+            bool inside = false;
+            if (perspective) {
+                // nearest point of the bounding sphere, the camera looks down -z
+                const float distance = -glm::vec3(modelView * glm::vec4(mesh.getBoundsCenter(), 1.f)).z - mesh.getBoundsRadius() * scale;
+                inside = distance <= 0.f;
+                pixelsPerUnit = inside ? 0.f : pixelsPerUnitAtOne / distance;
+            }
+            if (!inside) {
+                for (int level = mesh.getLodCount() - 1; level > 0; level--) {
+                    if (mesh.getLod(level).error * scale * pixelsPerUnit <= options.lodPixelError) {
+                        lod = level;
+                        break;
+                    }
+                }
+            }
+        }
+        meshLods[i] = lod;
+        drawStats.trianglesFull += mesh.getLod(0).indexCount / 3;
+        drawStats.trianglesDrawn += mesh.getLod(lod).indexCount / 3;
+        drawStats.meshesPerLod[lod]++;
+    }
+}
+
+void Model::prepareArena(size_t vertexCount, size_t indexBytes) {
+    if (!options.packMeshes && !arena) {
+        return;
+    }
+    if (!arena) {
+        arena = std::make_shared<MeshArena>(vertexCount, indexBytes, options.vertexFormat());
+    } else {
+        arena->reserve(arena->getVertexCount() + vertexCount, arena->getIndexBytes() + indexBytes);
+    }
+}
+
+size_t Model::arenaIndexBytes(size_t vertexCount, size_t indexCount) const {
+    const unsigned int maxIndex = vertexCount > 0 ? static_cast<unsigned int>(vertexCount - 1) : 0;
+    return MeshArena::indexBytesFor(indexCount, chooseIndexType(maxIndex, options.byteIndices));
+}
+
+void Model::countUpload(const Mesh& mesh, size_t vertexCount) {
+    loadStats.vertexBytes += vertexCount * vertexStride(options.vertexFormat());
+    loadStats.indexBytes += mesh.getIndexBytes();
+    loadStats.indexBytes32 += mesh.getIndexBytes() / indexTypeSize(mesh.getIndexType()) * sizeof(unsigned int);
+}
+
 void Model::loadModel(const char *path) {
+    const auto start = std::chrono::steady_clock::now();
+    loadStats = ModelLoadStats();
+    resident = true;
+    std::string filepath(path);
+    directory = filepath.substr(0, filepath.find_last_of('/'));
+
+    // the cache is keyed by source content (materials included) + import/processing flags, a stale file is simply a miss
+    uint64_t sourceHash = 0;
+    const bool cacheable = options.useCache && MeshCache::hashSource(filepath, sourceHash);
+    if (cacheable) {
+        MeshCache cache;
+        if (cache.open(MeshCache::cachePathFor(filepath), sourceHash, options.importFlags, options.processFlags())) {
+            loadStats.importMs = elapsedMs(start);
+            loadStats.fromCache = true;
+            loadFromCache(cache);
+            loadStats.meshCount = meshes.size();
+            std::cout << "Model loaded from cache: " << filepath << " (" << meshes.size() << " meshes, " << elapsedMs(start) << " ms)" << std::endl;
+            return;
+        }
+    }
+
+    std::vector<MeshData> data;
+    if (!importMeshes(filepath, options, cacheable, sourceHash, data, loadStats)) {
+        return;
+    }
+    uploadMeshes(data);
+    loadStats.meshCount = meshes.size();
+
+    std::cout << "Model imported with Assimp: " << filepath << " (" << meshes.size() << " meshes, " << elapsedMs(start) << " ms"
+              << " | import " << loadStats.importMs << " / convert " << loadStats.convertMs
+              << " / textures " << loadStats.textureMs << " / upload " << loadStats.uploadMs << ")" << std::endl;
+}
+
+void Model::loadModelAsync(const char *path) {
+    const std::string filepath(path);
+    directory = filepath.substr(0, filepath.find_last_of('/'));
+    pending = std::make_shared<AsyncLoad>();
+    placeholder = std::make_unique<Mesh>(makeBoxMesh(glm::vec3(-0.5f), glm::vec3(0.5f)), std::vector<Texture2D>(), nullptr, options.vertexFormat());
+
+    // the arena owns GL buffers, the job must not hold the reference that could drop last on a pool thread
+    ModelLoadOptions importOptions = options;
+    importOptions.arena.reset();
+    ThreadPool::getInstance().submit([state = pending, filepath, directory = directory, options = std::move(importOptions)]() {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sourceHash = 0;
+        const bool cacheable = options.useCache && MeshCache::hashSource(filepath, sourceHash);
+
+        MeshCache cache;
+        if (cacheable && cache.open(MeshCache::cachePathFor(filepath), sourceHash, options.importFlags, options.processFlags())) {
+            // the mapping does not outlive this job, copy out here instead of on the GL thread
+            state->meshes.resize(cache.getMeshCount());
+            for (size_t i = 0; i < cache.getMeshCount(); i++) {
+                MeshCacheView view = cache.getMesh(i);
+                state->meshes[i].vertices.assign(view.vertices, view.vertices + view.vertexCount);
+                state->meshes[i].indices.assign(view.indices, view.indices + view.indexCount);
+                state->meshes[i].textures = std::move(view.textures);
+                state->meshes[i].lods = std::move(view.lods);
+            }
+            cache.close();
+            state->stats.importMs = elapsedMs(start);
+            state->stats.fromCache = true;
+        } else if (!importMeshes(filepath, options, cacheable, sourceHash, state->meshes, state->stats)) {
+            state->failed = true;
+            state->done = true;
+            return;
+        }
+
+        bool hasBounds = false;
+        for (const auto& mesh: state->meshes) {
+            for (const auto& vertex: mesh.vertices) {
+                state->boundsMin = hasBounds ? glm::min(state->boundsMin, vertex.position) : vertex.position;
+                state->boundsMax = hasBounds ? glm::max(state->boundsMax, vertex.position) : vertex.position;
+                hasBounds = true;
+            }
+            for (const auto& ref: mesh.textures) {
+                bool known = false;
+                for (const auto& texture: state->textures) {
+                    if (texture.path == ref.path) {
+                        known = true;
+                        break;
+                    }
+                }
+                if (!known) {
+                    state->textures.push_back(ref);
+                }
+            }
+        }
+
+        start = std::chrono::steady_clock::now();
+        state->images.resize(state->textures.size());
+        state->mips.resize(state->textures.size());
+        ThreadPool::getInstance().parallelFor(state->textures.size(), [&state, &directory](size_t i) {
+            const std::string path = directory + '/' + state->textures[i].path;
+            // resident already (another model), update() picks it up from the cache
+            if (!TextureCache::getInstance().contains(path) && loadImage(path, state->images[i], true)) {
+                state->mips[i] = buildMipLevels(state->images[i], MipColorSpace::SRGB);
+            }
+        });
+        state->stats.textureMs = elapsedMs(start);
+        state->done = true;
+    });
+}
+
+bool Model::update(const UploadBudget& budget) {
+    if (resident) {
+        return true;
+    }
+    if (!pending || !pending->done) {
+        return false;
+    }
+
+    AsyncLoad& state = *pending;
+    if (state.failed) {
+        std::cout << "ERROR::MODEL:: async load failed for " << directory << std::endl;
+        pending.reset();
+        placeholder.reset();
+        resident = true;
+        return true;
+    }
+    if (!state.boundsApplied) {
+        placeholder = std::make_unique<Mesh>(makeBoxMesh(state.boundsMin, state.boundsMax), std::vector<Texture2D>(), nullptr, options.vertexFormat());
+        loadStats = state.stats;
+        size_t vertexTotal = 0, indexTotal = 0;
+        for (const auto& data: state.meshes) {
+            vertexTotal += data.vertices.size();
+            indexTotal += arenaIndexBytes(data.vertices.size(), data.indices.size());
+        }
+        prepareArena(vertexTotal, indexTotal);
+        state.boundsApplied = true;
+    }
+
+    // pixels are handed to the TextureUploadQueue, which has its own per frame budget
+    while (state.nextTexture < state.images.size()) {
+        const auto start = std::chrono::steady_clock::now();
+        const TextureRef& ref = state.textures[state.nextTexture];
+        addTexture(std::move(state.images[state.nextTexture]), std::move(state.mips[state.nextTexture]), ref.path.c_str(), ref.type);
+        state.nextTexture++;
+        loadStats.textureMs += elapsedMs(start);
+    }
+
+    UploadBudgetScope scope(budget);
+
+    while (state.nextMesh < state.meshes.size()) {
+        MeshData& data = state.meshes[state.nextMesh];
+        const size_t bytes = data.vertices.size() * sizeof(Vertex) + data.indices.size() * sizeof(unsigned int);
+        if (!scope.canUpload(bytes)) {
+            return false;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<Texture2D> textures;
+        textures.reserve(data.textures.size());
+        for (const auto& ref: data.textures) {
+            textures.push_back(loadTexture(ref.path.c_str(), ref.type));
+        }
+        const size_t vertexCount = data.vertices.size();
+        meshes.emplace_back(std::move(data), textures, arena, options.vertexFormat(), options.byteIndices);
+        countUpload(meshes.back(), vertexCount);
+        scope.consume(bytes);
+        state.nextMesh++;
+        loadStats.uploadMs += elapsedMs(start);
+    }
+
+    loadStats.meshCount = meshes.size();
+    std::cout << "Model resident: " << directory << " (" << meshes.size() << " meshes"
+              << " | import " << loadStats.importMs << " / convert " << loadStats.convertMs
+              << " / textures " << loadStats.textureMs << " / upload " << loadStats.uploadMs << " ms)" << std::endl;
+    pending.reset();
+    placeholder.reset();
+    resident = true;
+    return true;
+}
+
+void Model::loadFromCache(const MeshCache& cache) {
+    size_t vertexTotal = 0, indexTotal = 0;
+    std::vector<TextureRef> refs;
+    for (size_t i = 0; i < cache.getMeshCount(); i++) {
+        const MeshCacheView view = cache.getMesh(i);
+        vertexTotal += view.vertexCount;
+        indexTotal += arenaIndexBytes(view.vertexCount, view.indexCount);
+        refs.insert(refs.end(), view.textures.begin(), view.textures.end());
+    }
+    prepareArena(vertexTotal, indexTotal);
+
+    const auto texturesStart = std::chrono::steady_clock::now();
+    acquireTextures(refs);
+    loadStats.textureMs += elapsedMs(texturesStart);
+
+    meshes.reserve(cache.getMeshCount());
+    for (size_t i = 0; i < cache.getMeshCount(); i++) {
+        MeshCacheView view = cache.getMesh(i);
+        std::vector<Texture2D> textures;
+        textures.reserve(view.textures.size());
+        auto stepStart = std::chrono::steady_clock::now();
+        for (const auto& ref: view.textures) {
+            textures.push_back(loadTexture(ref.path.c_str(), ref.type));
+        }
+        loadStats.textureMs += elapsedMs(stepStart);
+
+        // vertex/index data is uploaded directly from the mapping
+        stepStart = std::chrono::steady_clock::now();
+        meshes.emplace_back(view.vertices, view.vertexCount, view.indices, view.indexCount, textures, arena, options.vertexFormat(),
+                            options.byteIndices);
+        countUpload(meshes.back(), view.vertexCount);
+        if (!view.lods.empty()) {
+            meshes.back().setLods(view.lods);
+        }
+        loadStats.uploadMs += elapsedMs(stepStart);
+    }
+}
+
+void Model::uploadMeshes(std::vector<MeshData>& data) {
+    auto stepStart = std::chrono::steady_clock::now();
+    std::vector<TextureRef> refs;
+    for (const auto& mesh: data) {
+        refs.insert(refs.end(), mesh.textures.begin(), mesh.textures.end());
+    }
+    acquireTextures(refs);
+    std::vector<std::vector<Texture2D>> textures(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        for (const auto& ref: data[i].textures) {
+            textures[i].push_back(loadTexture(ref.path.c_str(), ref.type));
+        }
+    }
+    loadStats.textureMs += elapsedMs(stepStart);
+
+    stepStart = std::chrono::steady_clock::now();
+    size_t vertexTotal = 0, indexTotal = 0;
+    for (const auto& mesh: data) {
+        vertexTotal += mesh.vertices.size();
+        indexTotal += arenaIndexBytes(mesh.vertices.size(), mesh.indices.size());
+    }
+    prepareArena(vertexTotal, indexTotal);
+
+    meshes.reserve(meshes.size() + data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        const size_t vertexCount = data[i].vertices.size();
+        meshes.emplace_back(std::move(data[i]), textures[i], arena, options.vertexFormat(), options.byteIndices);
+        countUpload(meshes.back(), vertexCount);
+    }
+    loadStats.uploadMs += elapsedMs(stepStart);
+}
+
+bool Model::importMeshes(const std::string& filepath, const ModelLoadOptions& options, bool cacheable, uint64_t sourceHash,
+                         std::vector<MeshData>& out, ModelLoadStats& stats) {
+    auto stepStart = std::chrono::steady_clock::now();
     Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+    const aiScene *scene = importer.ReadFile(filepath.c_str(), options.importFlags);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         std::cout << "ERROR:ASSIMP::" << importer.GetErrorString() << std::endl;
-        return;
+        return false;
+    }
+    stats.importMs = elapsedMs(stepStart);
+
+    std::vector<const aiMesh*> sceneMeshes;
+    flattenNode(scene->mRootNode, scene, sceneMeshes);
+
+    // vertex/index conversion fans out over the pool, GL work stays on the context thread
+    stepStart = std::chrono::steady_clock::now();
+    const uint32_t processFlags = options.processFlags();
+    std::vector<std::vector<MeshData>> converted(sceneMeshes.size());
+    ThreadPool::getInstance().parallelFor(sceneMeshes.size(), [&sceneMeshes, &converted, processFlags](size_t i) {
+        MeshData data = convertMesh(sceneMeshes[i]);
+        if (processFlags & MESH_PROCESS_SPLIT) {
+            converted[i] = MeshOptimizer::splitMesh(std::move(data));
+        } else {
+            converted[i].push_back(std::move(data));
+        }
+    });
+    // chunks of a split mesh follow each other, everything below works per chunk
+    out.clear();
+    for (size_t i = 0; i < converted.size(); i++) {
+        if (converted[i].size() > 1) {
+            std::cout << "Split: mesh " << i << " (" << sceneMeshes[i]->mNumVertices << " vertices) into "
+                      << converted[i].size() << " chunks" << std::endl;
+        }
+        for (auto& chunk: converted[i]) {
+            out.push_back(std::move(chunk));
+        }
     }
 
-    std::string filepath(path);
-    directory = filepath.substr(0, filepath.find_last_of('/'));
+    const bool quantize = options.quantizeVertices;
+    std::vector<MeshOptimizer::VertexCacheStats> before(out.size()), after(out.size());
+    std::vector<QuantizationError> quantizationErrors(quantize ? out.size() : 0);
+    ThreadPool::getInstance().parallelFor(out.size(), [&out, processFlags, &before, &after, quantize, &quantizationErrors](size_t i) {
+        if (processFlags & MESH_PROCESS_VERTEX_CACHE) {
+            MeshData& data = out[i];
+            before[i] = MeshOptimizer::analyzeVertexCache(data.indices, data.vertices.size());
+            MeshOptimizer::optimizeVertexCache(data.indices, data.vertices.size());
+            if (processFlags & MESH_PROCESS_OVERDRAW) {
+                MeshOptimizer::optimizeOverdraw(data.indices, data.vertices);
+            }
+            MeshOptimizer::optimizeVertexFetch(data.vertices, data.indices);
+            after[i] = MeshOptimizer::analyzeVertexCache(data.indices, data.vertices.size());
+        }
+        if (processFlags & MESH_PROCESS_LOD) {
+            MeshOptimizer::buildLodChain(out[i].indices, out[i].vertices, out[i].lods);
+        }
+        if (quantize) {
+            quantizationErrors[i] = measureQuantizationError(out[i].vertices.data(), out[i].vertices.size());
+        }
+    });
+    if (processFlags & MESH_PROCESS_VERTEX_CACHE) {
+        for (size_t i = 0; i < out.size(); i++) {
+            const size_t triangles = (out[i].lods.empty() ? out[i].indices.size() : out[i].lods[0].indexCount) / 3;
+            std::cout << "MeshOptimizer: mesh " << i << " (" << triangles << " triangles)"
+                      << " ACMR " << before[i].acmr << " -> " << after[i].acmr
+                      << ", ATVR " << before[i].atvr << " -> " << after[i].atvr << std::endl;
+        }
+    }
+    if (processFlags & MESH_PROCESS_LOD) {
+        for (size_t i = 0; i < out.size(); i++) {
+            std::cout << "LOD: mesh " << i << " triangles";
+            for (const auto& lod: out[i].lods) {
+                std::cout << " " << lod.indexCount / 3 << " (error " << lod.error << ")";
+            }
+            std::cout << std::endl;
+        }
+    }
+    if (quantize) {
+        // 16 bit positions over the AABB: expected max error is about extent / 65535 * sqrt(3) / 2
+        QuantizationError worst;
+        for (size_t i = 0; i < quantizationErrors.size(); i++) {
+            const QuantizationError& error = quantizationErrors[i];
+            std::cout << "Quantization: mesh " << i << " (" << out[i].vertices.size() << " vertices)"
+                      << " position " << error.maxPositionError << " (extent " << error.extent << ")"
+                      << ", normal " << error.maxNormalError << " deg"
+                      << ", uv " << error.maxTexcoordError << std::endl;
+            worst.maxPositionError = std::max(worst.maxPositionError, error.maxPositionError);
+            worst.maxNormalError = std::max(worst.maxNormalError, error.maxNormalError);
+            worst.maxTexcoordError = std::max(worst.maxTexcoordError, error.maxTexcoordError);
+        }
+        std::cout << "Quantization: max position error " << worst.maxPositionError << ", max normal error " << worst.maxNormalError
+                  << " deg, max uv error " << worst.maxTexcoordError << std::endl;
+    }
 
-    processNode(scene->mRootNode, scene);
+    // texture references are resolved once per material
+    std::vector<std::vector<TextureRef>> materialTextures(scene->mNumMaterials);
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+        materialTextures[i] = collectMaterialTextures(scene->mMaterials[i], aiTextureType_DIFFUSE, "texture_diffuse");
+        // std::vector<Texture> specularMaps = collectMaterialTextures(material, aiTextureType_SPECULAR, TextureType::SPECULAR);
+        // std::vector<Texture> normalMaps = collectMaterialTextures(material, aiTextureType_NORMALS, TextureType::NORMAL);
+    }
+    for (auto& data: out) {
+        if (data.materialIndex < materialTextures.size()) {
+            data.textures = materialTextures[data.materialIndex];
+        }
+    }
+    stats.convertMs = elapsedMs(stepStart);
 
+    if (cacheable && !MeshCache::write(MeshCache::cachePathFor(filepath), sourceHash, options.importFlags, processFlags, out)) {
+        std::cout << "WARNING::MODEL:: failed to write mesh cache for " << filepath << std::endl;
+    }
+    return true;
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene) {
+void Model::flattenNode(const aiNode *node, const aiScene *scene, std::vector<const aiMesh*>& out) {
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene));
+        out.push_back(scene->mMeshes[node->mMeshes[i]]);
     }
     for (unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene);
+        flattenNode(node->mChildren[i], scene, out);
     }
-
 }
 
-Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene) {
-    std::vector<Vertex> vertices {};
-    std::vector<unsigned int> indices {};
-    std::vector<Texture2D> textures {};
+MeshData Model::convertMesh(const aiMesh *mesh) {
+    MeshData data;
+    data.materialIndex = mesh->mMaterialIndex;
 
     // vertices
+    data.vertices.resize(mesh->mNumVertices);
+    const bool hasNormals = mesh->HasNormals();
+    const aiVector3D *texcoords = mesh->mTextureCoords[0];
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-        Vertex vertex;
+        Vertex& vertex = data.vertices[i];
 
         vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
 
-        if (mesh->HasNormals()) {
+        if (hasNormals) {
             vertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+        } else {
+            vertex.normal = glm::vec3(0.f, 0.f, 0.f);
         }
 
-        if (mesh->mTextureCoords[0]) {
-            vertex.texcoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+        if (texcoords) {
+            vertex.texcoords = glm::vec2(texcoords[i].x, texcoords[i].y);
         } else {
             vertex.texcoords = glm::vec2(0.f, 0.f);
         }
-
-        vertices.push_back(vertex);
     }
 
-    // indices
+    // indices, faces are triangles after aiProcess_Triangulate
+    data.indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-        aiFace face = mesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; j++) {
-            indices.push_back(face.mIndices[j]);
-        }
+        const aiFace& face = mesh->mFaces[i];
+        data.indices.insert(data.indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
     }
 
-    // textures
-    aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-    std::vector<Texture2D> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-    textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-    // std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, TextureType::SPECULAR);
-    // textures.insert(textures.end(), std::make_move_iterator(specularMaps.begin()), std::make_move_iterator(specularMaps.end()));
-    // std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_NORMALS, TextureType::NORMAL);
-    // textures.insert(textures.end(), std::make_move_iterator(normalMaps.begin()), std::make_move_iterator(normalMaps.end()));
-
-    return Mesh(vertices, indices, textures);
+    return data;
 }
 
-std::vector<Texture2D> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type, const std::string& typeName) {
-    std::vector<Texture2D> textures;
+std::vector<TextureRef> Model::collectMaterialTextures(const aiMaterial *mat, aiTextureType type, const std::string& typeName) {
+    std::vector<TextureRef> textures;
     for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
         aiString str;
         mat->GetTexture(type, i, &str);
-        bool skip = false;
+        textures.push_back(TextureRef {typeName, str.C_Str()});
+    }
+    return textures;
+}
 
-        for (unsigned int j = 0; j < textures_loaded.size(); j++) {
-            if (std::strcmp(textures_loaded[j].path.c_str(), str.C_Str()) == 0) {
-                textures.push_back(textures_loaded[j]);
-                skip = true;
-                break;
-            }
+void Model::acquireTextures(const std::vector<TextureRef>& refs) {
+    std::vector<std::string> names;
+    std::vector<std::string> paths;
+    for (const auto& ref: refs) {
+        if (textures_loaded.count(ref.path) == 0 && std::find(names.begin(), names.end(), ref.path) == names.end()) {
+            names.push_back(ref.path);
+            paths.push_back(directory + '/' + ref.path);
         }
-
-        if (!skip) {
-            Texture2D texture;
-            texture.id = TextureFromFile(str.C_Str(), this->directory);
-            texture.type = typeName;
-            texture.path = str.C_Str();
-
-            textures_loaded.push_back(texture);
-            textures.push_back(texture);
+    }
+    std::vector<TextureCache::Handle> handles = TextureCache::getInstance().acquireAll(paths);
+    for (size_t i = 0; i < names.size(); i++) {
+        if (!handles[i]) {
+            std::cout << "Texture failed to load at path: " << names[i] << std::endl;
         }
-
+        textures_loaded.emplace(names[i], std::move(handles[i]));
     }
-    return textures;
 }
 
+Texture2D Model::loadTexture(const char *path, const std::string& typeName) {
+    auto it = textures_loaded.find(path);
+    if (it == textures_loaded.end()) {
+        // shared with every other model using the same file
+        it = textures_loaded.emplace(path, TextureCache::getInstance().acquire(directory + '/' + path)).first;
+        if (!it->second) {
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+        }
+    }
 
-unsigned int TextureFromFile(const char *path, const std::string &directory, bool gamma)
-{
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    stbi_set_flip_vertically_on_load(true);
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    Texture2D texture;
+    texture.id = it->second ? it->second->id : 0;
+    texture.type = typeName;
+    texture.path = path;
+    return texture;
+}
 
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+Texture2D Model::addTexture(Image&& image, std::vector<Image>&& mips, const char *path, const std::string& typeName) {
+    auto it = textures_loaded.find(path);
+    if (it == textures_loaded.end()) {
+        TextureCache::Handle handle = image.isValid()
+            ? TextureCache::getInstance().insertAsync(directory + '/' + path, std::move(image), std::move(mips))
+            : TextureCache::getInstance().acquireAsync(directory + '/' + path);
+        it = textures_loaded.emplace(path, handle).first;
     }
 
-    return textureID;
-}
\ No newline at end of file
+    Texture2D texture;
+    texture.id = it->second ? it->second->id : 0;
+    texture.type = typeName;
+    texture.path = path;
+    return texture;
+}
@@ -1,6 +1,8 @@
 #ifndef OPENGL_UTILS_MODEL
 #define OPENGL_UTILS_MODEL
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
@@ -9,25 +11,155 @@
 #include "utils/Mesh.h"
 #include "utils/Shader.h"
 #include "utils/Texture.h"
+#include "utils/TextureCache.h"
+#include "utils/UploadBudget.h"
 
+class MeshArena;
+class MeshCache;
+struct Image;
+
+// wall clock breakdown of the last load, in milliseconds
+struct ModelLoadStats {
+    double importMs = 0.0;    // Assimp ReadFile or cache mapping
+    double convertMs = 0.0;   // aiMesh -> Vertex/index conversion on the worker pool
+    double textureMs = 0.0;   // material texture decode + upload
+    double uploadMs = 0.0;    // vertex/index buffer creation
+    size_t meshCount = 0;
+    size_t vertexBytes = 0;   // gpu vertex buffer size, halves with quantizeVertices
+    size_t indexBytes = 0;    // gpu index buffer size, 16 bit for meshes up to 65536 vertices
+    size_t indexBytes32 = 0;  // what the same indices take as unsigned int
+    bool fromCache = false;
+};
+
+// triangles submitted by the last LOD aware draw
+struct ModelDrawStats {
+    size_t trianglesFull = 0;      // what draw() without LODs would have submitted
+    size_t trianglesDrawn = 0;
+    size_t meshesPerLod[MESH_MAX_LODS] = {};
+
+    size_t trianglesSaved() const { return trianglesFull - trianglesDrawn; }
+};
+
+struct ModelLoadOptions {
+    unsigned int importFlags = aiProcess_Triangulate | aiProcess_FlipUVs;
+    // read/write <path>.meshbin so warm starts skip Assimp
+    bool useCache = true;
+    // import + image decode on worker threads, uploads drained by update() each frame
+    bool async = false;
+    // pack all sub meshes into one vertex/index buffer pair drawn with base vertex offsets
+    bool packMeshes = false;
+    // arena shared with other models using the Vertex layout, implies packMeshes
+    std::shared_ptr<MeshArena> arena;
+    // reorder triangles/vertices for the post transform cache and vertex fetch at import time
+    bool optimizeMeshes = false;
+    // additionally sort triangle clusters outside-in to cut overdraw, implies optimizeMeshes
+    bool optimizeOverdraw = false;
+
+    // build 50% / 25% / 12.5% simplified levels per mesh, picked by the camera aware draw()
+    bool generateLods = false;
+    // largest simplification error allowed on screen, in pixels
+    float lodPixelError = 1.f;
+    // upload 16 byte QuantizedVertex instead of Vertex, needs a decoding vertex shader
+    // (shaders/03_shaders/01_2_Quantized_Model_vs.glsl), a shared arena must use the same format
+    bool quantizeVertices = false;
+    // cut meshes with more than 65536 vertices into chunks so they can use 16 bit indices too
+    bool splitLargeMeshes = false;
+    // 8 bit indices for meshes with at most 256 vertices, often emulated by desktop drivers
+    bool byteIndices = false;
+
+    // MeshProcessFlags the cache has to match for these options
+    uint32_t processFlags() const;
+
+    VertexFormat vertexFormat() const { return quantizeVertices ? VertexFormat::Quantized : VertexFormat::Float; }
+};
 
 class Model {
 public:
-    Model(const char *path);
+    Model(const char *path, const ModelLoadOptions& options = ModelLoadOptions());
 
+    // draws a bounding box placeholder until the model is resident
     void draw(Shader &shader);
+
+    /*
+     * picks a level per mesh from its simplification error projected to the screen,
+     * the matrices are the ones handed to the shader. Falls back to level 0 without LODs.
+     */
+    void draw(Shader &shader, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, float viewportHeight);
+
+    /*
+     * async mode: call once per frame on the GL thread, uploads finished
+     * background work within the budget. Returns true once resident, the textures may
+     * still be streaming through the TextureUploadQueue then (pump it every frame too).
+     */
+    bool update(const UploadBudget& budget = UploadBudget());
+
+    bool isResident() const { return resident; }
+
+    const ModelLoadStats& getLoadStats() const { return loadStats; }
+
+    const ModelDrawStats& getDrawStats() const { return drawStats; }
+
+    // texture binds issued / skipped since the model was created
+    const TextureBindState& getBindState() const { return bindState; }
 private:
+    struct AsyncLoad;
+
     std::string directory;
     std::vector<Mesh> meshes;
-    std::vector<Texture2D> textures_loaded;
+    // material path -> shared texture, keeps this model's textures resident in the TextureCache
+    std::unordered_map<std::string, TextureCache::Handle> textures_loaded;
+    ModelLoadOptions options;
+    ModelLoadStats loadStats;
+    bool resident;
+    std::shared_ptr<AsyncLoad> pending;
+    std::unique_ptr<Mesh> placeholder;
+    std::shared_ptr<MeshArena> arena;
+    ModelDrawStats drawStats;
+    std::vector<int> meshLods;
+    // mesh indices sorted by material so identical texture bindings follow each other
+    std::vector<unsigned int> drawOrder;
+    TextureBindState bindState;
 
     void loadModel(const char *path);
 
-    void processNode(aiNode *node, const aiScene *scene);
+    void loadModelAsync(const char *path);
+
+    void loadFromCache(const MeshCache& cache);
+
+    void uploadMeshes(std::vector<MeshData>& data);
+
+    // adds the mesh's gpu buffer sizes to loadStats
+    void countUpload(const Mesh& mesh, size_t vertexCount);
+
+    void drawMeshes(Shader& shader, bool useLods);
+
+    void selectLods(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, float viewportHeight);
+
+    // creates or grows the arena for the given totals when packing is enabled
+    void prepareArena(size_t vertexCount, size_t indexBytes);
+
+    // arena index bytes a mesh will take, from its vertex count since that bounds its index type
+    size_t arenaIndexBytes(size_t vertexCount, size_t indexCount) const;
+
+    // Assimp import + conversion, writes the .meshbin when cacheable
+    static bool importMeshes(const std::string& filepath, const ModelLoadOptions& options, bool cacheable, uint64_t sourceHash,
+                             std::vector<MeshData>& out, ModelLoadStats& stats);
+
+    // depth first, same order the recursive walk used to produce
+    static void flattenNode(const aiNode *node, const aiScene *scene, std::vector<const aiMesh*>& out);
+
+    // pure cpu work, safe to run on any thread
+    static MeshData convertMesh(const aiMesh *mesh);
+
+    static std::vector<TextureRef> collectMaterialTextures(const aiMaterial *mat, aiTextureType type, const std::string& typeName);
+
+    // decodes the not yet loaded textures of a batch concurrently, loadTexture then finds them
+    void acquireTextures(const std::vector<TextureRef>& refs);
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene);
+    Texture2D loadTexture(const char *path, const std::string& typeName);
 
-    std::vector<Texture2D> loadMaterialTextures(aiMaterial *mat, aiTextureType type, const std::string& typeName);
+    // streams through the TextureUploadQueue, the material shows a grey placeholder until then
+    Texture2D addTexture(Image&& image, std::vector<Image>&& mips, const char *path, const std::string& typeName);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,127 @@
+#include "NV12Stream.h"
+#include "utils/TextureYUV.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+NV12Stream::NV12Stream()
+    : width(0), height(0), frameBytes(0), frameCount(0), framesPerSecond(30.0), loop(true), buffers{0, 0}, staged{-1, -1},
+      current(-1) {
+}
+
+NV12Stream::~NV12Stream() {
+    close();
+}
+
+bool NV12Stream::open(const std::string& filepath, int w, int h, double fps, bool repeat) {
+    close();
+    if (w <= 0 || h <= 0 || fps <= 0.0) {
+        std::cout << "ERROR::NV12_STREAM:: invalid size or rate for " << filepath << std::endl;
+        return false;
+    }
+    if (!file.open(filepath)) {
+        std::cout << "ERROR::NV12_STREAM:: can not open " << filepath << std::endl;
+        return false;
+    }
+    width = w;
+    height = h;
+    frameBytes = nv12FrameBytes(w, h);
+    frameCount = static_cast<int>(file.size() / frameBytes);
+    if (frameCount == 0) {
+        std::cout << "ERROR::NV12_STREAM:: " << filepath << " is smaller than one " << w << "x" << h << " frame" << std::endl;
+        close();
+        return false;
+    }
+    if (file.size() % frameBytes != 0) {
+        std::cout << "WARNING::NV12_STREAM:: " << filepath << " ends with a partial frame, it is ignored" << std::endl;
+    }
+    framesPerSecond = fps;
+    loop = repeat;
+
+    glGenBuffers(2, buffers);
+    for (GLuint buffer: buffers) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(frameBytes), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void NV12Stream::close() {
+    if (buffers[0] != 0) {
+        glDeleteBuffers(2, buffers);
+        buffers[0] = buffers[1] = 0;
+    }
+    file.close();
+    staged[0] = staged[1] = -1;
+    current = -1;
+    frameCount = 0;
+    stats = NV12StreamStats();
+}
+
+const unsigned char* NV12Stream::getFrame(int index) const {
+    return file.data() + static_cast<size_t>(index) * frameBytes;
+}
+
+void NV12Stream::stage(int slot, int64_t tick) {
+    const auto start = std::chrono::steady_clock::now();
+    const unsigned char* frame = getFrame(static_cast<int>(tick % frameCount));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[slot]);
+    // orphan the old storage in case a transfer from it is still in flight
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(frameBytes), nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(frameBytes),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        std::memcpy(mapped, frame, frameBytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else {
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(frameBytes), frame);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    staged[slot] = tick;
+    stats.lastStageMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool NV12Stream::update(TextureYUV& texture, double seconds) {
+    if (!isOpen()) {
+        return false;
+    }
+    int64_t tick = static_cast<int64_t>(std::floor(std::max(seconds, 0.0) * framesPerSecond));
+    if (!loop && tick >= frameCount) {
+        tick = frameCount - 1;
+    }
+    if (tick == current) {
+        return false;
+    }
+    if (texture.getWidth() != width || texture.getHeight() != height || !texture.isValid()) {
+        texture.create(width, height, texture.getColorSpace());
+    }
+    if (current >= 0 && tick > current + 1) {
+        stats.framesSkipped += static_cast<size_t>(tick - current - 1);
+    }
+
+    int slot = staged[0] == tick ? 0 : (staged[1] == tick ? 1 : -1);
+    if (slot >= 0) {
+        stats.prefetchHits++;
+    } else {
+        // the clock jumped past the prefetched frame, stage it now into the buffer not used last
+        slot = staged[0] == current ? 1 : 0;
+        stats.prefetchMisses++;
+        stage(slot, tick);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[slot]);
+    texture.upload(nullptr, reinterpret_cast<const unsigned char*>(static_cast<size_t>(width) * height));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    current = tick;
+    stats.framesShown++;
+    stats.bytesUploaded += frameBytes;
+
+    // the next frame goes into the other buffer while the GPU reads this one
+    const int64_t next = loop || tick + 1 < frameCount ? tick + 1 : tick;
+    if (next != tick) {
+        stage(1 - slot, next);
+    }
+    return true;
+}
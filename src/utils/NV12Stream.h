@@ -0,0 +1,76 @@
+#ifndef OPENGL_UTILS_NV12_STREAM_H
+#define OPENGL_UTILS_NV12_STREAM_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "utils/MappedFile.h"
+#include "utils/YuvConvert.h"
+
+class TextureYUV;
+
+struct NV12StreamStats {
+    size_t framesShown = 0;
+    size_t framesSkipped = 0;       // the clock moved more than one frame between two updates
+    size_t prefetchHits = 0;        // the frame was already staged in a pixel buffer
+    size_t prefetchMisses = 0;
+    size_t bytesUploaded = 0;
+    double lastStageMs = 0.0;       // copy from the mapping into a pixel buffer
+};
+
+/*
+ * Plays a raw NV12 file (frames back to back, no header) into a TextureYUV at a fixed rate.
+ * The file is memory mapped, frames are paged in as they are read. Two pixel unpack buffers
+ * alternate: the texture is updated from the one staged last frame while the next frame is
+ * copied into the other, so the copy never waits for the transfer still reading a buffer.
+ * A file with a single frame loops it, every tick is still a full upload.
+ *
+ * GL thread only.
+ */
+class NV12Stream {
+public:
+    NV12Stream();
+    ~NV12Stream();
+
+    NV12Stream(const NV12Stream&) = delete;
+    NV12Stream& operator=(const NV12Stream&) = delete;
+
+    bool open(const std::string& filepath, int width, int height, double framesPerSecond = 30.0, bool loop = true);
+
+    void close();
+
+    // uploads the frame due at seconds (since the start of playback), false when it is already shown
+    bool update(TextureYUV& texture, double seconds);
+
+    // frame in the mapping, Y plane first and the UV plane right after it
+    const unsigned char* getFrame(int index) const;
+
+    int getFrameCount() const { return frameCount; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    size_t getFrameBytes() const { return frameBytes; }
+    // file frame of the last update, -1 before the first one
+    int getFrameIndex() const { return current < 0 ? -1 : static_cast<int>(current % frameCount); }
+    bool isOpen() const { return file.isOpen(); }
+
+    NV12StreamStats getStats() const { return stats; }
+
+private:
+    MappedFile file;
+    int width, height;
+    size_t frameBytes;
+    int frameCount;
+    double framesPerSecond;
+    bool loop;
+
+    GLuint buffers[2];
+    int64_t staged[2];      // tick held by each buffer, -1 if none
+    int64_t current;        // tick on the texture
+    NV12StreamStats stats;
+
+    // copies the frame of tick into buffers[slot]
+    void stage(int slot, int64_t tick);
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "ProgramCache.h"
+#include "utils/Hash.h"
+#include "utils/MappedFile.h"
+#include "utils/Utils.h"
+#include <GLFW/glfw3.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// GL 4.1 / GL_ARB_get_program_binary, a 3.3 core glad does not define them
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+static const char PROGRAM_CACHE_MAGIC[8] = {'P', 'R', 'O', 'G', 'B', 'I', 'N', '\0'};
+
+// length first so "ab" + "c" and "a" + "bc" hash differently
+static uint64_t hashPart(const std::string& part, uint64_t seed) {
+    const uint64_t size = part.size();
+    return hashString(part, hashBytes(&size, sizeof(size), seed));
+}
+
+static std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+ProgramCache& ProgramCache::getInstance() {
+    static ProgramCache instance;
+    return instance;
+}
+
+ProgramCache::ProgramCache()
+    : getProgramBinary(nullptr), programBinary(nullptr), programParameteri(nullptr), checked(false), supported(false), enabled(true)
+    , driverHash(0), directory(".shadercache") {}
+
+bool ProgramCache::isSupported() {
+    if (checked) {
+        return supported;
+    }
+    checked = true;
+    if (!gl::hasVersion(4, 1) && !gl::hasExtension("GL_ARB_get_program_binary")) {
+        return false;
+    }
+    getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(glfwGetProcAddress("glGetProgramBinary"));
+    programBinary = reinterpret_cast<ProgramBinaryProc>(glfwGetProcAddress("glProgramBinary"));
+    programParameteri = reinterpret_cast<ProgramParameteriProc>(glfwGetProcAddress("glProgramParameteri"));
+    // some drivers expose the entry points but no format to save in
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    supported = getProgramBinary && programBinary && programParameteri && formats > 0;
+
+    driverHash = hashPart(glString(GL_VENDOR), FNV_OFFSET_BASIS);
+    driverHash = hashPart(glString(GL_RENDERER), driverHash);
+    driverHash = hashPart(glString(GL_VERSION), driverHash);
+    return supported;
+}
+
+uint64_t ProgramCache::keyFor(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines) {
+    isSupported();
+    uint64_t key = hashBytes(&VERSION, sizeof(VERSION), driverHash);
+    key = hashPart(vertexSource, key);
+    key = hashPart(fragmentSource, key);
+    return hashPart(defines, key);
+}
+
+std::string ProgramCache::cachePathFor(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.progbin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+void ProgramCache::setDirectory(const std::string& path) {
+    directory = path;
+}
+
+void ProgramCache::prepareLink(GLuint program) {
+    if (enabled && isSupported()) {
+        programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+GLuint ProgramCache::load(uint64_t key) {
+    if (!enabled || !isSupported()) {
+        return 0;
+    }
+    const std::string cachePath = cachePathFor(key);
+    MappedFile file;
+    if (!file.open(cachePath)) {
+        stats.misses++;
+        return 0;
+    }
+    const ProgramCacheHeader* header = file.size() >= sizeof(ProgramCacheHeader) ? reinterpret_cast<const ProgramCacheHeader*>(file.data()) : nullptr;
+    if (!header
+        || std::memcmp(header->magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC)) != 0
+        || header->version != VERSION
+        || header->key != key
+        || header->binarySize != file.size() - sizeof(ProgramCacheHeader)) {
+        std::cout << "WARNING::PROGRAM_CACHE:: corrupted cache file " << cachePath << std::endl;
+        stats.misses++;
+        return 0;
+    }
+
+    const GLuint program = glCreateProgram();
+    programBinary(program, header->binaryFormat, file.data() + sizeof(ProgramCacheHeader), static_cast<GLsizei>(header->binarySize));
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // the same driver strings can still refuse a binary (e.g. a changed GPU behind the same version)
+        glDeleteProgram(program);
+        file.close();
+        std::remove(cachePath.c_str());
+        stats.rejected++;
+        stats.misses++;
+        return 0;
+    }
+    stats.hits++;
+    return program;
+}
+
+bool ProgramCache::store(uint64_t key, GLuint program) {
+    if (!enabled || !isSupported()) {
+        return false;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLsizei written = 0;
+    GLenum format = 0;
+    getProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return false;
+    }
+
+    ProgramCacheHeader header {};
+    std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+    header.version = VERSION;
+    header.binaryFormat = format;
+    header.key = key;
+    header.binarySize = static_cast<uint64_t>(written);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    // write to a temporary file first so a crash never leaves a half written binary behind
+    const std::string cachePath = cachePathFor(key);
+    const std::string tmpPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cout << "WARNING::PROGRAM_CACHE:: can not write " << tmpPath << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), written);
+        if (!out) {
+            std::cout << "WARNING::PROGRAM_CACHE:: failed writing " << tmpPath << std::endl;
+            return false;
+        }
+    }
+
+    std::remove(cachePath.c_str());
+    if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    stats.writes++;
+    return true;
+}
+
+void ProgramCache::record(const std::string& name, bool cached, double milliseconds) {
+    for (auto& entry: records) {
+        if (entry.name == name) {
+            entry.cached = cached;
+            entry.milliseconds = milliseconds;
+            return;
+        }
+    }
+    records.push_back({name, cached, milliseconds});
+}
+
+void ProgramCache::printReport() const {
+    double compiledMs = 0.0;
+    double cachedMs = 0.0;
+    size_t cachedCount = 0;
+    for (const auto& entry: records) {
+        std::cout << "  " << (entry.cached ? "cache hit " : "compiled  ") << entry.milliseconds << " ms  " << entry.name << std::endl;
+        (entry.cached ? cachedMs : compiledMs) += entry.milliseconds;
+        cachedCount += entry.cached ? 1 : 0;
+    }
+    std::cout << "  " << records.size() << " programs: " << records.size() - cachedCount << " compiled in " << compiledMs << " ms, "
+              << cachedCount << " from the cache in " << cachedMs << " ms (" << stats.rejected << " binaries rejected)" << std::endl;
+}
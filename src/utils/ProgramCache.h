@@ -0,0 +1,108 @@
+#ifndef OPENGL_UTILS_PROGRAM_CACHE_H
+#define OPENGL_UTILS_PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * .progbin file layout (little endian):
+ *
+ *   ProgramCacheHeader
+ *   binary           (binarySize bytes from glGetProgramBinary)
+ *
+ * Linked programs as the driver hands them out (GL 4.1 / GL_ARB_get_program_binary), so a warm
+ * start is a glProgramBinary instead of compiling and linking GLSL. The key hashes both sources,
+ * the defines and the GL_VENDOR / GL_RENDERER / GL_VERSION strings, a driver update or an edited
+ * shader simply misses. Files are named after the key in one directory (.shadercache by default).
+ * A binary the driver rejects is deleted and the program is compiled from source again.
+ */
+
+struct ProgramCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint64_t key;
+    uint64_t binarySize;
+};
+
+struct ProgramCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t rejected = 0;    // binary refused by the driver, counted as a miss too
+    size_t writes = 0;
+};
+
+// one Shader load, for the timing report
+struct ProgramLoadRecord {
+    std::string name;
+    bool cached = false;
+    double milliseconds = 0.0;
+};
+
+class ProgramCache {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    static ProgramCache& getInstance();
+
+    // the context can hand out and take back program binaries (checked once, a context must be current)
+    bool isSupported();
+
+    uint64_t keyFor(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines = "");
+
+    // a linked program from the cached binary, 0 on a miss or when the driver rejects it
+    GLuint load(uint64_t key);
+
+    // saves the binary of a linked program, it must have been linked with prepareLink
+    bool store(uint64_t key, GLuint program);
+
+    // asks the driver to keep the binary retrievable, call between glAttachShader and glLinkProgram
+    void prepareLink(GLuint program);
+
+    std::string cachePathFor(uint64_t key) const;
+
+    void setDirectory(const std::string& path);
+
+    const std::string& getDirectory() const { return directory; }
+
+    // off makes load always miss and store a no-op (benchmarks, shader development)
+    void setEnabled(bool value) { enabled = value; }
+
+    bool isEnabled() const { return enabled; }
+
+    ProgramCacheStats getStats() const { return stats; }
+
+    // the latest load of each program, loading the same name again replaces its entry
+    void record(const std::string& name, bool cached, double milliseconds);
+
+    const std::vector<ProgramLoadRecord>& getRecords() const { return records; }
+
+    void clearRecords() { records.clear(); }
+
+    // one line per program load, compile or cache hit and its time
+    void printReport() const;
+
+private:
+    ProgramCache();
+
+    typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+    typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+    typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+    GetProgramBinaryProc getProgramBinary;
+    ProgramBinaryProc programBinary;
+    ProgramParameteriProc programParameteri;
+    bool checked;
+    bool supported;
+    bool enabled;
+    // GL_VENDOR / GL_RENDERER / GL_VERSION, hashed into every key
+    uint64_t driverHash;
+    std::string directory;
+    ProgramCacheStats stats;
+    std::vector<ProgramLoadRecord> records;
+};
+
+#endif
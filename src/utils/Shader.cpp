@@ -1,42 +1,124 @@
 #include "Shader.h"
+#include "utils/FrameUniforms.h"
+#include "utils/ProgramCache.h"
+#include "utils/ShaderReload.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
+
+static bool uniformCacheEnabled = true;
+// bumped on every switch, values set while the cache was off never reached it
+static unsigned uniformCacheGeneration = 0;
+// every program a Shader takes gets the next one, GL program names are reused and these are not
+static uint64_t lastProgramGeneration = 0;
 
 Shader::Shader(): ID(0) {}
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)  {
-    loadFromfile(vertexPath, fragmentPath);
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines)  {
+    loadFromfile(vertexPath, fragmentPath, defines);
 }
 
 Shader::~Shader() {
+  ShaderReload::getInstance().remove(this);
   glDeleteProgram(ID);
 }
 
-void Shader::loadFromfile(const char* vertexPath, const char* fragmentPath) {
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
+Shader::Shader(Shader&& other) noexcept
+    : ID(other.ID)
+    , vertexPath(std::move(other.vertexPath))
+    , fragmentPath(std::move(other.fragmentPath))
+    , defines(std::move(other.defines))
+    , sourceFiles(std::move(other.sourceFiles))
+    , uniformSlots(std::move(other.uniformSlots))
+    , uniforms(std::move(other.uniforms))
+    , uniformStats(other.uniformStats)
+    , cacheGeneration(other.cacheGeneration)
+    , programGeneration(other.programGeneration) {
+    other.ID = 0;
+    other.programGeneration = 0;
+    ShaderReload::getInstance().moved(&other, this);
+}
 
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+Shader& Shader::operator=(Shader&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    ShaderReload::getInstance().remove(this);
+    glDeleteProgram(ID);
+    ID = other.ID;
+    vertexPath = std::move(other.vertexPath);
+    fragmentPath = std::move(other.fragmentPath);
+    defines = std::move(other.defines);
+    sourceFiles = std::move(other.sourceFiles);
+    uniformSlots = std::move(other.uniformSlots);
+    uniforms = std::move(other.uniforms);
+    uniformStats = other.uniformStats;
+    cacheGeneration = other.cacheGeneration;
+    programGeneration = other.programGeneration;
+    other.ID = 0;
+    other.programGeneration = 0;
+    ShaderReload::getInstance().moved(&other, this);
+    return *this;
+}
 
-    try {
-    vShaderFile.open(vertexPath);
-    fShaderFile.open(fragmentPath);
+void Shader::loadFromfile(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines) {
+    this->vertexPath = vertexPath;
+    this->fragmentPath = fragmentPath;
+    this->defines = defines;
+    ShaderReload::getInstance().add(this);
 
-    std::stringstream vShaderStream, fShaderStream;
-    vShaderStream << vShaderFile.rdbuf();
-    fShaderStream << fShaderFile.rdbuf();
+    std::string vertexCode;
+    std::string fragmentCode;
+    readSources(vertexCode, fragmentCode);
+
+    ProgramCache& cache = ProgramCache::getInstance();
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t key = cache.keyFor(vertexCode, fragmentCode, defines.toString());
+    GLuint program = cache.load(key);
+    const bool cached = program != 0;
+    if (!cached) {
+        program = compileProgram(vertexCode, fragmentCode);
+    }
+    ID = program;
+    programGeneration = ++lastProgramGeneration;
+    std::string label = std::string(vertexPath) + " + " + fragmentPath;
+    if (!defines.empty()) {
+        label += " [" + defines.toString() + "]";
+    }
+    cache.record(label, cached,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    GLint linked = 0;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (!cached && linked) {
+        cache.store(key, ID);
+    }
 
-    vShaderFile.close();
-    fShaderFile.close();
+    FrameUniforms::bindBlocks(ID);
+    reflectUniforms();
+}
 
-    vertexCode = vShaderStream.str();
-    fragmentCode = fShaderStream.str();
-    } catch (std::ifstream::failure& e) {
-    std::cout << "ERROR: File not successfully read" << std::endl;
+bool Shader::readSources(std::string& vertexCode, std::string& fragmentCode) {
+    ShaderPreprocessor& preprocessor = ShaderPreprocessor::getInstance();
+    std::vector<std::string> files;
+    if (!preprocessor.process(vertexPath, defines, vertexCode, files) ||
+        !preprocessor.process(fragmentPath, defines, fragmentCode, files)) {
+        std::cout << "ERROR: File not successfully read" << std::endl;
+        // still watch what was found, the fix is an edit to one of them
+        for (const auto& file: files) {
+            if (std::find(sourceFiles.begin(), sourceFiles.end(), file) == sourceFiles.end()) {
+                sourceFiles.push_back(file);
+            }
+        }
+        return false;
     }
+    sourceFiles.swap(files);
+    return true;
+}
 
+GLuint Shader::compileProgram(const std::string& vertexCode, const std::string& fragmentCode) {
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
@@ -50,6 +132,7 @@ void Shader::loadFromfile(const char* vertexPath, const char* fragmentPath) {
     if (!success) {
     glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
     std::cout << "ERROR:vertex shader compile error\n" << infoLog << std::endl;
+    ShaderPreprocessor::printFiles(sourceFiles);
     }
 
     const unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
@@ -59,20 +142,201 @@ void Shader::loadFromfile(const char* vertexPath, const char* fragmentPath) {
     if (!success) {
     glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
     std::cout << "ERROR:fragment shader compile error\n" << infoLog << std::endl;
+    ShaderPreprocessor::printFiles(sourceFiles);
     }
 
-    ID = glCreateProgram();
-    glAttachShader(ID, vertexShader);
-    glAttachShader(ID, fragmentShader);
-    glLinkProgram(ID);
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    const GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    ProgramCache::getInstance().prepareLink(program);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
-    glGetProgramInfoLog(ID, 512, nullptr, infoLog);
+    glGetProgramInfoLog(program, 512, nullptr, infoLog);
     std::cout << "ERROR: program link error\n" << infoLog << std::endl;
     }
 
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+void Shader::reflectUniforms() {
+    uniforms.clear();
+    uniformSlots.clear();
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &size, &type, buffer.data());
+        const std::string name(buffer.data(), length);
+        // arrays of plain types are reported once as "name[0]", every element has its own location
+        const size_t bracket = name.size() > 3 ? name.size() - 3 : std::string::npos;
+        if (bracket != std::string::npos && name.compare(bracket, 3, "[0]") == 0) {
+            const std::string base = name.substr(0, bracket);
+            // the bare name is element 0, both keys share its slot so neither caches a stale value
+            addUniformKey(base, addUniform(name, type));
+            for (GLint element = 1; element < size; element++) {
+                addUniform(base + "[" + std::to_string(element) + "]", type);
+            }
+        } else {
+            addUniform(name, type);
+        }
+    }
+}
+
+int Shader::addUniform(const std::string& name, GLenum type) {
+    // members of uniform blocks have no location
+    const GLint location = glGetUniformLocation(ID, name.c_str());
+    if (location < 0) {
+        return -1;
+    }
+    UniformSlot slot;
+    slot.location = location;
+    slot.type = type;
+    uniformSlots.push_back(slot);
+    const int index = static_cast<int>(uniformSlots.size()) - 1;
+    addUniformKey(name, index);
+    return index;
+}
+
+void Shader::addUniformKey(const std::string& name, int slot) {
+    if (slot < 0) {
+        return;
+    }
+    const auto inserted = uniforms.emplace(hashString(name), slot);
+    if (!inserted.second && inserted.first->second != slot) {
+        std::cout << "WARNING::SHADER:: uniform " << name << " collides with another name's hash, it can not be set" << std::endl;
+        inserted.first->second = -1;
+    }
+}
+
+GLint Shader::getUniformLocation(const UniformKey& key) const {
+    if (!uniformCacheEnabled) {
+        uniformStats.lookups++;
+        return glGetUniformLocation(ID, key.name);
+    }
+    const auto it = uniforms.find(key.hash);
+    return it != uniforms.end() && it->second >= 0 ? uniformSlots[it->second].location : -1;
+}
+
+GLint Shader::prepareWrite(const UniformKey& key, const void* value, size_t bytes) const {
+    if (!uniformCacheEnabled) {
+        uniformStats.lookups++;
+        uniformStats.writes++;
+        return glGetUniformLocation(ID, key.name);
+    }
+    if (cacheGeneration != uniformCacheGeneration) {
+        cacheGeneration = uniformCacheGeneration;
+        for (auto& slot: uniformSlots) {
+            slot.written = false;
+        }
+    }
+    const auto it = uniforms.find(key.hash);
+    if (it == uniforms.end() || it->second < 0) {
+        uniformStats.unknown++;
+        return -1;
+    }
+    UniformSlot& slot = uniformSlots[it->second];
+    if (slot.written && std::memcmp(slot.value, value, bytes) == 0) {
+        uniformStats.skipped++;
+        return -1;
+    }
+    std::memcpy(slot.value, value, bytes);
+    slot.written = true;
+    uniformStats.writes++;
+    return slot.location;
+}
+
+void Shader::replaceProgram(GLuint program) {
+    GLint current = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    const GLuint previousProgram = ID;
+    std::unordered_map<uint64_t, int> previous;
+    previous.swap(uniforms);
+    std::vector<UniformSlot> previousSlots;
+    previousSlots.swap(uniformSlots);
+
+    ID = program;
+    programGeneration = ++lastProgramGeneration;
+    FrameUniforms::bindBlocks(ID);
+    reflectUniforms();
+
+    // a new program starts with every uniform 0, carry over what was set on the old one
+    glUseProgram(ID);
+    for (const auto& entry: previous) {
+        if (entry.second < 0 || !previousSlots[entry.second].written) {
+            continue;
+        }
+        const UniformSlot& old = previousSlots[entry.second];
+        const auto it = uniforms.find(entry.first);
+        if (it == uniforms.end() || it->second < 0) {
+            continue;
+        }
+        UniformSlot& slot = uniformSlots[it->second];
+        // the keys of an array's element 0 share a slot, it is written once
+        if (slot.written || slot.type != old.type) {
+            continue;
+        }
+        std::memcpy(slot.value, old.value, sizeof(slot.value));
+        slot.written = true;
+        writeSlot(slot);
+    }
+    glUseProgram(static_cast<GLuint>(current) == previousProgram ? ID : static_cast<GLuint>(current));
+    glDeleteProgram(previousProgram);
+}
+
+void Shader::writeSlot(const UniformSlot& slot) const {
+    switch (slot.type) {
+        case GL_FLOAT:
+            glUniform1fv(slot.location, 1, slot.value);
+            break;
+        case GL_FLOAT_VEC2:
+            glUniform2fv(slot.location, 1, slot.value);
+            break;
+        case GL_FLOAT_VEC3:
+            glUniform3fv(slot.location, 1, slot.value);
+            break;
+        case GL_FLOAT_VEC4:
+            glUniform4fv(slot.location, 1, slot.value);
+            break;
+        case GL_FLOAT_MAT3:
+            glUniformMatrix3fv(slot.location, 1, GL_FALSE, slot.value);
+            break;
+        case GL_FLOAT_MAT4:
+            glUniformMatrix4fv(slot.location, 1, GL_FALSE, slot.value);
+            break;
+        default: {
+            // int, bool and sampler uniforms, setInt / setBool stored the int bitwise
+            int value = 0;
+            std::memcpy(&value, slot.value, sizeof(value));
+            glUniform1i(slot.location, value);
+            break;
+        }
+    }
+}
+
+void Shader::invalidateUniformCache() {
+    for (auto& slot: uniformSlots) {
+        slot.written = false;
+    }
+}
+
+void Shader::setUniformCacheEnabled(bool enabled) {
+    if (enabled != uniformCacheEnabled) {
+        uniformCacheEnabled = enabled;
+        uniformCacheGeneration++;
+    }
+}
+
+bool Shader::isUniformCacheEnabled() {
+    return uniformCacheEnabled;
 }
 
 void Shader::use() {
@@ -80,52 +344,110 @@ void Shader::use() {
 }
 
 void Shader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int) value);
+    setBool(UniformKey(name), value);
 }
 
 void Shader::setInt(const std::string &name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    setInt(UniformKey(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    setFloat(UniformKey(name), value);
 }
 
 void Shader::setFloat2(const std::string &name, float value1, float value2) const {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), value1, value2);
+    setFloat2(UniformKey(name), value1, value2);
 }
 
 void Shader::setFloat2(const std::string& name, const glm::vec2 &value) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    setFloat2(UniformKey(name), value);
 }
 
 void Shader::setFloat3(const std::string &name, float value1, float value2, float value3) const {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), value1, value2, value3);
+    setFloat3(UniformKey(name), value1, value2, value3);
 }
 
 void Shader::setFloat3(const std::string &name, const glm::vec3 &value) const  {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    setFloat3(UniformKey(name), value);
 }
 
 void Shader::setFloat4(const std::string &name, float value1, float value2, float value3, float value4) const {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), value1, value2, value3, value4);
+    setFloat4(UniformKey(name), value1, value2, value3, value4);
 }
 
 void Shader::setFloat4(const std::string &name, const glm::vec4 &value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    setFloat4(UniformKey(name), value);
 }
 
 void Shader::setMatrix3(const std::string &name, const glm::mat3& mat3) const {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat3[0][0]);
+    setMatrix3(UniformKey(name), mat3);
 }
 
 void Shader::setMatrix4(const std::string &name, const glm::mat4& mat4) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat4[0][0]);
+    setMatrix4(UniformKey(name), mat4);
 }
 
+void Shader::setBool(const UniformKey &key, bool value) const {
+    setInt(key, static_cast<int>(value));
+}
 
+void Shader::setInt(const UniformKey &key, int value) const {
+    const GLint location = prepareWrite(key, &value, sizeof(value));
+    if (location >= 0) {
+        glUniform1i(location, value);
+    }
+}
 
+void Shader::setFloat(const UniformKey &key, float value) const {
+    const GLint location = prepareWrite(key, &value, sizeof(value));
+    if (location >= 0) {
+        glUniform1f(location, value);
+    }
+}
 
+void Shader::setFloat2(const UniformKey &key, float value1, float value2) const {
+    setFloat2(key, glm::vec2(value1, value2));
+}
 
+void Shader::setFloat2(const UniformKey &key, const glm::vec2 &value) const {
+    const GLint location = prepareWrite(key, glm::value_ptr(value), sizeof(float) * 2);
+    if (location >= 0) {
+        glUniform2fv(location, 1, glm::value_ptr(value));
+    }
+}
+
+void Shader::setFloat3(const UniformKey &key, float value1, float value2, float value3) const {
+    setFloat3(key, glm::vec3(value1, value2, value3));
+}
 
+void Shader::setFloat3(const UniformKey &key, const glm::vec3 &value) const {
+    const GLint location = prepareWrite(key, glm::value_ptr(value), sizeof(float) * 3);
+    if (location >= 0) {
+        glUniform3fv(location, 1, glm::value_ptr(value));
+    }
+}
+
+void Shader::setFloat4(const UniformKey &key, float value1, float value2, float value3, float value4) const {
+    setFloat4(key, glm::vec4(value1, value2, value3, value4));
+}
 
+void Shader::setFloat4(const UniformKey &key, const glm::vec4 &value) const {
+    const GLint location = prepareWrite(key, glm::value_ptr(value), sizeof(float) * 4);
+    if (location >= 0) {
+        glUniform4fv(location, 1, glm::value_ptr(value));
+    }
+}
+
+void Shader::setMatrix3(const UniformKey &key, const glm::mat3& mat3) const {
+    const GLint location = prepareWrite(key, &mat3[0][0], sizeof(float) * 9);
+    if (location >= 0) {
+        glUniformMatrix3fv(location, 1, GL_FALSE, &mat3[0][0]);
+    }
+}
+
+void Shader::setMatrix4(const UniformKey &key, const glm::mat4& mat4) const {
+    const GLint location = prepareWrite(key, &mat4[0][0], sizeof(float) * 16);
+    if (location >= 0) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &mat4[0][0]);
+    }
+}
@@ -2,8 +2,13 @@
 #define OPENGL_SHADER_H
 
 #include "glm/fwd.hpp"
+#include "utils/Hash.h"
+#include "utils/ShaderPreprocessor.h"
 #include <glad/glad.h>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -11,17 +16,59 @@
 #include <glm/gtc/type_ptr.hpp>
 
 
+/*
+ * Name of a uniform with its hash, the key of the Shader's uniform table.
+ * "lightPos"_uniform or a static constexpr UniformKey hashes at compile time, the std::string
+ * setters hash at run time. Either way no glGetUniformLocation is called per set.
+ */
+struct UniformKey {
+    uint64_t hash;
+    const char* name;
+
+    constexpr UniformKey(const char* str, size_t length): hash(hashLiteral(str, length)), name(str) {}
+
+    template<size_t N>
+    constexpr explicit UniformKey(const char (&str)[N]): UniformKey(str, N - 1) {}
+
+    // the string must outlive the key
+    explicit UniformKey(const std::string& str): hash(hashString(str)), name(str.c_str()) {}
+};
+
+constexpr UniformKey operator""_uniform(const char* str, size_t length) {
+    return UniformKey(str, length);
+}
+
+struct UniformStats {
+    size_t writes = 0;        // glUniform* calls
+    size_t skipped = 0;       // same value as last time, not written
+    size_t lookups = 0;       // glGetUniformLocation calls, only with the cache off
+    size_t unknown = 0;       // not an active uniform of the program
+};
+
 class Shader {
 public:
     unsigned int ID;
 
     Shader();
 
-    Shader(const char* vertexPath, const char* fragmentPath);
+    Shader(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines = ShaderDefines());
 
     ~Shader();
 
-    void loadFromfile(const char* vertexPath, const char* fragmentPath);
+    // a copy would share and delete the program; a move takes over the ShaderReload registration
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    Shader(Shader&& other) noexcept;
+
+    Shader& operator=(Shader&& other) noexcept;
+
+    /*
+     * linked program from the ProgramCache when the sources and driver match, compiled otherwise.
+     * The files go through the ShaderPreprocessor: #include is resolved and the defines are
+     * injected after #version, so one source builds specialized variants (see ShaderLibrary).
+     */
+    void loadFromfile(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines = ShaderDefines());
 
     void use();
 
@@ -48,6 +95,106 @@ public:
 
     void setMatrix4(const std::string &name,  const glm::mat4 &mat4 ) const;
 
+    /*
+     * Same setters on precomputed keys. The active uniforms are reflected after link, and the last
+     * value written to each is kept so setting it again is skipped. Like before the shader must be
+     * in use, and glUniform calls made around these setters must be followed by invalidateUniformCache.
+     */
+    void setBool(const UniformKey &key, bool value) const;
+
+    void setInt(const UniformKey &key, int value) const;
+
+    void setFloat(const UniformKey &key, float value) const;
+
+    void setFloat2(const UniformKey &key, float value1, float value2) const;
+
+    void setFloat2(const UniformKey &key, const glm::vec2 &value) const;
+
+    void setFloat3(const UniformKey &key, float value1, float value2, float value3) const;
+
+    void setFloat3(const UniformKey &key, const glm::vec3 &value) const;
+
+    void setFloat4(const UniformKey &key, float value1, float value2, float value3, float value4) const;
+
+    void setFloat4(const UniformKey &key, const glm::vec4 &value) const;
+
+    void setMatrix3(const UniformKey &key, const glm::mat3 &mat3) const;
+
+    void setMatrix4(const UniformKey &key, const glm::mat4 &mat4) const;
+
+    // -1 if the name is not an active uniform
+    GLint getUniformLocation(const UniformKey &key) const;
+
+    bool hasUniform(const UniformKey &key) const { return getUniformLocation(key) >= 0; }
+
+    // forget the last written values, the next set of every uniform is written
+    void invalidateUniformCache();
+
+    /*
+     * Swaps in a newly linked program built from the same sources (ShaderReload). The uniform
+     * blocks are bound and the uniform values set on the old program are written to the new one,
+     * so a demo that sets its samplers once keeps working. The old program is deleted.
+     */
+    void replaceProgram(GLuint program);
+
+    // unique per program this process linked or loaded into a Shader, changes with replaceProgram; 0 before loading
+    uint64_t getProgramGeneration() const { return programGeneration; }
+
+    const std::string& getVertexPath() const { return vertexPath; }
+
+    const std::string& getFragmentPath() const { return fragmentPath; }
+
+    const ShaderDefines& getDefines() const { return defines; }
+
+    // both stages and everything they include, normalized; an edit to any of them reloads the shader
+    const std::vector<std::string>& getSourceFiles() const { return sourceFiles; }
+
+    // both stages preprocessed with the shader's defines, false (and an error printed) if a file can not be read
+    bool readSources(std::string& vertexCode, std::string& fragmentCode);
+
+    UniformStats getUniformStats() const { return uniformStats; }
+
+    void resetUniformStats() { uniformStats = UniformStats(); }
+
+    // false falls back to glGetUniformLocation and glUniform on every set, for benchmarks
+    static void setUniformCacheEnabled(bool enabled);
+
+    static bool isUniformCacheEnabled();
+
+private:
+    struct UniformSlot {
+        GLint location = -1;
+        GLenum type = 0;
+        bool written = false;
+        // last value, ints bitwise, up to a mat4
+        float value[16] = {};
+    };
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    ShaderDefines defines;
+    std::vector<std::string> sourceFiles;
+    // one slot per location, "weights" and "weights[0]" are two keys of the same slot
+    mutable std::vector<UniformSlot> uniformSlots;
+    // name hash -> index into uniformSlots, -1 for names whose hashes collide
+    std::unordered_map<uint64_t, int> uniforms;
+    mutable UniformStats uniformStats;
+    mutable unsigned cacheGeneration = 0;
+    uint64_t programGeneration = 0;
+
+    GLuint compileProgram(const std::string& vertexCode, const std::string& fragmentCode);
+
+    void reflectUniforms();
+
+    // index of the new slot, -1 if the name has no location
+    int addUniform(const std::string& name, GLenum type);
+
+    void addUniformKey(const std::string& name, int slot);
+
+    void writeSlot(const UniformSlot& slot) const;
+
+    // location to write, -1 when the value is unchanged or the uniform is not active
+    GLint prepareWrite(const UniformKey& key, const void* value, size_t bytes) const;
 };
 
 
@@ -0,0 +1,49 @@
+#include "ShaderLibrary.h"
+#include "utils/FileWatcher.h"
+#include "utils/Hash.h"
+#include "utils/ShaderReload.h"
+
+ShaderLibrary& ShaderLibrary::getInstance() {
+    static ShaderLibrary instance;
+    return instance;
+}
+
+ShaderLibrary::ShaderLibrary() {
+    // constructed first so it is destroyed after the library, whose Shaders unregister from it
+    ShaderReload::getInstance();
+}
+
+uint64_t ShaderLibrary::keyFor(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines) {
+    // separators keep ("ab", "c") and ("a", "bc") apart
+    uint64_t key = hashString(FileWatcher::normalizePath(vertexPath));
+    key = hashString("\n" + FileWatcher::normalizePath(fragmentPath), key);
+    return hashString("\n" + defines.toString(), key);
+}
+
+Shader& ShaderLibrary::get(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines) {
+    const uint64_t key = keyFor(vertexPath, fragmentPath, defines);
+    const auto it = variants.find(key);
+    if (it != variants.end()) {
+        stats.hits++;
+        return *it->second;
+    }
+    stats.misses++;
+    std::unique_ptr<Shader> shader = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), defines);
+    Shader& result = *shader;
+    variants.emplace(key, std::move(shader));
+    return result;
+}
+
+bool ShaderLibrary::contains(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines) const {
+    return variants.find(keyFor(vertexPath, fragmentPath, defines)) != variants.end();
+}
+
+ShaderLibraryStats ShaderLibrary::getStats() const {
+    ShaderLibraryStats result = stats;
+    result.variants = variants.size();
+    return result;
+}
+
+void ShaderLibrary::clear() {
+    variants.clear();
+}
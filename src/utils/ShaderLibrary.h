@@ -0,0 +1,50 @@
+#ifndef OPENGL_UTILS_SHADER_LIBRARY_H
+#define OPENGL_UTILS_SHADER_LIBRARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "utils/Shader.h"
+
+struct ShaderLibraryStats {
+    size_t hits = 0;            // variant already linked in this process
+    size_t misses = 0;          // loaded, from the ProgramCache or compiled
+    size_t variants = 0;        // programs held
+};
+
+/*
+ * Compiled shader variants keyed by (vertex path, fragment path, defines). A draw asks for the
+ * variant it needs, e.g. get(vs, fs, {{"NUM_POINT_LIGHTS", "4"}, {"SPECULAR_MAP", "1"}}), and the
+ * driver compiles each specialization once: branches on a define are removed at compile time
+ * instead of testing a uniform per fragment. Misses go through Shader::loadFromfile, so variants
+ * seen in an earlier run come from the ProgramCache, and every variant is hot reloaded.
+ * The Shaders live until clear, which must run while the GL context is current.
+ */
+class ShaderLibrary {
+public:
+    static ShaderLibrary& getInstance();
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    Shader& get(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines = ShaderDefines());
+
+    bool contains(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines = ShaderDefines()) const;
+
+    ShaderLibraryStats getStats() const;
+
+    // deletes every program
+    void clear();
+
+private:
+    std::unordered_map<uint64_t, std::unique_ptr<Shader>> variants;
+    ShaderLibraryStats stats;
+
+    ShaderLibrary();
+
+    static uint64_t keyFor(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines);
+};
+
+#endif
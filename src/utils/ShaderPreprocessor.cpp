@@ -0,0 +1,222 @@
+#include "ShaderPreprocessor.h"
+#include "utils/FileWatcher.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+ShaderDefines::ShaderDefines(std::initializer_list<std::pair<std::string, std::string>> values) {
+    for (const auto& value: values) {
+        set(value.first, value.second);
+    }
+}
+
+ShaderDefines& ShaderDefines::set(const std::string& name, const std::string& value) {
+    values[name] = value;
+    return *this;
+}
+
+ShaderDefines& ShaderDefines::set(const std::string& name, int value) {
+    return set(name, std::to_string(value));
+}
+
+void ShaderDefines::erase(const std::string& name) {
+    values.erase(name);
+}
+
+std::string ShaderDefines::toString() const {
+    std::string result;
+    for (const auto& value: values) {
+        if (!result.empty()) {
+            result += ';';
+        }
+        result += value.first + "=" + value.second;
+    }
+    return result;
+}
+
+std::string ShaderDefines::toGlsl() const {
+    std::string result;
+    for (const auto& value: values) {
+        result += "#define " + value.first + " " + value.second + "\n";
+    }
+    return result;
+}
+
+ShaderPreprocessor& ShaderPreprocessor::getInstance() {
+    static ShaderPreprocessor instance;
+    return instance;
+}
+
+void ShaderPreprocessor::addIncludeDirectory(const std::string& directory) {
+    if (std::find(includeDirectories.begin(), includeDirectories.end(), directory) == includeDirectories.end()) {
+        includeDirectories.push_back(directory);
+    }
+}
+
+// the directive name after '#', empty if the line is not a directive
+static std::string directiveOf(const std::string& line, size_t& end) {
+    size_t i = 0;
+    while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) {
+        i++;
+    }
+    if (i == line.size() || line[i] != '#') {
+        return std::string();
+    }
+    i++;
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
+        i++;
+    }
+    const size_t start = i;
+    while (i < line.size() && std::isalpha(static_cast<unsigned char>(line[i]))) {
+        i++;
+    }
+    end = i;
+    return line.substr(start, i - start);
+}
+
+// #include "name" or #include <name>
+static bool parseInclude(const std::string& line, std::string& name) {
+    size_t i = 0;
+    if (directiveOf(line, i) != "include") {
+        return false;
+    }
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
+        i++;
+    }
+    if (i == line.size() || (line[i] != '"' && line[i] != '<')) {
+        return false;
+    }
+    const char close = line[i] == '"' ? '"' : '>';
+    const size_t end = line.find(close, i + 1);
+    if (end == std::string::npos) {
+        return false;
+    }
+    name = line.substr(i + 1, end - i - 1);
+    return true;
+}
+
+static bool parseVersion(const std::string& line, int& version) {
+    size_t i = 0;
+    if (directiveOf(line, i) != "version") {
+        return false;
+    }
+    version = std::atoi(line.c_str() + i);
+    return true;
+}
+
+bool ShaderPreprocessor::process(const std::string& path, const ShaderDefines& defines, std::string& code, std::vector<std::string>& files) {
+    Context context;
+    context.defines = &defines;
+    context.files = &files;
+    context.version = 110;
+    const std::string normalized = FileWatcher::normalizePath(path);
+    // a stage that is not first in files needs a #line naming its number, like the defines
+    context.injected = defines.empty() && fileIndex(normalized, files) == 0;
+    context.included.push_back(normalized);
+    if (!expand(normalized, true, context)) {
+        return false;
+    }
+    code.swap(context.code);
+    return true;
+}
+
+bool ShaderPreprocessor::expand(const std::string& path, bool main, Context& context) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "ERROR::SHADER_PREPROCESSOR:: can not read " << path << std::endl;
+        return false;
+    }
+    const size_t index = fileIndex(path, *context.files);
+
+    std::string line;
+    std::string name;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        int version = 0;
+        if (parseInclude(line, name)) {
+            const std::string resolved = resolve(name, path);
+            if (resolved.empty()) {
+                std::cout << "ERROR::SHADER_PREPROCESSOR:: " << path << ":" << number << " include " << name << " not found" << std::endl;
+                return false;
+            }
+            if (std::find(context.included.begin(), context.included.end(), resolved) != context.included.end()) {
+                // already in this stage, an empty line keeps the numbering
+                context.code += '\n';
+                continue;
+            }
+            context.included.push_back(resolved);
+            context.code += lineDirective(1, fileIndex(resolved, *context.files), context.version);
+            if (!expand(resolved, false, context)) {
+                return false;
+            }
+            context.code += lineDirective(number + 1, index, context.version);
+            continue;
+        }
+        if (parseVersion(line, version)) {
+            if (!main) {
+                std::cout << "WARNING::SHADER_PREPROCESSOR:: " << path << ":" << number << " #version in an include is ignored" << std::endl;
+                context.code += '\n';
+                continue;
+            }
+            // #version must stay the first statement, the defines and the #line follow it
+            context.version = version;
+            context.code += line;
+            context.code += '\n';
+            if (!context.injected) {
+                context.code += context.defines->toGlsl();
+                context.code += lineDirective(number + 1, index, context.version);
+                context.injected = true;
+            }
+            continue;
+        }
+        context.code += line;
+        context.code += '\n';
+    }
+
+    if (main && !context.injected) {
+        // no #version, the defines and the #line go on top
+        context.code = context.defines->toGlsl() + lineDirective(1, index, context.version) + context.code;
+        context.injected = true;
+    }
+    return true;
+}
+
+std::string ShaderPreprocessor::resolve(const std::string& name, const std::string& from) const {
+    std::error_code error;
+    const std::filesystem::path local = std::filesystem::path(from).parent_path() / name;
+    if (std::filesystem::is_regular_file(local, error)) {
+        return FileWatcher::normalizePath(local.string());
+    }
+    for (const auto& directory: includeDirectories) {
+        const std::filesystem::path candidate = std::filesystem::path(directory) / name;
+        if (std::filesystem::is_regular_file(candidate, error)) {
+            return FileWatcher::normalizePath(candidate.string());
+        }
+    }
+    return std::string();
+}
+
+std::string ShaderPreprocessor::lineDirective(int line, size_t file, int version) {
+    // up to GLSL 4.10 #line names the number of the line before the next one
+    const int number = version < 420 ? line - 1 : line;
+    return "#line " + std::to_string(number) + " " + std::to_string(file) + "\n";
+}
+
+size_t ShaderPreprocessor::fileIndex(const std::string& path, std::vector<std::string>& files) {
+    const auto it = std::find(files.begin(), files.end(), path);
+    if (it != files.end()) {
+        return static_cast<size_t>(it - files.begin());
+    }
+    files.push_back(path);
+    return files.size() - 1;
+}
+
+void ShaderPreprocessor::printFiles(const std::vector<std::string>& files) {
+    for (size_t i = 0; i < files.size(); i++) {
+        std::cout << "  " << i << ": " << files[i] << std::endl;
+    }
+}
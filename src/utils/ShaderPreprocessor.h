@@ -0,0 +1,92 @@
+#ifndef OPENGL_UTILS_SHADER_PREPROCESSOR_H
+#define OPENGL_UTILS_SHADER_PREPROCESSOR_H
+
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * #define NAME VALUE lines a shader is compiled with, e.g. {{"NUM_POINT_LIGHTS", "4"}, {"SPECULAR_MAP", "1"}}.
+ * Kept sorted by name, so the same set always gives the same string and the same cache keys.
+ */
+class ShaderDefines {
+public:
+    ShaderDefines() = default;
+
+    ShaderDefines(std::initializer_list<std::pair<std::string, std::string>> values);
+
+    ShaderDefines& set(const std::string& name, const std::string& value = "1");
+
+    ShaderDefines& set(const std::string& name, int value);
+
+    void erase(const std::string& name);
+
+    bool empty() const { return values.empty(); }
+
+    // "NAME=VALUE;NAME=VALUE", for keys and logs
+    std::string toString() const;
+
+    // one #define line per entry
+    std::string toGlsl() const;
+
+    bool operator==(const ShaderDefines& other) const { return values == other.values; }
+
+private:
+    std::map<std::string, std::string> values;
+};
+
+/*
+ * GLSL front end of Shader: resolves #include "file" and injects defines after #version.
+ *   - an include is searched next to the including file, then in the include directories
+ *     ("shaders" by default, so #include "common/Light.glsl" works from every shader)
+ *   - every file is included once per stage, shared struct headers need no guards
+ *   - includes are not conditional, an #include inside #if is always expanded
+ *   - #line directives keep driver errors pointing at the right line; their source string numbers
+ *     index the files list, printFiles lists it next to a compile log
+ */
+class ShaderPreprocessor {
+public:
+    static ShaderPreprocessor& getInstance();
+
+    ShaderPreprocessor(const ShaderPreprocessor&) = delete;
+    ShaderPreprocessor& operator=(const ShaderPreprocessor&) = delete;
+
+    void addIncludeDirectory(const std::string& directory);
+
+    /*
+     * The expanded source of path. Every file read is appended to files (normalized, see
+     * FileWatcher::normalizePath) unless it is there already, so both stages of a program can
+     * share one list. False (and an error printed) if a file can not be read or an include is not found.
+     */
+    bool process(const std::string& path, const ShaderDefines& defines, std::string& code, std::vector<std::string>& files);
+
+    // "  0: shaders/...", what the source numbers in a driver log refer to
+    static void printFiles(const std::vector<std::string>& files);
+
+private:
+    struct Context {
+        const ShaderDefines* defines;
+        std::vector<std::string>* files;
+        std::vector<std::string> included;
+        int version;
+        bool injected;
+        std::string code;
+    };
+
+    std::vector<std::string> includeDirectories {"shaders"};
+
+    ShaderPreprocessor() = default;
+
+    bool expand(const std::string& path, bool main, Context& context);
+
+    // normalized path of an include, empty if it is nowhere
+    std::string resolve(const std::string& name, const std::string& from) const;
+
+    static std::string lineDirective(int line, size_t file, int version);
+
+    static size_t fileIndex(const std::string& path, std::vector<std::string>& files);
+};
+
+#endif
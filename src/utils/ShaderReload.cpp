@@ -0,0 +1,364 @@
+#include "ShaderReload.h"
+#include "utils/ProgramCache.h"
+#include "utils/Shader.h"
+#include "utils/Utils.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// GL_KHR_parallel_shader_compile, a 3.3 core glad does not define it
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// a hidden window whose context shares objects with the application's, and the thread using it
+struct ShaderReload::Worker {
+    GLFWwindow* context = nullptr;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<Pending>> queue;
+    bool quit = false;
+};
+
+ShaderReload& ShaderReload::getInstance() {
+    static ShaderReload instance;
+    return instance;
+}
+
+ShaderReload::ShaderReload() = default;
+
+ShaderReload::~ShaderReload() {
+    // stop was not called: glfw may be gone already, only the thread is ended
+    if (worker) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->quit = true;
+        }
+        worker->wake.notify_one();
+        worker->thread.join();
+    }
+}
+
+bool ShaderReload::start(const std::string& directory) {
+    if (!watcher.watch(directory)) {
+        return false;
+    }
+    if (!checked) {
+        checkParallel();
+    }
+    if (!stats.parallel && !worker) {
+        startWorker();
+    }
+    std::cout << "ShaderReload: watching " << directory << (stats.parallel ? ", parallel compile" : worker ? ", compiling on a worker" : "") << std::endl;
+    return true;
+}
+
+void ShaderReload::stop() {
+    watcher.stop();
+    for (const auto& job: pending) {
+        discard(job);
+    }
+    pending.clear();
+    stopWorker();
+}
+
+bool ShaderReload::startWorker() {
+    GLFWwindow* current = glfwGetCurrentContext();
+    if (!current) {
+        return false;
+    }
+    // same hints as the application's window, so the contexts can share
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* context = glfwCreateWindow(1, 1, "ShaderReload", nullptr, current);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!context) {
+        std::cout << "WARNING::SHADER_RELOAD:: no shared context, reloads compile on the GL thread" << std::endl;
+        return false;
+    }
+    worker = std::make_unique<Worker>();
+    worker->context = context;
+    worker->thread = std::thread(workerLoop, worker.get());
+    stats.worker = true;
+    return true;
+}
+
+void ShaderReload::stopWorker() {
+    if (!worker) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->quit = true;
+    }
+    worker->wake.notify_one();
+    worker->thread.join();
+    glfwDestroyWindow(worker->context);
+    worker.reset();
+    stats.worker = false;
+}
+
+void ShaderReload::workerLoop(Worker* worker) {
+    glfwMakeContextCurrent(worker->context);
+    for (;;) {
+        std::shared_ptr<Pending> job;
+        {
+            std::unique_lock<std::mutex> lock(worker->mutex);
+            worker->wake.wait(lock, [worker] { return worker->quit || !worker->queue.empty(); });
+            if (worker->quit) {
+                break;
+            }
+            job = worker->queue.front();
+            worker->queue.pop_front();
+            if (job->cancelled) {
+                continue;
+            }
+        }
+        // the GL thread only reads the job again once done is set
+        compile(*job);
+        readStatus(*job);
+        // the program must be complete before the other context uses it
+        glFinish();
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        job->done = true;
+        if (job->cancelled) {
+            deleteObjects(*job);
+        }
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+void ShaderReload::add(Shader* shader) {
+    if (std::find(shaders.begin(), shaders.end(), shader) == shaders.end()) {
+        shaders.push_back(shader);
+    }
+}
+
+void ShaderReload::remove(Shader* shader) {
+    shaders.erase(std::remove(shaders.begin(), shaders.end(), shader), shaders.end());
+    for (auto it = pending.begin(); it != pending.end();) {
+        if ((*it)->shader == shader) {
+            discard(*it);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ShaderReload::moved(Shader* from, Shader* to) {
+    for (Shader*& shader: shaders) {
+        if (shader == from) {
+            shader = to;
+        }
+    }
+    for (const auto& job: pending) {
+        if (job->shader == from) {
+            job->shader = to;
+        }
+    }
+}
+
+void ShaderReload::checkParallel() {
+    checked = true;
+    MaxShaderCompilerThreadsProc maxThreads = nullptr;
+    if (gl::hasExtension("GL_KHR_parallel_shader_compile")) {
+        maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    } else if (gl::hasExtension("GL_ARB_parallel_shader_compile")) {
+        maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    }
+    if (maxThreads) {
+        // as many threads as the driver likes
+        maxThreads(0xFFFFFFFFu);
+        stats.parallel = true;
+    }
+}
+
+void ShaderReload::reload(Shader* shader) {
+    if (!checked) {
+        checkParallel();
+    }
+    // a newer edit replaces a compile still in flight
+    for (auto it = pending.begin(); it != pending.end();) {
+        if ((*it)->shader == shader) {
+            discard(*it);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!shader->readSources(vertexCode, fragmentCode)) {
+        return;
+    }
+
+    auto job = std::make_shared<Pending>();
+    job->shader = shader;
+    job->cacheKey = ProgramCache::getInstance().keyFor(vertexCode, fragmentCode, shader->getDefines().toString());
+    job->start = std::chrono::steady_clock::now();
+    job->vertexCode = std::move(vertexCode);
+    job->fragmentCode = std::move(fragmentCode);
+    if (worker) {
+        job->onWorker = true;
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->queue.push_back(job);
+        }
+        worker->wake.notify_one();
+    } else {
+        // no status queries here, they would wait for the compiler
+        compile(*job);
+    }
+    pending.push_back(job);
+    stats.started++;
+}
+
+void ShaderReload::compile(Pending& job) {
+    const char* vertexSource = job.vertexCode.c_str();
+    const char* fragmentSource = job.fragmentCode.c_str();
+    job.vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(job.vertex, 1, &vertexSource, nullptr);
+    glCompileShader(job.vertex);
+    job.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(job.fragment, 1, &fragmentSource, nullptr);
+    glCompileShader(job.fragment);
+    job.program = glCreateProgram();
+    glAttachShader(job.program, job.vertex);
+    glAttachShader(job.program, job.fragment);
+    ProgramCache::getInstance().prepareLink(job.program);
+    glLinkProgram(job.program);
+}
+
+void ShaderReload::readStatus(Pending& job) {
+    char infoLog[1024];
+    GLint success = 0;
+    glGetShaderiv(job.vertex, GL_COMPILE_STATUS, &success);
+    job.vertexOk = success != 0;
+    if (!job.vertexOk) {
+        glGetShaderInfoLog(job.vertex, sizeof(infoLog), nullptr, infoLog);
+        job.vertexLog = infoLog;
+    }
+    glGetShaderiv(job.fragment, GL_COMPILE_STATUS, &success);
+    job.fragmentOk = success != 0;
+    if (!job.fragmentOk) {
+        glGetShaderInfoLog(job.fragment, sizeof(infoLog), nullptr, infoLog);
+        job.fragmentLog = infoLog;
+    }
+    glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+    job.linked = success != 0;
+    if (!job.linked) {
+        glGetProgramInfoLog(job.program, sizeof(infoLog), nullptr, infoLog);
+        job.linkLog = infoLog;
+    }
+}
+
+bool ShaderReload::isComplete(const Pending& job) const {
+    if (job.onWorker) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        return job.done;
+    }
+    if (stats.parallel) {
+        GLint complete = 0;
+        glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &complete);
+        return complete != 0;
+    }
+    // no way to ask without waiting, finish blocks on the GL thread if the compile is not done
+    return job.frames > 0;
+}
+
+void ShaderReload::update() {
+    if (!isRunning() && pending.empty()) {
+        return;
+    }
+    const std::vector<std::string> changed = watcher.poll();
+    if (!changed.empty()) {
+        stats.changes += changed.size();
+        for (Shader* shader: shaders) {
+            // the stages and their includes, an edit to a shared include reloads every user
+            const std::vector<std::string>& files = shader->getSourceFiles();
+            const bool edited = std::any_of(changed.begin(), changed.end(), [&](const std::string& path) {
+                return std::find(files.begin(), files.end(), path) != files.end();
+            });
+            if (edited) {
+                std::cout << "ShaderReload: recompiling " << shader->getVertexPath() << " + " << shader->getFragmentPath() << std::endl;
+                reload(shader);
+            }
+        }
+    }
+
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (!isComplete(**it)) {
+            (*it)->frames++;
+            ++it;
+            continue;
+        }
+        finish(**it);
+        it = pending.erase(it);
+    }
+}
+
+void ShaderReload::finish(Pending& job) {
+    if (!job.onWorker) {
+        readStatus(job);
+    }
+    bool ok = true;
+    if (!job.vertexOk) {
+        std::cout << "ERROR::SHADER_RELOAD:: " << job.shader->getVertexPath() << " compile error\n" << job.vertexLog << std::endl;
+        ShaderPreprocessor::printFiles(job.shader->getSourceFiles());
+        ok = false;
+    }
+    if (!job.fragmentOk) {
+        std::cout << "ERROR::SHADER_RELOAD:: " << job.shader->getFragmentPath() << " compile error\n" << job.fragmentLog << std::endl;
+        ShaderPreprocessor::printFiles(job.shader->getSourceFiles());
+        ok = false;
+    }
+    if (ok && !job.linked) {
+        std::cout << "ERROR::SHADER_RELOAD:: " << job.shader->getVertexPath() << " + " << job.shader->getFragmentPath()
+                  << " link error\n" << job.linkLog << std::endl;
+        ok = false;
+    }
+    if (!ok) {
+        std::cout << "ShaderReload: keeping the running program" << std::endl;
+        deleteObjects(job);
+        stats.failed++;
+        return;
+    }
+
+    glDetachShader(job.program, job.vertex);
+    glDetachShader(job.program, job.fragment);
+    glDeleteShader(job.vertex);
+    glDeleteShader(job.fragment);
+    job.shader->replaceProgram(job.program);
+    stats.succeeded++;
+    stats.lastCompileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.start).count();
+    std::cout << "ShaderReload: " << job.shader->getVertexPath() << " + " << job.shader->getFragmentPath() << " reloaded in "
+              << stats.lastCompileMs << " ms" << std::endl;
+
+    // the next launch starts from the edited program
+    ProgramCache::getInstance().store(job.cacheKey, job.shader->ID);
+}
+
+void ShaderReload::discard(const std::shared_ptr<Pending>& job) {
+    if (job->onWorker) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (!job->done) {
+            // the worker skips it, or deletes what it made once it is done
+            job->cancelled = true;
+            return;
+        }
+    }
+    deleteObjects(*job);
+}
+
+void ShaderReload::deleteObjects(Pending& job) {
+    glDeleteProgram(job.program);
+    glDeleteShader(job.vertex);
+    glDeleteShader(job.fragment);
+    job.program = job.vertex = job.fragment = 0;
+}
@@ -0,0 +1,129 @@
+#ifndef OPENGL_UTILS_SHADER_RELOAD_H
+#define OPENGL_UTILS_SHADER_RELOAD_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "utils/FileWatcher.h"
+
+class Shader;
+
+struct ShaderReloadStats {
+    size_t changes = 0;         // watched files reported changed
+    size_t started = 0;         // programs sent to the compiler
+    size_t succeeded = 0;       // swapped in
+    size_t failed = 0;          // compile or link errors, the old program kept running
+    double lastCompileMs = 0.0; // from start to the swap, spread over frames
+    bool parallel = false;      // GL_KHR_parallel_shader_compile completion polling
+    bool worker = false;        // compiled on a thread with a shared context
+};
+
+/*
+ * Hot reload of every loaded Shader whose stages or includes change under the watched directories.
+ *   - with GL_KHR_parallel_shader_compile (or the ARB one) the driver compiles on its own threads:
+ *     compile and link are issued without asking for their status and update polls
+ *     GL_COMPLETION_STATUS_KHR
+ *   - without it start creates a hidden window sharing the GL context, and a worker thread
+ *     compiles and links there; update only picks up programs the worker has finished
+ *   - only when neither is available (reload before start, or no shared context) the status is
+ *     read one frame later, and that query waits for the compile on the GL thread
+ *   - only a program that linked replaces Shader::ID, between two frames, with its uniform values
+ *     carried over; on errors the info logs are printed and the old program keeps running
+ * Shader registers itself on load. Call start once and update every frame on the GL thread,
+ * and stop before the window is destroyed (Application does all three).
+ */
+class ShaderReload {
+public:
+    static ShaderReload& getInstance();
+
+    ShaderReload(const ShaderReload&) = delete;
+    ShaderReload& operator=(const ShaderReload&) = delete;
+
+    bool start(const std::string& directory = "shaders");
+
+    // stops watching, drops compiles in flight and ends the worker
+    void stop();
+
+    bool isRunning() const { return watcher.isWatching(); }
+
+    // starts the compiles of changed shaders and swaps in the finished ones
+    void update();
+
+    // reload shader now, e.g. from a key binding; it still completes in update
+    void reload(Shader* shader);
+
+    ShaderReloadStats getStats() const { return stats; }
+
+    void add(Shader* shader);
+
+    void remove(Shader* shader);
+
+    // a moved Shader: the registration and a compile in flight follow it to its new address
+    void moved(Shader* from, Shader* to);
+
+private:
+    typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+    struct Pending {
+        Shader* shader = nullptr;
+        GLuint vertex = 0;
+        GLuint fragment = 0;
+        GLuint program = 0;
+        int frames = 0;             // updates since the compile was issued
+        uint64_t cacheKey = 0;      // ProgramCache key of the sources that were compiled
+        std::chrono::steady_clock::time_point start;
+        // the worker compiles from these and reports status and logs, guarded by Worker::mutex
+        std::string vertexCode;
+        std::string fragmentCode;
+        bool onWorker = false;
+        bool done = false;
+        bool cancelled = false;
+        // statuses and logs, filled by the worker or read in finish
+        bool vertexOk = false;
+        bool fragmentOk = false;
+        bool linked = false;
+        std::string vertexLog;
+        std::string fragmentLog;
+        std::string linkLog;
+    };
+
+    struct Worker;
+
+    FileWatcher watcher;
+    std::vector<Shader*> shaders;
+    std::vector<std::shared_ptr<Pending>> pending;
+    std::unique_ptr<Worker> worker;
+    ShaderReloadStats stats;
+    bool checked = false;
+
+    ShaderReload();
+    ~ShaderReload();
+
+    void checkParallel();
+
+    bool startWorker();
+
+    void stopWorker();
+
+    static void workerLoop(Worker* worker);
+
+    // issues the compiles and the link on the current context
+    static void compile(Pending& job);
+
+    // statuses and info logs, waits for the compiler
+    static void readStatus(Pending& job);
+
+    bool isComplete(const Pending& job) const;
+
+    void finish(Pending& job);
+
+    void discard(const std::shared_ptr<Pending>& job);
+
+    static void deleteObjects(Pending& job);
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "Texture.h"
+#include "utils/DirectStateAccess.h"
+#include "utils/MipChain.h"
+#include "utils/TextureResidency.h"
 #include <iostream>
-#include "stb_define.h"
 
 Texture::Texture(): textureId(0), width(0), height(0), channels(0), format(GL_RGB) {
 
@@ -11,9 +13,17 @@ Texture::Texture(const std::string& filepath): textureId(0), width(0), height(0)
 }
 
 Texture::~Texture() {
-    if (textureId != 0) {
+    release();
+}
+
+void Texture::release() {
+    if (cached) {
+        cached.reset();
+    } else if (textureId != 0) {
+        TextureResidency::getInstance().untrack(textureId);
         glDeleteTextures(1, &textureId);
     }
+    textureId = 0;
 }
 
 Texture::Texture(Texture&& other) noexcept 
@@ -23,15 +33,14 @@ Texture::Texture(Texture&& other) noexcept
     ,channels(other.channels)
     ,format(other.format)
     ,type(other.type)
-    ,path(std::move(other.path)){
+    ,path(std::move(other.path))
+    ,cached(std::move(other.cached)){
     other.textureId = 0;
 }
 
 Texture& Texture::operator=(Texture&& other) noexcept {
     if (this != &other) {
-        if (textureId != 0) {
-            glDeleteTextures(1, &textureId);
-        }
+        release();
         textureId = other.textureId;
         width = other.width;
         height = other.height;
@@ -39,6 +48,7 @@ Texture& Texture::operator=(Texture&& other) noexcept {
         format = other.format;
         type = other.type;
         path = std::move(other.path);
+        cached = std::move(other.cached);
 
         other.textureId = 0;
     }
@@ -46,63 +56,59 @@ Texture& Texture::operator=(Texture&& other) noexcept {
 }
 
 bool Texture::loadFromFile(const std::string& filepath) {
-    stbi_set_flip_vertically_on_load(true);
-    path = filepath.substr(filepath.find_last_of('/') + 1);
-    std::cout << "Path: " << path << std::endl;
+    release();
     std::cout << "LoadTexture From Path: " << filepath << std::endl;
-    unsigned char* data = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
-    if (!data) {
-        std::cerr << "Failed to load texture: " << filepath << std::endl;
-        std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
-        return false;
-    }
-
-    switch(channels) {
-        case 1:
-            format = GL_RED;
-            break;
-        case 3:
-            format = GL_RGB;
-            break;
-        case 4:
-            format = GL_RGBA;
-            break;
-        default:
-            std::cerr << "Unsupported number of channels: " << channels << std::endl;
-            stbi_image_free(data);
-            return false;
-    }
 
-    glGenTextures(1, &textureId);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    // decoded and uploaded once per process, later loads of the same file share the GL texture
+    return adopt(filepath, TextureCache::getInstance().acquire(filepath, true));
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+bool Texture::loadFromFileAsync(const std::string& filepath) {
+    release();
+    std::cout << "LoadTexture From Path (async): " << filepath << std::endl;
+    return adopt(filepath, TextureCache::getInstance().acquireAsync(filepath, true));
+}
 
-    // Upload texture data
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+std::vector<Texture> Texture::loadFromFiles(const std::vector<std::string>& filepaths) {
+    std::vector<TextureCache::Handle> handles = TextureCache::getInstance().acquireAll(filepaths, true);
+    std::vector<Texture> textures(filepaths.size());
+    for (size_t i = 0; i < filepaths.size(); i++) {
+        textures[i].adopt(filepaths[i], std::move(handles[i]));
+    }
+    return textures;
+}
 
-    // Unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+bool Texture::adopt(const std::string& filepath, TextureCache::Handle handle) {
+    path = filepath.substr(filepath.find_last_of('/') + 1);
+    cached = std::move(handle);
+    if (!cached) {
+        std::cerr << "Failed to load texture: " << filepath << std::endl;
+        return false;
+    }
 
-    // Free image data
-    stbi_image_free(data);
+    textureId = cached->id;
+    width = cached->width;
+    height = cached->height;
+    channels = cached->channels;
+    format = cached->format;
 
+    if (!cached->ready) {
+        std::cout << "Texture queued for upload: " << filepath << std::endl;
+        return true;
+    }
     std::cout << "Texture loaded successfully: " << filepath << " (" << width << "x" << height << ", " << channels << " channels)" << std::endl;
     return true;
 }
 
 
-bool Texture::createFromData(const unsigned char* data, int w, int h, int ch) {
+bool Texture::createFromData(const unsigned char* data, int w, int h, int ch, MipColorSpace colorSpace) {
     // Create texture from raw data
     if (!data) {
         std::cerr << "Invalid data provided to createFromData" << std::endl;
         return false;
     }
 
+    release();
     width = w;
     height = h;
     channels = ch;
@@ -123,34 +129,54 @@ bool Texture::createFromData(const unsigned char* data, int w, int h, int ch) {
             return false;
     }
 
-    // Generate and bind texture
-    glGenTextures(1, &textureId);
-    glBindTexture(GL_TEXTURE_2D, textureId);
-
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Generate texture and set its parameters, DSA still binds once below for the mip upload
+    if (gl::useDsa()) {
+        const gl::DsaFunctions& dsa = gl::dsa();
+        dsa.createTextures(GL_TEXTURE_2D, 1, &textureId);
+        dsa.textureParameteri(textureId, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        dsa.textureParameteri(textureId, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        dsa.textureParameteri(textureId, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        dsa.textureParameteri(textureId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl::bindTexture(GL_TEXTURE_2D, textureId);
+    } else {
+        glGenTextures(1, &textureId);
+        gl::bindTexture(GL_TEXTURE_2D, textureId);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
 
-    // Upload texture data
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // Upload texture data and its mip chain level by level
+    const std::vector<Image> mips = buildMipLevels(data, width, height, channels, colorSpace);
+    uploadMipChain(GL_TEXTURE_2D, data, width, height, channels, mips);
+
+    // accounted only, there is no file to reload the pixels from
+    ResidencyFootprint footprint;
+    footprint.width = width;
+    footprint.height = height;
+    footprint.levels = static_cast<int>(mips.size()) + 1;
+    footprint.bytes = static_cast<size_t>(width) * height * channels;
+    for (const auto& level: mips) {
+        footprint.bytes += level.byteSize();
+    }
+    TextureResidency::getInstance().track(textureId, GL_TEXTURE_2D, format, footprint, path.empty() ? "(data)" : path);
 
     // Unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl::bindTexture(GL_TEXTURE_2D, 0);
 
     return true;
 }
 
 
 void Texture::bind(GLuint textureUnit) const {
+    TextureResidency::getInstance().touch(textureId);
     glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    gl::bindTexture(GL_TEXTURE_2D, textureId);
 }
 
 void Texture::unbind() const {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::setType(TextureType type) {
@@ -159,13 +185,21 @@ void Texture::setType(TextureType type) {
 
 // Set texture parameters
 void Texture::setParameter(GLenum parameter, GLuint value) {
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    if (gl::useDsa()) {
+        gl::dsa().textureParameteri(textureId, parameter, static_cast<GLint>(value));
+        return;
+    }
+    gl::bindTexture(GL_TEXTURE_2D, textureId);
     glTexParameteri(GL_TEXTURE_2D, parameter, value);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::setParameter(GLenum parameter, GLfloat value) {
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    if (gl::useDsa()) {
+        gl::dsa().textureParameterf(textureId, parameter, value);
+        return;
+    }
+    gl::bindTexture(GL_TEXTURE_2D, textureId);
     glTexParameterf(GL_TEXTURE_2D, parameter, value);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl::bindTexture(GL_TEXTURE_2D, 0);
 }
@@ -3,7 +3,10 @@
 #include <cstdint>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <memory>
 #include <string>
+#include <vector>
+#include "utils/TextureCache.h"
 
 enum class TextureType: uint8_t {
     DIFFUSE,
@@ -18,6 +21,12 @@ private:
     GLenum format;
     TextureType type = TextureType::DIFFUSE;
     std::string path;
+    // set for file textures, the GL object then belongs to TextureCache and is shared
+    TextureCache::Handle cached;
+
+    void release();
+
+    bool adopt(const std::string& filepath, TextureCache::Handle handle);
 
 public:
     Texture();
@@ -36,12 +45,23 @@ public:
 
     bool loadFromFile(const std::string& filepath);
 
-    bool createFromData(const unsigned char* data, int w, int h, int ch);
+    /*
+     * returns at once with a grey placeholder, decode and upload happen through the
+     * TextureUploadQueue over the next frames. The id stays the same, isReady() flips.
+     */
+    bool loadFromFileAsync(const std::string& filepath);
+
+    // decodes all files concurrently (see TextureCache::acquireAll), failed entries are !isValid()
+    static std::vector<Texture> loadFromFiles(const std::vector<std::string>& filepaths);
+
+    // uploads with a CPU mip chain (see MipChain.h), built on the calling thread
+    bool createFromData(const unsigned char* data, int w, int h, int ch, MipColorSpace colorSpace = MipColorSpace::SRGB);
 
     void bind(GLuint textureUnit = 0) const;
 
     void unbind() const;
 
+    // glTextureParameter* by name when direct state access is there (DirectStateAccess.h), bind-to-edit otherwise
     void setParameter(GLenum parameter, GLuint value);
 
     void setParameter(GLenum parameter, GLfloat value);
@@ -49,13 +69,15 @@ public:
     void setType(TextureType type);
 
     GLuint getId() const { return textureId; }
-    int getWidth() const { return width; }
-    int getHeight() const { return height; }
-    int getChannles() const { return channels; }
-    GLenum getFormat() const { return format; }
+    // read through the cache entry, a streamed texture changes size when its pixels arrive
+    int getWidth() const { return cached ? cached->width : width; }
+    int getHeight() const { return cached ? cached->height : height; }
+    int getChannles() const { return cached ? cached->channels : channels; }
+    GLenum getFormat() const { return cached ? cached->format : format; }
     TextureType getType() const { return type; }
     std::string getPath() const { return path; }
     bool isValid() const { return textureId != 0; }
+    bool isReady() const { return cached ? cached->ready : isValid(); }
 
 
 };
@@ -0,0 +1,416 @@
+#include "TextureAtlas.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+// where one texture goes inside a layer, the padded rect includes the gutter
+struct Placement {
+    int layer = 0;
+    int x = 0;
+    int y = 0;
+    int extendLeft = 0;
+    int extendBottom = 0;
+    int extendRight = 0;
+    int extendTop = 0;
+};
+
+/*
+ * Bottom-left skyline packer: the top edge of the placed rects is kept as a list of
+ * horizontal segments, a new rect goes where its top ends lowest.
+ */
+class Skyline {
+public:
+    Skyline(int width, int height) : width(width), height(height), segments{{0, 0, width}} {}
+
+    bool insert(int w, int h, int& outX, int& outY) {
+        int bestIndex = -1, bestTop = INT_MAX, bestWidth = INT_MAX, bestY = 0;
+        for (size_t i = 0; i < segments.size(); i++) {
+            int y = 0;
+            if (!fits(i, w, h, y)) {
+                continue;
+            }
+            if (y + h < bestTop || (y + h == bestTop && segments[i].width < bestWidth)) {
+                bestIndex = static_cast<int>(i);
+                bestTop = y + h;
+                bestWidth = segments[i].width;
+                bestY = y;
+            }
+        }
+        if (bestIndex < 0) {
+            return false;
+        }
+        outX = segments[bestIndex].x;
+        outY = bestY;
+
+        segments.insert(segments.begin() + bestIndex, Segment{outX, bestY + h, w});
+        // cut the segments the new one covers
+        for (size_t i = bestIndex + 1; i < segments.size();) {
+            const int coveredUntil = segments[i - 1].x + segments[i - 1].width;
+            if (segments[i].x >= coveredUntil) {
+                break;
+            }
+            const int overlap = coveredUntil - segments[i].x;
+            if (segments[i].width <= overlap) {
+                segments.erase(segments.begin() + i);
+                continue;
+            }
+            segments[i].x += overlap;
+            segments[i].width -= overlap;
+            break;
+        }
+        for (size_t i = 0; i + 1 < segments.size();) {
+            if (segments[i].y == segments[i + 1].y) {
+                segments[i].width += segments[i + 1].width;
+                segments.erase(segments.begin() + i + 1);
+            } else {
+                i++;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    int width;
+    int height;
+    std::vector<Segment> segments;
+
+    bool fits(size_t index, int w, int h, int& y) const {
+        if (segments[index].x + w > width) {
+            return false;
+        }
+        int remaining = w;
+        y = 0;
+        for (size_t i = index; remaining > 0 && i < segments.size(); i++) {
+            y = std::max(y, segments[i].y);
+            if (y + h > height) {
+                return false;
+            }
+            remaining -= segments[i].width;
+        }
+        return true;
+    }
+};
+
+int alignUp(int value, int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/*
+ * copies source to (x, y) of the layer, converting to the layer's channel count, and repeats
+ * its border texels outwards so filtering near the edge never reads a neighbour
+ */
+void blitExtended(Image& layer, const Image& source, const Placement& placement) {
+    const int sourceChannels = source.channels;
+    const int channels = layer.channels;
+    const int x0 = std::max(placement.x - placement.extendLeft, 0);
+    const int x1 = std::min(placement.x + source.width + placement.extendRight, layer.width);
+    const int y0 = std::max(placement.y - placement.extendBottom, 0);
+    const int y1 = std::min(placement.y + source.height + placement.extendTop, layer.height);
+    for (int py = y0; py < y1; py++) {
+        const int sy = std::min(std::max(py - placement.y, 0), source.height - 1);
+        const unsigned char* sourceRow = source.pixels.data() + static_cast<size_t>(sy) * source.width * sourceChannels;
+        unsigned char* row = layer.pixels.data() + static_cast<size_t>(py) * layer.width * channels;
+        for (int px = x0; px < x1; px++) {
+            const int sx = std::min(std::max(px - placement.x, 0), source.width - 1);
+            const unsigned char* s = sourceRow + static_cast<size_t>(sx) * sourceChannels;
+            unsigned char* d = row + static_cast<size_t>(px) * channels;
+            if (sourceChannels == channels) {
+                std::copy(s, s + channels, d);
+                continue;
+            }
+            // gray (+ alpha) or RGB (+ alpha) widened, a missing alpha is opaque
+            const unsigned char r = s[0];
+            const unsigned char g = sourceChannels >= 3 ? s[1] : s[0];
+            const unsigned char b = sourceChannels >= 3 ? s[2] : s[0];
+            const unsigned char a = sourceChannels == 2 ? s[1] : (sourceChannels == 4 ? s[3] : 255);
+            if (channels == 2) {
+                d[0] = r;
+                d[1] = a;
+            } else {
+                d[0] = r;
+                d[1] = g;
+                d[2] = b;
+                if (channels == 4) {
+                    d[3] = a;
+                }
+            }
+        }
+    }
+}
+
+}
+
+TextureAtlas::~TextureAtlas() {
+    if (textureId != 0) {
+        glDeleteTextures(1, &textureId);
+    }
+}
+
+TextureAtlas::TextureAtlas(TextureAtlas&& other) noexcept
+    : textureId(other.textureId)
+    , format(other.format)
+    , layout(other.layout)
+    , regions(std::move(other.regions))
+    , names(std::move(other.names))
+    , stats(other.stats) {
+    other.textureId = 0;
+}
+
+TextureAtlas& TextureAtlas::operator=(TextureAtlas&& other) noexcept {
+    if (this != &other) {
+        if (textureId != 0) {
+            glDeleteTextures(1, &textureId);
+        }
+        textureId = other.textureId;
+        format = other.format;
+        layout = other.layout;
+        regions = std::move(other.regions);
+        names = std::move(other.names);
+        stats = other.stats;
+
+        other.textureId = 0;
+    }
+    return *this;
+}
+
+void TextureAtlas::bind(GLuint textureUnit) const {
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+}
+
+void TextureAtlas::unbind() const {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+const AtlasRegion* TextureAtlas::find(const std::string& name) const {
+    auto it = names.find(name);
+    return it != names.end() ? &regions[it->second] : nullptr;
+}
+
+TextureAtlasBuilder::TextureAtlasBuilder(int pageSize, int padding)
+    : pageSize(std::max(pageSize, 1)), padding(std::max(padding, 0)) {
+}
+
+bool TextureAtlasBuilder::add(const std::string& name, Image image) {
+    if (!image.isValid() || formatForChannels(image.channels) == 0) {
+        std::cout << "ERROR::TEXTURE_ATLAS:: " << name << " has no usable pixels" << std::endl;
+        return false;
+    }
+    for (const auto& entry: entries) {
+        if (entry.name == name) {
+            std::cout << "ERROR::TEXTURE_ATLAS:: " << name << " was added twice" << std::endl;
+            return false;
+        }
+    }
+    entries.push_back({name, std::move(image)});
+    return true;
+}
+
+bool TextureAtlasBuilder::addFiles(const std::vector<std::string>& paths, bool flipVertically) {
+    std::vector<Image> images(paths.size());
+    std::vector<char> decoded(paths.size(), 0);
+    ThreadPool::getInstance().parallelFor(paths.size(), [&](size_t i) {
+        decoded[i] = loadImage(paths[i], images[i], flipVertically) ? 1 : 0;
+    });
+
+    bool ok = true;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!decoded[i]) {
+            std::cout << "ERROR::TEXTURE_ATLAS:: failed to load " << paths[i] << std::endl;
+            ok = false;
+            continue;
+        }
+        ok = add(paths[i], std::move(images[i])) && ok;
+    }
+    return ok;
+}
+
+TextureAtlas TextureAtlasBuilder::build(AtlasLayout layout) const {
+    TextureAtlas atlas;
+    if (entries.empty()) {
+        std::cout << "ERROR::TEXTURE_ATLAS:: nothing to build" << std::endl;
+        return atlas;
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    GLint maxSize = 0, maxLayers = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    int channels = 0;
+    int maxWidth = 0, maxHeight = 0;
+    for (const auto& entry: entries) {
+        channels = std::max(channels, entry.image.channels);
+        maxWidth = std::max(maxWidth, entry.image.width);
+        maxHeight = std::max(maxHeight, entry.image.height);
+    }
+
+    std::vector<Placement> placements(entries.size());
+    int layers = 0, layerWidth = 0, layerHeight = 0, levels = 1;
+    if (layout == AtlasLayout::Array) {
+        layerWidth = maxWidth;
+        layerHeight = maxHeight;
+        layers = static_cast<int>(entries.size());
+        levels = mipLevelCount(layerWidth, layerHeight);
+        for (size_t i = 0; i < entries.size(); i++) {
+            placements[i].layer = static_cast<int>(i);
+            placements[i].extendRight = layerWidth - entries[i].image.width;
+            placements[i].extendTop = layerHeight - entries[i].image.height;
+        }
+    } else {
+        // a gutter of padding texels survives log2(padding) halvings, aligning the rects to the
+        // same power of two keeps every mip texel inside one rect
+        while (padding >> levels) {
+            levels++;
+        }
+        const int alignment = 1 << (levels - 1);
+        std::vector<int> paddedWidth(entries.size()), paddedHeight(entries.size());
+        int limit = pageSize;
+        for (size_t i = 0; i < entries.size(); i++) {
+            paddedWidth[i] = alignUp(entries[i].image.width + 2 * padding, alignment);
+            paddedHeight[i] = alignUp(entries[i].image.height + 2 * padding, alignment);
+            limit = std::max({limit, paddedWidth[i], paddedHeight[i]});
+        }
+        if (maxSize > 0) {
+            limit = std::min(limit, maxSize);
+        }
+
+        // tallest first keeps the skyline flat
+        std::vector<size_t> order(entries.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return paddedHeight[a] != paddedHeight[b] ? paddedHeight[a] > paddedHeight[b] : paddedWidth[a] > paddedWidth[b];
+        });
+
+        std::vector<Skyline> pages;
+        for (size_t i: order) {
+            if (paddedWidth[i] > limit || paddedHeight[i] > limit) {
+                std::cout << "ERROR::TEXTURE_ATLAS:: " << entries[i].name << " is larger than GL_MAX_TEXTURE_SIZE" << std::endl;
+                return atlas;
+            }
+            int x = 0, y = 0;
+            size_t page = 0;
+            while (page < pages.size() && !pages[page].insert(paddedWidth[i], paddedHeight[i], x, y)) {
+                page++;
+            }
+            if (page == pages.size()) {
+                pages.emplace_back(limit, limit);
+                pages.back().insert(paddedWidth[i], paddedHeight[i], x, y);
+            }
+            Placement& placement = placements[i];
+            placement.layer = static_cast<int>(page);
+            placement.x = x + padding;
+            placement.y = y + padding;
+            placement.extendLeft = padding;
+            placement.extendBottom = padding;
+            placement.extendRight = paddedWidth[i] - entries[i].image.width - padding;
+            placement.extendTop = paddedHeight[i] - entries[i].image.height - padding;
+            // every layer shares one size, shrink it to what the pages actually use
+            layerWidth = std::max(layerWidth, x + paddedWidth[i]);
+            layerHeight = std::max(layerHeight, y + paddedHeight[i]);
+        }
+        layers = static_cast<int>(pages.size());
+        levels = std::min(levels, mipLevelCount(layerWidth, layerHeight));
+    }
+
+    if (layerWidth > maxSize || layerHeight > maxSize) {
+        std::cout << "ERROR::TEXTURE_ATLAS:: layers of " << layerWidth << "x" << layerHeight << " exceed GL_MAX_TEXTURE_SIZE" << std::endl;
+        return atlas;
+    }
+    if (layers > maxLayers) {
+        std::cout << "ERROR::TEXTURE_ATLAS:: " << layers << " layers exceed GL_MAX_ARRAY_TEXTURE_LAYERS" << std::endl;
+        return atlas;
+    }
+
+    // compose and filter the layers concurrently
+    std::vector<std::vector<size_t>> members(layers);
+    for (size_t i = 0; i < entries.size(); i++) {
+        members[placements[i].layer].push_back(i);
+    }
+    std::vector<Image> pages(layers);
+    std::vector<std::vector<Image>> chains(layers);
+    ThreadPool::getInstance().parallelFor(static_cast<size_t>(layers), [&](size_t layer) {
+        Image& page = pages[layer];
+        page.width = layerWidth;
+        page.height = layerHeight;
+        page.channels = channels;
+        page.pixels.assign(static_cast<size_t>(layerWidth) * layerHeight * channels, 0);
+        for (size_t i: members[layer]) {
+            blitExtended(page, entries[i].image, placements[i]);
+        }
+        if (levels > 1) {
+            chains[layer] = buildMipLevels(page, colorSpace);
+            chains[layer].resize(levels - 1);
+        }
+    });
+    const std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+
+    const GLenum format = formatForChannels(channels);
+    glGenTextures(1, &atlas.textureId);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.textureId);
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    size_t bytes = 0;
+    for (int level = 0; level < levels; level++) {
+        const Image& first = level == 0 ? pages[0] : chains[0][level - 1];
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, first.width, first.height, layers, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        for (int layer = 0; layer < layers; layer++) {
+            const Image& image = level == 0 ? pages[layer] : chains[layer][level - 1];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, image.width, image.height, 1, format, GL_UNSIGNED_BYTE,
+                            image.pixels.data());
+            bytes += image.byteSize();
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // repeat is done with fract in the shader, the hardware must not wrap into other regions
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    atlas.format = format;
+    atlas.layout = layout;
+    atlas.regions.resize(entries.size());
+    size_t usedTexels = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Image& image = entries[i].image;
+        AtlasRegion& region = atlas.regions[i];
+        region.layer = placements[i].layer;
+        region.x = placements[i].x;
+        region.y = placements[i].y;
+        region.width = image.width;
+        region.height = image.height;
+        region.uvTransform = glm::vec4(static_cast<float>(image.width) / layerWidth, static_cast<float>(image.height) / layerHeight,
+                                       static_cast<float>(region.x) / layerWidth, static_cast<float>(region.y) / layerHeight);
+        atlas.names[entries[i].name] = i;
+        usedTexels += static_cast<size_t>(image.width) * image.height;
+    }
+
+    AtlasStats& stats = atlas.stats;
+    stats.textures = entries.size();
+    stats.layers = layers;
+    stats.layerWidth = layerWidth;
+    stats.layerHeight = layerHeight;
+    stats.levels = levels;
+    stats.usedTexels = usedTexels;
+    stats.totalTexels = static_cast<size_t>(layerWidth) * layerHeight * layers;
+    stats.efficiency = static_cast<double>(usedTexels) / static_cast<double>(stats.totalTexels);
+    stats.bytes = bytes;
+    stats.buildMs = buildTime.count();
+    return atlas;
+}
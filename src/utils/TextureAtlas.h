@@ -0,0 +1,118 @@
+#ifndef OPENGL_UTILS_TEXTURE_ATLAS_H
+#define OPENGL_UTILS_TEXTURE_ATLAS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "utils/Image.h"
+#include "utils/MipChain.h"
+
+enum class AtlasLayout: uint8_t {
+    Array,      // one texture per layer, every layer as big as the largest texture
+    Packed,     // skyline packed pages with an edge extended gutter, one page per layer
+};
+
+/*
+ * Where a source texture ended up. In the shader (see shaders/03_shaders/02_1_Texture_Atlas_fs.glsl):
+ *   uv' = fract(uv) * uvTransform.xy + uvTransform.zw, sampled from layer
+ * fract keeps GL_REPEAT style tiling inside the region.
+ */
+struct AtlasRegion {
+    int layer = 0;
+    int x = 0;              // level 0 texels, gutter excluded
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    glm::vec4 uvTransform {1.0f, 1.0f, 0.0f, 0.0f};
+};
+
+struct AtlasStats {
+    size_t textures = 0;
+    int layers = 0;
+    int layerWidth = 0;
+    int layerHeight = 0;
+    int levels = 0;
+    size_t usedTexels = 0;      // texels of the source textures
+    size_t totalTexels = 0;     // layerWidth * layerHeight * layers
+    double efficiency = 0.0;    // usedTexels / totalTexels
+    size_t bytes = 0;           // all layers with their mip chains
+    double buildMs = 0.0;       // packing, padding and mip chains on the CPU
+};
+
+// GL_TEXTURE_2D_ARRAY built by TextureAtlasBuilder, every region is reachable without a rebind
+class TextureAtlas {
+public:
+    TextureAtlas() = default;
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    TextureAtlas(TextureAtlas&& other) noexcept;
+    TextureAtlas& operator=(TextureAtlas&& other) noexcept;
+
+    void bind(GLuint textureUnit = 0) const;
+
+    void unbind() const;
+
+    // nullptr if no texture of that name was added
+    const AtlasRegion* find(const std::string& name) const;
+
+    const std::vector<AtlasRegion>& getRegions() const { return regions; }
+    const AtlasStats& getStats() const { return stats; }
+    AtlasLayout getLayout() const { return layout; }
+    GLuint getId() const { return textureId; }
+    GLenum getFormat() const { return format; }
+    bool isValid() const { return textureId != 0; }
+
+private:
+    friend class TextureAtlasBuilder;
+
+    GLuint textureId = 0;
+    GLenum format = 0;
+    AtlasLayout layout = AtlasLayout::Array;
+    std::vector<AtlasRegion> regions;       // in the order the textures were added
+    std::unordered_map<std::string, size_t> names;
+    AtlasStats stats;
+};
+
+/*
+ * Collects textures and builds one TextureAtlas from them.
+ * All textures end up with the widest channel count that was added (gray is replicated, a
+ * missing alpha is opaque). Packed pages only get as many mip levels as the gutter covers
+ * (padding 4 -> 3 levels), regions are aligned so no mip texel mixes two textures.
+ */
+class TextureAtlasBuilder {
+public:
+    // pageSize is the packed page limit, raised to the largest texture and clamped to GL_MAX_TEXTURE_SIZE
+    explicit TextureAtlasBuilder(int pageSize = 2048, int padding = 4);
+
+    // false if the image is empty or the name was added before
+    bool add(const std::string& name, Image image);
+
+    // decodes concurrently on the ThreadPool, the paths are the names; false if any file failed
+    bool addFiles(const std::vector<std::string>& paths, bool flipVertically = true);
+
+    void setColorSpace(MipColorSpace space) { colorSpace = space; }
+
+    size_t size() const { return entries.size(); }
+
+    // must run on the GL thread, the builder keeps its textures and can build again
+    TextureAtlas build(AtlasLayout layout) const;
+
+private:
+    struct Entry {
+        std::string name;
+        Image image;
+    };
+
+    int pageSize;
+    int padding;
+    MipColorSpace colorSpace = MipColorSpace::SRGB;
+    std::vector<Entry> entries;
+};
+
+#endif
@@ -0,0 +1,498 @@
+#include "TextureCache.h"
+#include "utils/Image.h"
+#include "utils/ImageCache.h"
+#include "utils/Ktx2.h"
+#include "utils/MipChain.h"
+#include "utils/TextureResidency.h"
+#include "utils/TextureUploadQueue.h"
+#include "utils/ThreadPool.h"
+#include <filesystem>
+#include <iostream>
+
+CachedTexture::~CachedTexture() {
+    if (id != 0) {
+        TextureResidency::getInstance().untrack(id);
+        glDeleteTextures(1, &id);
+    }
+    TextureCache::getInstance().release(key, bytes);
+}
+
+static ResidencyFootprint footprintOf(const CachedTexture& texture) {
+    ResidencyFootprint footprint;
+    footprint.width = texture.width;
+    footprint.height = texture.height;
+    footprint.levels = texture.levels;
+    footprint.bytes = texture.bytes;
+    return footprint;
+}
+
+static size_t compressedBytes(const Ktx2Texture& ktx, GLenum format) {
+    // GL_RGBA8 when the driver lacked the format and the levels were decoded on the cpu
+    return format == GL_RGBA8 ? static_cast<size_t>(ktx.width) * ktx.height * 4 * 4 / 3 : ktx.byteSize();
+}
+
+// pixels and mip chain from the .texbin when it is current, otherwise decoded and written to it
+static bool decodeCached(const std::string& path, bool flipVertically, MipColorSpace colorSpace, Image& image, std::vector<Image>& mips) {
+    const uint32_t flags = ImageCache::flagsFor(flipVertically, true, colorSpace);
+    ImageCache cache;
+    if (cache.open(path, flags)) {
+        cache.copyTo(image, mips);
+        return true;
+    }
+    if (!loadImage(path, image, flipVertically)) {
+        return false;
+    }
+    mips = buildMipLevels(image, colorSpace);
+    ImageCache::write(path, flags, image, mips);
+    return true;
+}
+
+// decode + mip chain on the ThreadPool, the pixels then stream in through the TextureUploadQueue
+static void streamFromFile(const std::weak_ptr<CachedTexture>& weak, const std::string& path, bool flipVertically,
+                           MipColorSpace colorSpace) {
+    ThreadPool::getInstance().submit([weak, path, flipVertically, colorSpace]() {
+        if (weak.expired()) {
+            return;
+        }
+        TextureUpload upload;
+        upload.texture = weak;
+        if (!decodeCached(path, flipVertically, colorSpace, upload.image, upload.mips)) {
+            std::cout << "ERROR::TEXTURE_CACHE:: failed to load " << path << ", keeping the placeholder" << std::endl;
+            return;
+        }
+        TextureUploadQueue::getInstance().enqueue(std::move(upload));
+    });
+}
+
+// inverse of makeKey
+static void splitKey(const std::string& key, std::string& path, bool& flipVertically, MipColorSpace& colorSpace) {
+    path = key.substr(0, key.find('|'));
+    flipVertically = key.find("|noflip") == std::string::npos;
+    colorSpace = key.find("|linear") == std::string::npos ? MipColorSpace::SRGB : MipColorSpace::Linear;
+}
+
+TextureCache& TextureCache::getInstance() {
+    static TextureCache instance;
+    return instance;
+}
+
+std::string TextureCache::canonicalPath(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    if (error) {
+        canonical = std::filesystem::absolute(path, error).lexically_normal();
+    }
+    return canonical.generic_string();
+}
+
+std::string TextureCache::makeKey(const std::string& path, bool flipVertically, MipColorSpace colorSpace) {
+    // the same file loaded with and without the flip (or with other mips) are different textures
+    std::string key = canonicalPath(path);
+    if (!flipVertically) {
+        key += "|noflip";
+    }
+    if (colorSpace == MipColorSpace::Linear) {
+        key += "|linear";
+    }
+    return key;
+}
+
+TextureCache::Handle TextureCache::lookup(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    Handle handle = it->second.lock();
+    if (handle) {
+        stats.hits++;
+    }
+    return handle;
+}
+
+TextureCache::Handle TextureCache::upload(const std::string& key, const Image& image, const std::vector<Image>& mips) {
+    const GLenum format = formatForChannels(image.channels);
+    if (!image.isValid() || format == 0) {
+        return nullptr;
+    }
+
+    Handle texture = std::make_shared<CachedTexture>();
+    texture->width = image.width;
+    texture->height = image.height;
+    texture->channels = image.channels;
+    texture->format = format;
+    texture->levels = static_cast<int>(mips.size()) + 1;
+    texture->bytes = image.byteSize();
+    for (const auto& level: mips) {
+        texture->bytes += level.byteSize();
+    }
+    texture->key = key;
+
+    glGenTextures(1, &texture->id);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    uploadMipChain(GL_TEXTURE_2D, image.pixels.data(), image.width, image.height, image.channels, mips);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return track(key, texture);
+}
+
+TextureCache::Handle TextureCache::uploadCached(const std::string& key, const ImageCache& cache) {
+    Handle texture = std::make_shared<CachedTexture>();
+    texture->width = cache.getWidth();
+    texture->height = cache.getHeight();
+    texture->channels = cache.getChannels();
+    texture->format = formatForChannels(cache.getChannels());
+    texture->levels = cache.getLevelCount();
+    texture->bytes = cache.byteSize();
+    texture->key = key;
+
+    glGenTextures(1, &texture->id);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    // straight from the mapping, the pixels are never copied on the cpu
+    cache.upload(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture->levels - 1);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return track(key, texture);
+}
+
+TextureCache::Handle TextureCache::uploadCompressed(const std::string& key, const Ktx2Texture& ktx) {
+    if (ktx.faceCount != 1 || ktx.levels.empty()) {
+        std::cout << "ERROR::TEXTURE_CACHE:: " << key << " is not a 2D texture" << std::endl;
+        return nullptr;
+    }
+
+    Handle texture = std::make_shared<CachedTexture>();
+    texture->width = ktx.width;
+    texture->height = ktx.height;
+    texture->channels = compressedChannels(ktx.format);
+    texture->levels = static_cast<int>(ktx.levels.size());
+    texture->key = key;
+
+    glGenTextures(1, &texture->id);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    // the mip chain comes from the file, no glGenerateMipmap
+    texture->format = uploadKtx2(ktx, GL_TEXTURE_2D);
+    texture->bytes = compressedBytes(ktx, texture->format);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ktx.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return track(key, texture);
+}
+
+TextureCache::Handle TextureCache::uploadPlaceholder(const std::string& key) {
+    static const unsigned char grey[4] = {128, 128, 128, 255};
+    Handle texture = std::make_shared<CachedTexture>();
+    texture->width = 1;
+    texture->height = 1;
+    texture->channels = 4;
+    texture->format = GL_RGBA;
+    texture->bytes = sizeof(grey);
+    texture->ready = false;
+    texture->key = key;
+
+    glGenTextures(1, &texture->id);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return track(key, texture);
+}
+
+TextureCache::Handle TextureCache::track(const std::string& key, const Handle& texture) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries[key] = texture;
+        stats.misses++;
+        stats.residentTextures++;
+        stats.residentBytes += texture->bytes;
+    }
+
+    std::weak_ptr<CachedTexture> weak = texture;
+    TextureResidencyHooks hooks;
+    hooks.reload = [weak]() { return TextureCache::getInstance().reload(weak); };
+    hooks.restream = [weak](int firstLevel, ResidencyFootprint& footprint) {
+        return TextureCache::getInstance().restream(weak, firstLevel, footprint);
+    };
+    hooks.resized = [weak](ResidencyState state, const ResidencyFootprint& footprint) {
+        if (Handle resized = weak.lock()) {
+            resized->width = footprint.width;
+            resized->height = footprint.height;
+            resized->levels = footprint.levels;
+            if (state == ResidencyState::Evicted) {
+                // a grey texel like the streaming placeholder
+                resized->format = GL_RGBA;
+                resized->ready = false;
+            }
+            TextureCache::getInstance().resize(*resized, footprint.bytes);
+        }
+    };
+    const std::string name = key.substr(key.find_last_of('/') + 1);
+    TextureResidency::getInstance().track(texture->id, GL_TEXTURE_2D, formatForChannels(texture->channels), footprintOf(*texture), name,
+                                          std::move(hooks), !texture->ready);
+    return texture;
+}
+
+bool TextureCache::reload(const std::weak_ptr<CachedTexture>& weak) {
+    Handle texture = weak.lock();
+    if (!texture) {
+        return false;
+    }
+    std::string path;
+    bool flipVertically = true;
+    MipColorSpace colorSpace = MipColorSpace::SRGB;
+    splitKey(texture->key, path, flipVertically, colorSpace);
+    if (!isKtx2Path(path)) {
+        // streams back like acquireAsync, the queue calls TextureResidency::loaded once all levels are in
+        texture->ready = false;
+        streamFromFile(weak, path, flipVertically, colorSpace);
+        return true;
+    }
+
+    Ktx2Texture ktx;
+    if (!readKtx2(path, ktx) || ktx.faceCount != 1 || ktx.levels.empty()) {
+        std::cout << "ERROR::TEXTURE_CACHE:: failed to reload " << path << std::endl;
+        return false;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    texture->format = uploadKtx2(ktx, GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    texture->width = ktx.width;
+    texture->height = ktx.height;
+    texture->levels = static_cast<int>(ktx.levels.size());
+    texture->ready = true;
+    resize(*texture, compressedBytes(ktx, texture->format));
+    TextureResidency::getInstance().loaded(texture->id, footprintOf(*texture));
+    return true;
+}
+
+bool TextureCache::restream(const std::weak_ptr<CachedTexture>& weak, int firstLevel, ResidencyFootprint& footprint) {
+    Handle texture = weak.lock();
+    if (!texture || !texture->ready) {
+        return false;
+    }
+    std::string path;
+    bool flipVertically = true;
+    MipColorSpace colorSpace = MipColorSpace::SRGB;
+    splitKey(texture->key, path, flipVertically, colorSpace);
+
+    footprint.levels = 0;
+    if (isKtx2Path(path)) {
+        Ktx2Texture ktx;
+        if (!readKtx2(path, ktx) || ktx.faceCount != 1 || static_cast<int>(ktx.levels.size()) <= firstLevel) {
+            return false;
+        }
+        ktx.dropLevels(firstLevel);
+        glBindTexture(GL_TEXTURE_2D, texture->id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        texture->format = uploadKtx2(ktx, GL_TEXTURE_2D);
+        footprint.width = ktx.width;
+        footprint.height = ktx.height;
+        footprint.levels = static_cast<int>(ktx.levels.size());
+        footprint.bytes = compressedBytes(ktx, texture->format);
+    } else {
+        // mapped, the pixels go from the file to the driver without a copy
+        ImageCache cache;
+        if (!cache.open(path, ImageCache::flagsFor(flipVertically, true, colorSpace)) || cache.getLevelCount() <= firstLevel) {
+            return false;
+        }
+        glBindTexture(GL_TEXTURE_2D, texture->id);
+        cache.upload(GL_TEXTURE_2D, firstLevel);
+        for (int level = firstLevel; level < cache.getLevelCount(); level++) {
+            int width = 0, height = 0;
+            cache.getLevel(level, width, height);
+            if (level == firstLevel) {
+                footprint.width = width;
+                footprint.height = height;
+            }
+            footprint.bytes += static_cast<size_t>(width) * height * cache.getChannels();
+        }
+        footprint.levels = cache.getLevelCount() - firstLevel;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+TextureCache::Handle TextureCache::acquire(const std::string& path, bool flipVertically, MipColorSpace colorSpace) {
+    const std::string key = makeKey(path, flipVertically, colorSpace);
+    if (Handle handle = lookup(key)) {
+        return handle;
+    }
+    // compressed files are stored in upload order already, the flip does not apply
+    if (isKtx2Path(path)) {
+        Ktx2Texture ktx;
+        if (!readKtx2(path, ktx)) {
+            std::cout << "ERROR::TEXTURE_CACHE:: failed to load " << path << std::endl;
+            return nullptr;
+        }
+        return uploadCompressed(key, ktx);
+    }
+    const uint32_t cacheFlags = ImageCache::flagsFor(flipVertically, true, colorSpace);
+    ImageCache cache;
+    if (cache.open(path, cacheFlags)) {
+        return uploadCached(key, cache);
+    }
+    Image image;
+    if (!loadImage(path, image, flipVertically)) {
+        std::cout << "ERROR::TEXTURE_CACHE:: failed to load " << path << std::endl;
+        return nullptr;
+    }
+    std::vector<Image> mips = buildMipLevels(image, colorSpace);
+    ImageCache::write(path, cacheFlags, image, mips);
+    return upload(key, image, mips);
+}
+
+std::vector<TextureCache::Handle> TextureCache::acquireAll(const std::vector<std::string>& paths, bool flipVertically,
+                                                           MipColorSpace colorSpace) {
+    std::vector<Handle> handles(paths.size());
+    std::vector<std::string> keys(paths.size());
+    // first path of every missing key, duplicates in the batch are decoded once
+    std::vector<size_t> misses;
+    std::unordered_map<std::string, size_t> firstMiss;
+    for (size_t i = 0; i < paths.size(); i++) {
+        keys[i] = makeKey(paths[i], flipVertically, colorSpace);
+        handles[i] = lookup(keys[i]);
+        if (!handles[i] && firstMiss.emplace(keys[i], i).second) {
+            misses.push_back(i);
+        }
+    }
+
+    std::vector<Image> images(misses.size());
+    std::vector<std::vector<Image>> mips(misses.size());
+    std::vector<Ktx2Texture> compressed(misses.size());
+    // current .texbin files are only mapped, the rest is decoded and written back on the workers
+    std::vector<ImageCache> cached(misses.size());
+    const uint32_t cacheFlags = ImageCache::flagsFor(flipVertically, true, colorSpace);
+    ThreadPool::getInstance().parallelFor(misses.size(), [&](size_t i) {
+        const std::string& path = paths[misses[i]];
+        if (isKtx2Path(path)) {
+            readKtx2(path, compressed[i]);
+        } else if (!cached[i].open(path, cacheFlags) && loadImage(path, images[i], flipVertically)) {
+            mips[i] = buildMipLevels(images[i], colorSpace);
+            ImageCache::write(path, cacheFlags, images[i], mips[i]);
+        }
+    });
+
+    for (size_t i = 0; i < misses.size(); i++) {
+        const size_t index = misses[i];
+        if (!compressed[i].levels.empty()) {
+            handles[index] = uploadCompressed(keys[index], compressed[i]);
+        } else if (cached[i].isOpen()) {
+            handles[index] = uploadCached(keys[index], cached[i]);
+        } else if (images[i].isValid()) {
+            handles[index] = upload(keys[index], images[i], mips[i]);
+        } else {
+            std::cout << "ERROR::TEXTURE_CACHE:: failed to load " << paths[index] << std::endl;
+        }
+        // free the pixels as soon as they are on the gpu
+        images[i] = Image();
+        mips[i].clear();
+        compressed[i] = Ktx2Texture();
+        cached[i].close();
+    }
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!handles[i]) {
+            handles[i] = handles[firstMiss[keys[i]]];
+        }
+    }
+    return handles;
+}
+
+TextureCache::Handle TextureCache::insert(const std::string& path, const Image& image, const std::vector<Image>& mips,
+                                          bool flipVertically, MipColorSpace colorSpace) {
+    const std::string key = makeKey(path, flipVertically, colorSpace);
+    if (Handle handle = lookup(key)) {
+        return handle;
+    }
+    if (mips.empty()) {
+        return upload(key, image, buildMipLevels(image, colorSpace));
+    }
+    return upload(key, image, mips);
+}
+
+TextureCache::Handle TextureCache::acquireAsync(const std::string& path, bool flipVertically, MipColorSpace colorSpace) {
+    const std::string key = makeKey(path, flipVertically, colorSpace);
+    if (Handle handle = lookup(key)) {
+        return handle;
+    }
+    // compressed files are small and already in upload layout
+    if (isKtx2Path(path)) {
+        return acquire(path, flipVertically, colorSpace);
+    }
+
+    Handle texture = uploadPlaceholder(key);
+    streamFromFile(texture, path, flipVertically, colorSpace);
+    return texture;
+}
+
+TextureCache::Handle TextureCache::insertAsync(const std::string& path, Image image, std::vector<Image> mips, bool flipVertically,
+                                               MipColorSpace colorSpace) {
+    const std::string key = makeKey(path, flipVertically, colorSpace);
+    if (Handle handle = lookup(key)) {
+        return handle;
+    }
+    if (mips.empty()) {
+        mips = buildMipLevels(image, colorSpace);
+    }
+    Handle texture = uploadPlaceholder(key);
+    TextureUpload upload;
+    upload.texture = texture;
+    upload.image = std::move(image);
+    upload.mips = std::move(mips);
+    TextureUploadQueue::getInstance().enqueue(std::move(upload));
+    return texture;
+}
+
+TextureCache::Handle TextureCache::find(const std::string& path, bool flipVertically, MipColorSpace colorSpace) {
+    return lookup(makeKey(path, flipVertically, colorSpace));
+}
+
+bool TextureCache::contains(const std::string& path, bool flipVertically, MipColorSpace colorSpace) {
+    const std::string key = makeKey(path, flipVertically, colorSpace);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    return it != entries.end() && !it->second.expired();
+}
+
+TextureCacheStats TextureCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void TextureCache::resize(CachedTexture& texture, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.residentBytes = stats.residentBytes - texture.bytes + bytes;
+    texture.bytes = bytes;
+}
+
+void TextureCache::release(const std::string& key, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    // a new texture may already have been uploaded under the same key
+    if (it != entries.end() && it->second.expired()) {
+        entries.erase(it);
+    }
+    stats.residentTextures--;
+    stats.residentBytes -= bytes;
+}
@@ -0,0 +1,142 @@
+#ifndef OPENGL_UTILS_TEXTURE_CACHE_H
+#define OPENGL_UTILS_TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "utils/MipChain.h"
+
+class ImageCache;
+struct Ktx2Texture;
+struct ResidencyFootprint;
+
+// GL texture owned by the cache, deleted when the last handle goes away
+struct CachedTexture {
+    GLuint id = 0;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    GLenum format = 0;      // internal format, a GL_COMPRESSED_* enum for .ktx2 files
+    int levels = 1;         // uploaded mip levels
+    size_t bytes = 0;       // base level + mip chain
+    bool ready = true;      // false while the TextureUploadQueue streams it, a grey 1x1 until then
+    std::string key;
+
+    CachedTexture() = default;
+    CachedTexture(const CachedTexture&) = delete;
+    CachedTexture& operator=(const CachedTexture&) = delete;
+    ~CachedTexture();
+};
+
+struct TextureCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t residentTextures = 0;
+    size_t residentBytes = 0;
+};
+
+/*
+ * Process wide 2D texture cache keyed by canonical path, shared by Model, Texture and
+ * SpriteSheet (through Texture). Textures are reference counted through the handles:
+ * the GL object lives as long as any user holds one.
+ * Sampler parameters (wrap, filter) are texture state and therefore shared by all users.
+ * .ktx2 paths are uploaded block compressed with their stored mip chain, everything else is
+ * decoded with stb_image and gets a CPU mip chain (MipChain.h) uploaded level by level. Color
+ * textures are filtered in linear light, pass MipColorSpace::Linear for data textures; the color
+ * space is part of the key like the flip. Decoded pixels and their chain are kept in a .texbin
+ * next to the file (ImageCache.h), later runs map it and skip both.
+ *
+ * The *Async variants return a placeholder right away and hand the pixels to the
+ * TextureUploadQueue, which streams them in over the next frames (see CachedTexture::ready).
+ * Every texture is accounted by the TextureResidency; under a VRAM budget it may be trimmed
+ * or evicted while unused and is reloaded from its file when drawn again.
+ *
+ * acquire/insert create GL objects and must run on the GL thread, find/contains/getStats
+ * may be called from anywhere.
+ */
+class TextureCache {
+public:
+    using Handle = std::shared_ptr<CachedTexture>;
+
+    static TextureCache& getInstance();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // returns the resident texture or decodes + uploads it, nullptr if the file can not be loaded
+    Handle acquire(const std::string& path, bool flipVertically = true, MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    /*
+     * acquire for a batch: the misses are decoded and their mip chains built concurrently on the
+     * ThreadPool, only the uploads run on the calling (GL) thread. Result order matches paths,
+     * failed entries are nullptr.
+     */
+    std::vector<Handle> acquireAll(const std::vector<std::string>& paths, bool flipVertically = true,
+                                   MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    /*
+     * like acquire, but uploads already decoded pixels on a miss (e.g. decoded on a worker thread).
+     * mips are the levels below image from buildMipLevels, empty builds them here.
+     */
+    Handle insert(const std::string& path, const Image& image, const std::vector<Image>& mips, bool flipVertically = true,
+                  MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    // like acquire, but decodes on the ThreadPool and uploads through the TextureUploadQueue
+    Handle acquireAsync(const std::string& path, bool flipVertically = true, MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    // like insert, the pixels are moved into the TextureUploadQueue
+    Handle insertAsync(const std::string& path, Image image, std::vector<Image> mips, bool flipVertically = true,
+                       MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    Handle find(const std::string& path, bool flipVertically = true, MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    bool contains(const std::string& path, bool flipVertically = true, MipColorSpace colorSpace = MipColorSpace::SRGB);
+
+    TextureCacheStats getStats() const;
+
+    // absolute, normalized path (symlinks resolved when the file exists)
+    static std::string canonicalPath(const std::string& path);
+
+private:
+    friend struct CachedTexture;
+    friend class TextureUploadQueue;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<CachedTexture>> entries;
+    TextureCacheStats stats;
+
+    TextureCache() = default;
+
+    static std::string makeKey(const std::string& path, bool flipVertically, MipColorSpace colorSpace);
+
+    Handle lookup(const std::string& key);
+
+    Handle upload(const std::string& key, const Image& image, const std::vector<Image>& mips);
+
+    // every level of a mapped .texbin, no decode and no mip chain
+    Handle uploadCached(const std::string& key, const ImageCache& cache);
+
+    Handle uploadCompressed(const std::string& key, const Ktx2Texture& texture);
+
+    Handle uploadPlaceholder(const std::string& key);
+
+    // registers with the TextureResidency too, which may trim, evict and reload it
+    Handle track(const std::string& key, const Handle& texture);
+
+    // reload hook for the TextureResidency, the texture keeps its GL name
+    bool reload(const std::weak_ptr<CachedTexture>& texture);
+
+    // restream hook for the TextureResidency: the chain from firstLevel on, from the .texbin or .ktx2
+    bool restream(const std::weak_ptr<CachedTexture>& texture, int firstLevel, ResidencyFootprint& footprint);
+
+    // the real size of a streamed texture is known once its pixels are decoded
+    void resize(CachedTexture& texture, size_t bytes);
+
+    void release(const std::string& key, size_t bytes);
+};
+
+#endif
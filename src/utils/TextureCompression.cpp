@@ -0,0 +1,848 @@
+#include "TextureCompression.h"
+#include "utils/Image.h"
+#include "utils/ThreadPool.h"
+#include "utils/Utils.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+typedef uint8_t Texel[4];
+
+// ---- block access ----
+
+void fetchBlock(const Image& image, int bx, int by, Texel block[16]) {
+    const int channels = image.channels;
+    for (int y = 0; y < 4; y++) {
+        const int sy = std::min(by * 4 + y, image.height - 1);
+        for (int x = 0; x < 4; x++) {
+            const int sx = std::min(bx * 4 + x, image.width - 1);
+            const unsigned char* src = &image.pixels[(static_cast<size_t>(sy) * image.width + sx) * channels];
+            Texel& texel = block[y * 4 + x];
+            texel[0] = src[0];
+            texel[1] = channels > 1 ? src[1] : 0;
+            texel[2] = channels > 2 ? src[2] : 0;
+            texel[3] = channels > 3 ? src[3] : 255;
+        }
+    }
+}
+
+void storeBlock(const Texel block[16], int bx, int by, Image& image) {
+    for (int y = 0; y < 4 && by * 4 + y < image.height; y++) {
+        for (int x = 0; x < 4 && bx * 4 + x < image.width; x++) {
+            unsigned char* dst = &image.pixels[(static_cast<size_t>(by * 4 + y) * image.width + bx * 4 + x) * 4];
+            std::memcpy(dst, block[y * 4 + x], 4);
+        }
+    }
+}
+
+void fillMagenta(Texel block[16]) {
+    for (int i = 0; i < 16; i++) {
+        block[i][0] = 255;
+        block[i][1] = 0;
+        block[i][2] = 255;
+        block[i][3] = 255;
+    }
+}
+
+int clampByte(int value) {
+    return std::min(std::max(value, 0), 255);
+}
+
+// ---- principal axis, shared by the BC1 and BC7 endpoint fits ----
+
+template<int N>
+void principalAxis(const Texel block[16], float mean[N], float axis[N], float& minT, float& maxT) {
+    for (int c = 0; c < N; c++) {
+        mean[c] = 0.f;
+        for (int i = 0; i < 16; i++) {
+            mean[c] += block[i][c];
+        }
+        mean[c] /= 16.f;
+    }
+    float cov[N][N] = {};
+    for (int i = 0; i < 16; i++) {
+        float d[N];
+        for (int c = 0; c < N; c++) {
+            d[c] = block[i][c] - mean[c];
+        }
+        for (int a = 0; a < N; a++) {
+            for (int b = 0; b < N; b++) {
+                cov[a][b] += d[a] * d[b];
+            }
+        }
+    }
+    // power iteration, starting from the luminance-ish diagonal
+    for (int c = 0; c < N; c++) {
+        axis[c] = 1.f;
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[N] = {};
+        float length = 0.f;
+        for (int a = 0; a < N; a++) {
+            for (int b = 0; b < N; b++) {
+                next[a] += cov[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        if (length < 1e-12f) {
+            break;
+        }
+        length = std::sqrt(length);
+        for (int c = 0; c < N; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+    float length = 0.f;
+    for (int c = 0; c < N; c++) {
+        length += axis[c] * axis[c];
+    }
+    length = std::sqrt(length);
+    for (int c = 0; c < N; c++) {
+        axis[c] /= length;
+    }
+
+    minT = 1e30f;
+    maxT = -1e30f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.f;
+        for (int c = 0; c < N; c++) {
+            t += (block[i][c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+}
+
+// ---- BC1 color block ----
+
+uint16_t pack565(const float color[3]) {
+    const int r = static_cast<int>(std::lround(std::min(std::max(color[0], 0.f), 255.f) * 31.f / 255.f));
+    const int g = static_cast<int>(std::lround(std::min(std::max(color[1], 0.f), 255.f) * 63.f / 255.f));
+    const int b = static_cast<int>(std::lround(std::min(std::max(color[2], 0.f), 255.f) * 31.f / 255.f));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpack565(uint16_t value, int color[3]) {
+    const int r = (value >> 11) & 31;
+    const int g = (value >> 5) & 63;
+    const int b = value & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// 4 color mode palette, only valid for c0 > c1
+void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+    unpack565(c0, palette[0]);
+    unpack565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+}
+
+int bc1Indices(const Texel block[16], uint16_t c0, uint16_t c1, uint8_t indices[16]) {
+    int palette[4][3];
+    bc1Palette(c0, c1, palette);
+    int total = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < 4; p++) {
+            int error = 0;
+            for (int c = 0; c < 3; c++) {
+                const int d = block[i][c] - palette[p][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        indices[i] = static_cast<uint8_t>(best);
+        total += bestError;
+    }
+    return total;
+}
+
+// least squares endpoints for fixed indices, false if the system is singular
+bool refineEndpoints(const Texel block[16], const uint8_t indices[16], const float* weights, int channels, float e0[4], float e1[4]) {
+    float aa = 0.f, ab = 0.f, bb = 0.f;
+    float ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; i++) {
+        const float b = weights[indices[i]];
+        const float a = 1.f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < channels; c++) {
+            ax[c] += a * block[i][c];
+            bx[c] += b * block[i][c];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) {
+        return false;
+    }
+    for (int c = 0; c < channels; c++) {
+        e0[c] = (ax[c] * bb - bx[c] * ab) / det;
+        e1[c] = (bx[c] * aa - ax[c] * ab) / det;
+    }
+    return true;
+}
+
+void writeBc1(uint16_t c0, uint16_t c1, const uint8_t indices[16], uint8_t out[8]) {
+    out[0] = static_cast<uint8_t>(c0 & 0xFF);
+    out[1] = static_cast<uint8_t>(c0 >> 8);
+    out[2] = static_cast<uint8_t>(c1 & 0xFF);
+    out[3] = static_cast<uint8_t>(c1 >> 8);
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        bits |= static_cast<uint32_t>(indices[i]) << (i * 2);
+    }
+    for (int i = 0; i < 4; i++) {
+        out[4 + i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+}
+
+void encodeBc1(const Texel block[16], uint8_t out[8]) {
+    // weight of the second endpoint for palette entries 0..3
+    static const float weights[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+
+    float mean[3], axis[3], minT, maxT;
+    principalAxis<3>(block, mean, axis, minT, maxT);
+    // pull the endpoints in a little, the extremes are rarely worth an exact match
+    const float inset = (maxT - minT) / 16.f;
+    float e0[4], e1[4];
+    for (int c = 0; c < 3; c++) {
+        e0[c] = mean[c] + axis[c] * (maxT - inset);
+        e1[c] = mean[c] + axis[c] * (minT + inset);
+    }
+
+    uint16_t bestC0 = 0, bestC1 = 0;
+    uint8_t bestIndices[16] = {};
+    int bestError = 1 << 30;
+    for (int iteration = 0; iteration < 3; iteration++) {
+        uint16_t c0 = pack565(e0), c1 = pack565(e1);
+        if (c0 < c1) {
+            std::swap(c0, c1);
+        }
+        // equal endpoints select the 3 color mode, all indices then end up 0 which is still exactly c0
+        uint8_t indices[16] = {};
+        const int error = bc1Indices(block, c0, c1, indices);
+        if (error < bestError) {
+            bestError = error;
+            bestC0 = c0;
+            bestC1 = c1;
+            std::memcpy(bestIndices, indices, sizeof(indices));
+        }
+        if (c0 == c1 || !refineEndpoints(block, indices, weights, 3, e0, e1)) {
+            break;
+        }
+    }
+    writeBc1(bestC0, bestC1, bestIndices, out);
+}
+
+void decodeBc1(const uint8_t* data, Texel block[16]) {
+    const uint16_t c0 = static_cast<uint16_t>(data[0] | (data[1] << 8));
+    const uint16_t c1 = static_cast<uint16_t>(data[2] | (data[3] << 8));
+    int palette[4][3];
+    int alpha[4] = {255, 255, 255, 255};
+    if (c0 > c1) {
+        bc1Palette(c0, c1, palette);
+    } else {
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        alpha[3] = 0;
+    }
+    const uint32_t bits = data[4] | (data[5] << 8) | (data[6] << 16) | (static_cast<uint32_t>(data[7]) << 24);
+    for (int i = 0; i < 16; i++) {
+        const int index = (bits >> (i * 2)) & 3;
+        block[i][0] = static_cast<uint8_t>(palette[index][0]);
+        block[i][1] = static_cast<uint8_t>(palette[index][1]);
+        block[i][2] = static_cast<uint8_t>(palette[index][2]);
+        block[i][3] = static_cast<uint8_t>(alpha[index]);
+    }
+}
+
+// ---- BC4 single channel block (BC3 alpha, BC5 red / green) ----
+
+void bc4Palette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+        }
+    } else {
+        for (int i = 2; i < 6; i++) {
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+void encodeBc4(const Texel block[16], int channel, uint8_t out[8]) {
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; i++) {
+        lo = std::min(lo, static_cast<int>(block[i][channel]));
+        hi = std::max(hi, static_cast<int>(block[i][channel]));
+    }
+    std::memset(out, 0, 8);
+    out[0] = static_cast<uint8_t>(hi);
+    out[1] = static_cast<uint8_t>(lo);
+    if (hi == lo) {
+        return;
+    }
+
+    int palette[8];
+    bc4Palette(hi, lo, palette);
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < 8; p++) {
+            const int error = std::abs(block[i][channel] - palette[p]);
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        bits |= static_cast<uint64_t>(best) << (i * 3);
+    }
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+}
+
+void decodeBc4(const uint8_t* data, int channel, Texel block[16]) {
+    int palette[8];
+    bc4Palette(data[0], data[1], palette);
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) {
+        bits |= static_cast<uint64_t>(data[2 + i]) << (i * 8);
+    }
+    for (int i = 0; i < 16; i++) {
+        block[i][channel] = static_cast<uint8_t>(palette[(bits >> (i * 3)) & 7]);
+    }
+}
+
+// ---- BC7 mode 6 ----
+
+const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BitWriter {
+    uint8_t* data;
+    int position = 0;
+
+    void write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++, position++) {
+            if ((value >> i) & 1) {
+                data[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+            }
+        }
+    }
+};
+
+struct BitReader {
+    const uint8_t* data;
+    int position = 0;
+
+    uint32_t read(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; i++, position++) {
+            value |= static_cast<uint32_t>((data[position >> 3] >> (position & 7)) & 1) << i;
+        }
+        return value;
+    }
+};
+
+int bc7Interpolate(int e0, int e1, int index) {
+    return ((64 - BC7_WEIGHTS[index]) * e0 + BC7_WEIGHTS[index] * e1 + 32) >> 6;
+}
+
+// endpoints as 8 bit values (7 bit + p bit), returns the squared error
+int bc7Indices(const Texel block[16], const int e0[4], const int e1[4], uint8_t indices[16]) {
+    int palette[16][4];
+    for (int p = 0; p < 16; p++) {
+        for (int c = 0; c < 4; c++) {
+            palette[p][c] = bc7Interpolate(e0[c], e1[c], p);
+        }
+    }
+    int total = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < 16; p++) {
+            int error = 0;
+            for (int c = 0; c < 4; c++) {
+                const int d = block[i][c] - palette[p][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        indices[i] = static_cast<uint8_t>(best);
+        total += bestError;
+    }
+    return total;
+}
+
+void quantizeBc7Endpoint(const float endpoint[4], int pbit, int quantized[4], int value[4]) {
+    for (int c = 0; c < 4; c++) {
+        const int q = static_cast<int>(std::lround((std::min(std::max(endpoint[c], 0.f), 255.f) - pbit) / 2.f));
+        quantized[c] = std::min(std::max(q, 0), 127);
+        value[c] = (quantized[c] << 1) | pbit;
+    }
+}
+
+void encodeBc7(const Texel block[16], uint8_t out[16]) {
+    float weights[16];
+    for (int i = 0; i < 16; i++) {
+        weights[i] = BC7_WEIGHTS[i] / 64.f;
+    }
+
+    float mean[4], axis[4], minT, maxT;
+    principalAxis<4>(block, mean, axis, minT, maxT);
+    float e0[4], e1[4];
+    for (int c = 0; c < 4; c++) {
+        e0[c] = mean[c] + axis[c] * minT;
+        e1[c] = mean[c] + axis[c] * maxT;
+    }
+
+    int bestQ0[4] = {}, bestQ1[4] = {}, bestP0 = 0, bestP1 = 0;
+    uint8_t bestIndices[16] = {};
+    int bestError = 1 << 30;
+    for (int iteration = 0; iteration < 2; iteration++) {
+        uint8_t iterationIndices[16] = {};
+        int iterationError = 1 << 30;
+        for (int p0 = 0; p0 < 2; p0++) {
+            for (int p1 = 0; p1 < 2; p1++) {
+                int q0[4], q1[4], v0[4], v1[4];
+                quantizeBc7Endpoint(e0, p0, q0, v0);
+                quantizeBc7Endpoint(e1, p1, q1, v1);
+                uint8_t indices[16];
+                const int error = bc7Indices(block, v0, v1, indices);
+                if (error < iterationError) {
+                    iterationError = error;
+                    std::memcpy(iterationIndices, indices, sizeof(indices));
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    std::memcpy(bestQ0, q0, sizeof(q0));
+                    std::memcpy(bestQ1, q1, sizeof(q1));
+                    bestP0 = p0;
+                    bestP1 = p1;
+                    std::memcpy(bestIndices, indices, sizeof(indices));
+                }
+            }
+        }
+        if (bestError == 0 || !refineEndpoints(block, iterationIndices, weights, 4, e0, e1)) {
+            break;
+        }
+    }
+
+    // the anchor index is stored without its top bit, so it has to be < 8
+    if (bestIndices[0] & 8) {
+        std::swap(bestQ0, bestQ1);
+        std::swap(bestP0, bestP1);
+        for (int i = 0; i < 16; i++) {
+            bestIndices[i] = static_cast<uint8_t>(15 - bestIndices[i]);
+        }
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer {out};
+    writer.write(1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        writer.write(static_cast<uint32_t>(bestQ0[c]), 7);
+        writer.write(static_cast<uint32_t>(bestQ1[c]), 7);
+    }
+    writer.write(static_cast<uint32_t>(bestP0), 1);
+    writer.write(static_cast<uint32_t>(bestP1), 1);
+    writer.write(bestIndices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        writer.write(bestIndices[i], 4);
+    }
+}
+
+void decodeBc7(const uint8_t* data, Texel block[16]) {
+    BitReader reader {data};
+    if (reader.read(7) != (1u << 6)) {
+        fillMagenta(block);
+        return;
+    }
+    int q[4][2];
+    for (int c = 0; c < 4; c++) {
+        q[c][0] = static_cast<int>(reader.read(7));
+        q[c][1] = static_cast<int>(reader.read(7));
+    }
+    const int p0 = static_cast<int>(reader.read(1));
+    const int p1 = static_cast<int>(reader.read(1));
+    int e0[4], e1[4];
+    for (int c = 0; c < 4; c++) {
+        e0[c] = (q[c][0] << 1) | p0;
+        e1[c] = (q[c][1] << 1) | p1;
+    }
+    for (int i = 0; i < 16; i++) {
+        const int index = static_cast<int>(reader.read(i == 0 ? 3 : 4));
+        for (int c = 0; c < 4; c++) {
+            block[i][c] = static_cast<uint8_t>(bc7Interpolate(e0[c], e1[c], index));
+        }
+    }
+}
+
+// ---- ETC2 (ETC1 compatible individual / differential blocks) ----
+
+const int ETC_MODIFIERS[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+// selector value (msb lsb) -> modifier: 0 +small, 1 +large, 2 -small, 3 -large
+int etcModifier(int table, int selector) {
+    const int magnitude = ETC_MODIFIERS[table][selector & 1];
+    return selector & 2 ? -magnitude : magnitude;
+}
+
+// pixel i (row major) of the block is in the second sub block
+bool etcSecondSubBlock(int i, bool flip) {
+    return flip ? (i / 4) >= 2 : (i % 4) >= 2;
+}
+
+// best table for one sub block, selectors are written for the pixels of that sub block
+int etcFitSubBlock(const Texel block[16], bool flip, bool second, const int base[3], int& table, uint8_t selectors[16]) {
+    int bestError = 1 << 30;
+    for (int t = 0; t < 8; t++) {
+        int error = 0;
+        uint8_t chosen[16] = {};
+        for (int i = 0; i < 16; i++) {
+            if (etcSecondSubBlock(i, flip) != second) {
+                continue;
+            }
+            int bestPixel = 1 << 30;
+            for (int s = 0; s < 4; s++) {
+                const int modifier = etcModifier(t, s);
+                int pixelError = 0;
+                for (int c = 0; c < 3; c++) {
+                    const int d = block[i][c] - clampByte(base[c] + modifier);
+                    pixelError += d * d;
+                }
+                if (pixelError < bestPixel) {
+                    bestPixel = pixelError;
+                    chosen[i] = static_cast<uint8_t>(s);
+                }
+            }
+            error += bestPixel;
+        }
+        if (error < bestError) {
+            bestError = error;
+            table = t;
+            for (int i = 0; i < 16; i++) {
+                if (etcSecondSubBlock(i, flip) == second) {
+                    selectors[i] = chosen[i];
+                }
+            }
+        }
+    }
+    return bestError;
+}
+
+void encodeEtc2(const Texel block[16], uint8_t out[8]) {
+    uint64_t bestBits = 0;
+    int bestError = 1 << 30;
+    for (int flip = 0; flip < 2; flip++) {
+        float average[2][3] = {};
+        for (int i = 0; i < 16; i++) {
+            const int sub = etcSecondSubBlock(i, flip != 0) ? 1 : 0;
+            for (int c = 0; c < 3; c++) {
+                average[sub][c] += block[i][c] / 8.f;
+            }
+        }
+
+        // differential (5 bit + 3 bit delta) when the averages are close, individual 4 bit colors otherwise
+        int q[2][3];
+        bool differential = true;
+        for (int c = 0; c < 3; c++) {
+            q[0][c] = static_cast<int>(std::lround(average[0][c] * 31.f / 255.f));
+            q[1][c] = static_cast<int>(std::lround(average[1][c] * 31.f / 255.f));
+            const int delta = q[1][c] - q[0][c];
+            differential = differential && delta >= -4 && delta <= 3;
+        }
+        int base[2][3];
+        for (int sub = 0; sub < 2; sub++) {
+            for (int c = 0; c < 3; c++) {
+                if (differential) {
+                    base[sub][c] = (q[sub][c] << 3) | (q[sub][c] >> 2);
+                } else {
+                    q[sub][c] = static_cast<int>(std::lround(average[sub][c] * 15.f / 255.f));
+                    base[sub][c] = (q[sub][c] << 4) | q[sub][c];
+                }
+            }
+        }
+
+        uint8_t selectors[16] = {};
+        int tables[2] = {};
+        const int error = etcFitSubBlock(block, flip != 0, false, base[0], tables[0], selectors)
+                        + etcFitSubBlock(block, flip != 0, true, base[1], tables[1], selectors);
+        if (error >= bestError) {
+            continue;
+        }
+        bestError = error;
+
+        uint64_t bits = 0;
+        for (int c = 0; c < 3; c++) {
+            const int shift = 56 - c * 8;
+            if (differential) {
+                bits |= static_cast<uint64_t>(q[0][c]) << (shift + 3);
+                bits |= static_cast<uint64_t>((q[1][c] - q[0][c]) & 7) << shift;
+            } else {
+                bits |= static_cast<uint64_t>(q[0][c]) << (shift + 4);
+                bits |= static_cast<uint64_t>(q[1][c]) << shift;
+            }
+        }
+        bits |= static_cast<uint64_t>(tables[0]) << 37;
+        bits |= static_cast<uint64_t>(tables[1]) << 34;
+        bits |= static_cast<uint64_t>(differential ? 1 : 0) << 33;
+        bits |= static_cast<uint64_t>(flip) << 32;
+        // selector bits are column major, msb plane in the upper half
+        for (int i = 0; i < 16; i++) {
+            const int bit = (i % 4) * 4 + i / 4;
+            bits |= static_cast<uint64_t>(selectors[i] >> 1) << (16 + bit);
+            bits |= static_cast<uint64_t>(selectors[i] & 1) << bit;
+        }
+        bestBits = bits;
+    }
+    for (int i = 0; i < 8; i++) {
+        out[i] = static_cast<uint8_t>(bestBits >> (56 - i * 8));
+    }
+}
+
+void decodeEtc2(const uint8_t* data, Texel block[16]) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits = (bits << 8) | data[i];
+    }
+    const bool differential = (bits >> 33) & 1;
+    const bool flip = (bits >> 32) & 1;
+    int base[2][3];
+    for (int c = 0; c < 3; c++) {
+        const int shift = 56 - c * 8;
+        if (differential) {
+            const int first = static_cast<int>((bits >> (shift + 3)) & 31);
+            int delta = static_cast<int>((bits >> shift) & 7);
+            delta = delta >= 4 ? delta - 8 : delta;
+            const int second = first + delta;
+            if (second < 0 || second > 31) {
+                // T, H or planar mode
+                fillMagenta(block);
+                return;
+            }
+            base[0][c] = (first << 3) | (first >> 2);
+            base[1][c] = (second << 3) | (second >> 2);
+        } else {
+            const int first = static_cast<int>((bits >> (shift + 4)) & 15);
+            const int second = static_cast<int>((bits >> shift) & 15);
+            base[0][c] = (first << 4) | first;
+            base[1][c] = (second << 4) | second;
+        }
+    }
+    const int tables[2] = {static_cast<int>((bits >> 37) & 7), static_cast<int>((bits >> 34) & 7)};
+    for (int i = 0; i < 16; i++) {
+        const int bit = (i % 4) * 4 + i / 4;
+        const int selector = static_cast<int>((((bits >> (16 + bit)) & 1) << 1) | ((bits >> bit) & 1));
+        const int sub = etcSecondSubBlock(i, flip) ? 1 : 0;
+        const int modifier = etcModifier(tables[sub], selector);
+        for (int c = 0; c < 3; c++) {
+            block[i][c] = static_cast<uint8_t>(clampByte(base[sub][c] + modifier));
+        }
+        block[i][3] = 255;
+    }
+}
+
+void encodeBlock(const Texel block[16], CompressedFormat format, uint8_t* out) {
+    switch (format) {
+        case CompressedFormat::BC1:
+            encodeBc1(block, out);
+            break;
+        case CompressedFormat::BC3:
+            encodeBc4(block, 3, out);
+            encodeBc1(block, out + 8);
+            break;
+        case CompressedFormat::BC5:
+            encodeBc4(block, 0, out);
+            encodeBc4(block, 1, out + 8);
+            break;
+        case CompressedFormat::BC7:
+            encodeBc7(block, out);
+            break;
+        case CompressedFormat::ETC2:
+            encodeEtc2(block, out);
+            break;
+    }
+}
+
+void decodeBlock(const uint8_t* data, CompressedFormat format, Texel block[16]) {
+    switch (format) {
+        case CompressedFormat::BC1:
+            decodeBc1(data, block);
+            break;
+        case CompressedFormat::BC3:
+            decodeBc1(data + 8, block);
+            decodeBc4(data, 3, block);
+            break;
+        case CompressedFormat::BC5:
+            for (int i = 0; i < 16; i++) {
+                block[i][2] = 0;
+                block[i][3] = 255;
+            }
+            decodeBc4(data, 0, block);
+            decodeBc4(data + 8, 1, block);
+            break;
+        case CompressedFormat::BC7:
+            decodeBc7(data, block);
+            break;
+        case CompressedFormat::ETC2:
+            decodeEtc2(data, block);
+            break;
+    }
+}
+
+}
+
+const char* compressedFormatName(CompressedFormat format) {
+    switch (format) {
+        case CompressedFormat::BC1:  return "BC1";
+        case CompressedFormat::BC3:  return "BC3";
+        case CompressedFormat::BC5:  return "BC5";
+        case CompressedFormat::BC7:  return "BC7";
+        case CompressedFormat::ETC2: return "ETC2";
+    }
+    return "?";
+}
+
+bool parseCompressedFormat(const std::string& name, CompressedFormat& format) {
+    static const CompressedFormat formats[] = {
+        CompressedFormat::BC1, CompressedFormat::BC3, CompressedFormat::BC5, CompressedFormat::BC7, CompressedFormat::ETC2,
+    };
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (CompressedFormat candidate: formats) {
+        std::string candidateName(compressedFormatName(candidate));
+        std::transform(candidateName.begin(), candidateName.end(), candidateName.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lower == candidateName) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t compressedBlockBytes(CompressedFormat format) {
+    return format == CompressedFormat::BC1 || format == CompressedFormat::ETC2 ? 8 : 16;
+}
+
+size_t compressedImageBytes(CompressedFormat format, int width, int height) {
+    const size_t blocksX = (static_cast<size_t>(width) + 3) / 4;
+    const size_t blocksY = (static_cast<size_t>(height) + 3) / 4;
+    return blocksX * blocksY * compressedBlockBytes(format);
+}
+
+int compressedChannels(CompressedFormat format) {
+    switch (format) {
+        case CompressedFormat::BC5:
+            return 2;
+        case CompressedFormat::BC3:
+        case CompressedFormat::BC7:
+            return 4;
+        default:
+            return 3;
+    }
+}
+
+GLenum compressedGLFormat(CompressedFormat format) {
+    switch (format) {
+        case CompressedFormat::BC1:  return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case CompressedFormat::BC3:  return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case CompressedFormat::BC5:  return GL_COMPRESSED_RG_RGTC2;
+        case CompressedFormat::BC7:  return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case CompressedFormat::ETC2: return GL_COMPRESSED_RGB8_ETC2;
+    }
+    return 0;
+}
+
+bool isCompressedFormatSupported(CompressedFormat format) {
+    switch (format) {
+        case CompressedFormat::BC1:
+        case CompressedFormat::BC3:
+            return gl::hasExtension("GL_EXT_texture_compression_s3tc");
+        case CompressedFormat::BC5:
+            // RGTC is core since 3.0
+            return true;
+        case CompressedFormat::BC7:
+            return gl::hasVersion(4, 2) || gl::hasExtension("GL_ARB_texture_compression_bptc");
+        case CompressedFormat::ETC2:
+            return gl::hasVersion(4, 3) || gl::hasExtension("GL_ARB_ES3_compatibility");
+    }
+    return false;
+}
+
+void compressImage(const Image& image, CompressedFormat format, std::vector<unsigned char>& out) {
+    out.assign(compressedImageBytes(format, image.width, image.height), 0);
+    if (!image.isValid()) {
+        return;
+    }
+    const int blocksX = (image.width + 3) / 4;
+    const int blocksY = (image.height + 3) / 4;
+    const size_t blockBytes = compressedBlockBytes(format);
+    // one block row per job
+    ThreadPool::getInstance().parallelFor(static_cast<size_t>(blocksY), [&](size_t by) {
+        Texel block[16];
+        for (int bx = 0; bx < blocksX; bx++) {
+            fetchBlock(image, bx, static_cast<int>(by), block);
+            encodeBlock(block, format, &out[(by * blocksX + bx) * blockBytes]);
+        }
+    });
+}
+
+void decompressImage(const unsigned char* data, int width, int height, CompressedFormat format, Image& out) {
+    out.width = width;
+    out.height = height;
+    out.channels = 4;
+    out.pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const size_t blockBytes = compressedBlockBytes(format);
+    ThreadPool::getInstance().parallelFor(static_cast<size_t>(blocksY), [&](size_t by) {
+        Texel block[16];
+        for (int bx = 0; bx < blocksX; bx++) {
+            decodeBlock(data + (by * blocksX + bx) * blockBytes, format, block);
+            storeBlock(block, bx, static_cast<int>(by), out);
+        }
+    });
+}
+
+double computePsnr(const Image& reference, const Image& decoded, int channels) {
+    if (reference.width != decoded.width || reference.height != decoded.height) {
+        return 0.0;
+    }
+    channels = std::min(channels, std::min(reference.channels, decoded.channels));
+    const size_t pixels = static_cast<size_t>(reference.width) * reference.height;
+    if (pixels == 0 || channels <= 0) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < pixels; i++) {
+        for (int c = 0; c < channels; c++) {
+            const double d = static_cast<double>(reference.pixels[i * reference.channels + c]) - decoded.pixels[i * decoded.channels + c];
+            sum += d * d;
+        }
+    }
+    const double mse = sum / (static_cast<double>(pixels) * channels);
+    return mse <= 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
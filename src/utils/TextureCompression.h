@@ -0,0 +1,72 @@
+#ifndef OPENGL_UTILS_TEXTURE_COMPRESSION_H
+#define OPENGL_UTILS_TEXTURE_COMPRESSION_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct Image;
+
+// extension / newer core enums, a 3.3 core glad does not define them
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+
+/*
+ * 4x4 block compressed formats written by the TextureCompress tool:
+ *   BC1   RGB,  8 bytes per block (DXT1, no alpha)
+ *   BC3   RGBA, 16 bytes (BC1 color + BC4 alpha)
+ *   BC5   RG,   16 bytes (two BC4 channels, normal maps)
+ *   BC7   RGBA, 16 bytes, mode 6 only (one subset, 7 bit endpoints + p bit, 4 bit indices)
+ *   ETC2  RGB,  8 bytes, individual/differential blocks only (the ETC1 compatible subset)
+ * The decoders understand exactly what the encoders write, other BC7 modes and the
+ * ETC2 T/H/planar modes decode to magenta.
+ */
+enum class CompressedFormat {
+    BC1,
+    BC3,
+    BC5,
+    BC7,
+    ETC2,
+};
+
+const char* compressedFormatName(CompressedFormat format);
+
+// "bc1", "bc3", "bc5", "bc7", "etc2"
+bool parseCompressedFormat(const std::string& name, CompressedFormat& format);
+
+size_t compressedBlockBytes(CompressedFormat format);
+
+size_t compressedImageBytes(CompressedFormat format, int width, int height);
+
+// channels that carry data, e.g. 2 for BC5
+int compressedChannels(CompressedFormat format);
+
+GLenum compressedGLFormat(CompressedFormat format);
+
+// needs a current context: S3TC is an extension, BPTC needs 4.2 and ETC2 4.3 (or the ARB extensions)
+bool isCompressedFormatSupported(CompressedFormat format);
+
+/*
+ * encodes all blocks of the image on the ThreadPool. Edge blocks repeat the last row / column,
+ * channels the image does not have are 0 (alpha 255), like a GL_RED / GL_RGB upload.
+ */
+void compressImage(const Image& image, CompressedFormat format, std::vector<unsigned char>& out);
+
+// decodes to 4 channel RGBA8
+void decompressImage(const unsigned char* data, int width, int height, CompressedFormat format, Image& out);
+
+// peak signal to noise ratio in dB over the first channels of both images, 99 when identical
+double computePsnr(const Image& reference, const Image& decoded, int channels);
+
+#endif
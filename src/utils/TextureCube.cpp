@@ -1,46 +1,99 @@
 #include "TextureCube.h"
 #include <iostream>
-#include "stb_define.h"  // Ensure stb_image.h is included correctly
+#include "utils/Image.h"
+#include "utils/ImageCache.h"
+#include "utils/Ktx2.h"
+#include "utils/ThreadPool.h"
 
 TextureCube::TextureCube() : textureId(0), width(0), height(0), channels(0), format(GL_RGB) {
 }
 
+void TextureCube::release() {
+    if (textureId != 0) {
+        TextureResidency::getInstance().untrack(textureId);
+        glDeleteTextures(1, &textureId);
+        textureId = 0;
+    }
+}
+
+// the rgba8 fallback holds 4 bytes per texel and a third more for the mips
+static size_t compressedBytes(const Ktx2Texture& ktx, GLenum format) {
+    return format == GL_RGBA8 ? static_cast<size_t>(ktx.width) * ktx.height * 4 * 6 * 4 / 3 : ktx.byteSize();
+}
+
+// one face, mapped from its .texbin or freshly decoded
+struct CubeFace {
+    ImageCache cache;
+    Image image;
+
+    int width() const { return cache.isOpen() ? cache.getWidth() : image.width; }
+    int height() const { return cache.isOpen() ? cache.getHeight() : image.height; }
+    int channels() const { return cache.isOpen() ? cache.getChannels() : image.channels; }
+};
+
+static bool decodeFaces(const std::vector<std::string>& filepaths, CubeFace* faces) {
+    // the six faces decode concurrently, cube maps are not flipped and have no mips
+    bool decoded[6] = {};
+    ThreadPool::getInstance().parallelFor(6, [&](size_t i) {
+        if (faces[i].cache.open(filepaths[i], IMAGE_CACHE_NONE)) {
+            decoded[i] = true;
+        } else if (loadImage(filepaths[i], faces[i].image, false)) {
+            ImageCache::write(filepaths[i], IMAGE_CACHE_NONE, faces[i].image, {});
+            decoded[i] = true;
+        }
+    });
+
+    for (unsigned int i = 0; i < 6; ++i) {
+        if (!decoded[i]) {
+            std::cerr << "Failed to load texture: " << filepaths[i] << std::endl;
+            return false;
+        }
+        if (formatForChannels(faces[i].channels()) == 0 || faces[i].channels() == 2) {
+            std::cerr << "Unsupported number of channels: " << faces[i].channels() << std::endl;
+            return false;
+        }
+        if (faces[i].width() != faces[0].width() || faces[i].height() != faces[0].height()) {
+            std::cerr << "Error: cube map face " << filepaths[i] << " has a different size" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 bool TextureCube::loadFromFiles(const std::vector<std::string>& filepaths) {
     if (filepaths.size() != 6) {
         std::cerr << "Error: Exactly 6 file paths are required for a cube map texture." << std::endl;
         return false;
     }
 
-    stbi_set_flip_vertically_on_load(false);
+    CubeFace faces[6];
+    if (!decodeFaces(filepaths, faces)) {
+        return false;
+    }
+
+    release();
     glGenTextures(1, &textureId);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+    uploadFaces(faces);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
-    for (unsigned int i = 0; i < filepaths.size(); ++i) {
-        unsigned char* data = stbi_load(filepaths[i].c_str(), &width, &height, &channels, 0);
-        if (!data) {
-            std::cerr << "Failed to load texture: " << filepaths[i] << std::endl;
-            std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
-            return false;
-        }
+    sources = filepaths;
+    track(1, static_cast<size_t>(width) * height * channels * 6);
+    return true;
+}
 
-        switch (channels) {
-            case 1:
-                format = GL_RED;
-                break;
-            case 3:
-                format = GL_RGB;
-                break;
-            case 4:
-                format = GL_RGBA;
-                break;
-            default:
-                std::cerr << "Unsupported number of channels: " << channels << std::endl;
-                stbi_image_free(data);
-                return false;
+void TextureCube::uploadFaces(const CubeFace* faces) {
+    for (unsigned int i = 0; i < 6; ++i) {
+        width = faces[i].width();
+        height = faces[i].height();
+        channels = faces[i].channels();
+        format = formatForChannels(channels);
+        if (faces[i].cache.isOpen()) {
+            faces[i].cache.upload(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
+        } else {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE,
+                         faces[i].image.pixels.data());
         }
-
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        stbi_image_free(data);
     }
 
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -48,8 +101,105 @@ bool TextureCube::loadFromFiles(const std::vector<std::string>& filepaths) {
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+}
 
+bool TextureCube::loadFromKtx2(const std::string& filepath) {
+    Ktx2Texture ktx;
+    if (!readKtx2(filepath, ktx)) {
+        return false;
+    }
+    if (ktx.faceCount != 6) {
+        std::cerr << "Error: " << filepath << " is not a cube map." << std::endl;
+        return false;
+    }
+
+    release();
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+    uploadCompressed(ktx);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    sources = {filepath};
+    track(static_cast<int>(ktx.levels.size()), compressedBytes(ktx, format));
+    return true;
+}
+
+void TextureCube::uploadCompressed(const Ktx2Texture& ktx) {
+    width = ktx.width;
+    height = ktx.height;
+    channels = compressedChannels(ktx.format);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
+    format = uploadKtx2(ktx, GL_TEXTURE_CUBE_MAP);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, ktx.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
 
+void TextureCube::track(int levels, size_t bytes) {
+    ResidencyFootprint footprint;
+    footprint.width = width;
+    footprint.height = height;
+    footprint.levels = levels;
+    footprint.bytes = bytes;
+    TextureResidencyHooks hooks;
+    // the cube is not movable, the residency entry goes away with it in release()
+    hooks.reload = [this]() { return reload(); };
+    if (sources.size() == 1) {
+        hooks.restream = [this](int firstLevel, ResidencyFootprint& footprint) { return restream(firstLevel, footprint); };
+    }
+    hooks.resized = [this](ResidencyState, const ResidencyFootprint& resized) {
+        width = resized.width;
+        height = resized.height;
+    };
+    const std::string& name = sources.front();
+    TextureResidency::getInstance().track(textureId, GL_TEXTURE_CUBE_MAP, formatForChannels(channels), footprint,
+                                          name.substr(name.find_last_of('/') + 1), std::move(hooks));
+}
+
+bool TextureCube::reload() {
+    ResidencyFootprint footprint;
+    if (sources.size() == 6) {
+        CubeFace faces[6];
+        if (!decodeFaces(sources, faces)) {
+            return false;
+        }
+        glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+        uploadFaces(faces);
+        footprint.bytes = static_cast<size_t>(width) * height * channels * 6;
+    } else {
+        Ktx2Texture ktx;
+        if (sources.empty() || !readKtx2(sources.front(), ktx) || ktx.faceCount != 6) {
+            return false;
+        }
+        glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+        uploadCompressed(ktx);
+        footprint.levels = static_cast<int>(ktx.levels.size());
+        footprint.bytes = compressedBytes(ktx, format);
+    }
     glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    footprint.width = width;
+    footprint.height = height;
+    TextureResidency::getInstance().loaded(textureId, footprint);
     return true;
-}
\ No newline at end of file
+}
+
+bool TextureCube::restream(int firstLevel, ResidencyFootprint& footprint) {
+    Ktx2Texture ktx;
+    if (sources.size() != 1 || !readKtx2(sources.front(), ktx) || ktx.faceCount != 6 || static_cast<int>(ktx.levels.size()) <= firstLevel) {
+        return false;
+    }
+    ktx.dropLevels(firstLevel);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+    uploadCompressed(ktx);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    footprint.width = width;
+    footprint.height = height;
+    footprint.levels = static_cast<int>(ktx.levels.size());
+    footprint.bytes = compressedBytes(ktx, format);
+    return true;
+}
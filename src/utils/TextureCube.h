@@ -5,19 +5,28 @@
 #include <GLFW/glfw3.h>
 #include <string>
 #include <vector>
+#include "utils/TextureResidency.h"
+
+struct CubeFace;
+struct Ktx2Texture;
 
 class TextureCube {
 public:
     TextureCube();
     ~TextureCube() {
-        if (textureId != 0) {
-            glDeleteTextures(1, &textureId);
-        }
+        release();
     };
 
+    TextureCube(const TextureCube&) = delete;
+    TextureCube& operator=(const TextureCube&) = delete;
+
     bool loadFromFiles(const std::vector<std::string>& filepaths);   // right left top bottom back front
 
+    // block compressed cube map (faceCount 6) written by TextureCompress --cube
+    bool loadFromKtx2(const std::string& filepath);
+
     void bind() const {
+        TextureResidency::getInstance().touch(textureId);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
     };
@@ -36,6 +45,23 @@ private:
     GLuint textureId;
     int width, height, channels;
     GLenum format;
+    // six face images or one .ktx2, what the TextureResidency reloads from
+    std::vector<std::string> sources;
+
+    void release();
+
+    void uploadFaces(const CubeFace* faces);
+
+    void uploadCompressed(const Ktx2Texture& ktx);
+
+    // registers with the TextureResidency after a load
+    void track(int levels, size_t bytes);
+
+    // residency reload hook, same GL name
+    bool reload();
+
+    // residency restream hook, only a .ktx2 source has the smaller levels stored
+    bool restream(int firstLevel, ResidencyFootprint& footprint);
 };
 
 
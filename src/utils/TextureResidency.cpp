@@ -0,0 +1,405 @@
+#include "TextureResidency.h"
+#include "utils/Utils.h"
+#include <GLFW/glfw3.h>
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+static const double MEGABYTE = 1024.0 * 1024.0;
+
+static int pixelFormatChannels(GLenum format) {
+    switch (format) {
+        case GL_RED: return 1;
+        case GL_RG: return 2;
+        case GL_RGB: return 3;
+        default: return 4;
+    }
+}
+
+static const char* stateName(ResidencyState state) {
+    switch (state) {
+        case ResidencyState::Full: return "full";
+        case ResidencyState::Trimmed: return "trimmed";
+        case ResidencyState::Evicted: return "evicted";
+        default: return "loading";
+    }
+}
+
+TextureResidency& TextureResidency::getInstance() {
+    static TextureResidency instance;
+    return instance;
+}
+
+void TextureResidency::track(GLuint id, GLenum target, GLenum pixelFormat, const ResidencyFootprint& footprint, const std::string& name,
+                             TextureResidencyHooks hooks, bool loading) {
+    if (id == 0) {
+        return;
+    }
+    // GL reuses names, a stale entry would carry the old sizes
+    untrack(id);
+    Entry& entry = entries[id];
+    entry.target = target;
+    entry.pixelFormat = pixelFormat;
+    entry.name = name;
+    entry.state = loading ? ResidencyState::Loading : ResidencyState::Full;
+    entry.current = footprint;
+    entry.full = footprint;
+    // new textures get the same grace period as ones that were just drawn
+    entry.lastUsed = frame;
+    entry.hooks = std::move(hooks);
+    resident += footprint.bytes;
+    fullBytes += footprint.bytes;
+    totals.peakBytes = std::max(totals.peakBytes, resident);
+}
+
+void TextureResidency::untrack(GLuint id) {
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return;
+    }
+    resident -= it->second.current.bytes;
+    fullBytes -= it->second.full.bytes;
+    entries.erase(it);
+}
+
+void TextureResidency::loaded(GLuint id, const ResidencyFootprint& footprint) {
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return;
+    }
+    Entry& entry = it->second;
+    resident = resident - entry.current.bytes + footprint.bytes;
+    fullBytes = fullBytes - entry.full.bytes + footprint.bytes;
+    entry.current = footprint;
+    entry.full = footprint;
+    entry.state = ResidencyState::Full;
+    totals.peakBytes = std::max(totals.peakBytes, resident);
+}
+
+void TextureResidency::use(GLuint id, Entry& entry) {
+    entry.lastUsed = frame;
+    usedThisFrame++;
+    if ((entry.state == ResidencyState::Trimmed || entry.state == ResidencyState::Evicted) && entry.hooks.reload) {
+        reloads.push_back(id);
+    }
+}
+
+void TextureResidency::setState(Entry& entry, ResidencyState state, const ResidencyFootprint& footprint) {
+    resident = resident - entry.current.bytes + footprint.bytes;
+    entry.current = footprint;
+    entry.state = state;
+    if (entry.hooks.resized) {
+        entry.hooks.resized(state, footprint);
+    }
+}
+
+void TextureResidency::checkCopyImage() {
+    copyImageChecked = true;
+    if (gl::hasVersion(4, 3) || gl::hasExtension("GL_ARB_copy_image")) {
+        copyImageSubData = reinterpret_cast<CopyImageSubDataProc>(glfwGetProcAddress("glCopyImageSubData"));
+    }
+}
+
+bool TextureResidency::canTrim(const Entry& entry) const {
+    return (copyImageSubData || entry.hooks.restream) && entry.current.levels > 1
+        && std::min(entry.current.width, entry.current.height) / 2 >= MIN_TRIM_SIZE;
+}
+
+bool TextureResidency::trim(GLuint id, Entry& entry) {
+    const int faces = entry.target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+    const int levels = entry.current.levels;
+    ResidencyFootprint footprint;
+    if (copyImageSubData) {
+        copyLevels(id, entry, footprint);
+    } else {
+        // the owner uploads the smaller chain from its file, the texture must be bound for it
+        glBindTexture(entry.target, id);
+        const bool restreamed = entry.hooks.restream(entry.full.levels - levels + 1, footprint);
+        glBindTexture(entry.target, 0);
+        if (!restreamed) {
+            // evicted when it comes to that, the source can not give a smaller chain
+            entry.hooks.restream = nullptr;
+            return false;
+        }
+    }
+
+    // a 0x0 image releases the levels past the new chain
+    glBindTexture(entry.target, id);
+    for (int face = 0; face < faces; face++) {
+        const GLenum faceTarget = faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : entry.target;
+        for (int level = footprint.levels; level < levels; level++) {
+            glTexImage2D(faceTarget, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glTexParameteri(entry.target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(entry.target, GL_TEXTURE_MAX_LEVEL, footprint.levels - 1);
+    glBindTexture(entry.target, 0);
+
+    totals.trims++;
+    totals.bytesFreed += entry.current.bytes > footprint.bytes ? entry.current.bytes - footprint.bytes : 0;
+    setState(entry, ResidencyState::Trimmed, footprint);
+    return true;
+}
+
+void TextureResidency::copyLevels(GLuint id, Entry& entry, ResidencyFootprint& footprint) {
+    const int faces = entry.target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+    const int levels = entry.current.levels;
+    const GLenum firstFace = faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : entry.target;
+    glBindTexture(entry.target, id);
+    GLint internalFormat = 0, compressed = GL_FALSE;
+    glGetTexLevelParameteriv(firstFace, 1, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+    glGetTexLevelParameteriv(firstFace, 1, GL_TEXTURE_COMPRESSED, &compressed);
+    std::vector<GLint> widths(levels - 1), heights(levels - 1), sizes(levels - 1, 0);
+    for (int level = 1; level < levels; level++) {
+        glGetTexLevelParameteriv(firstFace, level, GL_TEXTURE_WIDTH, &widths[level - 1]);
+        glGetTexLevelParameteriv(firstFace, level, GL_TEXTURE_HEIGHT, &heights[level - 1]);
+        if (compressed) {
+            glGetTexLevelParameteriv(firstFace, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &sizes[level - 1]);
+        }
+    }
+
+    // (re)specifies levels 0..levels-2 with the sizes of the kept ones, contents undefined
+    auto specify = [&]() {
+        for (int face = 0; face < faces; face++) {
+            const GLenum faceTarget = faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : entry.target;
+            for (int level = 0; level < levels - 1; level++) {
+                if (compressed) {
+                    glCompressedTexImage2D(faceTarget, level, static_cast<GLenum>(internalFormat), widths[level], heights[level], 0,
+                                           sizes[level], nullptr);
+                } else {
+                    glTexImage2D(faceTarget, level, internalFormat, widths[level], heights[level], 0, entry.pixelFormat,
+                                 GL_UNSIGNED_BYTE, nullptr);
+                }
+            }
+        }
+        glTexParameteri(entry.target, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(entry.target, GL_TEXTURE_MAX_LEVEL, levels - 2);
+    };
+
+    // copies need both textures complete: the scratch gets a consistent chain, the original keeps one
+    GLuint scratch = 0;
+    glGenTextures(1, &scratch);
+    glBindTexture(entry.target, scratch);
+    specify();
+    for (int level = 1; level < levels; level++) {
+        // a cube map is 6 layers deep for the copy, all faces in one call
+        copyImageSubData(id, entry.target, level, 0, 0, 0, scratch, entry.target, level - 1, 0, 0, 0,
+                         widths[level - 1], heights[level - 1], faces);
+    }
+    glBindTexture(entry.target, id);
+    specify();
+    for (int level = 0; level < levels - 1; level++) {
+        copyImageSubData(scratch, entry.target, level, 0, 0, 0, id, entry.target, level, 0, 0, 0, widths[level], heights[level], faces);
+    }
+    glBindTexture(entry.target, 0);
+    glDeleteTextures(1, &scratch);
+
+    footprint.width = widths[0];
+    footprint.height = heights[0];
+    footprint.levels = levels - 1;
+    for (int level = 0; level < levels - 1; level++) {
+        footprint.bytes += compressed ? static_cast<size_t>(sizes[level]) * faces
+                                      : static_cast<size_t>(widths[level]) * heights[level] * pixelFormatChannels(entry.pixelFormat) * faces;
+    }
+}
+
+void TextureResidency::evict(GLuint id, Entry& entry) {
+    static const unsigned char grey[4] = {128, 128, 128, 255};
+    const int faces = entry.target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+    glBindTexture(entry.target, id);
+    for (int face = 0; face < faces; face++) {
+        const GLenum faceTarget = faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : entry.target;
+        glTexImage2D(faceTarget, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        for (int level = 1; level < entry.current.levels; level++) {
+            glTexImage2D(faceTarget, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glTexParameteri(entry.target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(entry.target, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(entry.target, 0);
+
+    ResidencyFootprint footprint;
+    footprint.width = 1;
+    footprint.height = 1;
+    footprint.levels = 1;
+    footprint.bytes = sizeof(grey) * faces;
+    totals.evictions++;
+    totals.bytesFreed += entry.current.bytes - footprint.bytes;
+    setState(entry, ResidencyState::Evicted, footprint);
+}
+
+void TextureResidency::update(const UploadBudget& uploadBudget) {
+    // textures drawn while degraded come back first, their owners decide how fast
+    std::vector<GLuint> pending;
+    pending.swap(reloads);
+    for (GLuint id: pending) {
+        auto it = entries.find(id);
+        if (it == entries.end() || (it->second.state != ResidencyState::Trimmed && it->second.state != ResidencyState::Evicted)) {
+            continue;
+        }
+        Entry& entry = it->second;
+        const ResidencyState previous = entry.state;
+        entry.state = ResidencyState::Loading;
+        totals.reloads++;
+        // the hook may call loaded right away for a synchronous reload
+        if (!entry.hooks.reload()) {
+            std::cout << "ERROR::TEXTURE_RESIDENCY:: can not reload " << entry.name << ", keeping it as it is" << std::endl;
+            entry.hooks.reload = nullptr;
+            entry.state = previous;
+        }
+    }
+
+    if (budget > 0 && resident > budget) {
+        if (!copyImageChecked) {
+            checkCopyImage();
+        }
+        // least recently used first, the bigger one first among equals
+        std::vector<std::pair<GLuint, Entry*>> candidates;
+        for (auto& [id, entry]: entries) {
+            if (entry.hooks.reload && frame - entry.lastUsed >= KEEP_FRAMES
+                && (entry.state == ResidencyState::Full || entry.state == ResidencyState::Trimmed)) {
+                candidates.emplace_back(id, &entry);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+            if (a.second->lastUsed != b.second->lastUsed) {
+                return a.second->lastUsed < b.second->lastUsed;
+            }
+            return a.second->current.bytes > b.second->current.bytes;
+        });
+
+        // one level per texture and round, so quality degrades evenly before anything disappears
+        UploadBudgetScope scope(uploadBudget);
+        bool progress = true;
+        bool stalled = false;
+        while (resident > budget && progress && !stalled) {
+            progress = false;
+            for (auto& [id, entry]: candidates) {
+                if (resident <= budget) {
+                    break;
+                }
+                if (!canTrim(*entry)) {
+                    continue;
+                }
+                // the levels that stay, about a quarter of the texture, are copied out and back or uploaded once
+                const size_t copyBytes = entry->current.bytes / 4 * (copyImageSubData ? 2 : 1);
+                if (!scope.canUpload(copyBytes)) {
+                    stalled = true;
+                    break;
+                }
+                scope.consume(copyBytes);
+                if (trim(id, *entry)) {
+                    progress = true;
+                }
+            }
+        }
+        // eviction is cheap, but only once trimming is exhausted; a stalled frame continues trimming next frame
+        if (!stalled) {
+            for (auto& [id, entry]: candidates) {
+                if (resident <= budget) {
+                    break;
+                }
+                if (entry->state != ResidencyState::Evicted) {
+                    evict(id, *entry);
+                }
+            }
+        }
+    }
+    totals.overBudget = budget > 0 && resident > budget;
+
+    usedLastFrame = usedThisFrame;
+    usedThisFrame = 0;
+    frame++;
+}
+
+TextureResidencyStats TextureResidency::getStats() const {
+    TextureResidencyStats stats = totals;
+    stats.budgetBytes = budget;
+    stats.residentBytes = resident;
+    stats.fullBytes = fullBytes;
+    stats.textures = entries.size();
+    stats.usedLastFrame = usedLastFrame;
+    for (const auto& [id, entry]: entries) {
+        stats.pinned += entry.hooks.reload ? 0 : 1;
+        stats.trimmed += entry.state == ResidencyState::Trimmed ? 1 : 0;
+        stats.evicted += entry.state == ResidencyState::Evicted ? 1 : 0;
+        stats.loading += entry.state == ResidencyState::Loading ? 1 : 0;
+    }
+    return stats;
+}
+
+std::vector<TextureResidencyEntry> TextureResidency::getEntries() const {
+    std::vector<TextureResidencyEntry> rows;
+    rows.reserve(entries.size());
+    for (const auto& [id, entry]: entries) {
+        TextureResidencyEntry row;
+        row.id = id;
+        row.name = entry.name;
+        row.target = entry.target;
+        row.state = entry.state;
+        row.current = entry.current;
+        row.full = entry.full;
+        row.idleFrames = frame - 1 > entry.lastUsed ? frame - 1 - entry.lastUsed : 0;
+        row.pinned = !entry.hooks.reload;
+        rows.push_back(std::move(row));
+    }
+    std::sort(rows.begin(), rows.end(), [](const TextureResidencyEntry& a, const TextureResidencyEntry& b) {
+        return a.full.bytes > b.full.bytes;
+    });
+    return rows;
+}
+
+void TextureResidency::drawPanel() {
+    const TextureResidencyStats stats = getStats();
+    ImGui::Begin("Texture Residency");
+
+    int budgetMegabytes = static_cast<int>(budget / (1024 * 1024));
+    if (ImGui::SliderInt("Budget (MB, 0 = off)", &budgetMegabytes, 0, 1024)) {
+        budget = static_cast<size_t>(budgetMegabytes) * 1024 * 1024;
+    }
+    char label[64];
+    if (budget > 0) {
+        std::snprintf(label, sizeof(label), "%.1f / %.1f MB", stats.residentBytes / MEGABYTE, budget / MEGABYTE);
+        ImGui::ProgressBar(std::min(1.0f, static_cast<float>(static_cast<double>(stats.residentBytes) / budget)), ImVec2(-1.0f, 0.0f), label);
+    }
+    ImGui::Text("resident %.1f MB of %.1f MB at full resolution, peak %.1f MB", stats.residentBytes / MEGABYTE,
+                stats.fullBytes / MEGABYTE, stats.peakBytes / MEGABYTE);
+    ImGui::Text("%zu textures: %zu trimmed, %zu evicted, %zu loading, %zu pinned", stats.textures, stats.trimmed, stats.evicted,
+                stats.loading, stats.pinned);
+    ImGui::Text("%zu bound last frame", stats.usedLastFrame);
+    ImGui::Text("totals: %zu trims, %zu evictions, %zu reloads, %.1f MB freed", stats.trims, stats.evictions, stats.reloads,
+                stats.bytesFreed / MEGABYTE);
+    if (stats.overBudget) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "over budget: the rest is in use, pinned or at its smallest");
+    }
+
+    if (ImGui::CollapsingHeader("Textures")) {
+        const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY;
+        if (ImGui::BeginTable("residency", 5, flags, ImVec2(0.0f, 300.0f))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("name");
+            ImGui::TableSetupColumn("size");
+            ImGui::TableSetupColumn("MB");
+            ImGui::TableSetupColumn("state");
+            ImGui::TableSetupColumn("idle");
+            ImGui::TableHeadersRow();
+            for (const TextureResidencyEntry& row: getEntries()) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(row.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%dx%d%s, %d levels", row.current.width, row.current.height, row.target == GL_TEXTURE_CUBE_MAP ? " x6" : "",
+                            row.current.levels);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f / %.2f", row.current.bytes / MEGABYTE, row.full.bytes / MEGABYTE);
+                ImGui::TableNextColumn();
+                ImGui::Text("%s%s", stateName(row.state), row.pinned ? ", pinned" : "");
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(row.idleFrames));
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+}
@@ -0,0 +1,187 @@
+#ifndef OPENGL_UTILS_TEXTURE_RESIDENCY_H
+#define OPENGL_UTILS_TEXTURE_RESIDENCY_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "utils/UploadBudget.h"
+
+enum class ResidencyState: uint8_t {
+    Full,       // every level the owner uploaded
+    Trimmed,    // top levels dropped, sampled from a smaller level 0
+    Evicted,    // a grey 1x1 stand in
+    Loading,    // the owner is (re)loading it
+};
+
+// what a texture takes on the gpu right now
+struct ResidencyFootprint {
+    int width = 0;
+    int height = 0;
+    int levels = 1;
+    size_t bytes = 0;       // all levels and faces
+};
+
+// how the manager talks back to the owner of a texture
+struct TextureResidencyHooks {
+    /*
+     * brings the full texture back under the same GL name, may finish frames later
+     * (TextureResidency::loaded then). false when it can not, the texture is pinned from then on.
+     */
+    std::function<bool()> reload;
+    /*
+     * re-specifies the texture from its source with level firstLevel as level 0, synchronously and
+     * under the same GL name, and fills in what is resident then. Used to trim when the driver can
+     * not copy between textures (glCopyImageSubData); null or false when the source can not do it.
+     */
+    std::function<bool(int firstLevel, ResidencyFootprint& footprint)> restream;
+    // the manager replaced the storage, keep cached sizes in sync
+    std::function<void(ResidencyState, const ResidencyFootprint&)> resized;
+};
+
+struct TextureResidencyStats {
+    size_t budgetBytes = 0;     // 0 = no limit
+    size_t residentBytes = 0;
+    size_t fullBytes = 0;       // all tracked textures at full resolution
+    size_t peakBytes = 0;
+    size_t textures = 0;
+    size_t pinned = 0;          // no reload hook, accounted only
+    size_t trimmed = 0;
+    size_t evicted = 0;
+    size_t loading = 0;
+    size_t usedLastFrame = 0;
+    size_t trims = 0;           // totals since start
+    size_t evictions = 0;
+    size_t reloads = 0;
+    size_t bytesFreed = 0;
+    bool overBudget = false;    // nothing left that may be trimmed or evicted
+};
+
+// one row of the panel
+struct TextureResidencyEntry {
+    GLuint id = 0;
+    std::string name;
+    GLenum target = GL_TEXTURE_2D;
+    ResidencyState state = ResidencyState::Full;
+    ResidencyFootprint current;
+    ResidencyFootprint full;
+    uint64_t idleFrames = 0;
+    bool pinned = false;
+};
+
+/*
+ * Accounts the GPU memory of Texture, TextureCube and TextureCache (Model) textures, mip levels
+ * and cube faces included, and keeps it under a budget.
+ * Over budget, textures not used for KEEP_FRAMES frames are degraded least recently used first:
+ *   - trim : the top mip level is dropped and the remaining levels are re-specified under the same
+ *            GL name, so Mesh / MaterialBinding ids stay valid. They are copied on the gpu through a
+ *            scratch texture (GL 4.3 / GL_ARB_copy_image), or else restreamed from the owner's
+ *            .texbin / .ktx2; never read back. Textures that allow neither are evicted instead
+ *   - evict: once a texture is down to MIN_TRIM_SIZE, its storage becomes a grey 1x1 texel
+ * Every candidate loses a level before the first one is evicted. Binding a trimmed or evicted
+ * texture (touch) schedules a reload through its owner's hook, the next update issues it.
+ * Textures without a reload hook (e.g. Texture::createFromData) are accounted but pinned.
+ *
+ * GL thread only. Nothing is trimmed or evicted until a budget is set.
+ */
+class TextureResidency {
+public:
+    static constexpr int MIN_TRIM_SIZE = 64;
+    static constexpr uint64_t KEEP_FRAMES = 2;
+
+    static TextureResidency& getInstance();
+
+    TextureResidency(const TextureResidency&) = delete;
+    TextureResidency& operator=(const TextureResidency&) = delete;
+
+    // bytes, 0 turns the limit off
+    void setBudget(size_t bytes) { budget = bytes; }
+
+    size_t getBudget() const { return budget; }
+
+    /*
+     * target is GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP, pixelFormat the GL_RED..GL_RGBA layout of
+     * uncompressed levels, used to specify the scratch copy. loading: the owner calls loaded when
+     * the pixels are in.
+     */
+    void track(GLuint id, GLenum target, GLenum pixelFormat, const ResidencyFootprint& footprint, const std::string& name,
+               TextureResidencyHooks hooks = TextureResidencyHooks(), bool loading = false);
+
+    void untrack(GLuint id);
+
+    // the owner finished (re)loading the whole texture
+    void loaded(GLuint id, const ResidencyFootprint& footprint);
+
+    // marks the texture as used this frame, the bind paths call it
+    void touch(GLuint id) {
+        if (id == 0) {
+            return;
+        }
+        auto it = entries.find(id);
+        if (it != entries.end() && it->second.lastUsed != frame) {
+            use(id, it->second);
+        }
+    }
+
+    // once per frame: issues reloads, then trims / evicts; the copies and re-uploads count against budget
+    void update(const UploadBudget& budget = UploadBudget());
+
+    TextureResidencyStats getStats() const;
+
+    // biggest first
+    std::vector<TextureResidencyEntry> getEntries() const;
+
+    // ImGui window with live numbers and a budget slider, call between ImGuiManager::newFrame and render
+    void drawPanel();
+
+private:
+    typedef void (APIENTRYP CopyImageSubDataProc)(GLuint srcName, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                                                  GLuint dstName, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                                                  GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth);
+
+    struct Entry {
+        GLenum target = GL_TEXTURE_2D;
+        GLenum pixelFormat = GL_RGBA;
+        std::string name;
+        ResidencyState state = ResidencyState::Full;
+        ResidencyFootprint current;
+        ResidencyFootprint full;
+        uint64_t lastUsed = 0;
+        TextureResidencyHooks hooks;
+    };
+
+    std::unordered_map<GLuint, Entry> entries;
+    std::vector<GLuint> reloads;            // touched while trimmed or evicted
+    size_t budget = 0;
+    size_t resident = 0;
+    size_t fullBytes = 0;
+    uint64_t frame = 1;
+    size_t usedThisFrame = 0;
+    size_t usedLastFrame = 0;
+    TextureResidencyStats totals;
+    CopyImageSubDataProc copyImageSubData = nullptr;
+    bool copyImageChecked = false;
+
+    TextureResidency() = default;
+
+    void checkCopyImage();
+
+    void use(GLuint id, Entry& entry);
+
+    void setState(Entry& entry, ResidencyState state, const ResidencyFootprint& footprint);
+
+    bool canTrim(const Entry& entry) const;
+
+    // drops level 0, the other levels move up by one; false when the texture can not be trimmed
+    bool trim(GLuint id, Entry& entry);
+
+    // trim on the gpu: the kept levels go to a scratch texture and back at their new level
+    void copyLevels(GLuint id, Entry& entry, ResidencyFootprint& footprint);
+
+    void evict(GLuint id, Entry& entry);
+};
+
+#endif
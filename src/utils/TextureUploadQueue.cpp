@@ -0,0 +1,329 @@
+#include "TextureUploadQueue.h"
+#include "utils/TextureCache.h"
+#include "utils/TextureResidency.h"
+#include "utils/Utils.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// GL 4.4 / GL_ARB_buffer_storage, a 3.3 core glad does not define them
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace {
+
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+// every slice starts aligned for any pixel size and the drivers' fast copy paths
+constexpr size_t RING_ALIGNMENT = 256;
+constexpr GLuint64 FLUSH_TIMEOUT_NS = 1000000000ull;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+TextureUploadQueue& TextureUploadQueue::getInstance() {
+    static TextureUploadQueue instance;
+    return instance;
+}
+
+bool TextureUploadQueue::init() {
+    ringSize = DEFAULT_RING_BYTES;
+    BufferStorageProc bufferStorage = nullptr;
+    if (gl::hasVersion(4, 4) || gl::hasExtension("GL_ARB_buffer_storage")) {
+        bufferStorage = reinterpret_cast<BufferStorageProc>(glfwGetProcAddress("glBufferStorage"));
+    }
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    if (bufferStorage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(ringSize), nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(ringSize), flags));
+        if (!mapped) {
+            // immutable storage can not be respecified, start over with a plain buffer
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        }
+    }
+    if (!mapped) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(ringSize), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    head = tail = used = 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.ringBytes = ringSize;
+    stats.persistent = mapped != nullptr;
+    std::cout << "TextureUploadQueue: " << ringSize / (1024 * 1024) << " MB staging ring, "
+              << (mapped ? "persistently mapped" : "mapped per copy") << std::endl;
+    return buffer != 0;
+}
+
+void TextureUploadQueue::shutdown() {
+    if (buffer == 0) {
+        return;
+    }
+    retire(true);
+    if (mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        mapped = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    ringSize = head = tail = used = 0;
+}
+
+void TextureUploadQueue::enqueue(TextureUpload upload) {
+    if (!upload.image.isValid() || formatForChannels(upload.image.channels) == 0) {
+        std::cout << "ERROR::TEXTURE_UPLOAD_QUEUE:: nothing to upload" << std::endl;
+        return;
+    }
+    Job job;
+    job.texture = std::move(upload.texture);
+    job.image = std::move(upload.image);
+    job.mips = std::move(upload.mips);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    incoming.push_back(std::move(job));
+    stats.queued++;
+}
+
+bool TextureUploadQueue::isIdle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats.queued == 0;
+}
+
+TextureUploadStats TextureUploadQueue::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void TextureUploadQueue::retire(bool wait) {
+    while (!inFlight.empty()) {
+        const InFlight& batch = inFlight.front();
+        const GLenum result = glClientWaitSync(batch.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? FLUSH_TIMEOUT_NS : 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            if (wait) {
+                continue;
+            }
+            break;
+        }
+        // GL_WAIT_FAILED means a lost context, nothing reads the ring any more either
+        glDeleteSync(batch.fence);
+        used -= batch.bytes;
+        tail = batch.end;
+        inFlight.pop_front();
+    }
+}
+
+size_t TextureUploadQueue::allocate(size_t bytes) {
+    if (used == 0) {
+        head = tail = 0;
+    }
+    if (bytes > ringSize || (used > 0 && head == tail)) {
+        return ringSize;
+    }
+    if (head >= tail) {
+        if (head + bytes <= ringSize) {
+            const size_t offset = head;
+            head += bytes;
+            used += bytes;
+            return offset;
+        }
+        // the rest of the ring is too short, skip it and continue at the start
+        if (bytes <= tail) {
+            used += ringSize - head + bytes;
+            head = bytes;
+            return 0;
+        }
+        return ringSize;
+    }
+    if (head + bytes <= tail) {
+        const size_t offset = head;
+        head += bytes;
+        used += bytes;
+        return offset;
+    }
+    return ringSize;
+}
+
+size_t TextureUploadQueue::largestFree() const {
+    if (used == 0) {
+        return ringSize;
+    }
+    if (head == tail) {
+        return 0;
+    }
+    return head > tail ? std::max(ringSize - head, tail) : tail - head;
+}
+
+const Image& TextureUploadQueue::levelImage(const Job& job, int level) const {
+    return level == 0 ? job.image : job.mips[level - 1];
+}
+
+void TextureUploadQueue::start(Job& job, CachedTexture& texture) {
+    const int levels = static_cast<int>(job.mips.size()) + 1;
+    const GLenum format = formatForChannels(job.image.channels);
+    size_t bytes = 0;
+    for (int level = 0; level < levels; level++) {
+        bytes += levelImage(job, level).byteSize();
+    }
+    texture.width = job.image.width;
+    texture.height = job.image.height;
+    texture.channels = job.image.channels;
+    texture.format = format;
+    texture.levels = levels;
+    TextureCache::getInstance().resize(texture, bytes);
+
+    // storage for the whole chain first, no unpack buffer may be bound for the null uploads
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    for (int level = 0; level < levels; level++) {
+        const Image& image = levelImage(job, level);
+        glTexImage2D(GL_TEXTURE_2D, level, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    job.level = levels - 1;
+    job.row = 0;
+    job.started = true;
+}
+
+void TextureUploadQueue::update(const UploadBudget& budget) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& job: incoming) {
+            active.push_back(std::move(job));
+        }
+        incoming.clear();
+    }
+    if (active.empty() && inFlight.empty()) {
+        return;
+    }
+    if (buffer == 0 && !init()) {
+        return;
+    }
+
+    const auto frameStart = std::chrono::steady_clock::now();
+    retire(false);
+    const size_t usedBefore = used;
+    size_t completed = 0, dropped = 0;
+    bool stalled = false;
+    UploadBudgetScope scope(budget);
+
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    while (!active.empty()) {
+        Job& job = active.front();
+        std::shared_ptr<CachedTexture> texture = job.texture.lock();
+        if (!texture) {
+            active.pop_front();
+            dropped++;
+            continue;
+        }
+        if (!job.started) {
+            start(job, *texture);
+        }
+
+        const Image& level = levelImage(job, job.level);
+        const GLenum format = formatForChannels(level.channels);
+        const size_t rowBytes = static_cast<size_t>(level.width) * level.channels;
+        if (!scope.canUpload(rowBytes)) {
+            break;
+        }
+        glBindTexture(GL_TEXTURE_2D, texture->id);
+
+        // as many rows as the budget and the free ring space allow, at least one per frame
+        size_t rows = static_cast<size_t>(level.height - job.row);
+        const size_t budgetBytes = scope.bytesUploaded() < budget.maxBytes ? budget.maxBytes - scope.bytesUploaded() : 0;
+        rows = std::min(rows, std::max<size_t>(budgetBytes / rowBytes, 1));
+        size_t offset = ringSize;
+        if (alignUp(rowBytes, RING_ALIGNMENT) > ringSize) {
+            // a single row does not fit the ring, copy straight from client memory
+            glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, job.row, level.width, static_cast<GLsizei>(rows), format, GL_UNSIGNED_BYTE,
+                            level.pixels.data() + job.row * rowBytes);
+        } else {
+            rows = std::min(rows, largestFree() / rowBytes);
+            while (rows > 0 && (offset = allocate(alignUp(rows * rowBytes, RING_ALIGNMENT))) == ringSize) {
+                rows /= 2;
+            }
+            if (rows == 0) {
+                stalled = true;
+                break;
+            }
+            const size_t bytes = rows * rowBytes;
+            const unsigned char* source = level.pixels.data() + job.row * rowBytes;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            if (mapped) {
+                std::memcpy(mapped + offset, source, bytes);
+            } else {
+                // the fences guarantee the gpu is done with this range, no need to let the driver sync
+                void* target = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes),
+                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+                if (target) {
+                    std::memcpy(target, source, bytes);
+                    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                }
+            }
+            glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, job.row, level.width, static_cast<GLsizei>(rows), format, GL_UNSIGNED_BYTE,
+                            reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        scope.consume(rows * rowBytes);
+        job.row += static_cast<int>(rows);
+
+        if (job.row == level.height) {
+            // this level and every smaller one are complete, sample from here on
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, job.level);
+            job.row = 0;
+            if (job.level == 0) {
+                texture->ready = true;
+                TextureResidency::getInstance().loaded(texture->id, {texture->width, texture->height, texture->levels, texture->bytes});
+                active.pop_front();
+                completed++;
+            } else {
+                job.level--;
+            }
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    if (used != usedBefore) {
+        inFlight.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), used - usedBefore, head});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.queued -= completed + dropped;
+    stats.completed += completed;
+    stats.dropped += dropped;
+    stats.bytesUploaded += scope.bytesUploaded();
+    stats.lastFrameBytes = scope.bytesUploaded();
+    stats.lastFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    stats.ringInFlight = used;
+    stats.ringStalls += stalled ? 1 : 0;
+}
+
+void TextureUploadQueue::flush() {
+    UploadBudget unlimited;
+    unlimited.maxBytes = SIZE_MAX;
+    unlimited.maxMilliseconds = 1e9;
+    while (!isIdle()) {
+        update(unlimited);
+        // the ring is full, wait until the gpu consumed it
+        retire(true);
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef OPENGL_UTILS_TEXTURE_UPLOAD_QUEUE_H
+#define OPENGL_UTILS_TEXTURE_UPLOAD_QUEUE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "utils/Image.h"
+#include "utils/UploadBudget.h"
+
+struct CachedTexture;
+
+// decoded pixels waiting for the GL thread, mips are the levels below image (MipChain.h)
+struct TextureUpload {
+    std::weak_ptr<CachedTexture> texture;
+    Image image;
+    std::vector<Image> mips;
+};
+
+struct TextureUploadStats {
+    size_t queued = 0;          // textures waiting or in progress
+    size_t completed = 0;
+    size_t dropped = 0;         // texture released before its upload finished
+    size_t bytesUploaded = 0;
+    size_t lastFrameBytes = 0;
+    double lastFrameMs = 0.0;
+    size_t ringBytes = 0;
+    size_t ringInFlight = 0;    // bytes the GPU may still read, guarded by fences
+    size_t ringStalls = 0;      // frames that stopped early because the ring was full
+    bool persistent = false;    // GL_ARB_buffer_storage mapping, otherwise mapped per copy
+};
+
+/*
+ * Streams texture pixels through a ring of pixel unpack buffer memory instead of glTexImage2D
+ * from client memory, so a big texture arriving mid session does not stall a frame.
+ *   - the ring is persistently mapped when GL 4.4 / GL_ARB_buffer_storage is there, a 3.3
+ *     context maps each copy with GL_MAP_UNSYNCHRONIZED_BIT instead
+ *   - every frame that wrote to the ring ends with a fence, ring space is reused only after
+ *     the fence signalled
+ *   - levels go up smallest first, GL_TEXTURE_BASE_LEVEL follows the finest complete level
+ *     so the texture sharpens while it streams; big levels are split into row slices
+ *
+ * enqueue may be called from any thread (e.g. a ThreadPool decode job), update must run once
+ * per frame on the GL thread.
+ */
+class TextureUploadQueue {
+public:
+    static constexpr size_t DEFAULT_RING_BYTES = 32 * 1024 * 1024;
+
+    static TextureUploadQueue& getInstance();
+
+    TextureUploadQueue(const TextureUploadQueue&) = delete;
+    TextureUploadQueue& operator=(const TextureUploadQueue&) = delete;
+
+    void enqueue(TextureUpload upload);
+
+    // copies as much as the budget and the free ring space allow and issues the texture copies
+    void update(const UploadBudget& budget = UploadBudget());
+
+    // runs update until every queued texture is on the gpu, for loading screens and shutdown
+    void flush();
+
+    bool isIdle() const;
+
+    TextureUploadStats getStats() const;
+
+    // releases the GL objects, the queue sets itself up again on the next update
+    void shutdown();
+
+private:
+    struct Job {
+        std::weak_ptr<CachedTexture> texture;
+        Image image;
+        std::vector<Image> mips;
+        bool started = false;
+        int level = 0;          // level being uploaded, counts down to 0
+        int row = 0;            // first row of the next slice
+    };
+
+    // one frame worth of ring writes, free again once the fence signalled
+    struct InFlight {
+        GLsync fence;
+        size_t bytes;
+        size_t end;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Job> incoming;
+    std::deque<Job> active;
+    std::deque<InFlight> inFlight;
+    TextureUploadStats stats;
+
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr;
+    size_t ringSize = 0;
+    size_t head = 0;
+    size_t tail = 0;
+    size_t used = 0;
+
+    TextureUploadQueue() = default;
+
+    bool init();
+
+    void retire(bool wait);
+
+    // ring offset of bytes free bytes, ringSize if there is no room right now
+    size_t allocate(size_t bytes);
+
+    size_t largestFree() const;
+
+    void start(Job& job, CachedTexture& texture);
+
+    const Image& levelImage(const Job& job, int level) const;
+};
+
+#endif
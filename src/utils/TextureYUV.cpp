@@ -0,0 +1,118 @@
+#include "TextureYUV.h"
+#include "utils/MappedFile.h"
+#include "utils/Shader.h"
+#include "utils/TextureResidency.h"
+#include <iostream>
+
+TextureYUV::TextureYUV(): yTexture(0), uvTexture(0), width(0), height(0), colorSpace(YuvColorSpace::BT601) {
+}
+
+TextureYUV::~TextureYUV() {
+    release();
+}
+
+void TextureYUV::release() {
+    if (yTexture != 0) {
+        TextureResidency::getInstance().untrack(yTexture);
+        TextureResidency::getInstance().untrack(uvTexture);
+        glDeleteTextures(1, &yTexture);
+        glDeleteTextures(1, &uvTexture);
+        yTexture = 0;
+        uvTexture = 0;
+    }
+}
+
+static GLuint createPlane(GLint internalFormat, GLenum format, int width, int height) {
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    // one level, video frames are shown about at their size
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return id;
+}
+
+bool TextureYUV::create(int w, int h, YuvColorSpace space) {
+    if (w <= 0 || h <= 0) {
+        std::cout << "ERROR::TEXTURE_YUV:: invalid size " << w << "x" << h << std::endl;
+        return false;
+    }
+    release();
+    width = w;
+    height = h;
+    colorSpace = space;
+    yTexture = createPlane(GL_R8, GL_RED, width, height);
+    uvTexture = createPlane(GL_RG8, GL_RG, (width + 1) / 2, (height + 1) / 2);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // accounted only, the pixels come from the caller every frame
+    ResidencyFootprint footprint;
+    footprint.width = width;
+    footprint.height = height;
+    footprint.bytes = static_cast<size_t>(width) * height;
+    TextureResidency::getInstance().track(yTexture, GL_TEXTURE_2D, GL_RED, footprint, "NV12 Y");
+    footprint.width = (width + 1) / 2;
+    footprint.height = (height + 1) / 2;
+    footprint.bytes = static_cast<size_t>(footprint.width) * footprint.height * 2;
+    TextureResidency::getInstance().track(uvTexture, GL_TEXTURE_2D, GL_RG, footprint, "NV12 UV");
+    return true;
+}
+
+bool TextureYUV::loadFromFile(const std::string& filepath, int w, int h, YuvColorSpace space, int frame) {
+    MappedFile file;
+    if (!file.open(filepath)) {
+        std::cout << "ERROR::TEXTURE_YUV:: can not open " << filepath << std::endl;
+        return false;
+    }
+    const size_t frameBytes = nv12FrameBytes(w, h);
+    if (frame < 0 || (static_cast<size_t>(frame) + 1) * frameBytes > file.size()) {
+        std::cout << "ERROR::TEXTURE_YUV:: " << filepath << " has no frame " << frame << " of " << w << "x" << h << std::endl;
+        return false;
+    }
+    if (width != w || height != h || !isValid()) {
+        if (!create(w, h, space)) {
+            return false;
+        }
+    }
+    colorSpace = space;
+    const unsigned char* y = file.data() + static_cast<size_t>(frame) * frameBytes;
+    upload(y, y + static_cast<size_t>(w) * h);
+    return true;
+}
+
+void TextureYUV::upload(const unsigned char* y, const unsigned char* uv) {
+    // odd widths and the 2 byte UV texels are not 4 byte aligned rows
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, yTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, y);
+    glBindTexture(GL_TEXTURE_2D, uvTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (width + 1) / 2, (height + 1) / 2, GL_RG, GL_UNSIGNED_BYTE, uv);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
+
+void TextureYUV::bind(GLuint yUnit, GLuint uvUnit) const {
+    TextureResidency::getInstance().touch(yTexture);
+    TextureResidency::getInstance().touch(uvTexture);
+    glActiveTexture(GL_TEXTURE0 + yUnit);
+    glBindTexture(GL_TEXTURE_2D, yTexture);
+    glActiveTexture(GL_TEXTURE0 + uvUnit);
+    glBindTexture(GL_TEXTURE_2D, uvTexture);
+}
+
+void TextureYUV::unbind() const {
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TextureYUV::setUniforms(const Shader& shader, GLuint yUnit, GLuint uvUnit) const {
+    shader.setInt("textureY", static_cast<int>(yUnit));
+    shader.setInt("textureUV", static_cast<int>(uvUnit));
+    shader.setMatrix3("yuvToRgb", yuvToRgbMatrix(colorSpace));
+    shader.setFloat3("yuvOffset", yuvOffset());
+}
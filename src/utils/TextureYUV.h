@@ -0,0 +1,67 @@
+#ifndef OPENGL_UTILS_TEXTURE_YUV_H
+#define OPENGL_UTILS_TEXTURE_YUV_H
+
+#include <glad/glad.h>
+#include <string>
+#include "utils/YuvConvert.h"
+
+class Shader;
+
+/*
+ * NV12 image as two textures: Y (GL_R8, full size) and the interleaved UV plane (GL_RG8, half
+ * size). The shader samples both and converts with yuvToRgb / yuvOffset (setUniforms):
+ *
+ *   uniform sampler2D textureY;
+ *   uniform sampler2D textureUV;
+ *   uniform mat3 yuvToRgb;
+ *   uniform vec3 yuvOffset;
+ *   ...
+ *   vec3 yuv = vec3(texture(textureY, uv).r, texture(textureUV, uv).rg);
+ *   vec3 rgb = yuvToRgb * (yuv - yuvOffset);
+ *
+ * Rows are stored top-down like the source, flip v when sampling. The storage is allocated once,
+ * later frames only replace the pixels (see NV12Stream for streaming through pixel buffers).
+ */
+class TextureYUV {
+public:
+    TextureYUV();
+    ~TextureYUV();
+
+    TextureYUV(const TextureYUV&) = delete;
+    TextureYUV& operator=(const TextureYUV&) = delete;
+
+    // storage for both planes, contents undefined until the first upload
+    bool create(int width, int height, YuvColorSpace colorSpace = YuvColorSpace::BT601);
+
+    // one frame of a raw NV12 file (frames back to back, no header)
+    bool loadFromFile(const std::string& filepath, int width, int height, YuvColorSpace colorSpace = YuvColorSpace::BT601,
+                      int frame = 0);
+
+    // client memory, or offsets into the bound GL_PIXEL_UNPACK_BUFFER
+    void upload(const unsigned char* y, const unsigned char* uv);
+
+    void bind(GLuint yUnit = 0, GLuint uvUnit = 1) const;
+
+    void unbind() const;
+
+    // sampler units and the conversion for the color space, the shader must be in use
+    void setUniforms(const Shader& shader, GLuint yUnit = 0, GLuint uvUnit = 1) const;
+
+    void release();
+
+    GLuint getYId() const { return yTexture; }
+    GLuint getUVId() const { return uvTexture; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    YuvColorSpace getColorSpace() const { return colorSpace; }
+    void setColorSpace(YuvColorSpace space) { colorSpace = space; }
+    bool isValid() const { return yTexture != 0; }
+
+private:
+    GLuint yTexture;
+    GLuint uvTexture;
+    int width, height;
+    YuvColorSpace colorSpace;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(size_t threadCount): mStopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    mWorkers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        mWorkers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    for (auto& worker: mWorkers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::getInstance() {
+    static ThreadPool instance;
+    return instance;
+}
+
+void ThreadPool::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push(std::move(job));
+    }
+    mCondition.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+            if (mStopping && mJobs.empty()) {
+                return;
+            }
+            job = std::move(mJobs.front());
+            mJobs.pop();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1) {
+        func(0);
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next {0};
+        std::atomic<size_t> done {0};
+        std::function<void(size_t)> func;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    state->func = func;
+
+    // items are pulled from a shared counter so uneven work (big and small meshes) balances itself
+    auto run = [state, count]() {
+        for (size_t i = state->next.fetch_add(1); i < count; i = state->next.fetch_add(1)) {
+            state->func(i);
+            if (state->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count - 1, mWorkers.size());
+    for (size_t i = 0; i < helpers; i++) {
+        enqueue(run);
+    }
+    // the calling thread works too and only waits for items, not for helper jobs,
+    // so a nested call from inside a worker can not dead lock the pool
+    run();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count]() { return state->done.load() == count; });
+}
@@ -0,0 +1,55 @@
+#ifndef OPENGL_UTILS_THREAD_POOL_H
+#define OPENGL_UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Fixed size worker pool for cpu side asset work (mesh conversion, image decode ...)
+ * Jobs must never touch GL, the context only lives on the main thread.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // process wide pool sized to the core count
+    static ThreadPool& getInstance();
+
+    template<typename F>
+    auto submit(F&& func) -> std::future<typename std::invoke_result<F>::type> {
+        using Result = typename std::invoke_result<F>::type;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        std::future<Result> future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // runs func(i) for i in [0, count) across the workers and the calling thread, blocks until done
+    void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+    size_t getThreadCount() const { return mWorkers.size(); }
+
+private:
+    std::vector<std::thread> mWorkers;
+    std::queue<std::function<void()>> mJobs;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopping;
+
+    void enqueue(std::function<void()> job);
+    void workerLoop();
+};
+
+#endif
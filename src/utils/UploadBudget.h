@@ -0,0 +1,44 @@
+#ifndef OPENGL_UTILS_UPLOAD_BUDGET_H
+#define OPENGL_UTILS_UPLOAD_BUDGET_H
+
+#include <chrono>
+#include <cstddef>
+
+// how much GPU upload work may happen on the GL thread in one frame
+struct UploadBudget {
+    size_t maxBytes = 8 * 1024 * 1024;
+    double maxMilliseconds = 2.0;
+};
+
+/*
+ * Per frame bookkeeping for an UploadBudget.
+ * The first upload of a frame is always allowed, so an item bigger than the
+ * whole budget still makes progress instead of stalling forever.
+ */
+class UploadBudgetScope {
+public:
+    explicit UploadBudgetScope(const UploadBudget& budget)
+        : mBudget(budget), mBytes(0), mStart(std::chrono::steady_clock::now()) {}
+
+    bool canUpload(size_t bytes) const {
+        if (mBytes == 0) {
+            return true;
+        }
+        return mBytes + bytes <= mBudget.maxBytes && elapsedMilliseconds() < mBudget.maxMilliseconds;
+    }
+
+    void consume(size_t bytes) { mBytes += bytes; }
+
+    size_t bytesUploaded() const { return mBytes; }
+
+    double elapsedMilliseconds() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+    }
+
+private:
+    UploadBudget mBudget;
+    size_t mBytes;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+#endif
@@ -1,5 +1,25 @@
 #include "Utils.h"
+#include <cstring>
 
 namespace gl {
 
-}
\ No newline at end of file
+bool hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool hasVersion(int major, int minor) {
+    GLint currentMajor = 0, currentMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &currentMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &currentMinor);
+    return currentMajor > major || (currentMajor == major && currentMinor >= minor);
+}
+
+}
@@ -15,5 +15,15 @@ public:
     }
 };
 
+// context queries, need a current context
+namespace gl {
+
+bool hasExtension(const char* name);
+
+// core version of the current context is at least major.minor
+bool hasVersion(int major, int minor);
+
+}
+
 
 #endif //OPENGL_UTILS_H
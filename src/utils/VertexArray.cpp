@@ -2,6 +2,7 @@
 #include "VertexArray.h"
 #include "VertexBuffer.h"
 #include "utils/Application.h"
+#include "utils/DirectStateAccess.h"
 #include <utility>
 #include <vector>
 #include <iostream>
@@ -37,23 +38,58 @@ VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
 }
 
 void VertexArray::create() {
-    glGenVertexArrays(1, &mId);
+    if (gl::useDsa()) {
+        gl::dsa().createVertexArrays(1, &mId);
+    } else {
+        glGenVertexArrays(1, &mId);
+    }
 }
 
 void VertexArray::bind() const {
-    glBindVertexArray(mId);
+    gl::bindVertexArray(mId);
 }
 
 void VertexArray::unbind() const {
-    glBindVertexArray(0);
+    gl::bindVertexArray(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // the DSA path never binds the buffers
+    if (gl::useDsa()) {
+        return;
+    }
+    gl::bindBuffer(GL_ARRAY_BUFFER, 0);
     if (mIndexBufferBound) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        gl::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 }
 
+static GLsizei attributeBytes(const VertexAttribute& attr) {
+    // every AttributeType is 4 bytes wide
+    return attr.size * 4;
+}
+
 VertexArray& VertexArray::addVertexBuffer(const VertexBuffer& vbo, const std::vector<VertexAttribute>& attributes) {
+    if (gl::useDsa()) {
+        const gl::DsaFunctions& dsa = gl::dsa();
+        for (const auto& attr: attributes) {
+            /*
+             * one binding point per attribute carrying its own offset and stride is exactly what
+             * glVertexAttribPointer sets up; stride 0 means tightly packed there but not here
+             */
+            const GLsizei stride = attr.stride != 0 ? attr.stride : attributeBytes(attr);
+            dsa.enableVertexArrayAttrib(mId, attr.index);
+            if (attr.type == AttributeType::Int || attr.type == AttributeType::UInt) {
+                dsa.vertexArrayAttribIFormat(mId, attr.index, attr.size, static_cast<GLenum>(attr.type), 0);
+            } else {
+                dsa.vertexArrayAttribFormat(mId, attr.index, attr.size, static_cast<GLenum>(attr.type),
+                                            attr.normalized ? GL_TRUE : GL_FALSE, 0);
+            }
+            dsa.vertexArrayAttribBinding(mId, attr.index, attr.index);
+            dsa.vertexArrayVertexBuffer(mId, attr.index, vbo.id(), reinterpret_cast<GLintptr>(attr.offset), stride);
+        }
+        mVboIds.push_back(vbo.id());
+        return *this;
+    }
+
     bind();
     vbo.bind();
 
@@ -84,6 +120,11 @@ VertexArray& VertexArray::addVertexBuffer(const VertexBuffer& vbo, const std::ve
 }
 
 VertexArray& VertexArray::setIndexBuffer(const VertexBuffer& ibo) {
+    if (gl::useDsa()) {
+        gl::dsa().vertexArrayElementBuffer(mId, ibo.id());
+        mIndexBufferBound = true;
+        return *this;
+    }
     bind();
     ibo.bind();
     mIndexBufferBound = true;
@@ -1,7 +1,13 @@
 #include "VertexBuffer.h"
+#include "utils/DirectStateAccess.h"
 
 VertexBuffer::VertexBuffer(GLenum targetType): mId(0), mTargetType(targetType) {
-    glGenBuffers(1, &mId);
+    // a glCreateBuffers name is a buffer object right away, DSA calls on a glGenBuffers name fail until it was bound
+    if (gl::useDsa()) {
+        gl::dsa().createBuffers(1, &mId);
+    } else {
+        glGenBuffers(1, &mId);
+    }
 }
 
 VertexBuffer::~VertexBuffer() {
@@ -11,7 +17,7 @@ VertexBuffer::~VertexBuffer() {
     }
 }
 
-VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept : mId(other.mId) {
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept : mId(other.mId), mTargetType(other.mTargetType) {
     other.mId = 0;
 }
 
@@ -21,15 +27,25 @@ VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept {
             glDeleteBuffers(1, &mId);
         }
         mId = other.mId;
+        mTargetType = other.mTargetType;
         other.mId = 0;
     }
     return *this;
 }
 
 void VertexBuffer::bind() const {
-    glBindBuffer(mTargetType, mId);
+    gl::bindBuffer(mTargetType, mId);
 }
 
 void VertexBuffer::unbind() const {
-    glBindBuffer(mTargetType, 0);
+    gl::bindBuffer(mTargetType, 0);
+}
+
+void VertexBuffer::uploadBytes(const void* data, size_t bytes, BufferUsage usage) {
+    if (gl::useDsa()) {
+        gl::dsa().namedBufferData(mId, static_cast<GLsizeiptr>(bytes), data, static_cast<GLenum>(usage));
+        return;
+    }
+    bind();
+    glBufferData(mTargetType, static_cast<GLsizeiptr>(bytes), data, static_cast<GLenum>(usage));
 }
\ No newline at end of file
@@ -36,16 +36,17 @@ public:
 
     template<typename T>
     void upload(const std::vector<T>& data, BufferUsage usage = BufferUsage::StaticDraw) {
-        bind();
-        glBufferData(mTargetType, data.size() * sizeof(T), data.data(), static_cast<GLenum>(usage));
+        uploadBytes(data.data(), data.size() * sizeof(T), usage);
     }
 
     template<typename T>
     void upload(const T* data, size_t count, BufferUsage usage = BufferUsage::StaticDraw) {
-        bind();
-        glBufferData(mTargetType, count * sizeof(T), data, static_cast<GLenum>(usage));
+        uploadBytes(data, count * sizeof(T), usage);
     }
 
+    // glNamedBufferData with direct state access, otherwise bind + glBufferData (the buffer stays bound)
+    void uploadBytes(const void* data, size_t bytes, BufferUsage usage = BufferUsage::StaticDraw);
+
     GLuint id() const { return mId; }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "VertexQuantization.h"
+#include "utils/Mesh.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+float signNotZero(float value) {
+    return value >= 0.f ? 1.f : -1.f;
+}
+
+uint16_t toUnorm16(float value) {
+    return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.f), 1.f) * 65535.f));
+}
+
+int16_t toSnorm16(float value) {
+    return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.f), 1.f) * 32767.f));
+}
+
+float fromSnorm16(int16_t value) {
+    return std::max(value / 32767.f, -1.f);
+}
+
+glm::vec3 decodePosition(const QuantizedVertex& vertex, const QuantizationBounds& bounds) {
+    return bounds.offset + glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]) / 65535.f * bounds.scale;
+}
+
+}
+
+size_t vertexStride(VertexFormat format) {
+    return format == VertexFormat::Quantized ? sizeof(QuantizedVertex) : sizeof(Vertex);
+}
+
+void setupVertexAttributes(VertexFormat format) {
+    // order: vertex  normal texcoord
+    if (format == VertexFormat::Quantized) {
+        const GLsizei stride = sizeof(QuantizedVertex);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, position));
+        glEnableVertexAttribArray(0);
+
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, normal));
+        glEnableVertexAttribArray(1);
+
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(QuantizedVertex, texcoords));
+        glEnableVertexAttribArray(2);
+        return;
+    }
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(Vertex), (void*)offsetof(Vertex, texcoords));
+    glEnableVertexAttribArray(2);
+}
+
+QuantizationBounds computeQuantizationBounds(const Vertex* vertices, size_t count) {
+    QuantizationBounds bounds;
+    if (count == 0) {
+        return bounds;
+    }
+    glm::vec3 min = vertices[0].position;
+    glm::vec3 max = vertices[0].position;
+    for (size_t i = 1; i < count; i++) {
+        min = glm::min(min, vertices[i].position);
+        max = glm::max(max, vertices[i].position);
+    }
+    bounds.offset = min;
+    bounds.scale = max - min;
+    return bounds;
+}
+
+void quantizeVertices(const Vertex* vertices, size_t count, const QuantizationBounds& bounds, QuantizedVertex* out) {
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& vertex = vertices[i];
+        QuantizedVertex& q = out[i];
+        for (int axis = 0; axis < 3; axis++) {
+            // flat axes (scale 0) all land on the offset
+            const float scale = bounds.scale[axis];
+            q.position[axis] = scale > 0.f ? toUnorm16((vertex.position[axis] - bounds.offset[axis]) / scale) : 0;
+        }
+        q.padding = 0;
+
+        const glm::vec2 normal = octEncode(vertex.normal);
+        q.normal[0] = toSnorm16(normal.x);
+        q.normal[1] = toSnorm16(normal.y);
+
+        q.texcoords[0] = floatToHalf(vertex.texcoords.x);
+        q.texcoords[1] = floatToHalf(vertex.texcoords.y);
+    }
+}
+
+QuantizationError measureQuantizationError(const Vertex* vertices, size_t count) {
+    QuantizationError error;
+    const QuantizationBounds bounds = computeQuantizationBounds(vertices, count);
+    error.extent = std::max(bounds.scale.x, std::max(bounds.scale.y, bounds.scale.z));
+
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& vertex = vertices[i];
+        QuantizedVertex q;
+        quantizeVertices(&vertex, 1, bounds, &q);
+
+        error.maxPositionError = std::max(error.maxPositionError, glm::length(decodePosition(q, bounds) - vertex.position));
+
+        // meshes without normals carry zero vectors, nothing to compare
+        const float normalLength = glm::length(vertex.normal);
+        if (normalLength > 0.f) {
+            const glm::vec3 decoded = octDecode(glm::vec2(fromSnorm16(q.normal[0]), fromSnorm16(q.normal[1])));
+            const float cosAngle = std::min(std::max(glm::dot(decoded, vertex.normal / normalLength), -1.f), 1.f);
+            error.maxNormalError = std::max(error.maxNormalError, std::acos(cosAngle) * 57.29578f);
+        }
+
+        error.maxTexcoordError = std::max(error.maxTexcoordError, std::max(
+            std::fabs(halfToFloat(q.texcoords[0]) - vertex.texcoords.x), std::fabs(halfToFloat(q.texcoords[1]) - vertex.texcoords.y)));
+    }
+    return error;
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t exponentBits = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponentBits == 0xff) {
+        // inf / nan
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+    const int exponent = static_cast<int>(exponentBits) - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+    if (exponent <= 0) {
+        // subnormal half, or zero when too small
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        const int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    // round to nearest, a carry correctly bumps the exponent
+    if (mantissa & 0x1000) {
+        half++;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value) {
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    const uint32_t mantissa = value & 0x3ff;
+
+    if (exponent == 0) {
+        const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -magnitude : magnitude;
+    }
+    uint32_t bits;
+    if (exponent == 31) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+glm::vec2 octEncode(const glm::vec3& normal) {
+    const float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (sum == 0.f) {
+        return glm::vec2(0.f);
+    }
+    const glm::vec3 n = normal / sum;
+    if (n.z >= 0.f) {
+        return glm::vec2(n.x, n.y);
+    }
+    // fold the lower hemisphere over the diagonals
+    return glm::vec2((1.f - std::fabs(n.y)) * signNotZero(n.x), (1.f - std::fabs(n.x)) * signNotZero(n.y));
+}
+
+glm::vec3 octDecode(const glm::vec2& encoded) {
+    glm::vec3 n(encoded.x, encoded.y, 1.f - std::fabs(encoded.x) - std::fabs(encoded.y));
+    if (n.z < 0.f) {
+        const float x = n.x;
+        n.x = (1.f - std::fabs(n.y)) * signNotZero(x);
+        n.y = (1.f - std::fabs(x)) * signNotZero(n.y);
+    }
+    return glm::normalize(n);
+}
@@ -0,0 +1,62 @@
+#ifndef OPENGL_UTILS_VERTEX_QUANTIZATION_H
+#define OPENGL_UTILS_VERTEX_QUANTIZATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+struct Vertex;
+
+/*
+ * Compact vertex layout, 16 bytes instead of the 32 of Vertex:
+ *   position   3 x unorm16, relative to the mesh AABB (decoded with positionOffset/positionScale uniforms)
+ *   normal     2 x snorm16, octahedral encoding
+ *   texcoords  2 x half float
+ * Attribute locations match Vertex (0 position, 1 normal, 2 texcoords), but the vertex shader has
+ * to decode, see shaders/03_shaders/01_2_Quantized_Model_vs.glsl.
+ */
+enum class VertexFormat {
+    Float,
+    Quantized,
+};
+
+struct QuantizedVertex {
+    uint16_t position[3];
+    uint16_t padding;
+    int16_t normal[2];
+    uint16_t texcoords[2];
+};
+
+// decode: position = offset + unorm * scale
+struct QuantizationBounds {
+    glm::vec3 offset {0.f};
+    glm::vec3 scale {0.f};
+};
+
+// worst case difference between the source and the decoded vertices
+struct QuantizationError {
+    float maxPositionError = 0.f;   // model units
+    float maxNormalError = 0.f;     // degrees
+    float maxTexcoordError = 0.f;
+    float extent = 0.f;             // largest AABB side, to put the position error in relation
+};
+
+size_t vertexStride(VertexFormat format);
+
+// vertex attribute pointers for the bound VAO / GL_ARRAY_BUFFER
+void setupVertexAttributes(VertexFormat format);
+
+QuantizationBounds computeQuantizationBounds(const Vertex* vertices, size_t count);
+
+void quantizeVertices(const Vertex* vertices, size_t count, const QuantizationBounds& bounds, QuantizedVertex* out);
+
+// quantizes and decodes again without keeping the result, cheap enough to run at import
+QuantizationError measureQuantizationError(const Vertex* vertices, size_t count);
+
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+glm::vec2 octEncode(const glm::vec3& normal);
+glm::vec3 octDecode(const glm::vec2& encoded);
+
+#endif
@@ -0,0 +1,605 @@
+#include "VirtualTexture.h"
+#include "utils/MappedFile.h"
+#include "utils/Shader.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+struct VirtualTextureHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t border;
+    uint32_t levels;
+    uint32_t reserved;
+};
+
+constexpr char VTEX_MAGIC[4] = {'V', 'T', 'E', 'X'};
+constexpr uint32_t VTEX_VERSION = 1;
+// bounds the tiles held in memory between the file and the gpu
+constexpr size_t MAX_LOADS_IN_FLIGHT = 64;
+// page coordinates are stored in 8 bit page table channels
+constexpr int MAX_PAGES_PER_SIDE = 256;
+
+uint32_t packEntry(int pageX, int pageY, int level) {
+    const unsigned char bytes[4] = {static_cast<unsigned char>(pageX), static_cast<unsigned char>(pageY),
+                                    static_cast<unsigned char>(level), 255};
+    uint32_t entry;
+    std::memcpy(&entry, bytes, sizeof(entry));
+    return entry;
+}
+
+int keyLevel(uint64_t key) { return static_cast<int>(key >> 48); }
+int keyY(uint64_t key) { return static_cast<int>((key >> 24) & 0xFFFFFF); }
+int keyX(uint64_t key) { return static_cast<int>(key & 0xFFFFFF); }
+
+void readRgba(const Image& image, int x, int y, unsigned char* out) {
+    const unsigned char* p = image.pixels.data() + (static_cast<size_t>(y) * image.width + x) * image.channels;
+    switch (image.channels) {
+        case 1: out[0] = out[1] = out[2] = p[0]; out[3] = 255; break;
+        case 2: out[0] = out[1] = out[2] = p[0]; out[3] = p[1]; break;
+        case 3: out[0] = p[0]; out[1] = p[1]; out[2] = p[2]; out[3] = 255; break;
+        default: std::memcpy(out, p, 4); break;
+    }
+}
+
+}
+
+struct VirtualTexture::LoadState {
+    MappedFile file;
+    size_t dataOffset = 0;
+    std::mutex mutex;
+    std::vector<TileData> done;
+};
+
+size_t VirtualTextureInfo::tileCount() const {
+    size_t count = 0;
+    for (int level = 0; level < levels; level++) {
+        count += static_cast<size_t>(tilesX(level)) * tilesY(level);
+    }
+    return count;
+}
+
+static int nextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+int VirtualTextureInfo::tableWidth(int level) const {
+    return std::max(1, nextPowerOfTwo(tilesX(0)) >> level);
+}
+
+int VirtualTextureInfo::tableHeight(int level) const {
+    return std::max(1, nextPowerOfTwo(tilesY(0)) >> level);
+}
+
+size_t VirtualTextureInfo::tileIndex(int level, int x, int y) const {
+    size_t index = 0;
+    for (int i = 0; i < level; i++) {
+        index += static_cast<size_t>(tilesX(i)) * tilesY(i);
+    }
+    return index + static_cast<size_t>(y) * tilesX(level) + x;
+}
+
+bool isVirtualTexturePath(const std::string& path) {
+    return path.size() > 5 && path.compare(path.size() - 5, 5, ".vtex") == 0;
+}
+
+bool bakeVirtualTexture(const Image& source, const std::string& path, const VirtualTextureBakeOptions& options) {
+    if (!source.isValid() || options.tileSize < 16 || options.border < 0 || options.border > options.tileSize / 2 || options.repeat < 1) {
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: invalid bake input for " << path << std::endl;
+        return false;
+    }
+    VirtualTextureInfo info;
+    info.width = source.width * options.repeat;
+    info.height = source.height * options.repeat;
+    info.tileSize = options.tileSize;
+    info.border = options.border;
+    info.levels = 1;
+    while (info.levelWidth(info.levels - 1) > info.tileSize || info.levelHeight(info.levels - 1) > info.tileSize) {
+        info.levels++;
+    }
+    if (info.tilesX(0) > (1 << 12) || info.tilesY(0) > (1 << 12)) {
+        // the feedback buffer encodes tile coordinates in 12 bits
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: " << info.width << "x" << info.height << " needs more than 4096 tiles per side, raise the tile size" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: can not write " << path << std::endl;
+        return false;
+    }
+    VirtualTextureHeader header = {};
+    std::memcpy(header.magic, VTEX_MAGIC, sizeof(VTEX_MAGIC));
+    header.version = VTEX_VERSION;
+    header.width = static_cast<uint32_t>(info.width);
+    header.height = static_cast<uint32_t>(info.height);
+    header.tileSize = static_cast<uint32_t>(info.tileSize);
+    header.border = static_cast<uint32_t>(info.border);
+    header.levels = static_cast<uint32_t>(info.levels);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // the virtual image is never built, a texel of level n comes from level n of the source mip chain
+    const std::vector<Image> chain = buildMipLevels(source, options.colorSpace);
+    const int padded = info.paddedTileSize();
+    const size_t tileBytes = info.tileBytes();
+    for (int level = 0; level < info.levels; level++) {
+        const Image& image = level == 0 ? source : chain[std::min<size_t>(level, chain.size()) - 1];
+        const int width = info.levelWidth(level);
+        const int height = info.levelHeight(level);
+        const int tilesX = info.tilesX(level);
+        std::vector<unsigned char> row(tilesX * tileBytes);
+        for (int ty = 0; ty < info.tilesY(level); ty++) {
+            ThreadPool::getInstance().parallelFor(tilesX, [&](size_t tx) {
+                unsigned char* tile = row.data() + tx * tileBytes;
+                for (int j = 0; j < padded; j++) {
+                    const int vy = std::min(std::max(ty * info.tileSize + j - info.border, 0), height - 1);
+                    // position inside the copy of the source, exact even when the level sizes do not divide
+                    const double fy = (vy + 0.5) * options.repeat / height;
+                    const int sy = std::min(static_cast<int>((fy - std::floor(fy)) * image.height), image.height - 1);
+                    for (int i = 0; i < padded; i++) {
+                        const int vx = std::min(std::max(static_cast<int>(tx) * info.tileSize + i - info.border, 0), width - 1);
+                        const double fx = (vx + 0.5) * options.repeat / width;
+                        const int sx = std::min(static_cast<int>((fx - std::floor(fx)) * image.width), image.width - 1);
+                        readRgba(image, sx, sy, tile + (static_cast<size_t>(j) * padded + i) * 4);
+                    }
+                }
+            });
+            file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+        }
+    }
+    if (!file) {
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: failed writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+VirtualTexture::VirtualTexture() = default;
+
+VirtualTexture::~VirtualTexture() {
+    close();
+}
+
+uint64_t VirtualTexture::makeKey(int level, int x, int y) {
+    return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+}
+
+bool VirtualTexture::open(const std::string& path, int pagesPerSide) {
+    close();
+    auto state = std::make_shared<LoadState>();
+    if (!state->file.open(path)) {
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: can not open " << path << std::endl;
+        return false;
+    }
+    VirtualTextureHeader header;
+    if (state->file.size() < sizeof(header)) {
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: truncated file " << path << std::endl;
+        return false;
+    }
+    std::memcpy(&header, state->file.data(), sizeof(header));
+    if (std::memcmp(header.magic, VTEX_MAGIC, sizeof(VTEX_MAGIC)) != 0 || header.version != VTEX_VERSION || header.levels == 0
+        || header.levels > 32 || header.tileSize == 0) {
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: not a virtual texture " << path << std::endl;
+        return false;
+    }
+    info.width = static_cast<int>(header.width);
+    info.height = static_cast<int>(header.height);
+    info.tileSize = static_cast<int>(header.tileSize);
+    info.border = static_cast<int>(header.border);
+    info.levels = static_cast<int>(header.levels);
+    state->dataOffset = sizeof(header);
+    if (state->dataOffset + info.tileCount() * info.tileBytes() > state->file.size()) {
+        std::cout << "ERROR::VIRTUAL_TEXTURE:: truncated tile data in " << path << std::endl;
+        return false;
+    }
+    // a page table level that can not hold its tiles would leave the table mipmap incomplete
+    for (int level = 0; level < info.levels; level++) {
+        if (info.tilesX(level) > info.tableWidth(level) || info.tilesY(level) > info.tableHeight(level)) {
+            std::cout << "ERROR::VIRTUAL_TEXTURE:: level " << level << " of " << path << " has " << info.tilesX(level) << "x"
+                      << info.tilesY(level) << " tiles, the page table only " << info.tableWidth(level) << "x"
+                      << info.tableHeight(level) << std::endl;
+            return false;
+        }
+    }
+    loads = state;
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    const int padded = info.paddedTileSize();
+    this->pagesPerSide = std::max(1, std::min({pagesPerSide, MAX_PAGES_PER_SIDE, maxSize / padded}));
+    const int pageCount = this->pagesPerSide * this->pagesPerSide;
+    const int side = this->pagesPerSide * padded;
+
+    glGenTextures(1, &pageTexture);
+    glBindTexture(GL_TEXTURE_2D, pageTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, side, side, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenTextures(1, &tableTexture);
+    glBindTexture(GL_TEXTURE_2D, tableTexture);
+    table.assign(info.levels, {});
+    size_t tableBytes = 0;
+    for (int level = 0; level < info.levels; level++) {
+        table[level].assign(static_cast<size_t>(info.tilesX(level)) * info.tilesY(level), 0);
+        // the padding texels are never fetched, the shaders clamp to the real tile count
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, info.tableWidth(level), info.tableHeight(level), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        tableBytes += static_cast<size_t>(info.tableWidth(level)) * info.tableHeight(level) * sizeof(uint32_t);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, info.levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    pages.assign(pageCount, Page());
+    freePages.clear();
+    for (int page = pageCount; page-- > 0;) {
+        freePages.push_back(page);
+    }
+
+    stats = VirtualTextureStats();
+    stats.capacity = static_cast<size_t>(pageCount);
+    stats.gpuBytes = static_cast<size_t>(side) * side * 4 + tableBytes;
+    for (int level = 0; level < info.levels; level++) {
+        stats.virtualBytes += static_cast<size_t>(info.levelWidth(level)) * info.levelHeight(level) * 4;
+    }
+
+    // the single tile of the coarsest level is the fallback for everything else
+    const int top = info.levels - 1;
+    const int page = acquirePage();
+    const uint64_t key = makeKey(top, 0, 0);
+    upload(key, page, loads->file.data() + loads->dataOffset + info.tileIndex(top, 0, 0) * info.tileBytes());
+    pages[page].pinned = true;
+    lru.erase(pages[page].lru);
+
+    std::cout << "VirtualTexture: " << path << " " << info.width << "x" << info.height << ", " << info.levels << " levels of "
+              << info.tileSize << " texel tiles, " << pageCount << " pages (" << stats.gpuBytes / (1024 * 1024) << " MB of "
+              << stats.virtualBytes / (1024 * 1024) << " MB resident at most)" << std::endl;
+    return true;
+}
+
+void VirtualTexture::close() {
+    if (pageTexture != 0) {
+        glDeleteTextures(1, &pageTexture);
+        glDeleteTextures(1, &tableTexture);
+        pageTexture = tableTexture = 0;
+    }
+    if (feedbackFramebuffer != 0) {
+        glDeleteFramebuffers(1, &feedbackFramebuffer);
+        glDeleteRenderbuffers(1, &feedbackColor);
+        glDeleteRenderbuffers(1, &feedbackDepth);
+        glDeleteBuffers(2, feedbackBuffers);
+        feedbackFramebuffer = feedbackColor = feedbackDepth = 0;
+        feedbackBuffers[0] = feedbackBuffers[1] = 0;
+        feedbackWidth = feedbackHeight = 0;
+        feedbackPending[0] = feedbackPending[1] = false;
+    }
+    // tile jobs still running keep their LoadState alive and finish into it
+    loads.reset();
+    pages.clear();
+    freePages.clear();
+    lru.clear();
+    resident.clear();
+    loading.clear();
+    requested.clear();
+    ready.clear();
+    table.clear();
+}
+
+void VirtualTexture::beginFeedback(int viewWidth, int viewHeight) {
+    const int width = std::max(1, viewWidth / FEEDBACK_SCALE);
+    const int height = std::max(1, viewHeight / FEEDBACK_SCALE);
+    if (feedbackFramebuffer == 0) {
+        glGenFramebuffers(1, &feedbackFramebuffer);
+        glGenRenderbuffers(1, &feedbackColor);
+        glGenRenderbuffers(1, &feedbackDepth);
+        glGenBuffers(2, feedbackBuffers);
+    }
+    if (width != feedbackWidth || height != feedbackHeight) {
+        feedbackWidth = width;
+        feedbackHeight = height;
+        glBindRenderbuffer(GL_RENDERBUFFER, feedbackColor);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        for (GLuint buffer: feedbackBuffers) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 4, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        feedbackPending[0] = feedbackPending[1] = false;
+    }
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &savedFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, savedClearColor);
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, feedbackColor);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth);
+    glViewport(0, 0, width, height);
+    // level 0 in the blue channel means no request
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTexture::endFeedback() {
+    const int index = feedbackFrame % 2;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[index]);
+    glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    feedbackPending[index] = true;
+    feedbackFrame++;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(savedFramebuffer));
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+    glClearColor(savedClearColor[0], savedClearColor[1], savedClearColor[2], savedClearColor[3]);
+}
+
+void VirtualTexture::readFeedback() {
+    // the buffer written one frame ago, its copy has finished by now in all but the slowest cases
+    const int index = feedbackFrame % 2;
+    if (!feedbackPending[index]) {
+        return;
+    }
+    feedbackPending[index] = false;
+    const size_t size = static_cast<size_t>(feedbackWidth) * feedbackHeight * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[index]);
+    const auto* pixels = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+    if (pixels) {
+        uint32_t previous = 0;
+        for (size_t i = 0; i < size; i += 4) {
+            uint32_t value;
+            std::memcpy(&value, pixels + i, sizeof(value));
+            // neighbouring pixels mostly want the same tile
+            if (value == previous || pixels[i + 2] == 0) {
+                continue;
+            }
+            previous = value;
+            const int x = pixels[i] | ((pixels[i + 3] & 0x0F) << 8);
+            const int y = pixels[i + 1] | ((pixels[i + 3] >> 4) << 8);
+            request(pixels[i + 2] - 1, x, y);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void VirtualTexture::request(int level, int x, int y) {
+    if (level < 0 || level >= info.levels || x < 0 || y < 0 || x >= info.tilesX(level) || y >= info.tilesY(level)) {
+        return;
+    }
+    requested.insert(makeKey(level, x, y));
+}
+
+void VirtualTexture::requestRegion(const glm::vec2& uvMin, const glm::vec2& uvMax, float screenPixels) {
+    if (!isOpen()) {
+        return;
+    }
+    const glm::vec2 low = glm::clamp(glm::min(uvMin, uvMax), 0.0f, 1.0f);
+    const glm::vec2 high = glm::clamp(glm::max(uvMin, uvMax), 0.0f, 1.0f);
+    const float texels = std::max((high.x - low.x) * info.width, (high.y - low.y) * info.height);
+    const float ratio = texels / std::max(screenPixels, 1.0f);
+    const int level = std::min(std::max(static_cast<int>(std::floor(std::log2(std::max(ratio, 1.0f)))), 0), info.levels - 1);
+    const float tileU = static_cast<float>(info.tileSize) / info.levelWidth(level);
+    const float tileV = static_cast<float>(info.tileSize) / info.levelHeight(level);
+    const int x0 = static_cast<int>(low.x / tileU), x1 = std::min(static_cast<int>(high.x / tileU), info.tilesX(level) - 1);
+    const int y0 = static_cast<int>(low.y / tileV), y1 = std::min(static_cast<int>(high.y / tileV), info.tilesY(level) - 1);
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            request(level, x, y);
+        }
+    }
+}
+
+int VirtualTexture::acquirePage() {
+    if (!freePages.empty()) {
+        const int page = freePages.back();
+        freePages.pop_back();
+        return page;
+    }
+    if (lru.empty() || pages[lru.back()].lastUsed == frame) {
+        return -1;
+    }
+    const int page = lru.back();
+    evict(page);
+    return page;
+}
+
+void VirtualTexture::touch(int page) {
+    pages[page].lastUsed = frame;
+    if (!pages[page].pinned) {
+        lru.splice(lru.begin(), lru, pages[page].lru);
+    }
+}
+
+void VirtualTexture::evict(int page) {
+    Page& entry = pages[page];
+    resident.erase(entry.key);
+    lru.erase(entry.lru);
+    entry.occupied = false;
+    stats.evictedTiles++;
+    refreshTable(keyLevel(entry.key), keyX(entry.key), keyY(entry.key));
+}
+
+void VirtualTexture::upload(uint64_t key, int page, const unsigned char* pixels) {
+    const int padded = info.paddedTileSize();
+    glBindTexture(GL_TEXTURE_2D, pageTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (page % pagesPerSide) * padded, (page / pagesPerSide) * padded, padded, padded,
+                    GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    Page& entry = pages[page];
+    entry.key = key;
+    entry.occupied = true;
+    entry.lastUsed = frame;
+    lru.push_front(page);
+    entry.lru = lru.begin();
+    resident[key] = page;
+    stats.loadedTiles++;
+    refreshTable(keyLevel(key), keyX(key), keyY(key));
+}
+
+void VirtualTexture::refreshTable(int level, int x, int y) {
+    std::vector<uint32_t> rect;
+    glBindTexture(GL_TEXTURE_2D, tableTexture);
+    // top down, so the parent entries a fallback copies are already current
+    for (int k = level; k >= 0; k--) {
+        const int shift = level - k;
+        const int x0 = x << shift, x1 = std::min((x + 1) << shift, info.tilesX(k));
+        const int y0 = y << shift, y1 = std::min((y + 1) << shift, info.tilesY(k));
+        if (x0 >= x1 || y0 >= y1) {
+            break;
+        }
+        const int tilesX = info.tilesX(k);
+        rect.resize(static_cast<size_t>(x1 - x0) * (y1 - y0));
+        size_t n = 0;
+        for (int ty = y0; ty < y1; ty++) {
+            for (int tx = x0; tx < x1; tx++) {
+                uint32_t& entry = table[k][static_cast<size_t>(ty) * tilesX + tx];
+                auto it = resident.find(makeKey(k, tx, ty));
+                if (it != resident.end()) {
+                    entry = packEntry(it->second % pagesPerSide, it->second / pagesPerSide, k);
+                } else if (k + 1 < info.levels) {
+                    entry = table[k + 1][static_cast<size_t>(ty >> 1) * info.tilesX(k + 1) + (tx >> 1)];
+                }
+                rect[n++] = entry;
+            }
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, k, x0, y0, x1 - x0, y1 - y0, GL_RGBA, GL_UNSIGNED_BYTE, rect.data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void VirtualTexture::update(const UploadBudget& budget) {
+    if (!isOpen()) {
+        return;
+    }
+    frame++;
+    readFeedback();
+
+    // a visible tile keeps its ancestors, they are the fallback while it streams
+    std::vector<uint64_t> wanted(requested.begin(), requested.end());
+    for (uint64_t key: wanted) {
+        int level = keyLevel(key), x = keyX(key), y = keyY(key);
+        while (++level < info.levels) {
+            x >>= 1;
+            y >>= 1;
+            if (!requested.insert(makeKey(level, x, y)).second) {
+                break;
+            }
+        }
+    }
+
+    std::vector<uint64_t> missing;
+    stats.requestedTiles = requested.size();
+    stats.missingTiles = 0;
+    for (uint64_t key: requested) {
+        auto it = resident.find(key);
+        if (it != resident.end()) {
+            touch(it->second);
+            continue;
+        }
+        stats.missingTiles++;
+        if (loading.count(key) == 0) {
+            missing.push_back(key);
+        }
+    }
+    requested.clear();
+
+    // coarse levels first, they cover the most screen for the least data
+    std::sort(missing.begin(), missing.end(), [](uint64_t a, uint64_t b) {
+        return keyLevel(a) != keyLevel(b) ? keyLevel(a) > keyLevel(b) : a < b;
+    });
+    for (uint64_t key: missing) {
+        if (loading.size() >= MAX_LOADS_IN_FLIGHT) {
+            break;
+        }
+        loading.insert(key);
+        const size_t offset = loads->dataOffset + info.tileIndex(keyLevel(key), keyX(key), keyY(key)) * info.tileBytes();
+        const size_t bytes = info.tileBytes();
+        std::shared_ptr<LoadState> state = loads;
+        // the copy faults the pages of the mapping in off the GL thread
+        ThreadPool::getInstance().submit([state, key, offset, bytes]() {
+            std::vector<unsigned char> pixels(state->file.data() + offset, state->file.data() + offset + bytes);
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done.emplace_back(key, std::move(pixels));
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(loads->mutex);
+        for (auto& tile: loads->done) {
+            ready.push_back(std::move(tile));
+        }
+        loads->done.clear();
+    }
+    std::sort(ready.begin(), ready.end(), [](const TileData& a, const TileData& b) { return keyLevel(a.first) > keyLevel(b.first); });
+
+    UploadBudgetScope scope(budget);
+    size_t uploaded = 0, consumed = 0;
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (; consumed < ready.size(); consumed++) {
+        if (!scope.canUpload(info.tileBytes())) {
+            break;
+        }
+        const uint64_t key = ready[consumed].first;
+        loading.erase(key);
+        // every page is in use this frame: drop the tile, it is requested again while it stays visible
+        const int page = acquirePage();
+        if (page < 0) {
+            continue;
+        }
+        upload(key, page, ready[consumed].second.data());
+        scope.consume(info.tileBytes());
+        uploaded++;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    ready.erase(ready.begin(), ready.begin() + static_cast<std::ptrdiff_t>(consumed));
+
+    stats.residentTiles = resident.size();
+    stats.loadsInFlight = loading.size();
+    stats.uploadsLastFrame = uploaded;
+}
+
+void VirtualTexture::bind(GLuint pageUnit, GLuint tableUnit) const {
+    glActiveTexture(GL_TEXTURE0 + pageUnit);
+    glBindTexture(GL_TEXTURE_2D, pageTexture);
+    glActiveTexture(GL_TEXTURE0 + tableUnit);
+    glBindTexture(GL_TEXTURE_2D, tableTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void VirtualTexture::setUniforms(const Shader& shader, GLuint pageUnit, GLuint tableUnit) const {
+    shader.setInt("pageTexture", static_cast<int>(pageUnit));
+    shader.setInt("pageTable", static_cast<int>(tableUnit));
+    shader.setFloat2("virtualSize", static_cast<float>(info.width), static_cast<float>(info.height));
+    shader.setFloat("tileSize", static_cast<float>(info.tileSize));
+    shader.setFloat("tileBorder", static_cast<float>(info.border));
+    shader.setFloat("pageTextureSize", static_cast<float>(pagesPerSide * info.paddedTileSize()));
+    shader.setFloat("maxLevel", static_cast<float>(info.levels - 1));
+    shader.setFloat("feedbackBias", std::log2(static_cast<float>(FEEDBACK_SCALE)));
+}
+
+VirtualTextureStats VirtualTexture::getStats() const {
+    return stats;
+}
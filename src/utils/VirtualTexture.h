@@ -0,0 +1,186 @@
+#ifndef OPENGL_UTILS_VIRTUAL_TEXTURE_H
+#define OPENGL_UTILS_VIRTUAL_TEXTURE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "utils/Image.h"
+#include "utils/MipChain.h"
+#include "utils/UploadBudget.h"
+
+class Shader;
+
+/*
+ * Layout of a baked .vtex file: a header followed by every tile of every level, level 0 first,
+ * rows bottom-up, tiles left to right. Tiles are RGBA8 with border texels copied from their
+ * neighbours on each side, so bilinear filtering inside the physical page texture never
+ * reads another tile.
+ */
+struct VirtualTextureInfo {
+    int width = 0;          // level 0 texels
+    int height = 0;
+    int tileSize = 128;     // texels per tile side, border excluded
+    int border = 4;
+    int levels = 0;         // down to the level that fits one tile
+
+    int levelWidth(int level) const { return width >> level > 0 ? width >> level : 1; }
+    int levelHeight(int level) const { return height >> level > 0 ? height >> level : 1; }
+    int tilesX(int level) const { return (levelWidth(level) + tileSize - 1) / tileSize; }
+    int tilesY(int level) const { return (levelHeight(level) + tileSize - 1) / tileSize; }
+    // page table size of a level: tilesX / tilesY round up per level, but a complete mip chain
+    // needs level k at exactly max(1, size0 >> k), so level 0 is padded to a power of two
+    int tableWidth(int level) const;
+    int tableHeight(int level) const;
+    int paddedTileSize() const { return tileSize + 2 * border; }
+    size_t tileBytes() const { return static_cast<size_t>(paddedTileSize()) * paddedTileSize() * 4; }
+    size_t tileCount() const;
+    // position of a tile in the file, counted over all levels
+    size_t tileIndex(int level, int x, int y) const;
+};
+
+struct VirtualTextureBakeOptions {
+    int tileSize = 128;
+    int border = 4;
+    // the source tiled repeat x repeat times, a cheap way to a gigapixel test image
+    int repeat = 1;
+    MipColorSpace colorSpace = MipColorSpace::SRGB;
+};
+
+// splits source and its mip chain into tiles, writes them level by level without building the whole virtual image
+bool bakeVirtualTexture(const Image& source, const std::string& path, const VirtualTextureBakeOptions& options = VirtualTextureBakeOptions());
+
+bool isVirtualTexturePath(const std::string& path);
+
+struct VirtualTextureStats {
+    size_t capacity = 0;            // physical pages
+    size_t residentTiles = 0;
+    size_t requestedTiles = 0;      // last frame, ancestors included
+    size_t missingTiles = 0;        // requested but drawn from a coarser level
+    size_t loadsInFlight = 0;
+    size_t loadedTiles = 0;         // totals since open
+    size_t evictedTiles = 0;
+    size_t uploadsLastFrame = 0;
+    size_t gpuBytes = 0;            // page texture + page table, fixed by the capacity
+    size_t virtualBytes = 0;        // every level at full resolution
+};
+
+/*
+ * Tiled virtual texture: a fixed size physical page texture holds the tiles that are in view,
+ * a page table texture (one RGBA8 texel per tile and level: page x, page y, level the data
+ * comes from) maps virtual tiles to pages. Tiles that are not resident point at their closest
+ * resident ancestor, the coarsest level is always resident.
+ *
+ * Per frame:
+ *   beginFeedback / draw with the feedback shader / endFeedback  -> tiles the GPU wants
+ *   request / requestRegion                                      -> or a CPU estimate
+ *   update                                                       -> load, upload, evict (LRU)
+ *   bind + setUniforms                                           -> draw with the sampling shader
+ * Tiles are copied out of the memory mapped file on the ThreadPool, GPU uploads are limited
+ * by an UploadBudget. See shaders/03_shaders/03_1_Virtual_Texture_fs.glsl for the lookup.
+ */
+class VirtualTexture {
+public:
+    static constexpr int DEFAULT_PAGES_PER_SIDE = 32;
+    // the feedback target is this many times smaller than the view in each direction
+    static constexpr int FEEDBACK_SCALE = 8;
+
+    VirtualTexture();
+    ~VirtualTexture();
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    // pagesPerSide^2 physical pages, that is the whole VRAM cost of the tiles
+    bool open(const std::string& path, int pagesPerSide = DEFAULT_PAGES_PER_SIDE);
+
+    void close();
+
+    // binds and clears the feedback framebuffer, draw the visible geometry with the feedback shader after this
+    void beginFeedback(int viewWidth, int viewHeight);
+
+    // starts the asynchronous read back and restores the previous framebuffer and viewport
+    void endFeedback();
+
+    void request(int level, int x, int y);
+
+    // CPU estimate: the uv rect is visible and covers about screenPixels pixels across
+    void requestRegion(const glm::vec2& uvMin, const glm::vec2& uvMax, float screenPixels);
+
+    // GL thread, once per frame
+    void update(const UploadBudget& budget = UploadBudget());
+
+    void bind(GLuint pageUnit = 0, GLuint tableUnit = 1) const;
+
+    // the sampler units and the sizes both virtual texture shaders need
+    void setUniforms(const Shader& shader, GLuint pageUnit = 0, GLuint tableUnit = 1) const;
+
+    const VirtualTextureInfo& getInfo() const { return info; }
+    VirtualTextureStats getStats() const;
+    bool isOpen() const { return pageTexture != 0; }
+
+private:
+    struct LoadState;
+    struct Page {
+        uint64_t key = 0;
+        uint64_t lastUsed = 0;      // frame
+        bool occupied = false;
+        bool pinned = false;        // coarsest level, never evicted
+        std::list<int>::iterator lru;
+    };
+    using TileData = std::pair<uint64_t, std::vector<unsigned char>>;
+
+    VirtualTextureInfo info;
+    std::shared_ptr<LoadState> loads;
+
+    GLuint pageTexture = 0;
+    GLuint tableTexture = 0;
+    int pagesPerSide = 0;
+    std::vector<Page> pages;
+    std::vector<int> freePages;
+    std::list<int> lru;                                 // least recently used at the back
+    std::unordered_map<uint64_t, int> resident;         // tile key -> page
+    std::unordered_set<uint64_t> loading;
+    std::unordered_set<uint64_t> requested;
+    std::vector<TileData> ready;                        // loaded, waiting for upload budget
+    std::vector<std::vector<uint32_t>> table;           // cpu copy of the page table, per level
+
+    GLuint feedbackFramebuffer = 0;
+    GLuint feedbackColor = 0;
+    GLuint feedbackDepth = 0;
+    GLuint feedbackBuffers[2] = {0, 0};
+    int feedbackWidth = 0;
+    int feedbackHeight = 0;
+    int feedbackFrame = 0;
+    bool feedbackPending[2] = {false, false};
+    GLint savedFramebuffer = 0;
+    GLint savedViewport[4] = {0, 0, 0, 0};
+    GLfloat savedClearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    uint64_t frame = 0;
+    VirtualTextureStats stats;
+
+    static uint64_t makeKey(int level, int x, int y);
+
+    void readFeedback();
+
+    void upload(uint64_t key, int page, const unsigned char* pixels);
+
+    void evict(int page);
+
+    // a free page or the least recently used one not needed this frame, -1 if there is none
+    int acquirePage();
+
+    void touch(int page);
+
+    // rewrites the page table below a tile after it became resident or was evicted
+    void refreshTable(int level, int x, int y);
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include "YuvConvert.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YUV_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define YUV_SIMD_NEON 1
+#endif
+
+namespace {
+
+constexpr int BAND_ROWS = 32;
+constexpr size_t PARALLEL_MIN_PIXELS = 256 * 256;
+
+std::atomic<bool> simdEnabled {true};
+
+/*
+ * rgb * 64 = y * (Y - 16) + {rv * V, -gu * U - gv * V, bu * U}, U and V centered on 128.
+ * Every intermediate fits a saturating int16 lane; the ones that saturate clamp to 255 anyway.
+ */
+struct Coefficients {
+    int y, rv, gu, gv, bu;
+};
+
+const Coefficients& coefficientsFor(YuvColorSpace colorSpace) {
+    static const Coefficients bt601 {74, 102, 25, 52, 129};
+    static const Coefficients bt709 {74, 115, 14, 34, 135};
+    return colorSpace == YuvColorSpace::BT709 ? bt709 : bt601;
+}
+
+unsigned char clampByte(int value) {
+    return static_cast<unsigned char>(std::min(std::max(value >> 6, 0), 255));
+}
+
+void convertPixel(int y, int u, int v, const Coefficients& k, unsigned char* rgba) {
+    const int luma = k.y * (y - 16) + 32;
+    u -= 128;
+    v -= 128;
+    rgba[0] = clampByte(luma + k.rv * v);
+    rgba[1] = clampByte(luma - k.gu * u - k.gv * v);
+    rgba[2] = clampByte(luma + k.bu * u);
+    rgba[3] = 255;
+}
+
+#if YUV_SIMD_SSE2
+// (u0 v0 u1 v1 ..) as int16 -> (u0 u0 u1 u1 ..) and (v0 v0 v1 v1 ..)
+inline void splitChroma(__m128i uv, __m128i& u, __m128i& v) {
+    const __m128i low = _mm_and_si128(uv, _mm_set1_epi32(0xffff));
+    const __m128i high = _mm_srli_epi32(uv, 16);
+    u = _mm_or_si128(low, _mm_slli_epi32(low, 16));
+    v = _mm_or_si128(high, _mm_slli_epi32(high, 16));
+}
+
+// eight pixels, int16 lanes, result >> 6
+inline void convert8(__m128i y, __m128i u, __m128i v, const Coefficients& k, __m128i& r, __m128i& g, __m128i& b) {
+    const __m128i luma = _mm_adds_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), _mm_set1_epi16(static_cast<short>(k.y))),
+                                        _mm_set1_epi16(32));
+    r = _mm_srai_epi16(_mm_adds_epi16(luma, _mm_mullo_epi16(v, _mm_set1_epi16(static_cast<short>(k.rv)))), 6);
+    g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(static_cast<short>(k.gu)))),
+                                      _mm_mullo_epi16(v, _mm_set1_epi16(static_cast<short>(k.gv)))), 6);
+    b = _mm_srai_epi16(_mm_adds_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(static_cast<short>(k.bu)))), 6);
+}
+#endif
+
+// one row, x from 0; returns the first pixel left for the scalar tail
+int convertRowSimd(const unsigned char* y, const unsigned char* uv, int width, const Coefficients& k, unsigned char* rgba) {
+    int x = 0;
+#if YUV_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+    for (; x + 16 <= width; x += 16) {
+        const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i chroma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x));
+        __m128i u0, v0, u1, v1;
+        splitChroma(_mm_sub_epi16(_mm_unpacklo_epi8(chroma, zero), bias), u0, v0);
+        splitChroma(_mm_sub_epi16(_mm_unpackhi_epi8(chroma, zero), bias), u1, v1);
+
+        __m128i r0, g0, b0, r1, g1, b1;
+        convert8(_mm_unpacklo_epi8(luma, zero), u0, v0, k, r0, g0, b0);
+        convert8(_mm_unpackhi_epi8(luma, zero), u1, v1, k, r1, g1, b1);
+        const __m128i r = _mm_packus_epi16(r0, r1);
+        const __m128i g = _mm_packus_epi16(g0, g1);
+        const __m128i b = _mm_packus_epi16(b0, b1);
+
+        const __m128i rgLow = _mm_unpacklo_epi8(r, g);
+        const __m128i rgHigh = _mm_unpackhi_epi8(r, g);
+        const __m128i baLow = _mm_unpacklo_epi8(b, alpha);
+        const __m128i baHigh = _mm_unpackhi_epi8(b, alpha);
+        __m128i* out = reinterpret_cast<__m128i*>(rgba + x * 4);
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(rgLow, baLow));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rgLow, baLow));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rgHigh, baHigh));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rgHigh, baHigh));
+    }
+#elif YUV_SIMD_NEON
+    const int16x8_t lumaOffset = vdupq_n_s16(16);
+    const int16x8_t chromaOffset = vdupq_n_s16(128);
+    const int16x8_t round = vdupq_n_s16(32);
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t luma = vld1q_u8(y + x);
+        const uint8x8x2_t chroma = vld2_u8(uv + x);
+        // every U, V pair covers two pixels
+        const uint8x8x2_t us = vzip_u8(chroma.val[0], chroma.val[0]);
+        const uint8x8x2_t vs = vzip_u8(chroma.val[1], chroma.val[1]);
+
+        uint8x16x4_t out;
+        uint8x8_t r[2], g[2], b[2];
+        for (int half = 0; half < 2; half++) {
+            const uint8x8_t yHalf = half == 0 ? vget_low_u8(luma) : vget_high_u8(luma);
+            const int16x8_t yy = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(yHalf)), lumaOffset);
+            const int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(us.val[half])), chromaOffset);
+            const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vs.val[half])), chromaOffset);
+            const int16x8_t l = vqaddq_s16(vmulq_n_s16(yy, static_cast<int16_t>(k.y)), round);
+            r[half] = vqshrun_n_s16(vqaddq_s16(l, vmulq_n_s16(v, static_cast<int16_t>(k.rv))), 6);
+            g[half] = vqshrun_n_s16(vqsubq_s16(vqsubq_s16(l, vmulq_n_s16(u, static_cast<int16_t>(k.gu))),
+                                               vmulq_n_s16(v, static_cast<int16_t>(k.gv))), 6);
+            b[half] = vqshrun_n_s16(vqaddq_s16(l, vmulq_n_s16(u, static_cast<int16_t>(k.bu))), 6);
+        }
+        out.val[0] = vcombine_u8(r[0], r[1]);
+        out.val[1] = vcombine_u8(g[0], g[1]);
+        out.val[2] = vcombine_u8(b[0], b[1]);
+        out.val[3] = vdupq_n_u8(255);
+        vst4q_u8(rgba + x * 4, out);
+    }
+#else
+    (void)y;
+    (void)uv;
+    (void)width;
+    (void)k;
+    (void)rgba;
+#endif
+    return x;
+}
+
+void convertRows(const unsigned char* y, const unsigned char* uv, int width, const Coefficients& k, unsigned char* rgba,
+                 int begin, int end, bool simd) {
+    const size_t uvStride = static_cast<size_t>((width + 1) / 2) * 2;
+    for (int row = begin; row < end; row++) {
+        const unsigned char* yRow = y + static_cast<size_t>(row) * width;
+        const unsigned char* uvRow = uv + static_cast<size_t>(row / 2) * uvStride;
+        unsigned char* out = rgba + static_cast<size_t>(row) * width * 4;
+        int x = simd ? convertRowSimd(yRow, uvRow, width, k, out) : 0;
+        for (; x < width; x++) {
+            const unsigned char* pair = uvRow + (x / 2) * 2;
+            convertPixel(yRow[x], pair[0], pair[1], k, out + x * 4);
+        }
+    }
+}
+
+}
+
+size_t nv12FrameBytes(int width, int height) {
+    return static_cast<size_t>(width) * height + static_cast<size_t>((width + 1) / 2) * 2 * ((height + 1) / 2);
+}
+
+void convertNV12ToRGBA(const unsigned char* y, const unsigned char* uv, int width, int height, unsigned char* rgba,
+                       YuvColorSpace colorSpace, bool parallel) {
+    const Coefficients& k = coefficientsFor(colorSpace);
+    const bool simd = simdEnabled;
+    if (!parallel || static_cast<size_t>(width) * height < PARALLEL_MIN_PIXELS) {
+        convertRows(y, uv, width, k, rgba, 0, height, simd);
+        return;
+    }
+    // nested calls from a worker are fine, parallelFor lets the caller work through the bands itself
+    const size_t bands = (static_cast<size_t>(height) + BAND_ROWS - 1) / BAND_ROWS;
+    ThreadPool::getInstance().parallelFor(bands, [&](size_t band) {
+        const int begin = static_cast<int>(band) * BAND_ROWS;
+        convertRows(y, uv, width, k, rgba, begin, std::min(begin + BAND_ROWS, height), simd);
+    });
+}
+
+glm::mat3 yuvToRgbMatrix(YuvColorSpace colorSpace) {
+    // columns: Y, U, V
+    if (colorSpace == YuvColorSpace::BT709) {
+        return glm::mat3(glm::vec3(1.164f, 1.164f, 1.164f), glm::vec3(0.0f, -0.213f, 2.112f), glm::vec3(1.793f, -0.533f, 0.0f));
+    }
+    return glm::mat3(glm::vec3(1.164f, 1.164f, 1.164f), glm::vec3(0.0f, -0.391f, 2.018f), glm::vec3(1.596f, -0.813f, 0.0f));
+}
+
+glm::vec3 yuvOffset() {
+    return glm::vec3(16.0f / 255.0f, 128.0f / 255.0f, 128.0f / 255.0f);
+}
+
+const char* yuvSimdName() {
+#if YUV_SIMD_SSE2
+    return "SSE2";
+#elif YUV_SIMD_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void setYuvSimdEnabled(bool enabled) {
+    simdEnabled = enabled;
+}
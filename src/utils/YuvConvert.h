@@ -0,0 +1,39 @@
+#ifndef OPENGL_UTILS_YUV_CONVERT_H
+#define OPENGL_UTILS_YUV_CONVERT_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * NV12: a full resolution 8 bit Y plane followed by one half resolution plane of interleaved
+ * U, V pairs, rows tightly packed top-down. Video range (Y 16..235, UV 16..240).
+ */
+enum class YuvColorSpace: uint8_t {
+    BT601,      // SD video, most camera / decoder dumps
+    BT709,      // HD video
+};
+
+// Y plane + UV plane bytes of one frame
+size_t nv12FrameBytes(int width, int height);
+
+/*
+ * Reference / fallback conversion to RGBA8 (alpha 255), same row order as the input.
+ * 6 bit fixed point, the SSE2 / NEON kernels (picked at compile time) give the same bytes as
+ * the scalar one. parallel splits the rows across the ThreadPool.
+ */
+void convertNV12ToRGBA(const unsigned char* y, const unsigned char* uv, int width, int height, unsigned char* rgba,
+                       YuvColorSpace colorSpace = YuvColorSpace::BT601, bool parallel = true);
+
+// rgb = matrix * (yuv - offset), for the shader path (normalized texture values)
+glm::mat3 yuvToRgbMatrix(YuvColorSpace colorSpace);
+
+glm::vec3 yuvOffset();
+
+// "SSE2", "NEON" or "scalar"
+const char* yuvSimdName();
+
+// false forces the scalar kernel, for benchmarks and validation
+void setYuvSimdEnabled(bool enabled);
+
+#endif